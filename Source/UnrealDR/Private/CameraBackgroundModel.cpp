@@ -0,0 +1,96 @@
+#include "CameraBackgroundModel.h"
+#include "UnrealDRSimd.h"
+#include <Async/ParallelFor.h>
+
+DECLARE_CYCLE_STAT(TEXT("Background Model Update"), STAT_UnrealDR_BackgroundModelUpdate, STATGROUP_UnrealDR);
+
+FCameraBackgroundModel::FCameraBackgroundModel(uint32 bufferSize, uint8 adaptationStep, int32 outputFrames) :
+	m_bufferSize(bufferSize), m_adaptationStep(FMath::Max<uint8>(adaptationStep, 1))
+{
+	m_model.SetNumUninitialized(static_cast<int32>(bufferSize));
+	m_outputPool = MakeShared<FCameraFramePool, ESPMode::ThreadSafe>(bufferSize, FMath::Max(outputFrames, 1));
+}
+
+FCameraFrameRef FCameraBackgroundModel::Update(const FCameraFrame& frame)
+{
+	if (frame.Size != m_bufferSize)
+		return FCameraFrameRef();
+
+	SCOPE_CYCLE_COUNTER(STAT_UnrealDR_BackgroundModelUpdate);
+
+	FCameraFrameRef output = m_outputPool->Acquire();
+	uint8* model = m_model.GetData();
+	uint8* target = output.IsValid() ? output->Data : nullptr;
+
+	if (!m_initialized)
+	{
+		// Start from the first frame, so that the model does not need to converge from black.
+		FMemory::Memcpy(model, frame.Data, m_bufferSize);
+
+		if (target != nullptr)
+			FMemory::Memcpy(target, frame.Data, m_bufferSize);
+
+		m_initialized = true;
+	}
+	else
+	{
+		// Each block is updated independently, since every value only depends on its own history.
+		const int32 blocks = static_cast<int32>(FMath::DivideAndRoundUp(m_bufferSize, BlockSize));
+		const uint8 step = m_adaptationStep;
+		const uint32 bufferSize = m_bufferSize;
+
+		ParallelFor(blocks, [&frame, model, target, step, bufferSize](int32 block) {
+			const SIZE_T offset = static_cast<SIZE_T>(block) * BlockSize;
+			const SIZE_T size = FMath::Min<SIZE_T>(BlockSize, bufferSize - offset);
+			UpdateApproximateMedian(frame.Data + offset, model + offset, target != nullptr ? target + offset : nullptr, size, step);
+		});
+	}
+
+	if (output.IsValid())
+	{
+		output->Header = frame.Header;
+		output->ExposureTime = frame.ExposureTime;
+		output->bHasExposureTime = frame.bHasExposureTime;
+		output->HeaderPollTime = frame.HeaderPollTime;
+		output->CaptureTime = frame.CaptureTime;
+	}
+
+	return output;
+}
+
+void FCameraBackgroundModel::UpdateApproximateMedian(const uint8* frame, uint8* model, uint8* output, SIZE_T size, uint8 step) noexcept
+{
+	SIZE_T i = 0;
+
+#if UNREALDR_SIMD_SSE2
+	const __m128i steps = _mm_set1_epi8(static_cast<char>(step));
+
+	for (; i + 16 <= size; i += 16)
+	{
+		const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(frame + i));
+		__m128i estimate = _mm_loadu_si128(reinterpret_cast<const __m128i*>(model + i));
+
+		// At most one of both differences is non-zero, so adding one and subtracting the other never saturates in the wrong direction.
+		const __m128i increment = _mm_min_epu8(_mm_subs_epu8(values, estimate), steps);
+		const __m128i decrement = _mm_min_epu8(_mm_subs_epu8(estimate, values), steps);
+		estimate = _mm_subs_epu8(_mm_adds_epu8(estimate, increment), decrement);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(model + i), estimate);
+
+		if (output != nullptr)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), estimate);
+	}
+#endif
+
+	for (; i < size; ++i)
+	{
+		const uint8 value = frame[i];
+		const uint8 estimate = model[i];
+		const uint8 updated = value > estimate ? static_cast<uint8>(estimate + FMath::Min<uint8>(value - estimate, step)) : static_cast<uint8>(estimate - FMath::Min<uint8>(estimate - value, step));
+
+		model[i] = updated;
+
+		if (output != nullptr)
+			output[i] = updated;
+	}
+}
@@ -0,0 +1,261 @@
+#include "CameraCalibrationCache.h"
+#include "OpenVRCameraFrameSource.h"
+#include <HAL/PlatformFilemanager.h>
+#include <HAL/FileManager.h>
+#include <Misc/Paths.h>
+
+namespace
+{
+	/// <summary>
+	/// Copies a string into a fixed-size, null-terminated UTF-8 field, truncating it if necessary.
+	/// </summary>
+	void CopyString(ANSICHAR (&field)[UnrealDR::CalibrationCache::MaxStringLength], const FString& value)
+	{
+		FTCHARToUTF8 converted(*value);
+		const int32 length = FMath::Min(converted.Length(), UnrealDR::CalibrationCache::MaxStringLength - 1);
+
+		FMemory::Memzero(field);
+		FMemory::Memcpy(field, converted.Get(), length);
+	}
+
+	/// <summary>
+	/// Reads a fixed-size, null-terminated UTF-8 field.
+	/// </summary>
+	FString ReadString(const ANSICHAR (&field)[UnrealDR::CalibrationCache::MaxStringLength])
+	{
+		ANSICHAR terminated[UnrealDR::CalibrationCache::MaxStringLength];
+		FMemory::Memcpy(terminated, field, sizeof(terminated));
+		terminated[UnrealDR::CalibrationCache::MaxStringLength - 1] = '\0';
+
+		return FString(UTF8_TO_TCHAR(terminated));
+	}
+
+	/// <summary>
+	/// Returns the directory the calibration files are stored in.
+	/// </summary>
+	FString GetCacheDirectory()
+	{
+		return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("UnrealDR"), TEXT("Calibration"));
+	}
+
+	/// <summary>
+	/// The tolerance of calibration values, below which differences are attributed to rounding in the runtime.
+	/// </summary>
+	constexpr float CalibrationTolerance = 1e-4f;
+}
+
+bool FCameraCalibration::IsEquivalent(const FCameraCalibration& other) const noexcept
+{
+	if (FrameWidth != other.FrameWidth || FrameHeight != other.FrameHeight || FrameBufferSize != other.FrameBufferSize || HasExtrinsics != other.HasExtrinsics)
+		return false;
+
+	for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+	{
+		for (int i = 0; i < 2; ++i)
+		{
+			if (!FMath::IsNearlyEqual(FocalLength[e].v[i], other.FocalLength[e].v[i], CalibrationTolerance) || !FMath::IsNearlyEqual(Center[e].v[i], other.Center[e].v[i], CalibrationTolerance))
+				return false;
+		}
+
+		for (int r = 0; r < 3; ++r)
+		{
+			for (int c = 0; c < 4; ++c)
+			{
+				if (!FMath::IsNearlyEqual(CameraToHead[e].m[r][c], other.CameraToHead[e].m[r][c], CalibrationTolerance))
+					return false;
+			}
+		}
+
+		if (Distortion[e].Function != other.Distortion[e].Function)
+			return false;
+
+		for (int i = 0; i < vr::k_unMaxDistortionFunctionParameters; ++i)
+		{
+			if (!FMath::IsNearlyEqual(Distortion[e].Coefficients[i], other.Distortion[e].Coefficients[i], static_cast<double>(CalibrationTolerance)))
+				return false;
+		}
+
+		for (int i = 0; i < 4; ++i)
+		{
+			if (!FMath::IsNearlyEqual(Projection[e][i], other.Projection[e][i], CalibrationTolerance))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+FString FCameraCalibrationCache::GetKey(const FString& serial, const FString& trackingSystem, const FString& variant)
+{
+	return FPaths::MakeValidFileName(FString::Printf(TEXT("%s_%s_%s"), *trackingSystem, *serial, *variant), TEXT('_'));
+}
+
+FString FCameraCalibrationCache::GetKey(const FCameraCalibration& calibration)
+{
+	return GetKey(ReadString(calibration.Serial), ReadString(calibration.TrackingSystem), ReadString(calibration.Variant));
+}
+
+FString FCameraCalibrationCache::GetFileName(const FString& key)
+{
+	return FPaths::Combine(GetCacheDirectory(), key + TEXT(".udrcal"));
+}
+
+bool FCameraCalibrationCache::Load(const FString& key, FCameraCalibration& calibration)
+{
+	// If a save has been interrupted, before the new file has been moved into place, the previous record is still available under its backup name.
+	const FString fileName = GetFileName(key);
+	return Read(fileName, calibration) || Read(fileName + TEXT(".bak"), calibration);
+}
+
+bool FCameraCalibrationCache::FindLatest(const FString& serial, uint32 deviceIndex, const FString& variant, FCameraCalibration& calibration)
+{
+	TArray<FString> fileNames;
+	IFileManager::Get().FindFiles(fileNames, *FPaths::Combine(GetCacheDirectory(), TEXT("*.udrcal")), true, false);
+
+	// Visit the files from the most recently written one on, so that only the files written after the matching one need to be read.
+	TArray<TPair<FDateTime, FString>> candidates;
+	candidates.Reserve(fileNames.Num());
+
+	for (const FString& name : fileNames)
+	{
+		const FString fileName = FPaths::Combine(GetCacheDirectory(), name);
+		candidates.Emplace(IFileManager::Get().GetTimeStamp(*fileName), fileName);
+	}
+
+	candidates.Sort([](const TPair<FDateTime, FString>& a, const TPair<FDateTime, FString>& b) { return a.Key > b.Key; });
+
+	for (const auto& candidate : candidates)
+	{
+		FCameraCalibration record;
+
+		if (!Read(candidate.Value, record) || ReadString(record.Variant) != variant)
+			continue;
+
+		if (serial.IsEmpty() ? record.DeviceIndex != deviceIndex : ReadString(record.Serial) != serial)
+			continue;
+
+		calibration = record;
+		return true;
+	}
+
+	return false;
+}
+
+bool FCameraCalibrationCache::Save(const FString& key, const FCameraCalibration& calibration)
+{
+	IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+	const FString fileName = GetFileName(key);
+	const FString tempFileName = fileName + TEXT(".tmp");
+
+	platformFile.CreateDirectoryTree(*GetCacheDirectory());
+
+	// Write a temporary file and move it into place, so that concurrent loads never read a partial record.
+	{
+		TUniquePtr<IFileHandle> file(platformFile.OpenWrite(*tempFileName));
+
+		if (!file.IsValid() || !file->Write(reinterpret_cast<const uint8*>(&calibration), sizeof(calibration)))
+		{
+			UE_LOG(LOG_UNREAL_DR, Warning, TEXT("[UnrealDR] Unable to write camera calibration cache file \"%s\"."), *tempFileName);
+			return false;
+		}
+	}
+
+	// Platforms that rename over existing files replace the previous file atomically.
+	if (platformFile.MoveFile(*fileName, *tempFileName))
+		return true;
+
+	// Otherwise, keep the previous file under a backup name, until the new one is in place, so that a failed move does not lose the cached calibration.
+	const FString backupFileName = fileName + TEXT(".bak");
+	const bool replace = platformFile.FileExists(*fileName);
+
+	if (replace)
+	{
+		platformFile.DeleteFile(*backupFileName);
+
+		if (!platformFile.MoveFile(*backupFileName, *fileName))
+		{
+			UE_LOG(LOG_UNREAL_DR, Warning, TEXT("[UnrealDR] Unable to replace camera calibration cache file \"%s\"."), *fileName);
+			platformFile.DeleteFile(*tempFileName);
+			return false;
+		}
+	}
+
+	if (!platformFile.MoveFile(*fileName, *tempFileName))
+	{
+		UE_LOG(LOG_UNREAL_DR, Warning, TEXT("[UnrealDR] Unable to replace camera calibration cache file \"%s\"."), *fileName);
+		platformFile.DeleteFile(*tempFileName);
+
+		if (replace)
+			platformFile.MoveFile(*fileName, *backupFileName);
+
+		return false;
+	}
+
+	platformFile.DeleteFile(*backupFileName);
+	return true;
+}
+
+bool FCameraCalibrationCache::Query(const ICameraFrameSource& source, vr::IVRSystem* system, vr::TrackedDeviceIndex_t device, const FString& variant, FCameraCalibration& calibration)
+{
+	calibration = FCameraCalibration();
+	calibration.DeviceIndex = device;
+	CopyString(calibration.Variant, variant);
+
+	if (system != nullptr)
+	{
+		CopyString(calibration.Serial, FOpenVRCameraFrameSource::GetStringProperty(system, device, vr::Prop_SerialNumber_String));
+		CopyString(calibration.TrackingSystem, FOpenVRCameraFrameSource::GetStringProperty(system, device, vr::Prop_TrackingSystemName_String));
+	}
+
+	if (!source.GetFrameSize(calibration.FrameWidth, calibration.FrameHeight, calibration.FrameBufferSize))
+		return false;
+
+	calibration.HasExtrinsics = source.GetExtrinsics(calibration.CameraToHead) ? 1 : 0;
+
+	for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+	{
+		const vr::EVREye eye = static_cast<vr::EVREye>(e);
+
+		if (!source.GetIntrinsics(eye, calibration.FocalLength[e], calibration.Center[e]))
+			return false;
+
+		source.GetDistortion(eye, calibration.Distortion[e]);
+		float* projection = calibration.Projection[e];
+
+		// The projection of the display is only known to the HMD. Without it, the camera projection is used instead.
+		if (system != nullptr)
+		{
+			system->GetProjectionRaw(eye, &projection[0], &projection[1], &projection[2], &projection[3]);
+		}
+		else
+		{
+			const vr::HmdVector2_t& focalLength = calibration.FocalLength[e];
+			const vr::HmdVector2_t& center = calibration.Center[e];
+			projection[0] = -center.v[0] / focalLength.v[0];
+			projection[1] = (static_cast<float>(calibration.FrameWidth) - center.v[0]) / focalLength.v[0];
+			projection[2] = -center.v[1] / focalLength.v[1];
+			projection[3] = (static_cast<float>(calibration.FrameHeight) / 2.f - center.v[1]) / focalLength.v[1];
+		}
+	}
+
+	return true;
+}
+
+bool FCameraCalibrationCache::Read(const FString& fileName, FCameraCalibration& calibration)
+{
+	TUniquePtr<IFileHandle> file(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*fileName));
+
+	if (!file.IsValid() || file->Size() != static_cast<int64>(sizeof(FCameraCalibration)))
+		return false;
+
+	FCameraCalibration record;
+
+	if (!file->Read(reinterpret_cast<uint8*>(&record), sizeof(record)))
+		return false;
+
+	if (record.Magic != UnrealDR::CalibrationCache::FileMagic || record.Version != UnrealDR::CalibrationCache::FileVersion || record.FrameWidth == 0 || record.FrameHeight == 0)
+		return false;
+
+	calibration = record;
+	return true;
+}
@@ -0,0 +1,154 @@
+#include "CameraCaptureWorker.h"
+#include <HAL/PlatformProcess.h>
+#include <HAL/PlatformTime.h>
+
+FCameraCaptureWorker::FCameraCaptureWorker(FCameraFrameSourcePtr source, FCameraFramePoolPtr pool, uint32 pollInterval, const FString& threadName) :
+	m_source(source), m_pool(pool), m_pollInterval(pollInterval), m_threadName(threadName)
+{
+}
+
+FCameraCaptureWorker::~FCameraCaptureWorker()
+{
+	this->Shutdown();
+}
+
+bool FCameraCaptureWorker::Start()
+{
+	if (m_thread != nullptr)
+		return true;
+
+	if (!m_source.IsValid() || !m_source->IsAcquired() || !m_pool.IsValid())
+		return false;
+
+	m_wakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	m_running = true;
+	m_thread = FRunnableThread::Create(this, *m_threadName, 0, TPri_AboveNormal);
+
+	if (m_thread == nullptr)
+	{
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to create camera capture thread."));
+		m_running = false;
+		FPlatformProcess::ReturnSynchEventToPool(m_wakeEvent);
+		m_wakeEvent = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+void FCameraCaptureWorker::Shutdown()
+{
+	if (m_thread == nullptr)
+		return;
+
+	// Kill calls Stop() and waits for the thread to return from Run().
+	m_thread->Kill(true);
+	delete m_thread;
+	m_thread = nullptr;
+
+	FPlatformProcess::ReturnSynchEventToPool(m_wakeEvent);
+	m_wakeEvent = nullptr;
+}
+
+bool FCameraCaptureWorker::HasNewFrame() const
+{
+	return m_frames.IsDirty();
+}
+
+FCameraFrameRef FCameraCaptureWorker::SwapToLatestFrame()
+{
+	m_frames.SwapReadBuffers();
+	return m_frames.Read();
+}
+
+int32 FCameraCaptureWorker::GetSkippedFrames() const
+{
+	return m_skippedFrames.GetValue();
+}
+
+int32 FCameraCaptureWorker::GetDroppedFrames() const
+{
+	return m_droppedFrames.GetValue();
+}
+
+int32 FCameraCaptureWorker::GetCapturedFrames() const
+{
+	return m_capturedFrames.GetValue();
+}
+
+bool FCameraCaptureWorker::Init()
+{
+	m_lastFrameIndex = 0;
+	return true;
+}
+
+uint32 FCameraCaptureWorker::Run()
+{
+	while (m_running)
+	{
+		// If there has been no new frame, wait for the next poll. The event is triggered, if the worker should stop.
+		if (!this->PollFrame())
+			m_wakeEvent->Wait(m_pollInterval);
+	}
+
+	return 0;
+}
+
+void FCameraCaptureWorker::Stop()
+{
+	m_running = false;
+
+	if (m_wakeEvent != nullptr)
+		m_wakeEvent->Trigger();
+}
+
+void FCameraCaptureWorker::Exit()
+{
+	// Return the pending frame to the pool.
+	m_pendingFrame.SafeRelease();
+}
+
+bool FCameraCaptureWorker::PollFrame()
+{
+	// Acquire a frame buffer to copy the next frame into.
+	if (!m_pendingFrame.IsValid())
+		m_pendingFrame = m_pool->Acquire();
+
+	if (!m_pendingFrame.IsValid())
+	{
+		// If the pool is exhausted, only check whether a new frame is available and drop it.
+		vr::CameraVideoStreamFrameHeader_t header;
+
+		if (!m_source->GetNextFrame(m_lastFrameIndex, nullptr, 0, header))
+			return false;
+
+		m_lastFrameIndex = header.nFrameSequence;
+		m_droppedFrames.Increment();
+		return true;
+	}
+
+	FCameraFrame* frame = m_pendingFrame.GetReference();
+	const double pollTime = FPlatformTime::Seconds();
+
+	if (!m_source->GetNextFrame(m_lastFrameIndex, frame->Data, frame->Size, frame->Header))
+		return false;
+
+	// OpenVR does not report exposure times, in which case the time the frame has been observed first is the closest estimate.
+	const double exposureTime = m_source->GetExposureTime(frame->Header);
+	frame->ExposureTime = exposureTime > 0.0 ? exposureTime : pollTime;
+	frame->bHasExposureTime = exposureTime > 0.0;
+	frame->HeaderPollTime = pollTime;
+	frame->CaptureTime = FPlatformTime::Seconds();
+	m_lastFrameIndex = frame->Header.nFrameSequence;
+	m_capturedFrames.Increment();
+
+	// If the previously published frame has not been read yet, it gets overwritten.
+	if (m_frames.IsDirty())
+		m_skippedFrames.Increment();
+
+	// Publish the frame. This releases the reference to the frame that has previously been stored in the write slot.
+	m_frames.GetWriteBuffer() = MoveTemp(m_pendingFrame);
+	m_frames.SwapWriteBuffers();
+
+	return true;
+}
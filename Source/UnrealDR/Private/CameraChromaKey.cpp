@@ -0,0 +1,411 @@
+#include "CameraChromaKey.h"
+#include "UnrealDRSimd.h"
+#include <Async/ParallelFor.h>
+
+DECLARE_CYCLE_STAT(TEXT("Chroma Key"), STAT_UnrealDR_ChromaKey, STATGROUP_UnrealDR);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Chroma Key Blobs"), STAT_UnrealDR_ChromaKeyBlobs, STATGROUP_UnrealDR);
+
+namespace
+{
+	/// <summary>
+	/// The BT.601 chroma weights in 8 bit fixed point. The weights of each channel add up to `0`, so that gray has no chroma.
+	/// </summary>
+	constexpr int32 CbWeightR = -43;
+	constexpr int32 CbWeightG = -85;
+	constexpr int32 CbWeightB = 128;
+	constexpr int32 CrWeightR = 128;
+	constexpr int32 CrWeightG = -107;
+	constexpr int32 CrWeightB = -21;
+
+	/// <summary>
+	/// The accumulated pixels of a connected region.
+	/// </summary>
+	struct FBlobAccumulator
+	{
+		int32 MinX{ MAX_int32 };
+		int32 MinY{ MAX_int32 };
+		int32 MaxX{ 0 };
+		int32 MaxY{ 0 };
+		int64 Area{ 0 };
+
+		/// <summary>
+		/// The sums of twice the x coordinates and of the y coordinates of the pixels.
+		/// </summary>
+		int64 SumX2{ 0 };
+		int64 SumY{ 0 };
+	};
+
+	/// <summary>
+	/// Returns the representative of the region of a run and shortens the path to it.
+	/// </summary>
+	FORCEINLINE int32 FindRoot(FCameraChromaKeyRun* runs, int32 run) noexcept
+	{
+		while (runs[run].Parent != run)
+		{
+			runs[run].Parent = runs[runs[run].Parent].Parent;
+			run = runs[run].Parent;
+		}
+
+		return run;
+	}
+
+	/// <summary>
+	/// Merges the regions of two runs. The run with the lower index becomes the representative, so that it is the first run of the region in row order.
+	/// </summary>
+	FORCEINLINE void MergeRuns(FCameraChromaKeyRun* runs, int32 a, int32 b) noexcept
+	{
+		a = FindRoot(runs, a);
+		b = FindRoot(runs, b);
+
+		if (a < b)
+			runs[b].Parent = a;
+		else if (b < a)
+			runs[a].Parent = b;
+	}
+
+	/// <summary>
+	/// Returns the first and one past the last strip of an eye image that intersect a region. An empty region has no strips.
+	/// </summary>
+	FORCEINLINE void GetStripRange(const FIntRect& region, int32& firstStrip, int32& endStrip) noexcept
+	{
+		firstStrip = region.Area() > 0 ? region.Min.Y / FCameraChromaKey::StripHeight : 0;
+		endStrip = region.Area() > 0 ? FMath::DivideAndRoundUp(region.Max.Y, FCameraChromaKey::StripHeight) : 0;
+	}
+
+	/// <summary>
+	/// Merges the runs of a row with the touching runs of the row above it. Both ranges are sorted, so they are swept once.
+	/// </summary>
+	void MergeRows(FCameraChromaKeyRun* runs, int32 previousStart, int32 previousEnd, int32 currentStart, int32 currentEnd) noexcept
+	{
+		int32 p = previousStart;
+
+		for (int32 c = currentStart; c < currentEnd; ++c)
+		{
+			// Runs touch diagonally, if one ends right before the other starts, since the end is exclusive.
+			while (p < previousEnd && runs[p].End < runs[c].Start)
+				++p;
+
+			for (int32 q = p; q < previousEnd && runs[q].Start <= runs[c].End; ++q)
+				MergeRuns(runs, c, q);
+		}
+	}
+}
+
+FCameraChromaKey::FCameraChromaKey(uint32 frameWidth, uint32 frameHeight, const FCameraChromaKeySettings& settings, int32 outputFrames) :
+	m_frameWidth(frameWidth), m_frameHeight(frameHeight)
+{
+	this->SetSettings(settings);
+
+	m_stripsPerEye = FMath::DivideAndRoundUp(static_cast<int32>(m_frameHeight / 2), StripHeight);
+	m_stripRuns.SetNum(m_stripsPerEye * 2);
+	m_outputPool = MakeShared<FCameraFramePool, ESPMode::ThreadSafe>(m_frameWidth * m_frameHeight, FMath::Max(outputFrames, 1));
+}
+
+FCameraChromaKeyResult FCameraChromaKey::Update(const FCameraFrame& frame, const FIntRect* regions)
+{
+	FCameraChromaKeyResult result;
+
+	if (frame.Size < m_frameWidth * m_frameHeight * 4)
+		return result;
+
+	FCameraFrameRef output = m_outputPool->Acquire();
+
+	if (!output.IsValid())
+		return result;
+
+	SCOPE_CYCLE_COUNTER(STAT_UnrealDR_ChromaKey);
+
+	const int32 width = static_cast<int32>(m_frameWidth);
+	const int32 eyeHeight = static_cast<int32>(m_frameHeight / 2);
+	const FIntRect eyeRect(0, 0, width, eyeHeight);
+
+	for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+	{
+		FIntRect region = regions != nullptr ? regions[e] : eyeRect;
+		region.Clip(eyeRect);
+		result.Regions[e] = region.Area() > 0 ? region : FIntRect();
+	}
+
+	// Key the rows of the regions in parallel and clear the rest of the mask, since the output frames are reused. The mask has the layout of the frame buffer, so the
+	// right eye image is stored in the upper half, the left eye image in the lower half.
+	int32 keyCb, keyCr;
+	GetChroma(m_settings.KeyColor, keyCb, keyCr);
+
+	const uint8* pixels = frame.Data;
+	uint8* mask = output->Data;
+	const int32 threshold = m_settings.Threshold;
+	const int32 softness = m_settings.Softness;
+	const FIntRect left = result.Regions[vr::Eye_Left];
+	const FIntRect right = result.Regions[vr::Eye_Right];
+
+	ParallelFor(static_cast<int32>(m_frameHeight), [pixels, mask, width, eyeHeight, keyCb, keyCr, threshold, softness, left, right](int32 y) {
+		const FIntRect& region = y < eyeHeight ? right : left;
+		const int32 row = y < eyeHeight ? y : y - eyeHeight;
+		uint8* maskRow = mask + static_cast<SIZE_T>(y) * width;
+
+		if (row < region.Min.Y || row >= region.Max.Y)
+		{
+			FMemory::Memzero(maskRow, width);
+			return;
+		}
+
+		FMemory::Memzero(maskRow, region.Min.X);
+		KeyRow(pixels + (static_cast<SIZE_T>(y) * width + region.Min.X) * 4, region.Width(), keyCb, keyCr, threshold, softness, maskRow + region.Min.X);
+		FMemory::Memzero(maskRow + region.Max.X, width - region.Max.X);
+	});
+
+	// Label the strips that intersect the regions of both eyes in parallel, then merge them and collect the connected regions of each eye.
+	int32 firstStrips[2], endStrips[2];
+	GetStripRange(left, firstStrips[vr::Eye_Left], endStrips[vr::Eye_Left]);
+	GetStripRange(right, firstStrips[vr::Eye_Right], endStrips[vr::Eye_Right]);
+
+	const int32 leftStrips = endStrips[vr::Eye_Left] - firstStrips[vr::Eye_Left];
+	const int32 rightStrips = endStrips[vr::Eye_Right] - firstStrips[vr::Eye_Right];
+
+	ParallelFor(leftStrips + rightStrips, [this, mask, &firstStrips, leftStrips, left, right](int32 index) {
+		if (index < leftStrips)
+			this->LabelStrip(mask, vr::Eye_Left, firstStrips[vr::Eye_Left] + index, left);
+		else
+			this->LabelStrip(mask, vr::Eye_Right, firstStrips[vr::Eye_Right] + index - leftStrips, right);
+	});
+
+	this->ExtractBlobs(vr::Eye_Left, left, result.Blobs);
+	this->ExtractBlobs(vr::Eye_Right, right, result.Blobs);
+
+	result.Blobs.StableSort([](const FCameraChromaKeyBlob& a, const FCameraChromaKeyBlob& b) { return a.Area > b.Area; });
+
+	if (result.Blobs.Num() > m_settings.MaxBlobs)
+		result.Blobs.SetNum(m_settings.MaxBlobs);
+
+	INC_DWORD_STAT_BY(STAT_UnrealDR_ChromaKeyBlobs, result.Blobs.Num());
+
+	output->Header = frame.Header;
+	output->ExposureTime = frame.ExposureTime;
+	output->bHasExposureTime = frame.bHasExposureTime;
+	output->HeaderPollTime = frame.HeaderPollTime;
+	output->CaptureTime = frame.CaptureTime;
+	result.Mask = output;
+
+	return result;
+}
+
+void FCameraChromaKey::SetSettings(const FCameraChromaKeySettings& settings)
+{
+	m_settings = settings;
+	m_settings.Threshold = FMath::Clamp(m_settings.Threshold, 0, 510);
+	m_settings.Softness = FMath::Clamp(m_settings.Softness, 1, 255);
+	m_settings.MinBlobArea = FMath::Max(m_settings.MinBlobArea, 1);
+	m_settings.MaxBlobs = FMath::Max(m_settings.MaxBlobs, 0);
+}
+
+void FCameraChromaKey::GetChroma(const FColor& color, int32& cb, int32& cr) noexcept
+{
+	cb = (CbWeightR * color.R + CbWeightG * color.G + CbWeightB * color.B + 128) >> 8;
+	cr = (CrWeightR * color.R + CrWeightG * color.G + CrWeightB * color.B + 128) >> 8;
+}
+
+void FCameraChromaKey::KeyRow(const uint8* row, uint32 width, int32 keyCb, int32 keyCr, int32 threshold, int32 softness, uint8* mask) noexcept
+{
+	// The mask is `min(max(threshold + softness - distance, 0), softness) * 255 / softness`. The division is replaced by a multiplication with a 8.8 fixed point
+	// gain, which stays within 16 bits, since the softness is at most 255.
+	const int32 limit = threshold + softness;
+	const int32 gain = 65280 / softness;
+	uint32 x = 0;
+
+#if UNREALDR_SIMD_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i cbWeights = _mm_setr_epi16(CbWeightR, CbWeightG, CbWeightB, 0, CbWeightR, CbWeightG, CbWeightB, 0);
+	const __m128i crWeights = _mm_setr_epi16(CrWeightR, CrWeightG, CrWeightB, 0, CrWeightR, CrWeightG, CrWeightB, 0);
+	const __m128i rounding = _mm_set1_epi32(128);
+	const __m128i keyCbs = _mm_set1_epi16(static_cast<int16>(keyCb));
+	const __m128i keyCrs = _mm_set1_epi16(static_cast<int16>(keyCr));
+	const __m128i limits = _mm_set1_epi16(static_cast<int16>(limit));
+	const __m128i softnesses = _mm_set1_epi16(static_cast<int16>(softness));
+	const __m128i gains = _mm_set1_epi16(static_cast<int16>(gain));
+	const __m128i maskRounding = _mm_set1_epi16(255);
+
+	// Computes the weighted sums of four pixels as 32 bit values: (wR * R + wG * G, wB * B) for each pixel, then both halves of each pixel are added.
+	auto weightPixels = [zero, rounding](__m128i pixels, __m128i weights) {
+		__m128i low = _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), weights);
+		__m128i high = _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), weights);
+		low = _mm_add_epi32(low, _mm_srli_epi64(low, 32));
+		high = _mm_add_epi32(high, _mm_srli_epi64(high, 32));
+
+		const __m128i sums = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(low), _mm_castsi128_ps(high), _MM_SHUFFLE(2, 0, 2, 0)));
+		return _mm_srai_epi32(_mm_add_epi32(sums, rounding), 8);
+	};
+
+	for (; x + 8 <= width; x += 8)
+	{
+		const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + 4 * x));
+		const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + 4 * x + 16));
+		const __m128i cb = _mm_packs_epi32(weightPixels(first, cbWeights), weightPixels(second, cbWeights));
+		const __m128i cr = _mm_packs_epi32(weightPixels(first, crWeights), weightPixels(second, crWeights));
+
+		// The absolute differences are the maximum of both differences, since SSE2 has no absolute value of 16 bit integers.
+		const __m128i dCb = _mm_sub_epi16(cb, keyCbs);
+		const __m128i dCr = _mm_sub_epi16(cr, keyCrs);
+		const __m128i distance = _mm_add_epi16(_mm_max_epi16(dCb, _mm_sub_epi16(zero, dCb)), _mm_max_epi16(dCr, _mm_sub_epi16(zero, dCr)));
+
+		// The product of the ramp and the gain is at most 65280, so it fits into unsigned 16 bit lanes, including the rounding.
+		const __m128i ramp = _mm_min_epi16(_mm_max_epi16(_mm_sub_epi16(limits, distance), zero), softnesses);
+		const __m128i values = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(ramp, gains), maskRounding), 8);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(mask + x), _mm_packus_epi16(values, zero));
+	}
+#endif
+
+	for (; x < width; ++x)
+	{
+		const uint8* pixel = row + 4 * x;
+		const int32 cb = (CbWeightR * pixel[0] + CbWeightG * pixel[1] + CbWeightB * pixel[2] + 128) >> 8;
+		const int32 cr = (CrWeightR * pixel[0] + CrWeightG * pixel[1] + CrWeightB * pixel[2] + 128) >> 8;
+		const int32 distance = FMath::Abs(cb - keyCb) + FMath::Abs(cr - keyCr);
+		const int32 ramp = FMath::Clamp(limit - distance, 0, softness);
+
+		mask[x] = static_cast<uint8>((ramp * gain + 255) >> 8);
+	}
+}
+
+void FCameraChromaKey::FindRuns(const uint8* mask, int32 width, int32 row, uint8 threshold, TArray<FCameraChromaKeyRun>& runs)
+{
+	int32 start = INDEX_NONE;
+	int32 x = 0;
+
+	// Starts or ends a run at a value, whose keyed state differs from the current run.
+	auto addValue = [&runs, &start, row](int32 position, bool keyed) {
+		if (keyed && start == INDEX_NONE)
+		{
+			start = position;
+		}
+		else if (!keyed && start != INDEX_NONE)
+		{
+			runs.Add({ start, position, row, runs.Num() });
+			start = INDEX_NONE;
+		}
+	};
+
+#if UNREALDR_SIMD_SSE2
+	// Compare blocks of 16 values at once, and only walk the bits of blocks that start or end a run.
+	const __m128i thresholds = _mm_set1_epi8(static_cast<char>(threshold));
+
+	for (; x + 16 <= width; x += 16)
+	{
+		const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + x));
+		const int32 keyed = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(values, thresholds), values));
+
+		if (keyed == (start == INDEX_NONE ? 0 : 0xFFFF))
+			continue;
+
+		for (int32 bit = 0; bit < 16; ++bit)
+			addValue(x + bit, ((keyed >> bit) & 1) != 0);
+	}
+#endif
+
+	for (; x < width; ++x)
+		addValue(x, mask[x] >= threshold);
+
+	if (start != INDEX_NONE)
+		runs.Add({ start, width, row, runs.Num() });
+}
+
+void FCameraChromaKey::LabelStrip(const uint8* mask, int32 eye, int32 strip, const FIntRect& region)
+{
+	// The right eye image is stored in the upper half, the left eye image in the lower half of the mask.
+	const int32 width = static_cast<int32>(m_frameWidth);
+	const int32 eyeHeight = static_cast<int32>(m_frameHeight / 2);
+	const uint8* eyeMask = mask + (eye == vr::Eye_Left ? static_cast<SIZE_T>(eyeHeight) * width : 0);
+	const int32 endRow = FMath::Min((strip + 1) * StripHeight, region.Max.Y);
+
+	TArray<FCameraChromaKeyRun>& runs = m_stripRuns[eye * m_stripsPerEye + strip];
+	runs.Reset();
+
+	int32 previousStart = 0;
+	int32 previousEnd = 0;
+
+	for (int32 y = FMath::Max(strip * StripHeight, region.Min.Y); y < endRow; ++y)
+	{
+		// Only the columns of the region are searched. The runs are moved from the region into the eye image afterwards.
+		const int32 currentStart = runs.Num();
+		FindRuns(eyeMask + static_cast<SIZE_T>(y) * width + region.Min.X, region.Width(), y, m_settings.BlobThreshold, runs);
+
+		for (int32 r = currentStart; r < runs.Num(); ++r)
+		{
+			runs[r].Start += region.Min.X;
+			runs[r].End += region.Min.X;
+		}
+
+		MergeRows(runs.GetData(), previousStart, previousEnd, currentStart, runs.Num());
+		previousStart = currentStart;
+		previousEnd = runs.Num();
+	}
+}
+
+void FCameraChromaKey::ExtractBlobs(int32 eye, const FIntRect& region, TArray<FCameraChromaKeyBlob>& blobs)
+{
+	// Concatenate the runs of all strips of the region and merge the last row of each strip with the first row of the next one.
+	int32 firstStrip, endStrip;
+	GetStripRange(region, firstStrip, endStrip);
+
+	m_runs.Reset();
+	int32 previousStart = 0;
+	int32 previousEnd = 0;
+
+	for (int32 strip = firstStrip; strip < endStrip; ++strip)
+	{
+		const TArray<FCameraChromaKeyRun>& stripRuns = m_stripRuns[eye * m_stripsPerEye + strip];
+		const int32 offset = m_runs.Num();
+		const int32 firstRow = FMath::Max(strip * StripHeight, region.Min.Y);
+
+		for (const FCameraChromaKeyRun& run : stripRuns)
+			m_runs.Add({ run.Start, run.End, run.Row, run.Parent + offset });
+
+		// Only runs of the previous row of the image touch the first row of the strip.
+		int32 currentEnd = offset;
+
+		while (currentEnd < m_runs.Num() && m_runs[currentEnd].Row == firstRow)
+			++currentEnd;
+
+		if (previousEnd > previousStart && m_runs[previousStart].Row == firstRow - 1)
+			MergeRows(m_runs.GetData(), previousStart, previousEnd, offset, currentEnd);
+
+		// Remember the runs of the last row of the strip.
+		previousEnd = m_runs.Num();
+		previousStart = previousEnd;
+
+		while (previousStart > offset && m_runs[previousStart - 1].Row == m_runs.Last().Row)
+			--previousStart;
+	}
+
+	// Accumulate the pixels of each region. Representatives are the first run of their region, so regions are created in row order.
+	TArray<FBlobAccumulator> accumulators;
+	m_labels.SetNumUninitialized(m_runs.Num());
+
+	for (int32 r = 0; r < m_runs.Num(); ++r)
+	{
+		const int32 root = FindRoot(m_runs.GetData(), r);
+		m_labels[r] = root == r ? accumulators.AddDefaulted() : m_labels[root];
+
+		const FCameraChromaKeyRun& run = m_runs[r];
+		const int64 length = run.End - run.Start;
+		FBlobAccumulator& blob = accumulators[m_labels[r]];
+		blob.MinX = FMath::Min(blob.MinX, run.Start);
+		blob.MinY = FMath::Min(blob.MinY, run.Row);
+		blob.MaxX = FMath::Max(blob.MaxX, run.End);
+		blob.MaxY = FMath::Max(blob.MaxY, run.Row + 1);
+		blob.Area += length;
+		blob.SumX2 += length * (run.Start + run.End - 1);
+		blob.SumY += length * run.Row;
+	}
+
+	for (const FBlobAccumulator& accumulator : accumulators)
+	{
+		if (accumulator.Area < m_settings.MinBlobArea)
+			continue;
+
+		FCameraChromaKeyBlob& blob = blobs.AddDefaulted_GetRef();
+		blob.Eye = eye == vr::Eye_Left ? ECameraEye::Left : ECameraEye::Right;
+		blob.Bounds = FIntRect(accumulator.MinX, accumulator.MinY, accumulator.MaxX, accumulator.MaxY);
+		blob.Area = static_cast<int32>(accumulator.Area);
+		blob.Centroid = FVector2D(accumulator.SumX2 / (2.f * accumulator.Area) + 0.5f, static_cast<float>(accumulator.SumY) / accumulator.Area + 0.5f);
+	}
+}
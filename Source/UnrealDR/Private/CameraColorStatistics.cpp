@@ -0,0 +1,163 @@
+#include "CameraColorStatistics.h"
+#include "UnrealDRSimd.h"
+
+DECLARE_CYCLE_STAT(TEXT("Color Statistics"), STAT_UnrealDR_ColorStatistics, STATGROUP_UnrealDR);
+
+namespace
+{
+	/// <summary>
+	/// The Rec. 709 luminance weights in 8 bit fixed point, which add up to 256.
+	/// </summary>
+	constexpr uint32 LuminanceWeightR = 54;
+	constexpr uint32 LuminanceWeightG = 183;
+	constexpr uint32 LuminanceWeightB = 19;
+
+	/// <summary>
+	/// Returns the luminance value, below which a fraction of the samples lie.
+	/// </summary>
+	float GetPercentile(const uint32* histogram, uint32 samples, float fraction) noexcept
+	{
+		const uint64 target = static_cast<uint64>(fraction * samples);
+		uint64 count = 0;
+
+		for (int32 bin = 0; bin < FCameraColorStatistics::HistogramBins; ++bin)
+		{
+			count += histogram[bin];
+
+			if (count > target)
+				return bin / 255.f;
+		}
+
+		return 1.f;
+	}
+
+	/// <summary>
+	/// Decodes an sRGB value to linear space.
+	/// </summary>
+	float SrgbToLinear(float value) noexcept
+	{
+		return value <= 0.04045f ? value / 12.92f : FMath::Pow((value + 0.055f) / 1.055f, 2.4f);
+	}
+}
+
+FCameraColorStatistics::FCameraColorStatistics(uint32 stride, float smoothingTime) :
+	m_stride(FMath::Max(stride, 1u)), m_smoothingTime(FMath::Max(smoothingTime, 0.f))
+{
+}
+
+void FCameraColorStatistics::Update(const FCameraFrame& frame, uint32 width, uint32 height)
+{
+	if (frame.Size < width * height * 4)
+		return;
+
+	SCOPE_CYCLE_COUNTER(STAT_UnrealDR_ColorStatistics);
+
+	uint32 histogram[HistogramBins]{};
+	uint64 sums[3]{};
+	uint32 samples = 0;
+
+	for (uint32 y = 0; y < height; y += m_stride)
+		samples += SampleRow(frame.Data + static_cast<SIZE_T>(y) * width * 4, width, m_stride, histogram, sums);
+
+	if (samples == 0)
+		return;
+
+	// Derive the statistics of the frame.
+	FCameraColorStats& latest = m_latest;
+	latest.SampleCount = static_cast<int32>(samples);
+	latest.AverageColor = FLinearColor(sums[0] / (255.f * samples), sums[1] / (255.f * samples), sums[2] / (255.f * samples), 1.f);
+	latest.AverageLuminance = (LuminanceWeightR * latest.AverageColor.R + LuminanceWeightG * latest.AverageColor.G + LuminanceWeightB * latest.AverageColor.B) / 256.f;
+	latest.LowLuminance = GetPercentile(histogram, samples, 0.05f);
+	latest.MedianLuminance = GetPercentile(histogram, samples, 0.5f);
+	latest.HighLuminance = GetPercentile(histogram, samples, 0.95f);
+	latest.ExposureBias = FMath::Log2(FMath::Max(SrgbToLinear(latest.MedianLuminance), 1.f / 4096.f) / 0.18f);
+	latest.WhiteBalance = FLinearColor(latest.AverageColor.G / FMath::Max(latest.AverageColor.R, 1.f / 255.f), 1.f, latest.AverageColor.G / FMath::Max(latest.AverageColor.B, 1.f / 255.f), 1.f);
+	latest.Histogram.SetNumUninitialized(HistogramBins);
+
+	for (int32 bin = 0; bin < HistogramBins; ++bin)
+		latest.Histogram[bin] = static_cast<int32>(histogram[bin]);
+
+	// Follow the frame statistics exponentially. The first frame, and frames after a gap in the exposure times, are taken as is.
+	const double elapsed = frame.ExposureTime - m_latestExposureTime;
+	const float alpha = m_latestExposureTime < 0.0 || elapsed < 0.0 || m_smoothingTime <= 0.f ? 1.f : 1.f - FMath::Exp(-static_cast<float>(elapsed) / m_smoothingTime);
+	m_latestExposureTime = frame.ExposureTime;
+
+	FCameraColorStats& smoothed = m_smoothed;
+	smoothed.SampleCount = latest.SampleCount;
+	smoothed.AverageColor = FMath::Lerp(smoothed.AverageColor, latest.AverageColor, alpha);
+	smoothed.AverageLuminance = FMath::Lerp(smoothed.AverageLuminance, latest.AverageLuminance, alpha);
+	smoothed.LowLuminance = FMath::Lerp(smoothed.LowLuminance, latest.LowLuminance, alpha);
+	smoothed.MedianLuminance = FMath::Lerp(smoothed.MedianLuminance, latest.MedianLuminance, alpha);
+	smoothed.HighLuminance = FMath::Lerp(smoothed.HighLuminance, latest.HighLuminance, alpha);
+	smoothed.ExposureBias = FMath::Lerp(smoothed.ExposureBias, latest.ExposureBias, alpha);
+	smoothed.WhiteBalance = FMath::Lerp(smoothed.WhiteBalance, latest.WhiteBalance, alpha);
+}
+
+void FCameraColorStatistics::Reset()
+{
+	m_latest = FCameraColorStats();
+	m_smoothed = FCameraColorStats();
+	m_latestExposureTime = -1.0;
+}
+
+uint32 FCameraColorStatistics::SampleRow(const uint8* row, uint32 width, uint32 stride, uint32* histogram, uint64 (&sums)[3]) noexcept
+{
+	uint32 samples = 0;
+	uint32 x = 0;
+
+#if UNREALDR_SIMD_SSE2
+	// Compute the luminance of four pixels at once. The channel sums stay in 32 bit lanes for the row, which cannot overflow for any supported frame size.
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i weights = _mm_setr_epi16(LuminanceWeightR, LuminanceWeightG, LuminanceWeightB, 0, LuminanceWeightR, LuminanceWeightG, LuminanceWeightB, 0);
+	const __m128i rounding = _mm_set1_epi32(128);
+	__m128i channelSums = zero;
+	alignas(16) uint32 luminance[4];
+
+	for (; x + 4 <= width; x += 4 * stride)
+	{
+		const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + 4 * x));
+		const __m128i low = _mm_unpacklo_epi8(pixels, zero);
+		const __m128i high = _mm_unpackhi_epi8(pixels, zero);
+
+		// (wR * R + wG * G, wB * B) for each pixel, then add both halves of each pixel.
+		__m128i lowProducts = _mm_madd_epi16(low, weights);
+		__m128i highProducts = _mm_madd_epi16(high, weights);
+		lowProducts = _mm_add_epi32(lowProducts, _mm_srli_epi64(lowProducts, 32));
+		highProducts = _mm_add_epi32(highProducts, _mm_srli_epi64(highProducts, 32));
+
+		const __m128i products = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(lowProducts), _mm_castsi128_ps(highProducts), _MM_SHUFFLE(2, 0, 2, 0)));
+		_mm_store_si128(reinterpret_cast<__m128i*>(luminance), _mm_srli_epi32(_mm_add_epi32(products, rounding), 8));
+
+		++histogram[luminance[0]];
+		++histogram[luminance[1]];
+		++histogram[luminance[2]];
+		++histogram[luminance[3]];
+
+		channelSums = _mm_add_epi32(channelSums, _mm_add_epi32(_mm_unpacklo_epi16(low, zero), _mm_unpackhi_epi16(low, zero)));
+		channelSums = _mm_add_epi32(channelSums, _mm_add_epi32(_mm_unpacklo_epi16(high, zero), _mm_unpackhi_epi16(high, zero)));
+		samples += 4;
+	}
+
+	alignas(16) uint32 channels[4];
+	_mm_store_si128(reinterpret_cast<__m128i*>(channels), channelSums);
+	sums[0] += channels[0];
+	sums[1] += channels[1];
+	sums[2] += channels[2];
+#endif
+
+	// Sample the remaining blocks, including a partial block at the end of the row.
+	for (; x < width; x += 4 * stride)
+	{
+		for (uint32 p = x; p < FMath::Min(x + 4, width); ++p)
+		{
+			const uint8* pixel = row + 4 * p;
+			++histogram[(LuminanceWeightR * pixel[0] + LuminanceWeightG * pixel[1] + LuminanceWeightB * pixel[2] + 128) >> 8];
+			sums[0] += pixel[0];
+			sums[1] += pixel[1];
+			sums[2] += pixel[2];
+			++samples;
+		}
+	}
+
+	return samples;
+}
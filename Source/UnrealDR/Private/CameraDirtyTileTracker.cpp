@@ -0,0 +1,152 @@
+#include "CameraDirtyTileTracker.h"
+#include "UnrealDRSimd.h"
+
+namespace
+{
+	/// <summary>
+	/// Folds the eight 32-bit lanes of the checksum accumulators into a single 64-bit value (FNV-1a over the lanes).
+	/// </summary>
+	inline uint64 FoldLanes(const uint32 (&sum)[4], const uint32 (&position)[4]) noexcept
+	{
+		uint64 hash = 0xcbf29ce484222325ull;
+
+		for (int32 i = 0; i < 4; ++i)
+		{
+			hash = (hash ^ sum[i]) * 0x100000001b3ull;
+			hash = (hash ^ position[i]) * 0x100000001b3ull;
+		}
+
+		return hash;
+	}
+}
+
+FCameraDirtyTileTracker::FCameraDirtyTileTracker(uint32 width, uint32 height, uint32 tileSize) :
+	m_width(width), m_height(height), m_tileSize(FMath::Max(tileSize, 4u))
+{
+	m_tilesX = FMath::DivideAndRoundUp(m_width, m_tileSize);
+	m_tilesY = FMath::DivideAndRoundUp(m_height, m_tileSize);
+	m_hashes.SetNumZeroed(static_cast<int32>(m_tilesX * m_tilesY));
+}
+
+uint32 FCameraDirtyTileTracker::Update(const uint8* data, uint32 pitch, uint32 srcX, uint32 srcY, float maxDirtyRatio, TArray<FUpdateTextureRegion2D>& regions)
+{
+	regions.Reset();
+
+	if (data == nullptr || m_hashes.Num() == 0)
+		return 0;
+
+	uint32 dirtyTiles = 0;
+	const uint8* image = data + static_cast<SIZE_T>(srcY) * pitch + static_cast<SIZE_T>(srcX) * 4;
+
+	for (uint32 ty = 0; ty < m_tilesY; ++ty)
+	{
+		const uint32 y = ty * m_tileSize;
+		const uint32 height = FMath::Min(m_tileSize, m_height - y);
+
+		// The start of the current run of dirty tiles or `INDEX_NONE`, if the previous tile has been clean.
+		int32 runStart = INDEX_NONE;
+
+		for (uint32 tx = 0; tx <= m_tilesX; ++tx)
+		{
+			bool dirty = false;
+
+			if (tx < m_tilesX)
+			{
+				const uint32 x = tx * m_tileSize;
+				const uint64 hash = HashTile(image + static_cast<SIZE_T>(y) * pitch + static_cast<SIZE_T>(x) * 4, pitch, FMath::Min(m_tileSize, m_width - x), height);
+				uint64& previous = m_hashes[static_cast<int32>(ty * m_tilesX + tx)];
+
+				dirty = !m_valid || hash != previous;
+				previous = hash;
+			}
+
+			if (dirty)
+			{
+				++dirtyTiles;
+
+				if (runStart == INDEX_NONE)
+					runStart = static_cast<int32>(tx);
+			}
+			else if (runStart != INDEX_NONE)
+			{
+				// Merge the run of dirty tiles into a single region.
+				const uint32 x = static_cast<uint32>(runStart) * m_tileSize;
+				const uint32 width = FMath::Min(tx * m_tileSize, m_width) - x;
+				regions.Emplace(x, y, srcX + x, srcY + y, width, height);
+				runStart = INDEX_NONE;
+			}
+		}
+	}
+
+	// Many small updates are slower than a single large one.
+	if (!m_valid || static_cast<float>(dirtyTiles) > maxDirtyRatio * static_cast<float>(this->GetTileCount()))
+	{
+		regions.Reset();
+		regions.Emplace(0, 0, srcX, srcY, m_width, m_height);
+	}
+
+	m_valid = true;
+	return dirtyTiles;
+}
+
+uint64 FCameraDirtyTileTracker::HashTile(const uint8* data, uint32 pitch, uint32 width, uint32 height) noexcept
+{
+	// Fletcher-style checksum over four interleaved 32-bit lanes: each lane accumulates the pixels and the running sum, which makes the checksum sensitive to the
+	// position of a change. Both paths wrap around at 32 bits and therefore produce identical results.
+	const uint32 vectorPixels = width & ~3u;
+	uint32 sum[4]{}, position[4]{};
+
+#if UNREALDR_SIMD_SSE2
+	__m128i vsum = _mm_setzero_si128();
+	__m128i vposition = _mm_setzero_si128();
+#endif
+
+	for (uint32 y = 0; y < height; ++y)
+	{
+		const uint8* row = data + static_cast<SIZE_T>(y) * pitch;
+
+#if UNREALDR_SIMD_SSE2
+		for (uint32 x = 0; x < vectorPixels; x += 4)
+		{
+			vsum = _mm_add_epi32(vsum, _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x * 4)));
+			vposition = _mm_add_epi32(vposition, vsum);
+		}
+#else
+		for (uint32 x = 0; x < vectorPixels; x += 4)
+		{
+			for (uint32 lane = 0; lane < 4; ++lane)
+			{
+				uint32 pixel;
+				FMemory::Memcpy(&pixel, row + (x + lane) * 4, sizeof(pixel));
+				sum[lane] += pixel;
+				position[lane] += sum[lane];
+			}
+		}
+#endif
+
+		// Handle the remaining pixels, as if the row was padded with zeros to a multiple of four pixels.
+		if (vectorPixels < width)
+		{
+			uint32 remainder[4]{};
+			FMemory::Memcpy(remainder, row + vectorPixels * 4, (width - vectorPixels) * 4);
+
+#if UNREALDR_SIMD_SSE2
+			vsum = _mm_add_epi32(vsum, _mm_loadu_si128(reinterpret_cast<const __m128i*>(remainder)));
+			vposition = _mm_add_epi32(vposition, vsum);
+#else
+			for (uint32 lane = 0; lane < 4; ++lane)
+			{
+				sum[lane] += remainder[lane];
+				position[lane] += sum[lane];
+			}
+#endif
+		}
+	}
+
+#if UNREALDR_SIMD_SSE2
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(sum), vsum);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(position), vposition);
+#endif
+
+	return FoldLanes(sum, position);
+}
@@ -0,0 +1,81 @@
+#include "CameraFramePool.h"
+
+FCameraFrame::FCameraFrame(uint32 size, uint32 alignment) :
+	Size(size)
+{
+	Data = reinterpret_cast<uint8*>(FMemory::Malloc(size, alignment));
+}
+
+FCameraFrame::~FCameraFrame()
+{
+	FMemory::Free(Data);
+}
+
+uint32 FCameraFrame::AddRef() const
+{
+	return static_cast<uint32>(m_references.Increment());
+}
+
+uint32 FCameraFrame::Release() const
+{
+	const int32 references = m_references.Decrement();
+	check(references >= 0);
+
+	// Return the frame to the pool, if it is no longer referenced. If this has been the last reference to the pool, the pool deletes the frame when it goes out of
+	// scope, so no members must be accessed afterwards.
+	if (references == 0)
+	{
+		FCameraFramePoolPtr pool = MoveTemp(const_cast<FCameraFrame*>(this)->m_pool);
+		pool->Return(const_cast<FCameraFrame*>(this));
+	}
+
+	return static_cast<uint32>(references);
+}
+
+uint32 FCameraFrame::GetRefCount() const
+{
+	return static_cast<uint32>(m_references.GetValue());
+}
+
+FCameraFramePool::FCameraFramePool(uint32 bufferSize, int32 poolSize, uint32 alignment) :
+	m_bufferSize(bufferSize)
+{
+	m_frames.Reserve(poolSize);
+
+	for (int32 i = 0; i < poolSize; ++i)
+	{
+		auto frame = new FCameraFrame(bufferSize, alignment);
+		m_frames.Add(frame);
+		m_freeFrames.Push(frame);
+	}
+
+	m_freeCount.Set(poolSize);
+}
+
+FCameraFramePool::~FCameraFramePool()
+{
+	ensureMsgf(m_freeCount.GetValue() == m_frames.Num(), TEXT("Camera frame pool destroyed while %d frames are still in use."), m_frames.Num() - m_freeCount.GetValue());
+
+	for (auto frame : m_frames)
+		delete frame;
+
+	m_frames.Empty();
+}
+
+FCameraFrameRef FCameraFramePool::Acquire()
+{
+	FCameraFrame* frame = m_freeFrames.Pop();
+
+	if (frame == nullptr)
+		return FCameraFrameRef();
+
+	m_freeCount.Decrement();
+	frame->m_pool = this->AsShared();
+	return FCameraFrameRef(frame);
+}
+
+void FCameraFramePool::Return(FCameraFrame* frame)
+{
+	m_freeCount.Increment();
+	m_freeFrames.Push(frame);
+}
@@ -0,0 +1,122 @@
+#include "CameraFrameSampleAction.h"
+#include <Async/Async.h>
+
+#include "CameraSeeThroughComponent.h"
+
+UCameraFrameSampleAction* UCameraFrameSampleAction::SampleCameraFrame(UCameraSeeThroughComponent* component, ECameraEye eye, FIntRect region, bool bWaitForNewFrame)
+{
+	UCameraFrameSampleAction* action = NewObject<UCameraFrameSampleAction>();
+	action->m_component = component;
+	action->m_eye = eye;
+	action->m_region = region;
+	action->m_waitForNewFrame = bWaitForNewFrame;
+
+	// Keep the action alive, until the result has been delivered.
+	if (component != nullptr)
+		action->RegisterWithGameInstance(component);
+
+	return action;
+}
+
+void UCameraFrameSampleAction::Activate()
+{
+	UCameraSeeThroughComponent* component = m_component.Get();
+
+	if (component == nullptr)
+	{
+		this->Fail();
+		return;
+	}
+
+	// Sample the latest frame right away, unless the next one is requested or no frame has been received yet.
+	FCameraFrameViewPtr view;
+
+	if (!m_waitForNewFrame)
+		view = component->GetLatestFrameView();
+
+	if (view.IsValid())
+	{
+		this->Sample(view);
+	}
+	else
+	{
+		// Fail, if the component stops streaming before the next frame arrives, so that the action does not stay registered forever.
+		m_frameViewHandle = component->OnFrameView().AddUObject(this, &UCameraFrameSampleAction::OnFrameView);
+		m_streamingEndedHandle = component->OnStreamingEnded().AddUObject(this, &UCameraFrameSampleAction::OnStreamingEnded);
+	}
+}
+
+void UCameraFrameSampleAction::SetReadyToDestroy()
+{
+	this->StopWaiting();
+	Super::SetReadyToDestroy();
+}
+
+void UCameraFrameSampleAction::OnFrameView(const FCameraFrameViewPtr& view)
+{
+	// Only sample a single frame.
+	this->StopWaiting();
+
+	if (view.IsValid())
+		this->Sample(view);
+	else
+		this->Fail();
+}
+
+void UCameraFrameSampleAction::OnStreamingEnded()
+{
+	this->StopWaiting();
+	this->Fail();
+}
+
+void UCameraFrameSampleAction::StopWaiting()
+{
+	if (UCameraSeeThroughComponent* component = m_component.Get())
+	{
+		component->OnFrameView().Remove(m_frameViewHandle);
+		component->OnStreamingEnded().Remove(m_streamingEndedHandle);
+	}
+
+	m_frameViewHandle.Reset();
+	m_streamingEndedHandle.Reset();
+}
+
+void UCameraFrameSampleAction::Sample(const FCameraFrameViewPtr& view)
+{
+	TWeakObjectPtr<UCameraFrameSampleAction> weakThis(this);
+	const vr::EVREye eye = m_eye == ECameraEye::Left ? vr::Eye_Left : vr::Eye_Right;
+	const FIntRect region = m_region;
+
+	// Copy the pixels on the thread pool and deliver them on the game thread. The view keeps the frame alive in the meantime.
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [weakThis, view, eye, region]() {
+		TArray<FColor> pixels;
+		const FIntRect sampled = view->CopyRegion(eye, region, pixels);
+		FLinearColor average(0.f, 0.f, 0.f, 0.f);
+
+		for (const FColor& pixel : pixels)
+			average += pixel.ReinterpretAsLinear();
+
+		if (pixels.Num() > 0)
+			average /= static_cast<float>(pixels.Num());
+
+		AsyncTask(ENamedThreads::GameThread, [weakThis, view, pixels = MoveTemp(pixels), sampled, average]() {
+			UCameraFrameSampleAction* action = weakThis.Get();
+
+			if (action == nullptr)
+				return;
+
+			if (pixels.Num() == 0)
+				action->Failed.Broadcast(FCameraFrameHandle(view), pixels, sampled, average);
+			else
+				action->Completed.Broadcast(FCameraFrameHandle(view), pixels, sampled, average);
+
+			action->SetReadyToDestroy();
+		});
+	});
+}
+
+void UCameraFrameSampleAction::Fail()
+{
+	Failed.Broadcast(FCameraFrameHandle(), TArray<FColor>(), FIntRect(), FLinearColor(0.f, 0.f, 0.f, 0.f));
+	this->SetReadyToDestroy();
+}
@@ -0,0 +1,65 @@
+#include "CameraFrameView.h"
+
+FCameraFrameView::FCameraFrameView(const FCameraFrameRef& frame, uint32 width, uint32 height, const FTransform& pose, bool poseValid) :
+	m_frame(frame), m_width(width), m_height(height), m_pose(pose), m_poseValid(poseValid)
+{
+	check(m_frame.IsValid() && m_frame->Size >= width * height * 4);
+}
+
+FIntRect FCameraFrameView::GetEyeRect(vr::EVREye eye) const noexcept
+{
+	// The right eye image is stored in the upper half, the left eye image in the lower half of the frame.
+	const int32 eyeHeight = static_cast<int32>(m_height / 2);
+	const int32 firstRow = eye == vr::Eye_Left ? eyeHeight : 0;
+
+	return FIntRect(0, firstRow, static_cast<int32>(m_width), firstRow + eyeHeight);
+}
+
+FColor FCameraFrameView::GetPixel(vr::EVREye eye, int32 x, int32 y) const noexcept
+{
+	const int32 eyeHeight = static_cast<int32>(m_height / 2);
+
+	if (m_width == 0 || eyeHeight == 0)
+		return FColor();
+
+	x = FMath::Clamp(x, 0, static_cast<int32>(m_width) - 1);
+	y = FMath::Clamp(y, 0, eyeHeight - 1);
+	const uint8* pixel = this->GetEyeData(eye) + y * this->GetPitch() + x * 4;
+	return FColor(pixel[0], pixel[1], pixel[2], pixel[3]);
+}
+
+FIntRect FCameraFrameView::CopyRegion(vr::EVREye eye, const FIntRect& region, TArray<FColor>& pixels) const
+{
+	const int32 eyeHeight = static_cast<int32>(m_height / 2);
+	const FIntRect clipped(FMath::Max(region.Min.X, 0), FMath::Max(region.Min.Y, 0), FMath::Min(region.Max.X, static_cast<int32>(m_width)), FMath::Min(region.Max.Y, eyeHeight));
+
+	pixels.Reset();
+
+	if (clipped.Max.X <= clipped.Min.X || clipped.Max.Y <= clipped.Min.Y)
+		return FIntRect();
+
+	// FColor is stored as BGRA, so the channels need to be swapped, instead of copying the rows.
+	pixels.Reserve(clipped.Area());
+
+	for (int32 y = clipped.Min.Y; y < clipped.Max.Y; ++y)
+	{
+		const uint8* pixel = this->GetEyeData(eye) + y * this->GetPitch() + clipped.Min.X * 4;
+
+		for (int32 x = clipped.Min.X; x < clipped.Max.X; ++x, pixel += 4)
+			pixels.Emplace(pixel[0], pixel[1], pixel[2], pixel[3]);
+	}
+
+	return clipped;
+}
+
+FCameraFrameHandle::FCameraFrameHandle(const FCameraFrameViewPtr& view) :
+	View(view)
+{
+	if (!View.IsValid())
+		return;
+
+	FrameSequence = static_cast<int32>(View->GetFrameSequence());
+	EyeSize = FIntPoint(static_cast<int32>(View->GetWidth()), static_cast<int32>(View->GetHeight() / 2));
+	Pose = View->GetPose();
+	bPoseValid = View->IsPoseValid();
+}
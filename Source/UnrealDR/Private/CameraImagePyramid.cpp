@@ -0,0 +1,112 @@
+#include "CameraImagePyramid.h"
+#include "UnrealDRSimd.h"
+
+DECLARE_CYCLE_STAT(TEXT("Image Pyramid"), STAT_UnrealDR_ImagePyramid, STATGROUP_UnrealDR);
+
+namespace
+{
+	/// <summary>
+	/// Returns the rounded average of two 8 bit values, like `_mm_avg_epu8`.
+	/// </summary>
+	FORCEINLINE uint8 Average(uint8 a, uint8 b) noexcept
+	{
+		return static_cast<uint8>((a + b + 1) >> 1);
+	}
+}
+
+FCameraImagePyramid::FCameraImagePyramid(uint32 width, uint32 height, int32 levels) :
+	m_width(width), m_height(height), m_levels(FMath::Max(levels, 0))
+{
+	// The first intermediate level is the largest one, so it determines the size of both buffers.
+	uint32 levelWidth, levelHeight;
+	this->GetLevelSize(1, levelWidth, levelHeight);
+
+	if (m_levels > 1)
+	{
+		m_scratch[0].SetNumUninitialized(static_cast<int32>(levelWidth * levelHeight * 4));
+		m_scratch[1].SetNumUninitialized(static_cast<int32>(levelWidth * levelHeight * 4));
+	}
+}
+
+void FCameraImagePyramid::GetLevelSize(int32 level, uint32& width, uint32& height) const noexcept
+{
+	width = m_width;
+	height = m_height;
+
+	for (int32 l = 0; l < level; ++l)
+	{
+		width = (width + 1) / 2;
+		height = (height + 1) / 2;
+	}
+}
+
+void FCameraImagePyramid::Build(const uint8* image, uint32 pitch, uint8* target, uint32 targetPitch)
+{
+	SCOPE_CYCLE_COUNTER(STAT_UnrealDR_ImagePyramid);
+
+	if (m_levels == 0)
+	{
+		for (uint32 y = 0; y < m_height; ++y)
+			FMemory::Memcpy(target + y * targetPitch, image + y * pitch, m_width * 4);
+
+		return;
+	}
+
+	const uint8* source = image;
+	uint32 sourcePitch = pitch;
+	uint32 width = m_width;
+	uint32 height = m_height;
+
+	for (int32 level = 1; level <= m_levels; ++level)
+	{
+		// The last level goes straight into the target, all others into the scratch buffer that has not been read from.
+		const bool last = level == m_levels;
+		const uint32 levelPitch = last ? targetPitch : ((width + 1) / 2) * 4;
+		uint8* levelImage = last ? target : m_scratch[level & 1].GetData();
+
+		Downsample(source, sourcePitch, width, height, levelImage, levelPitch);
+
+		source = levelImage;
+		sourcePitch = levelPitch;
+		width = (width + 1) / 2;
+		height = (height + 1) / 2;
+	}
+}
+
+void FCameraImagePyramid::Downsample(const uint8* source, uint32 sourcePitch, uint32 width, uint32 height, uint8* target, uint32 targetPitch) noexcept
+{
+	const uint32 targetWidth = (width + 1) / 2;
+	const uint32 targetHeight = (height + 1) / 2;
+
+	for (uint32 y = 0; y < targetHeight; ++y)
+	{
+		// The last row of an odd image is averaged with itself.
+		const uint8* upper = source + static_cast<SIZE_T>(2 * y) * sourcePitch;
+		const uint8* lower = source + static_cast<SIZE_T>(FMath::Min(2 * y + 1, height - 1)) * sourcePitch;
+		uint8* row = target + static_cast<SIZE_T>(y) * targetPitch;
+		uint32 x = 0;
+
+#if UNREALDR_SIMD_SSE2
+		// Average both rows, then the even and odd pixels of the result, which produces four target pixels from eight source pixels.
+		for (; 2 * x + 8 <= width; x += 4)
+		{
+			const __m128i first = _mm_avg_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(upper + 8 * x)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(lower + 8 * x)));
+			const __m128i second = _mm_avg_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(upper + 8 * x + 16)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(lower + 8 * x + 16)));
+			const __m128i even = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(first), _mm_castsi128_ps(second), _MM_SHUFFLE(2, 0, 2, 0)));
+			const __m128i odd = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(first), _mm_castsi128_ps(second), _MM_SHUFFLE(3, 1, 3, 1)));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(row + 4 * x), _mm_avg_epu8(even, odd));
+		}
+#endif
+
+		for (; x < targetWidth; ++x)
+		{
+			// The last column of an odd image is averaged with itself.
+			const uint32 left = 2 * x * 4;
+			const uint32 right = FMath::Min(2 * x + 1, width - 1) * 4;
+
+			for (uint32 c = 0; c < 4; ++c)
+				row[4 * x + c] = Average(Average(upper[left + c], lower[left + c]), Average(upper[right + c], lower[right + c]));
+		}
+	}
+}
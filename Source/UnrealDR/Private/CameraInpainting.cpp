@@ -0,0 +1,612 @@
+#include "CameraInpainting.h"
+#include "UnrealDRSimd.h"
+#include <Async/ParallelFor.h>
+#include <Math/RandomStream.h>
+#include <HAL/PlatformTime.h>
+
+DECLARE_CYCLE_STAT(TEXT("Inpainting"), STAT_UnrealDR_Inpainting, STATGROUP_UnrealDR);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Inpainted Pixels"), STAT_UnrealDR_InpaintedPixels, STATGROUP_UnrealDR);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Inpainting Iterations"), STAT_UnrealDR_InpaintingIterations, STATGROUP_UnrealDR);
+
+namespace
+{
+	/// <summary>
+	/// The minimum edge length of the coarsest pyramid level in pixels.
+	/// </summary>
+	constexpr int32 MinLevelSize = 32;
+
+	/// <summary>
+	/// The ratio of masked pixels that need to keep their match from the previous frame, so that the frame is not solved from scratch.
+	/// </summary>
+	constexpr float MinReusedRatio = 0.75f;
+}
+
+FCameraInpainting::FCameraInpainting(uint32 frameWidth, uint32 frameHeight, const FCameraInpaintingSettings& settings, int32 outputFrames) :
+	m_frameWidth(frameWidth), m_frameHeight(frameHeight), m_settings(settings)
+{
+	m_settings.PyramidLevels = FMath::Max(m_settings.PyramidLevels, 1);
+	m_settings.Iterations = FMath::Max(m_settings.Iterations, 1);
+	m_settings.SteadyStateIterations = FMath::Max(m_settings.SteadyStateIterations, 1);
+	m_outputPool = MakeShared<FCameraFramePool, ESPMode::ThreadSafe>(frameWidth * frameHeight * 4, FMath::Max(outputFrames, 1));
+}
+
+void FCameraInpainting::Reset() noexcept
+{
+	m_eyes[vr::Eye_Left].PreviousField.Empty();
+	m_eyes[vr::Eye_Right].PreviousField.Empty();
+}
+
+FCameraFrameRef FCameraInpainting::Inpaint(const FCameraFrame& frame, const TArray<uint8>& mask, const FIntRect* regions)
+{
+	const uint32 pitch = m_frameWidth * 4;
+
+	if (frame.Size != pitch * m_frameHeight || static_cast<uint32>(mask.Num()) != m_frameWidth * m_frameHeight)
+		return FCameraFrameRef();
+
+	FCameraFrameRef output = m_outputPool->Acquire();
+
+	if (!output.IsValid())
+		return output;
+
+	SCOPE_CYCLE_COUNTER(STAT_UnrealDR_Inpainting);
+
+	FMemory::Memcpy(output->Data, frame.Data, frame.Size);
+	output->Header = frame.Header;
+	output->ExposureTime = frame.ExposureTime;
+	output->bHasExposureTime = frame.bHasExposureTime;
+	output->HeaderPollTime = frame.HeaderPollTime;
+	output->CaptureTime = frame.CaptureTime;
+
+	// Both eyes share the time budget. The right eye image is stored in the upper half, the left eye image in the lower half of the frame.
+	const double deadline = FPlatformTime::Seconds() + m_settings.TimeBudget;
+	const uint32 eyeHeight = m_frameHeight / 2;
+
+	for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+	{
+		// Only the region is solved, so that the cost scales with its area. The state of the eye is reset, if the size of the region changes, and translated, if only
+		// its position changes.
+		const FIntRect eyeRect(0, 0, static_cast<int32>(m_frameWidth), static_cast<int32>(eyeHeight));
+		FIntRect region = regions != nullptr ? regions[e] : eyeRect;
+		region.Clip(eyeRect);
+
+		if (region.Area() <= 0)
+		{
+			m_eyes[e].PreviousField.Empty();
+			continue;
+		}
+
+		const uint32 row = (e == vr::Eye_Left ? eyeHeight : 0) + region.Min.Y;
+		this->InpaintEye(m_eyes[e], output->Data + row * pitch + region.Min.X * 4, pitch, mask.GetData() + row * m_frameWidth + region.Min.X, m_frameWidth, region.Min, region.Width(), region.Height(), frame.Header.nFrameSequence * 2 + e, deadline);
+	}
+
+	return output;
+}
+
+bool FCameraInpainting::InpaintEye(FEyeState& eye, uint8* image, uint32 pitch, const uint8* mask, uint32 maskPitch, const FIntPoint& origin, int32 width, int32 height, uint32 seed, double deadline)
+{
+	// Copy the image into the full resolution level.
+	if (eye.Levels.Num() == 0)
+		eye.Levels.SetNum(1);
+
+	FLevel& base = eye.Levels[0];
+
+	if (base.Width != width || base.Height != height)
+	{
+		ResizeLevel(base, width, height);
+		eye.PreviousField.Empty();
+	}
+
+	int32 holes = 0;
+
+	for (int32 y = 0; y < height; ++y)
+	{
+		FMemory::Memcpy(base.GetPixel(0, y), image + y * pitch, width * 4);
+
+		for (int32 x = 0; x < width; ++x)
+		{
+			const bool hole = mask[y * maskPitch + x] != 0;
+			base.Holes[y * width + x] = hole ? 1 : 0;
+			holes += hole ? 1 : 0;
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_UnrealDR_InpaintedPixels, holes);
+
+	if (holes == 0)
+	{
+		eye.PreviousField.Empty();
+		return false;
+	}
+
+	ExtendBorder(base);
+	ComputeSources(base);
+
+	if (base.SourceIndices.Num() == 0)
+		return false;
+
+	int32 iterations = 0;
+
+	if (eye.PreviousField.Num() == base.Field.Num() && this->ReuseField(base, eye.PreviousField, origin - eye.PreviousOrigin, seed))
+	{
+		// Most masked pixels keep their match from the previous frame, so only a few iterations at full resolution are required.
+		this->Reconstruct(base);
+
+		for (; iterations < m_settings.SteadyStateIterations && FPlatformTime::Seconds() < deadline; ++iterations)
+		{
+			this->Search(base, seed + iterations, (iterations & 1) != 0);
+			this->Reconstruct(base);
+		}
+	}
+	else
+	{
+		// Solve from scratch, starting with a random field at the coarsest level.
+		this->BuildPyramid(eye, m_settings.PyramidLevels);
+		this->InitializeCoarsest(eye.Levels.Last(), seed);
+
+		for (int32 l = eye.Levels.Num() - 1; l >= 0; --l)
+		{
+			FLevel& level = eye.Levels[l];
+
+			if (l < eye.Levels.Num() - 1)
+			{
+				this->Upsample(eye.Levels[l + 1], level, seed + l);
+				this->Reconstruct(level);
+			}
+
+			for (int32 i = 0; i < m_settings.Iterations && FPlatformTime::Seconds() < deadline; ++i, ++iterations)
+			{
+				this->Search(level, seed + iterations, (i & 1) != 0);
+				this->Reconstruct(level);
+			}
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_UnrealDR_InpaintingIterations, iterations);
+
+	// Keep the field as starting point for the next frame and write back the masked pixels.
+	FLevel& result = eye.Levels[0];
+	eye.PreviousField = result.Field;
+	eye.PreviousOrigin = origin;
+
+	for (int32 y = 0; y < height; ++y)
+	{
+		for (int32 x = 0; x < width; ++x)
+		{
+			if (result.Holes[y * width + x] != 0)
+				FMemory::Memcpy(image + y * pitch + x * 4, result.GetPixel(x, y), 4);
+		}
+	}
+
+	return true;
+}
+
+void FCameraInpainting::BuildPyramid(FEyeState& eye, int32 levels)
+{
+	// Halve the resolution, until the coarsest level would become too small to contain whole patches.
+	int32 count = 1;
+
+	for (int32 width = eye.Levels[0].Width, height = eye.Levels[0].Height; count < levels && FMath::Min(width / 2, height / 2) >= MinLevelSize; ++count)
+	{
+		width /= 2;
+		height /= 2;
+	}
+
+	eye.Levels.SetNum(count);
+
+	for (int32 l = 1; l < count; ++l)
+	{
+		const FLevel& fine = eye.Levels[l - 1];
+		FLevel& coarse = eye.Levels[l];
+		ResizeLevel(coarse, fine.Width / 2, fine.Height / 2);
+
+		ParallelFor(coarse.Height, [&fine, &coarse](int32 y) {
+			for (int32 x = 0; x < coarse.Width; ++x)
+			{
+				// A coarse pixel is masked, if any of its fine pixels is. Its initial estimate is the average of the unmasked fine pixels.
+				uint32 sum[4]{ 0, 0, 0, 0 };
+				uint32 count = 0;
+
+				for (int32 s = 0; s < 4; ++s)
+				{
+					const int32 fx = x * 2 + (s & 1);
+					const int32 fy = y * 2 + (s >> 1);
+
+					if (fine.Holes[fy * fine.Width + fx] != 0)
+						continue;
+
+					const uint8* pixel = fine.GetPixel(fx, fy);
+
+					for (int32 c = 0; c < 4; ++c)
+						sum[c] += pixel[c];
+
+					++count;
+				}
+
+				uint8* pixel = coarse.GetPixel(x, y);
+
+				for (int32 c = 0; c < 4; ++c)
+					pixel[c] = count > 0 ? static_cast<uint8>((sum[c] + count / 2) / count) : 0;
+
+				coarse.Holes[y * coarse.Width + x] = count < 4 ? 1 : 0;
+			}
+		});
+
+		ExtendBorder(coarse);
+		ComputeSources(coarse);
+
+		// Stop at the first level, where the mask leaves no source patches.
+		if (coarse.SourceIndices.Num() == 0)
+		{
+			eye.Levels.SetNum(l);
+			break;
+		}
+	}
+}
+
+void FCameraInpainting::InitializeCoarsest(FLevel& level, uint32 seed)
+{
+	const int32 pixels = level.Width * level.Height;
+
+	// Start with the mean color of the unmasked pixels as estimate for all masked pixels.
+	uint64 sum[4]{ 0, 0, 0, 0 };
+	uint64 count = 0;
+
+	for (int32 i = 0; i < pixels; ++i)
+	{
+		if (level.Holes[i] != 0)
+			continue;
+
+		const uint8* pixel = level.GetPixel(i % level.Width, i / level.Width);
+
+		for (int32 c = 0; c < 4; ++c)
+			sum[c] += pixel[c];
+
+		++count;
+	}
+
+	uint8 mean[4]{ 0, 0, 0, 255 };
+
+	for (int32 c = 0; count > 0 && c < 4; ++c)
+		mean[c] = static_cast<uint8>(sum[c] / count);
+
+	// Assign random matches to the masked pixels.
+	FRandomStream random(static_cast<int32>(seed));
+
+	for (int32 i = 0; i < pixels; ++i)
+	{
+		const int32 x = i % level.Width;
+		const int32 y = i / level.Width;
+
+		if (level.Holes[i] == 0)
+		{
+			level.Field[i] = { static_cast<int16>(x), static_cast<int16>(y) };
+			continue;
+		}
+
+		FMemory::Memcpy(level.GetPixel(x, y), mean, 4);
+
+		const int32 source = level.SourceIndices[random.RandHelper(level.SourceIndices.Num())];
+		level.Field[i] = { static_cast<int16>(source % level.Width), static_cast<int16>(source / level.Width) };
+	}
+
+	ExtendBorder(level);
+}
+
+bool FCameraInpainting::ReuseField(FLevel& level, const TArray<FMatch>& previousField, const FIntPoint& offset, uint32 seed)
+{
+	FRandomStream random(static_cast<int32>(seed));
+	int32 holes = 0, reused = 0;
+
+	for (int32 i = 0; i < level.Field.Num(); ++i)
+	{
+		const int32 x = i % level.Width;
+		const int32 y = i / level.Width;
+
+		if (level.Holes[i] == 0)
+		{
+			level.Field[i] = { static_cast<int16>(x), static_cast<int16>(y) };
+			continue;
+		}
+
+		// The previous field is relative to the previous region, so the pixel and its match are moved by the offset between both regions. Pixels that have not been
+		// part of the previous region and matches that have left the region or have been covered by the mask in the meantime are replaced by random ones.
+		const int32 previousX = x + offset.X;
+		const int32 previousY = y + offset.Y;
+		++holes;
+
+		if (previousX >= 0 && previousX < level.Width && previousY >= 0 && previousY < level.Height)
+		{
+			const FMatch& match = previousField[previousY * level.Width + previousX];
+			const int32 matchX = match.X - offset.X;
+			const int32 matchY = match.Y - offset.Y;
+
+			if (matchX >= 0 && matchX < level.Width && matchY >= 0 && matchY < level.Height && level.Sources[matchY * level.Width + matchX] != 0)
+			{
+				level.Field[i] = { static_cast<int16>(matchX), static_cast<int16>(matchY) };
+				++reused;
+				continue;
+			}
+		}
+
+		const int32 source = level.SourceIndices[random.RandHelper(level.SourceIndices.Num())];
+		level.Field[i] = { static_cast<int16>(source % level.Width), static_cast<int16>(source / level.Width) };
+	}
+
+	return reused >= holes * MinReusedRatio;
+}
+
+void FCameraInpainting::Upsample(const FLevel& coarse, FLevel& fine, uint32 seed)
+{
+	ParallelFor(fine.Height, [&coarse, &fine, seed](int32 y) {
+		FRandomStream random(static_cast<int32>(seed * 7919u + static_cast<uint32>(y)));
+
+		for (int32 x = 0; x < fine.Width; ++x)
+		{
+			const int32 i = y * fine.Width + x;
+
+			if (fine.Holes[i] == 0)
+			{
+				fine.Field[i] = { static_cast<int16>(x), static_cast<int16>(y) };
+				continue;
+			}
+
+			// Scale the coarse match and keep the offset within the coarse pixel. Fall back to a random match, if the scaled one is not a valid source.
+			const FMatch& match = coarse.Field[FMath::Min(y / 2, coarse.Height - 1) * coarse.Width + FMath::Min(x / 2, coarse.Width - 1)];
+			const int32 sourceX = match.X * 2 + (x & 1);
+			const int32 sourceY = match.Y * 2 + (y & 1);
+
+			if (sourceX < fine.Width && sourceY < fine.Height && fine.Sources[sourceY * fine.Width + sourceX] != 0)
+			{
+				fine.Field[i] = { static_cast<int16>(sourceX), static_cast<int16>(sourceY) };
+			}
+			else
+			{
+				const int32 source = fine.SourceIndices[random.RandHelper(fine.SourceIndices.Num())];
+				fine.Field[i] = { static_cast<int16>(source % fine.Width), static_cast<int16>(source / fine.Width) };
+			}
+		}
+	});
+}
+
+void FCameraInpainting::Search(FLevel& level, uint32 seed, bool reverse)
+{
+	// Neighbors in other tiles are read from a snapshot, since they are updated concurrently.
+	FMemory::Memcpy(level.Snapshot.GetData(), level.Field.GetData(), level.Field.Num() * sizeof(FMatch));
+
+	const int32 tiles = FMath::DivideAndRoundUp(level.Height, TileRows);
+
+	ParallelFor(tiles, [&level, seed, reverse](int32 tile) {
+		FRandomStream random(static_cast<int32>(seed * 7919u + static_cast<uint32>(tile)));
+
+		const int32 width = level.Width;
+		const int32 height = level.Height;
+		const int32 firstRow = tile * TileRows;
+		const int32 lastRow = FMath::Min(firstRow + TileRows, height) - 1;
+		const int32 step = reverse ? -1 : 1;
+
+		for (int32 row = 0; row <= lastRow - firstRow; ++row)
+		{
+			const int32 y = reverse ? lastRow - row : firstRow + row;
+
+			for (int32 column = 0; column < width; ++column)
+			{
+				const int32 x = reverse ? width - 1 - column : column;
+				const int32 i = y * width + x;
+
+				if (level.Holes[i] == 0)
+					continue;
+
+				FMatch best = level.Field[i];
+				uint32 bestCost = ComputeCost(level, x, y, best.X, best.Y);
+
+				auto test = [&level, &best, &bestCost, x, y](int32 sourceX, int32 sourceY) {
+					if (sourceX < 0 || sourceY < 0 || sourceX >= level.Width || sourceY >= level.Height || level.Sources[sourceY * level.Width + sourceX] == 0)
+						return;
+
+					const uint32 cost = ComputeCost(level, x, y, sourceX, sourceY);
+
+					if (cost < bestCost)
+					{
+						best = { static_cast<int16>(sourceX), static_cast<int16>(sourceY) };
+						bestCost = cost;
+					}
+				};
+
+				// Propagate the matches of the preceding neighbors in scan order, shifted by the offset to them.
+				if (x - step >= 0 && x - step < width)
+				{
+					const FMatch& match = level.Field[i - step];
+					test(match.X + step, match.Y);
+				}
+
+				if (y - step >= 0 && y - step < height)
+				{
+					const bool sameTile = y - step >= firstRow && y - step <= lastRow;
+					const FMatch& match = (sameTile ? level.Field : level.Snapshot)[i - step * width];
+					test(match.X, match.Y + step);
+				}
+
+				// Search randomly around the best match, with exponentially shrinking radius.
+				for (int32 radius = FMath::Max(width, height); radius >= 1; radius /= 2)
+					test(best.X + random.RandRange(-radius, radius), best.Y + random.RandRange(-radius, radius));
+
+				level.Field[i] = best;
+			}
+		}
+	});
+}
+
+void FCameraInpainting::Reconstruct(FLevel& level)
+{
+	// Sources never contain masked pixels, so masked pixels can be written in place.
+	ParallelFor(level.Height, [&level](int32 y) {
+		for (int32 x = 0; x < level.Width; ++x)
+		{
+			if (level.Holes[y * level.Width + x] == 0)
+				continue;
+
+			// Each masked patch overlapping the pixel votes for the pixel of its match at the same offset.
+			uint32 sum[4]{ 0, 0, 0, 0 };
+			uint32 votes = 0;
+
+			for (int32 dy = -PatchRadius; dy <= PatchRadius; ++dy)
+			{
+				const int32 qy = y + dy;
+
+				if (qy < 0 || qy >= level.Height)
+					continue;
+
+				for (int32 dx = -PatchRadius; dx <= PatchRadius; ++dx)
+				{
+					const int32 qx = x + dx;
+
+					if (qx < 0 || qx >= level.Width || level.Holes[qy * level.Width + qx] == 0)
+						continue;
+
+					const FMatch& match = level.Field[qy * level.Width + qx];
+					const uint8* pixel = level.GetPixel(match.X - dx, match.Y - dy);
+
+					for (int32 c = 0; c < 4; ++c)
+						sum[c] += pixel[c];
+
+					++votes;
+				}
+			}
+
+			uint8* pixel = level.GetPixel(x, y);
+
+			for (int32 c = 0; c < 4; ++c)
+				pixel[c] = static_cast<uint8>((sum[c] + votes / 2) / votes);
+		}
+	});
+
+	ExtendBorder(level);
+}
+
+void FCameraInpainting::ResizeLevel(FLevel& level, int32 width, int32 height)
+{
+	const int32 pixels = width * height;
+
+	level.Width = width;
+	level.Height = height;
+	level.Image.SetNumUninitialized((width + 2 * PatchRadius) * (height + 2 * PatchRadius) * 4);
+	level.Holes.SetNumUninitialized(pixels);
+	level.Sources.SetNumUninitialized(pixels);
+	level.Field.SetNumUninitialized(pixels);
+	level.Snapshot.SetNumUninitialized(pixels);
+}
+
+void FCameraInpainting::ComputeSources(FLevel& level)
+{
+	const int32 width = level.Width;
+	const int32 height = level.Height;
+
+	// First mark pixels with a masked pixel within the patch radius in the same row, then check the rows within the radius.
+	TArray<uint8> rowHoles;
+	rowHoles.SetNumUninitialized(width * height);
+
+	ParallelFor(height, [&level, &rowHoles, width](int32 y) {
+		const uint8* holes = level.Holes.GetData() + y * width;
+		int32 count = 0;
+
+		for (int32 x = 0; x < PatchRadius && x < width; ++x)
+			count += holes[x];
+
+		for (int32 x = 0; x < width; ++x)
+		{
+			if (x + PatchRadius < width)
+				count += holes[x + PatchRadius];
+
+			if (x - PatchRadius - 1 >= 0)
+				count -= holes[x - PatchRadius - 1];
+
+			rowHoles[y * width + x] = count > 0 ? 1 : 0;
+		}
+	});
+
+	ParallelFor(height, [&level, &rowHoles, width, height](int32 y) {
+		for (int32 x = 0; x < width; ++x)
+		{
+			uint8 valid = x >= PatchRadius && x < width - PatchRadius && y >= PatchRadius && y < height - PatchRadius ? 1 : 0;
+
+			for (int32 dy = -PatchRadius; valid != 0 && dy <= PatchRadius; ++dy)
+				valid = rowHoles[(y + dy) * width + x] == 0 ? 1 : 0;
+
+			level.Sources[y * width + x] = valid;
+		}
+	});
+
+	level.SourceIndices.Reset();
+
+	for (int32 i = 0; i < level.Sources.Num(); ++i)
+	{
+		if (level.Sources[i] != 0)
+			level.SourceIndices.Add(i);
+	}
+}
+
+void FCameraInpainting::ExtendBorder(FLevel& level)
+{
+	const int32 pitch = level.GetPitch();
+
+	// Replicate the first and last pixel of each row, then the first and last row.
+	for (int32 y = 0; y < level.Height; ++y)
+	{
+		const uint8* first = level.GetPixel(0, y);
+		const uint8* last = level.GetPixel(level.Width - 1, y);
+
+		for (int32 x = 1; x <= PatchRadius; ++x)
+		{
+			FMemory::Memcpy(level.GetPixel(-x, y), first, 4);
+			FMemory::Memcpy(level.GetPixel(level.Width - 1 + x, y), last, 4);
+		}
+	}
+
+	for (int32 y = 1; y <= PatchRadius; ++y)
+	{
+		FMemory::Memcpy(level.GetPixel(-PatchRadius, -y), level.GetPixel(-PatchRadius, 0), pitch);
+		FMemory::Memcpy(level.GetPixel(-PatchRadius, level.Height - 1 + y), level.GetPixel(-PatchRadius, level.Height - 1), pitch);
+	}
+}
+
+uint32 FCameraInpainting::ComputeCost(const FLevel& level, int32 x, int32 y, int32 sourceX, int32 sourceY) noexcept
+{
+	const int32 pitch = level.GetPitch();
+	return ComputePatchDistance(level.GetPixel(x - PatchRadius, y - PatchRadius), pitch, level.GetPixel(sourceX - PatchRadius, sourceY - PatchRadius), pitch);
+}
+
+uint32 FCameraInpainting::ComputePatchDistance(const uint8* a, int32 aPitch, const uint8* b, int32 bPitch) noexcept
+{
+	static_assert(PatchRadius == 3, "The patch distance is computed for patches of 7x7 pixels.");
+
+#if UNREALDR_SIMD_SSE2
+	// Each row of 28 bytes is split into 16 bytes and 12 bytes, padded with zeros, so that no bytes outside of the patch are read.
+	__m128i sum = _mm_setzero_si128();
+
+	for (int32 y = 0; y < 2 * PatchRadius + 1; ++y, a += aPitch, b += bPitch)
+	{
+		int32 aLast, bLast;
+		FMemory::Memcpy(&aLast, a + 24, 4);
+		FMemory::Memcpy(&bLast, b + 24, 4);
+
+		const __m128i aLow = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+		const __m128i bLow = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+		const __m128i aHigh = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(a + 16)), _mm_cvtsi32_si128(aLast));
+		const __m128i bHigh = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(b + 16)), _mm_cvtsi32_si128(bLast));
+
+		sum = _mm_add_epi32(sum, _mm_add_epi32(_mm_sad_epu8(aLow, bLow), _mm_sad_epu8(aHigh, bHigh)));
+	}
+
+	return static_cast<uint32>(_mm_cvtsi128_si32(sum) + _mm_cvtsi128_si32(_mm_srli_si128(sum, 8)));
+#else
+	uint32 sum = 0;
+
+	for (int32 y = 0; y < 2 * PatchRadius + 1; ++y, a += aPitch, b += bPitch)
+	{
+		for (int32 i = 0; i < (2 * PatchRadius + 1) * 4; ++i)
+			sum += static_cast<uint32>(FMath::Abs(static_cast<int32>(a[i]) - static_cast<int32>(b[i])));
+	}
+
+	return sum;
+#endif
+}
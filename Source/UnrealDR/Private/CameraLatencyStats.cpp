@@ -0,0 +1,376 @@
+#include "CameraLatencyStats.h"
+#include <Async/Async.h>
+#include <HAL/FileManager.h>
+#include <Misc/FileHelper.h>
+#include <Misc/ScopeLock.h>
+#include <Misc/CoreDelegates.h>
+#include <RenderingThread.h>
+#include <algorithm>
+
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Exposure to Poll (Min, ms)"), STAT_UnrealDR_ExposureMin, STATGROUP_UnrealDR);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Exposure to Poll (Avg, ms)"), STAT_UnrealDR_ExposureAvg, STATGROUP_UnrealDR);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Exposure to Poll (P99, ms)"), STAT_UnrealDR_ExposureP99, STATGROUP_UnrealDR);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Frame Copy (Min, ms)"), STAT_UnrealDR_CopyMin, STATGROUP_UnrealDR);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Frame Copy (Avg, ms)"), STAT_UnrealDR_CopyAvg, STATGROUP_UnrealDR);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Frame Copy (P99, ms)"), STAT_UnrealDR_CopyP99, STATGROUP_UnrealDR);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Copy to Upload Enqueue (Min, ms)"), STAT_UnrealDR_PublishMin, STATGROUP_UnrealDR);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Copy to Upload Enqueue (Avg, ms)"), STAT_UnrealDR_PublishAvg, STATGROUP_UnrealDR);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Copy to Upload Enqueue (P99, ms)"), STAT_UnrealDR_PublishP99, STATGROUP_UnrealDR);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Texture Upload (Min, ms)"), STAT_UnrealDR_UploadMin, STATGROUP_UnrealDR);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Texture Upload (Avg, ms)"), STAT_UnrealDR_UploadAvg, STATGROUP_UnrealDR);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Texture Upload (P99, ms)"), STAT_UnrealDR_UploadP99, STATGROUP_UnrealDR);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Upload to Render (Min, ms)"), STAT_UnrealDR_RenderMin, STATGROUP_UnrealDR);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Upload to Render (Avg, ms)"), STAT_UnrealDR_RenderAvg, STATGROUP_UnrealDR);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Upload to Render (P99, ms)"), STAT_UnrealDR_RenderP99, STATGROUP_UnrealDR);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Exposure to Render (Min, ms)"), STAT_UnrealDR_TotalMin, STATGROUP_UnrealDR);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Exposure to Render (Avg, ms)"), STAT_UnrealDR_TotalAvg, STATGROUP_UnrealDR);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Exposure to Render (P99, ms)"), STAT_UnrealDR_TotalP99, STATGROUP_UnrealDR);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Poll to Render (Min, ms)"), STAT_UnrealDR_TotalFromPollMin, STATGROUP_UnrealDR);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Poll to Render (Avg, ms)"), STAT_UnrealDR_TotalFromPollAvg, STATGROUP_UnrealDR);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Poll to Render (P99, ms)"), STAT_UnrealDR_TotalFromPollP99, STATGROUP_UnrealDR);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Exposure Times Available"), STAT_UnrealDR_ExposureAvailable, STATGROUP_UnrealDR);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Rendered Frames"), STAT_UnrealDR_RenderedFrames, STATGROUP_UnrealDR);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Dropped Frames"), STAT_UnrealDR_DroppedFrames, STATGROUP_UnrealDR);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Skipped Frames"), STAT_UnrealDR_SkippedFrames, STATGROUP_UnrealDR);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Repeated Frames"), STAT_UnrealDR_RepeatedFrames, STATGROUP_UnrealDR);
+
+#define SET_LATENCY_STATS(Stage, Summary) \
+	SET_FLOAT_STAT(STAT_UnrealDR_##Stage##Min, Summary.Min); \
+	SET_FLOAT_STAT(STAT_UnrealDR_##Stage##Avg, Summary.Avg); \
+	SET_FLOAT_STAT(STAT_UnrealDR_##Stage##P99, Summary.P99);
+
+namespace
+{
+	/// <summary>
+	/// The number of CSV lines that are buffered before they are written to disk.
+	/// </summary>
+	constexpr int32 CsvFlushInterval = 120;
+
+	/// <summary>
+	/// The maximum number of frames that wait to be rendered.
+	/// </summary>
+	constexpr int32 MaxPendingFrames = 16;
+}
+
+FCameraLatencyStats::FCameraLatencyStats(int32 windowSize) :
+	m_windowSize(FMath::Max(windowSize, 1))
+{
+	for (auto& samples : m_samples)
+		samples.Reserve(m_windowSize);
+}
+
+FCameraLatencyStats::~FCameraLatencyStats()
+{
+	this->FlushCsv(true);
+}
+
+void FCameraLatencyStats::EnableCsvExport(const FString& fileName)
+{
+	// Lines of a previous file must not end up in the new one.
+	this->FlushCsv(true);
+
+	FScopeLock lock(&m_lock);
+
+	m_csvFileName = fileName;
+	m_csvBuffer = TEXT("Sequence,Exposure,HeaderPoll,CopyDone,UploadEnqueued,UploadDone,Rendered");
+
+	for (int32 stage = 0; stage < static_cast<int32>(ECameraLatencyStage::Count); ++stage)
+		m_csvBuffer += FString::Printf(TEXT(",%sMs"), GetStageName(static_cast<ECameraLatencyStage>(stage)));
+
+	m_csvBuffer += LINE_TERMINATOR;
+	m_csvBufferedLines = 1;
+
+	// Truncate existing files.
+	FFileHelper::SaveStringToFile(TEXT(""), *m_csvFileName);
+}
+
+void FCameraLatencyStats::FlushCsv(bool wait)
+{
+	{
+		FScopeLock lock(&m_lock);
+
+		if (m_csvFileName.IsEmpty())
+			return;
+
+		if (m_csvBufferedLines > 0)
+		{
+			m_csvPending += m_csvBuffer;
+			m_csvBuffer.Reset();
+			m_csvBufferedLines = 0;
+		}
+
+		// A running writer picks up the new lines before it finishes, so a new one is only started if there is none.
+		if (!m_csvWriting && !m_csvPending.IsEmpty())
+		{
+			m_csvWriting = true;
+			m_csvWriter = Async(EAsyncExecution::ThreadPool, [this]() { this->WriteCsv(); });
+		}
+	}
+
+	if (wait)
+		this->WaitForCsvWriter();
+}
+
+void FCameraLatencyStats::WriteCsv()
+{
+	while (true)
+	{
+		FString lines, fileName;
+
+		{
+			FScopeLock lock(&m_lock);
+
+			if (m_csvPending.IsEmpty())
+			{
+				m_csvWriting = false;
+				return;
+			}
+
+			lines = MoveTemp(m_csvPending);
+			fileName = m_csvFileName;
+			m_csvPending.Reset();
+		}
+
+		FFileHelper::SaveStringToFile(lines, *fileName, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+	}
+}
+
+void FCameraLatencyStats::WaitForCsvWriter()
+{
+	TFuture<void> writer;
+
+	{
+		FScopeLock lock(&m_lock);
+		writer = MoveTemp(m_csvWriter);
+	}
+
+	// The writer captures the statistics, so the destructor must not return before it has finished.
+	if (writer.IsValid())
+		writer.Wait();
+}
+
+void FCameraLatencyStats::RegisterRenderFrameCallback()
+{
+	// The delegate is broadcast on the render thread, so it must also be modified there.
+	ENQUEUE_RENDER_COMMAND(UnrealDRRegisterLatencyStats)([stats = this->AsShared()](FRHICommandListImmediate&) {
+		if (!stats->m_endFrameHandle.IsValid())
+			stats->m_endFrameHandle = FCoreDelegates::OnEndFrameRT.AddThreadSafeSP(stats, &FCameraLatencyStats::MarkRenderFrameEnd);
+	});
+}
+
+void FCameraLatencyStats::UnregisterRenderFrameCallback()
+{
+	ENQUEUE_RENDER_COMMAND(UnrealDRUnregisterLatencyStats)([stats = this->AsShared()](FRHICommandListImmediate&) {
+		FCoreDelegates::OnEndFrameRT.Remove(stats->m_endFrameHandle);
+		stats->m_endFrameHandle.Reset();
+	});
+}
+
+void FCameraLatencyStats::MarkUploadEnqueued(const FCameraFrame& frame, int32 uploads)
+{
+	FPendingFrame pending;
+	pending.Sequence = frame.Header.nFrameSequence;
+	pending.Exposure = frame.ExposureTime;
+	pending.bHasExposure = frame.bHasExposureTime;
+	pending.HeaderPoll = frame.HeaderPollTime;
+	pending.CopyDone = frame.CaptureTime;
+	pending.UploadEnqueued = FPlatformTime::Seconds();
+	pending.PendingUploads = uploads;
+
+	FScopeLock lock(&m_lock);
+
+	// If render frames do not end (e.g. while the viewport is minimized), discard the oldest frames instead of growing indefinitely.
+	if (m_pendingFrames.Num() >= MaxPendingFrames)
+		m_pendingFrames.RemoveAt(0, 1, false);
+
+	m_pendingFrames.Add(pending);
+}
+
+void FCameraLatencyStats::MarkUploadDone(uint32 sequence)
+{
+	const double now = FPlatformTime::Seconds();
+	FScopeLock lock(&m_lock);
+
+	for (auto& pending : m_pendingFrames)
+	{
+		if (pending.Sequence == sequence && pending.PendingUploads > 0 && --pending.PendingUploads == 0)
+		{
+			pending.UploadDone = now;
+			break;
+		}
+	}
+}
+
+void FCameraLatencyStats::MarkRenderFrameEnd()
+{
+	const double now = FPlatformTime::Seconds();
+	FScopeLock lock(&m_lock);
+
+	for (int32 i = 0; i < m_pendingFrames.Num(); )
+	{
+		if (m_pendingFrames[i].PendingUploads == 0)
+		{
+			this->CompleteFrame(m_pendingFrames[i], now);
+			m_pendingFrames.RemoveAtSwap(i, 1, false);
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	if (m_csvBufferedLines >= CsvFlushInterval)
+	{
+		// Flushing acquires the lock again, which is fine, since it is re-entrant.
+		this->FlushCsv(false);
+	}
+}
+
+void FCameraLatencyStats::MarkRepeatedFrame()
+{
+	FScopeLock lock(&m_lock);
+	++m_repeatedFrames;
+}
+
+void FCameraLatencyStats::CompleteFrame(const FPendingFrame& frame, double renderTime)
+{
+	const float latencies[static_cast<int32>(ECameraLatencyStage::Count)] = {
+		static_cast<float>((frame.HeaderPoll - frame.Exposure) * 1000.0),
+		static_cast<float>((frame.CopyDone - frame.HeaderPoll) * 1000.0),
+		static_cast<float>((frame.UploadEnqueued - frame.CopyDone) * 1000.0),
+		static_cast<float>((frame.UploadDone - frame.UploadEnqueued) * 1000.0),
+		static_cast<float>((renderTime - frame.UploadDone) * 1000.0),
+		static_cast<float>((renderTime - frame.Exposure) * 1000.0)
+	};
+
+	// Store the latencies in the sliding window. Without an exposure time, the exposure stage would always be zero, so it is not sampled at all.
+	for (int32 stage = 0; stage < static_cast<int32>(ECameraLatencyStage::Count); ++stage)
+	{
+		if (stage == static_cast<int32>(ECameraLatencyStage::Exposure) && !frame.bHasExposure)
+			continue;
+
+		if (m_samples[stage].Num() < m_windowSize)
+			m_samples[stage].Add(latencies[stage]);
+		else
+			m_samples[stage][m_nextSample[stage]] = latencies[stage];
+
+		m_nextSample[stage] = (m_nextSample[stage] + 1) % m_windowSize;
+	}
+
+	++m_renderedFrames;
+
+	if (!m_csvFileName.IsEmpty())
+	{
+		// Unavailable exposure timestamps and latencies are left empty. This includes the total latency, which would otherwise start at the header poll.
+		m_csvBuffer += FString::Printf(TEXT("%u,"), frame.Sequence);
+
+		if (frame.bHasExposure)
+			m_csvBuffer += FString::Printf(TEXT("%.6f"), frame.Exposure);
+
+		m_csvBuffer += FString::Printf(TEXT(",%.6f,%.6f,%.6f,%.6f,%.6f"), frame.HeaderPoll, frame.CopyDone, frame.UploadEnqueued, frame.UploadDone, renderTime);
+
+		for (int32 stage = 0; stage < static_cast<int32>(ECameraLatencyStage::Count); ++stage)
+		{
+			if ((stage == static_cast<int32>(ECameraLatencyStage::Exposure) || stage == static_cast<int32>(ECameraLatencyStage::Total)) && !frame.bHasExposure)
+				m_csvBuffer += TEXT(",");
+			else
+				m_csvBuffer += FString::Printf(TEXT(",%.3f"), latencies[stage]);
+		}
+
+		m_csvBuffer += LINE_TERMINATOR;
+		++m_csvBufferedLines;
+	}
+}
+
+FCameraLatencySummary FCameraLatencyStats::GetSummary(ECameraLatencyStage stage) const
+{
+	TArray<float, TInlineAllocator<256>> samples;
+
+	{
+		FScopeLock lock(&m_lock);
+		samples.Append(m_samples[static_cast<int32>(stage)]);
+	}
+
+	FCameraLatencySummary summary;
+
+	if (samples.Num() == 0)
+		return summary;
+
+	float sum = 0.f;
+	summary.Min = samples[0];
+
+	for (float sample : samples)
+	{
+		sum += sample;
+		summary.Min = FMath::Min(summary.Min, sample);
+	}
+
+	summary.Avg = sum / samples.Num();
+
+	// Only the percentiles need to be in place, so a full sort is not required. Each partition leaves the larger samples behind the percentile, so the next one
+	// only needs to partition those.
+	const int32 p50 = FMath::Min(samples.Num() - 1, FMath::FloorToInt(samples.Num() * 0.5f));
+	const int32 p95 = FMath::Max(p50, FMath::Min(samples.Num() - 1, FMath::FloorToInt(samples.Num() * 0.95f)));
+	const int32 p99 = FMath::Max(p95, FMath::Min(samples.Num() - 1, FMath::FloorToInt(samples.Num() * 0.99f)));
+	std::nth_element(samples.GetData(), samples.GetData() + p50, samples.GetData() + samples.Num());
+	std::nth_element(samples.GetData() + p50, samples.GetData() + p95, samples.GetData() + samples.Num());
+	std::nth_element(samples.GetData() + p95, samples.GetData() + p99, samples.GetData() + samples.Num());
+	summary.P50 = samples[p50];
+	summary.P95 = samples[p95];
+	summary.P99 = samples[p99];
+
+	return summary;
+}
+
+bool FCameraLatencyStats::IsStageAvailable(ECameraLatencyStage stage) const
+{
+	FScopeLock lock(&m_lock);
+	return m_samples[static_cast<int32>(stage)].Num() > 0;
+}
+
+void FCameraLatencyStats::PublishStats(int32 droppedFrames, int32 skippedFrames) const
+{
+#if STATS
+	// If the source does not report exposure times, the exposure stats are not set, so that they do not show up as zero latency, and the total latency is
+	// published as poll to render latency instead.
+	const bool exposureAvailable = this->IsStageAvailable(ECameraLatencyStage::Exposure);
+	SET_DWORD_STAT(STAT_UnrealDR_ExposureAvailable, exposureAvailable ? 1 : 0);
+
+	if (exposureAvailable)
+	{
+		SET_LATENCY_STATS(Exposure, this->GetSummary(ECameraLatencyStage::Exposure));
+		SET_LATENCY_STATS(Total, this->GetSummary(ECameraLatencyStage::Total));
+	}
+	else
+	{
+		SET_LATENCY_STATS(TotalFromPoll, this->GetSummary(ECameraLatencyStage::Total));
+	}
+
+	SET_LATENCY_STATS(Copy, this->GetSummary(ECameraLatencyStage::Copy));
+	SET_LATENCY_STATS(Publish, this->GetSummary(ECameraLatencyStage::Publish));
+	SET_LATENCY_STATS(Upload, this->GetSummary(ECameraLatencyStage::Upload));
+	SET_LATENCY_STATS(Render, this->GetSummary(ECameraLatencyStage::Render));
+
+	FScopeLock lock(&m_lock);
+	SET_DWORD_STAT(STAT_UnrealDR_RenderedFrames, m_renderedFrames);
+	SET_DWORD_STAT(STAT_UnrealDR_DroppedFrames, droppedFrames);
+	SET_DWORD_STAT(STAT_UnrealDR_SkippedFrames, skippedFrames);
+	SET_DWORD_STAT(STAT_UnrealDR_RepeatedFrames, m_repeatedFrames);
+#endif // STATS
+}
+
+const TCHAR* FCameraLatencyStats::GetStageName(ECameraLatencyStage stage) noexcept
+{
+	switch (stage)
+	{
+	case ECameraLatencyStage::Exposure: return TEXT("Exposure");
+	case ECameraLatencyStage::Copy: return TEXT("Copy");
+	case ECameraLatencyStage::Publish: return TEXT("Publish");
+	case ECameraLatencyStage::Upload: return TEXT("Upload");
+	case ECameraLatencyStage::Render: return TEXT("Render");
+	case ECameraLatencyStage::Total: return TEXT("Total");
+	default: return TEXT("Unknown");
+	}
+}
+
+#undef SET_LATENCY_STATS
@@ -0,0 +1,220 @@
+#include "CameraOpticalFlow.h"
+#include "UnrealDRSimd.h"
+#include <Async/ParallelFor.h>
+
+DECLARE_CYCLE_STAT(TEXT("Optical Flow"), STAT_UnrealDR_OpticalFlow, STATGROUP_UnrealDR);
+
+namespace
+{
+	/// <summary>
+	/// The Rec. 709 luminance weights in 8 bit fixed point, which add up to 256.
+	/// </summary>
+	constexpr uint32 LuminanceWeightR = 54;
+	constexpr uint32 LuminanceWeightG = 183;
+	constexpr uint32 LuminanceWeightB = 19;
+
+	/// <summary>
+	/// Returns the offset of the minimum of a parabola through the costs of a displacement and its neighbors, or `0`, if the costs do not form a minimum.
+	/// </summary>
+	FORCEINLINE float RefineDisplacement(uint32 previous, uint32 center, uint32 next) noexcept
+	{
+		const float curvature = static_cast<float>(previous) - 2.f * center + static_cast<float>(next);
+		return curvature > 0.f ? FMath::Clamp(0.5f * (static_cast<float>(previous) - static_cast<float>(next)) / curvature, -0.5f, 0.5f) : 0.f;
+	}
+}
+
+FCameraOpticalFlow::FCameraOpticalFlow(uint32 frameWidth, uint32 frameHeight, const FCameraOpticalFlowSettings& settings, int32 outputFrames) :
+	m_settings(settings), m_frameWidth(frameWidth), m_frameHeight(frameHeight)
+{
+	m_settings.PyramidLevel = FMath::Clamp(m_settings.PyramidLevel, 0, 4);
+	m_settings.SearchRadius = FMath::Clamp(m_settings.SearchRadius, 1, MaxSearchRadius);
+
+	// Keep at least two blocks in each direction, so that small eye images can still be matched.
+	for (; m_settings.PyramidLevel >= 0; --m_settings.PyramidLevel)
+	{
+		m_pyramids[vr::Eye_Left] = MakeUnique<FCameraImagePyramid>(m_frameWidth, m_frameHeight / 2, m_settings.PyramidLevel);
+		m_pyramids[vr::Eye_Left]->GetLevelSize(m_settings.PyramidLevel, m_width, m_height);
+
+		if (m_settings.PyramidLevel == 0 || (m_width >= 2 * BlockSize && m_height >= 2 * BlockSize))
+			break;
+	}
+
+	if (m_width < BlockSize || m_height < BlockSize)
+	{
+		m_pyramids[vr::Eye_Left].Reset();
+		return;
+	}
+
+	m_pyramids[vr::Eye_Right] = MakeUnique<FCameraImagePyramid>(m_frameWidth, m_frameHeight / 2, m_settings.PyramidLevel);
+	m_columns = FMath::DivideAndRoundUp(static_cast<int32>(m_width), BlockSize);
+	m_rows = FMath::DivideAndRoundUp(static_cast<int32>(m_height), BlockSize);
+
+	const int32 pixels = static_cast<int32>(m_width * m_height);
+
+	for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+	{
+		m_downsampled[e].SetNumUninitialized(pixels * 4);
+		m_luminance[0][e].SetNumUninitialized(pixels);
+		m_luminance[1][e].SetNumUninitialized(pixels);
+	}
+
+	m_outputPool = MakeShared<FCameraFramePool, ESPMode::ThreadSafe>(static_cast<uint32>(m_columns * m_rows * 2 * 2 * sizeof(FFloat16)), FMath::Max(outputFrames, 1));
+}
+
+FCameraFrameRef FCameraOpticalFlow::Compute(const FCameraFrame& previous, const FCameraFrame& current)
+{
+	const uint32 frameSize = m_frameWidth * m_frameHeight * 4;
+
+	if (!m_outputPool.IsValid() || previous.Size < frameSize || current.Size < frameSize)
+		return FCameraFrameRef();
+
+	FCameraFrameRef output = m_outputPool->Acquire();
+
+	if (!output.IsValid())
+		return output;
+
+	SCOPE_CYCLE_COUNTER(STAT_UnrealDR_OpticalFlow);
+
+	// If the previous frame has been the current frame of the last call, its luminance is still there and only the new frame needs to be downsampled.
+	if (m_currentExposureTime >= 0.0 && previous.Header.nFrameSequence == m_currentSequence && previous.ExposureTime == m_currentExposureTime)
+	{
+		m_current = 1 - m_current;
+	}
+	else
+	{
+		this->ConvertFrame(previous, 1 - m_current);
+	}
+
+	this->ConvertFrame(current, m_current);
+	m_currentSequence = current.Header.nFrameSequence;
+	m_currentExposureTime = current.ExposureTime;
+
+	// The right eye is stored in the upper half, the left eye in the lower half of the flow field. Blocks only read the luminance, so all rows are independent.
+	FFloat16* field = reinterpret_cast<FFloat16*>(output->Data);
+
+	ParallelFor(m_rows * 2, [this, field](int32 index) {
+		const int32 eye = index < m_rows ? vr::Eye_Right : vr::Eye_Left;
+		this->MatchBlockRow(eye, index % m_rows, field + index * m_columns * 2);
+	});
+
+	output->Header = current.Header;
+	output->ExposureTime = current.ExposureTime;
+	output->bHasExposureTime = current.bHasExposureTime;
+	output->HeaderPollTime = current.HeaderPollTime;
+	output->CaptureTime = current.CaptureTime;
+
+	return output;
+}
+
+uint32 FCameraOpticalFlow::ComputeBlockCost(const uint8* block, const uint8* reference, uint32 pitch) noexcept
+{
+	static_assert(BlockSize == 8, "The vectorized cost assumes blocks of 8x8 values.");
+
+#if UNREALDR_SIMD_SSE2
+	// Compare two rows of eight values at once. `_mm_sad_epu8` leaves the sum of each row in the lower 16 bits of its 64 bit lane.
+	__m128i sums = _mm_setzero_si128();
+
+	for (int32 y = 0; y < BlockSize; y += 2)
+	{
+		const __m128i rows = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(block + y * pitch)), _mm_loadl_epi64(reinterpret_cast<const __m128i*>(block + (y + 1) * pitch)));
+		const __m128i references = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(reference + y * pitch)), _mm_loadl_epi64(reinterpret_cast<const __m128i*>(reference + (y + 1) * pitch)));
+		sums = _mm_add_epi32(sums, _mm_sad_epu8(rows, references));
+	}
+
+	return static_cast<uint32>(_mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+#else
+	uint32 cost = 0;
+
+	for (int32 y = 0; y < BlockSize; ++y)
+	{
+		for (int32 x = 0; x < BlockSize; ++x)
+			cost += static_cast<uint32>(FMath::Abs(block[y * pitch + x] - reference[y * pitch + x]));
+	}
+
+	return cost;
+#endif
+}
+
+void FCameraOpticalFlow::ConvertFrame(const FCameraFrame& frame, int32 index)
+{
+	const uint32 pitch = m_frameWidth * 4;
+	const uint32 pixels = m_width * m_height;
+
+	// The right eye image is stored in the upper half, the left eye image in the lower half of the frame buffer.
+	ParallelFor(2, [this, &frame, index, pitch, pixels](int32 e) {
+		const uint8* image = frame.Data + (e == vr::Eye_Left ? (m_frameHeight / 2) * pitch : 0);
+		m_pyramids[e]->Build(image, pitch, m_downsampled[e].GetData(), m_width * 4);
+
+		const uint8* pixel = m_downsampled[e].GetData();
+		uint8* luminance = m_luminance[index][e].GetData();
+
+		for (uint32 p = 0; p < pixels; ++p, pixel += 4)
+			luminance[p] = static_cast<uint8>((LuminanceWeightR * pixel[0] + LuminanceWeightG * pixel[1] + LuminanceWeightB * pixel[2] + 128) >> 8);
+	});
+}
+
+void FCameraOpticalFlow::MatchBlockRow(int32 eye, int32 row, FFloat16* field) const
+{
+	const int32 width = static_cast<int32>(m_width);
+	const int32 height = static_cast<int32>(m_height);
+	const int32 radius = m_settings.SearchRadius;
+	const int32 size = 2 * radius + 1;
+	const uint8* current = m_luminance[m_current][eye].GetData();
+	const uint8* previous = m_luminance[1 - m_current][eye].GetData();
+
+	// The last block of each row and column is moved inside the image, so that it overlaps its neighbor instead of reaching past the edge.
+	const int32 y0 = FMath::Min(row * BlockSize, height - BlockSize);
+	const int32 minY = FMath::Max(-radius, -y0);
+	const int32 maxY = FMath::Min(radius, height - BlockSize - y0);
+	uint32 costs[(2 * MaxSearchRadius + 1) * (2 * MaxSearchRadius + 1)];
+
+	for (int32 column = 0; column < m_columns; ++column)
+	{
+		const int32 x0 = FMath::Min(column * BlockSize, width - BlockSize);
+		const int32 minX = FMath::Max(-radius, -x0);
+		const int32 maxX = FMath::Min(radius, width - BlockSize - x0);
+		const uint8* block = current + y0 * width + x0;
+
+		// Search all displacements within the radius. Ties keep the first candidate in scanline order, so that the result does not depend on the cost function.
+		uint32 bestCost = MAX_uint32;
+		int32 bestX = 0;
+		int32 bestY = 0;
+
+		for (int32 dy = minY; dy <= maxY; ++dy)
+		{
+			for (int32 dx = minX; dx <= maxX; ++dx)
+			{
+				const uint32 cost = ComputeBlockCost(block, previous + (y0 + dy) * width + x0 + dx, static_cast<uint32>(width));
+				costs[(dy + radius) * size + dx + radius] = cost;
+
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestX = dx;
+					bestY = dy;
+				}
+			}
+		}
+
+		// Prefer zero motion, unless another displacement is clearly better.
+		if (costs[radius * size + radius] <= bestCost + m_settings.ZeroMotionBias)
+		{
+			bestX = 0;
+			bestY = 0;
+		}
+
+		const uint32* best = costs + (bestY + radius) * size + bestX + radius;
+		float displacementX = static_cast<float>(bestX);
+		float displacementY = static_cast<float>(bestY);
+
+		if (bestX > minX && bestX < maxX)
+			displacementX += RefineDisplacement(best[-1], best[0], best[1]);
+
+		if (bestY > minY && bestY < maxY)
+			displacementY += RefineDisplacement(best[-size], best[0], best[size]);
+
+		// The block has moved from the displaced position in the previous image to its position in the current image.
+		field[column * 2 + 0] = FFloat16(-displacementX / width);
+		field[column * 2 + 1] = FFloat16(-displacementY / height);
+	}
+}
@@ -1,6 +1,12 @@
 #include "CameraSeeThroughComponent.h"
+#include "OpenVRCameraFrameSource.h"
+#include "SyntheticCameraFrameSource.h"
+#include "ReplayCameraFrameSource.h"
+#include "UndistortedCameraFrameSource.h"
 #include <Modules/ModuleManager.h>
-#include <array>
+#include <Misc/Paths.h>
+#include <Misc/DateTime.h>
+#include <Async/Async.h>
 
 UCameraSeeThroughComponent::UCameraSeeThroughComponent()
 {
@@ -20,181 +26,270 @@ UCameraSeeThroughComponent::UCameraSeeThroughComponent()
 
 void UCameraSeeThroughComponent::OnRegister()
 {
-	// Request the VR system from the module instance.
+	// Request the VR system from the module instance. It is initialized on a background thread, when it is requested for the first time, so it might not be ready
+	// yet. Frame sources that do not stream from an HMD do not use it, so OpenVR is not initialized for them.
 	auto& m = FModuleManager::GetModuleChecked<FUnrealDRModule>("UnrealDR");
-	m_system = m.getVirtualRealitySystem();
+	m_system = this->RequiresVirtualRealitySystem() ? m.getVirtualRealitySystem() : nullptr;
 
-	if (m_system == nullptr)
+	if (m_system == nullptr && this->RequiresVirtualRealitySystem())
 	{
-		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] VR System is not initialized. Make sure the VR HMD is turned on and SteamVR has been launched."));
-		return;
-	}
+		// Set up the view planes from the cached calibration in the meantime, so that the component can be previewed before the runtime is up.
+		FCameraCalibration calibration;
+		this->ResolveTrackedDevice();
+
+		if (this->LoadCachedCalibration(calibration))
+			this->SetupViewPlanes(calibration);
+
+		// Finish the setup, once the system is ready. At most one callback is pending per component, and it is canceled, when the component is unregistered.
+		TWeakObjectPtr<UCameraSeeThroughComponent> self(this);
+		m.cancelVirtualRealitySystemCallback(m_systemReadyHandle);
+
+		m_systemReadyHandle = m.whenVirtualRealitySystemReady([self](vr::IVRSystem* system) {
+			if (!self.IsValid())
+				return;
 
-	// Get a tracked camera interface.
-	m_camera = vr::VRTrackedCamera();
+			self->m_systemReadyHandle.Reset();
 
-	if (m_camera == nullptr)
+			if (system != nullptr && self->IsRegistered())
+				self->OnVirtualRealitySystemReady(system);
+		});
+	}
+	else
 	{
-		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to retrieve HMD camera interface."));
-		return;
+		this->SetupCamera();
+
+		// Restart streaming, if the component has been registered again during play.
+		if (this->HasBegunPlay() && !m_streaming)
+			this->BeginStreaming();
 	}
 
-	// Check if a camera is available.
-	bool hasCamera{ false };
-	auto cameraError = m_camera->HasCamera(vr::k_unTrackedDeviceIndex_Hmd, &hasCamera);
+	Super::OnRegister();
+}
+
+void UCameraSeeThroughComponent::OnVirtualRealitySystemReady(vr::IVRSystem* system)
+{
+	m_system = system;
+	this->SetupCamera();
+
+	// Start streaming, if play has begun while waiting for the system.
+	if (this->HasBegunPlay() && !m_streaming)
+		this->BeginStreaming();
+}
+
+void UCameraSeeThroughComponent::SetupCamera()
+{
+	auto& m = FModuleManager::GetModuleChecked<FUnrealDRModule>("UnrealDR");
+
+	// Subscribe to the camera stream, if it has not yet been subscribed to or the stream configuration has changed. The stream is shared
+	// with all other components that display the same frame source, so that frames are only copied and uploaded once.
+	this->ResolveTrackedDevice();
+	const FString streamKey = this->GetStreamKey();
 
-	if (cameraError != vr::EVRTrackedCameraError::VRTrackedCameraError_None)
+	if (!m_stream.IsValid() || m_stream->GetKey() != streamKey)
 	{
-		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to retrieve camera: %d."), cameraError);
-		return;
+		if (m_stream.IsValid())
+			this->StopStreaming();
+
+		m_stream = m.getStreamHub().Subscribe(streamKey, [this]() { return this->CreateFrameSource(); }, StreamSettings);
 	}
-	else if (!hasCamera)
+
+	if (!m_stream.IsValid())
 	{
-		UE_LOG(LOG_UNREAL_DR, Warning, TEXT("[UnrealDR] The HMD does not provide camera access."));
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to create camera frame source."));
 		return;
 	}
 
-	// Allocate for camera frame buffer requirements
-	uint32_t frameBufferSize = 0;
+	// Use the eye images of the shared stream.
+	m_stream->GetFrameSize(m_frameWidth, m_frameHeight);
+	LeftEyeImage = m_stream->GetEyeImage(vr::Eye_Left);
+	RightEyeImage = m_stream->GetEyeImage(vr::Eye_Right);
+	StereoImage = m_stream->GetStereoImage();
+	LeftEyeBackground = m_stream->GetBackgroundImage(vr::Eye_Left);
+	RightEyeBackground = m_stream->GetBackgroundImage(vr::Eye_Right);
+	LeftEyeInpainted = m_stream->GetInpaintedImage(vr::Eye_Left);
+	RightEyeInpainted = m_stream->GetInpaintedImage(vr::Eye_Right);
+	DepthImage = m_stream->GetDepthImage();
+	FlowImage = m_stream->GetFlowImage();
+	ChromaKeyImage = m_stream->GetChromaKeyImage();
+	PeripheryImage = m_stream->GetPeripheryImage();
+	const FCameraFrameSourcePtr& frameSource = m_stream->GetSource();
+
+	// Create a material instance. The textures of the stream never change, so they are only bound once.
+	CameraImageMaterialInstance = UMaterialInstanceDynamic::Create(CameraImageMaterial, this, "Camera Image Material Instance");
+	this->BindMaterialParameters();
+
+	// Set up the view planes from the cached calibration and revalidate it against the live device in the background, since querying it takes several round trips
+	// to the runtime. Without a cached calibration, the live one is queried right away.
+	FCameraCalibration calibration;
 
-	if (m_camera->GetCameraFrameSize(vr::k_unTrackedDeviceIndex_Hmd, vr::VRTrackedCameraFrameType_Undistorted, &m_frameWidth, &m_frameHeight, &frameBufferSize) != vr::VRTrackedCameraError_None)
+	if (this->LoadCachedCalibration(calibration))
+	{
+		this->RevalidateCalibration(frameSource, calibration);
+	}
+	else if (FCameraCalibrationCache::Query(*frameSource, m_system, m_trackedDevice, this->GetCalibrationVariant(), calibration))
 	{
-		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to request front camera frame buffer bounds."));
+		if (this->UsesCalibrationCache())
+			FCameraCalibrationCache::Save(FCameraCalibrationCache::GetKey(calibration), calibration);
 	}
 	else
 	{
-		// Allocate new frame buffer, if size changes.
-		if (frameBufferSize != m_frameBufferSize)
-		{
-			if (m_frameBuffer)
-				std::free(m_frameBuffer);
-
-			if (m_frameBufferRegions.Contains(vr::Eye_Left))
-				FMemory::Free(m_frameBufferRegions[vr::Eye_Left]);
-			else
-				m_frameBufferRegions.Add(vr::Eye_Left);
-
-			if (m_frameBufferRegions.Contains(vr::Eye_Right))
-				FMemory::Free(m_frameBufferRegions[vr::Eye_Right]);
-			else
-				m_frameBufferRegions.Add(vr::Eye_Right);
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to request the camera calibration."));
+		return;
+	}
 
-			m_frameBuffer = reinterpret_cast<uint8_t*>(std::calloc(m_frameBufferSize = frameBufferSize, sizeof(uint8_t)));
-			m_frameBufferRegions[vr::Eye_Left] = new FUpdateTextureRegion2D(0, 0, 0, m_frameHeight / 2, m_frameWidth, m_frameHeight / 2);
-			m_frameBufferRegions[vr::Eye_Right] = new FUpdateTextureRegion2D(0, 0, 0, 0, m_frameWidth, m_frameHeight / 2);
+	this->SetupViewPlanes(calibration);
+}
 
-			// Create left and right eye texture instances.
-			LeftEyeImage = UTexture2D::CreateTransient(m_frameWidth, m_frameHeight / 2, EPixelFormat::PF_R8G8B8A8, "Left Eye Image");
-			LeftEyeImage->AddToRoot();
-			LeftEyeImage->UpdateResource();
+void UCameraSeeThroughComponent::SetupViewPlanes(const FCameraCalibration& calibration)
+{
+	// Request World-To-Meters scale.
+	m_worldToMeters = this->GetWorld()->GetWorldSettings()->WorldToMeters;
 
-			RightEyeImage = UTexture2D::CreateTransient(m_frameWidth, m_frameHeight / 2, EPixelFormat::PF_R8G8B8A8, "Right Eye Image");
-			RightEyeImage->AddToRoot();
-			RightEyeImage->UpdateResource();
-		}
+	// Until the stream has been set up, the eye images have the calibrated frame size.
+	if (!m_stream.IsValid())
+	{
+		m_frameWidth = calibration.FrameWidth;
+		m_frameHeight = calibration.FrameHeight;
 	}
 
-	// Create a material instance.
-	CameraImageMaterialInstance = UMaterialInstanceDynamic::Create(CameraImageMaterial, this, "Camera Image Material Instance");
+	m_hasCameraProjection = calibration.HasExtrinsics != 0;
 
-	// Request camera extrinsics.
-	vr::ETrackedPropertyError extrinsicsError;
-	std::array<vr::HmdMatrix34_t, 2> transformBuffer{ vr::HmdMatrix34_t{}, vr::HmdMatrix34_t{} };
+	if (!m_hasCameraProjection)
+		return;
 
-	if (m_system->GetArrayTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_CameraToHeadTransforms_Matrix34_Array, vr::k_unHmdMatrix34PropertyTag, transformBuffer.data(), transformBuffer.size() * sizeof(vr::HmdMatrix34_t), &extrinsicsError) == 0 || extrinsicsError != vr::ETrackedPropertyError::TrackedProp_Success)
+	// Create view for each eye.
+	for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
 	{
-		UE_LOG(LOG_UNREAL_DR, Warning, TEXT("[UnrealDR] Unable to request camera extrinsic calibration matrices: %d."), extrinsicsError);
-	}
-	else
-	{
-		// Create view for each eye.
-		for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+		auto eye = static_cast<vr::EVREye>(e);
+		const FVector2D center(calibration.Center[e].v[0], calibration.Center[e].v[1]);
+		const FVector2D focalLength(calibration.FocalLength[e].v[0], calibration.FocalLength[e].v[1]);
+
+		// Remember the calibration of the camera, which the world-space region of interest is projected with.
+		FVector translation;
+		FRotator rotation;
+		this->GetCameraPoseFromExtrinsicTransform(calibration.CameraToHead[e], translation, rotation);
+		m_cameraTransforms[e] = FTransform(rotation, translation);
+		m_focalLengths[e] = focalLength;
+		m_principalPoints[e] = center;
+
+		// Create view planes. Planes that have been created before the stream has been set up only need the material instance.
+		if (UStaticMeshComponent** existing = m_viewPlanes.Find(eye))
+		{
+			(*existing)->SetMaterial(0, CameraImageMaterialInstance);
+		}
+		else
 		{
-			auto eye = reinterpret_cast<vr::EVREye&>(e);
+			auto plane = this->CreateViewPlaneMesh(eye == vr::Eye_Left ? TEXT("Left Eye View Plane") : TEXT("Right Eye View Plane"), this->GetEyeAnchor(eye), center, focalLength);
 
-			// Create view planes.
-			if (!m_viewPlanes.Contains(eye))
+			if (plane == nullptr)
 			{
-				// Request camera intristics.
-				vr::HmdVector2_t focalLength, center;
-
-				auto intrinsicsError = m_camera->GetCameraIntrinsics(vr::k_unTrackedDeviceIndex_Hmd, eye, vr::VRTrackedCameraFrameType_Undistorted, &focalLength, &center);
-
-				if (intrinsicsError != vr::EVRTrackedCameraError::VRTrackedCameraError_None)
-				{
-					UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to get intristics for camera %d: %d."), e, intrinsicsError);
-				}
-				else
-				{
-					auto plane = this->CreateViewPlaneMesh(eye == vr::Eye_Left ? TEXT("Left Eye View Plane") : TEXT("Right Eye View Plane"), this->GetEyeAnchor(eye), FVector2D(center.v[0], center.v[1]), FVector2D(focalLength.v[0], focalLength.v[1]));
-
-					if (plane == nullptr)
-					{
-						UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to create view plane mesh for eye %d."), e);
-					}
-					else
-					{
-						// Assign the material to the viewplane.
-						plane->SetMaterial(0, CameraImageMaterialInstance);
-
-						// Store the view plane.
-						m_viewPlanes.Add(eye) = plane;
-					}
-				}
+				UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to create view plane mesh for eye %d."), e);
 			}
-
-#if WITH_EDITORONLY_DATA
-			// Register draw frustum for editor preview.
-			if (!this->EditorDrawFrustums.Contains(eye))
+			else
 			{
-				// Create a new view frustum.
-				auto frustum = NewObject<UDrawFrustumComponent>(this, NAME_None, RF_Transactional);
-				frustum->SetupAttachment(this);
-				frustum->SetIsVisualizationComponent(true);
-				frustum->CreationMethod = this->CreationMethod;
-				frustum->RegisterComponentWithWorld(this->GetWorld());
-
-				// Request the extrinsic pose.
-				FVector translation;
-				FRotator rotation;
-				this->GetCameraPoseFromExtrinsicTransform(transformBuffer[e], translation, rotation);
-
-				// Initialize the frustum.
-				frustum->AddLocalOffset(translation);
-				frustum->AddLocalRotation(rotation);
-				frustum->FrustumStartDist = 1.f;
-				frustum->FrustumEndDist = this->GetEyeAnchor(eye).X;	// X coordinate represents "forward".
-
-				// Get the raw projection angles.
-				// Note: Unreal does somehow make it very hard to access near/far clip values. That's why they are not representative in this case.
-				float left, right, top, bottom;
-				m_system->GetProjectionRaw(eye, &left, &right, &top, &bottom);
-				left = FMath::Abs(FMath::RadiansToDegrees(FMath::Atan(left)));
-				right = FMath::Abs(FMath::RadiansToDegrees(FMath::Atan(right)));
-				top = FMath::Abs(FMath::RadiansToDegrees(FMath::Atan(top)));
-				bottom = FMath::Abs(FMath::RadiansToDegrees(FMath::Atan(bottom)));
-
-				frustum->FrustumColor = eye == vr::Eye_Left ? FColor::Blue : FColor::Green;
-				frustum->FrustumAngle = left + right;
-				frustum->FrustumAspectRatio = frustum->FrustumAngle / (top + bottom);
-
-				frustum->MarkRenderStateDirty();
-				this->EditorDrawFrustums.Add(eye) = frustum;
+				// Assign the material to the viewplane.
+				plane->SetMaterial(0, CameraImageMaterialInstance);
+
+				// Store the view plane and its transform, which is used as a base for reprojection.
+				m_viewPlanes.Add(eye) = plane;
+				m_viewPlaneTransforms.Add(eye) = plane->GetRelativeTransform();
 			}
-#endif
 		}
+
+#if WITH_EDITORONLY_DATA
+		// Register draw frustum for editor preview.
+		if (!this->EditorDrawFrustums.Contains(eye))
+		{
+			// Create a new view frustum.
+			auto frustum = NewObject<UDrawFrustumComponent>(this, NAME_None, RF_Transactional);
+			frustum->SetupAttachment(this);
+			frustum->SetIsVisualizationComponent(true);
+			frustum->CreationMethod = this->CreationMethod;
+			frustum->RegisterComponentWithWorld(this->GetWorld());
+
+			// Initialize the frustum.
+			frustum->AddLocalOffset(translation);
+			frustum->AddLocalRotation(rotation);
+			frustum->FrustumStartDist = 1.f;
+			frustum->FrustumEndDist = this->GetEyeAnchor(eye).X;	// X coordinate represents "forward".
+
+			// Get the raw projection angles. Without an HMD, the calibration contains the camera projection instead.
+			// Note: Unreal does somehow make it very hard to access near/far clip values. That's why they are not representative in this case.
+			float left = calibration.Projection[e][0], right = calibration.Projection[e][1], top = calibration.Projection[e][2], bottom = calibration.Projection[e][3];
+			left = FMath::Abs(FMath::RadiansToDegrees(FMath::Atan(left)));
+			right = FMath::Abs(FMath::RadiansToDegrees(FMath::Atan(right)));
+			top = FMath::Abs(FMath::RadiansToDegrees(FMath::Atan(top)));
+			bottom = FMath::Abs(FMath::RadiansToDegrees(FMath::Atan(bottom)));
+
+			frustum->FrustumColor = eye == vr::Eye_Left ? FColor::Blue : FColor::Green;
+			frustum->FrustumAngle = left + right;
+			frustum->FrustumAspectRatio = frustum->FrustumAngle / (top + bottom);
+
+			frustum->MarkRenderStateDirty();
+			this->EditorDrawFrustums.Add(eye) = frustum;
+		}
+#endif
 	}
+}
 
-	// Request World-To-Meters scale.
-	m_worldToMeters = this->GetWorld()->GetWorldSettings()->WorldToMeters;
+bool UCameraSeeThroughComponent::UsesCalibrationCache() const
+{
+	return bCacheCalibration && FrameSource == ECameraFrameSourceType::OpenVR;
+}
 
-	Super::OnRegister();
+FString UCameraSeeThroughComponent::GetCalibrationVariant() const
+{
+	// The calibration of frames that are undistorted on the CPU depends on the undistortion settings.
+	if (bUndistortOnCpu)
+		return FString::Printf(TEXT("Undistorted_%dx%d_%.3f"), UndistortedFrameSize.X, UndistortedFrameSize.Y, UndistortedFieldOfView);
+	else
+		return TEXT("Runtime");
 }
 
-void UCameraSeeThroughComponent::OnUnregister()
+bool UCameraSeeThroughComponent::LoadCachedCalibration(FCameraCalibration& calibration) const
 {
-	m_system = nullptr;
+	if (!this->UsesCalibrationCache())
+		return false;
+
+	// Before the runtime is up, the serial number of the device is not known, in which case the calibration the device index has been streamed with last is used.
+	const FString serial = m_system != nullptr ? FOpenVRCameraFrameSource::GetStringProperty(m_system, m_trackedDevice, vr::Prop_SerialNumber_String) : TrackedDeviceSerial;
+
+	return FCameraCalibrationCache::FindLatest(serial, m_trackedDevice, this->GetCalibrationVariant(), calibration);
+}
+
+void UCameraSeeThroughComponent::RevalidateCalibration(const FCameraFrameSourcePtr& source, const FCameraCalibration& cached)
+{
+	TWeakObjectPtr<UCameraSeeThroughComponent> self(this);
+	vr::IVRSystem* system = m_system;
+	const vr::TrackedDeviceIndex_t device = m_trackedDevice;
+	const FString variant = this->GetCalibrationVariant();
+
+	// The queries only read device properties, which the runtime allows from any thread. The source is kept alive by the task.
+	Async(EAsyncExecution::ThreadPool, [self, source, system, device, variant, cached]() {
+		FCameraCalibration live;
+
+		if (!FCameraCalibrationCache::Query(*source, system, device, variant, live) || live.IsEquivalent(cached))
+			return;
+
+		FCameraCalibrationCache::Save(FCameraCalibrationCache::GetKey(live), live);
+
+		AsyncTask(ENamedThreads::GameThread, [self, live]() {
+			if (self.IsValid() && self->IsRegistered())
+				self->OnCalibrationChanged(live);
+		});
+	});
+}
 
+void UCameraSeeThroughComponent::OnCalibrationChanged(const FCameraCalibration& calibration)
+{
+	UE_LOG(LOG_UNREAL_DR, Log, TEXT("[UnrealDR] The camera calibration has changed since it has been cached. Rebuilding the view planes."));
+
+	this->DestroyViewPlanes();
+	this->SetupViewPlanes(calibration);
+}
+
+void UCameraSeeThroughComponent::DestroyViewPlanes()
+{
 #if WITH_EDITORONLY_DATA
 	if (this->EditorDrawFrustums.Contains(vr::Eye_Left))
 		this->EditorDrawFrustums[vr::Eye_Left]->DestroyComponent();
@@ -212,25 +307,81 @@ void UCameraSeeThroughComponent::OnUnregister()
 		this->m_viewPlanes[vr::Eye_Right]->DestroyComponent();
 
 	this->m_viewPlanes.Empty();
+	this->m_viewPlaneTransforms.Empty();
+}
+
+void UCameraSeeThroughComponent::OnUnregister()
+{
+	// Do not finish the setup of this registration, once the VR system is ready. The module could already have been unloaded, e.g. when the editor shuts down.
+	auto module = FModuleManager::GetModulePtr<FUnrealDRModule>("UnrealDR");
+
+	if (module != nullptr)
+		module->cancelVirtualRealitySystemCallback(m_systemReadyHandle);
+
+	m_systemReadyHandle.Reset();
+
+	m_system = nullptr;
+	this->DestroyViewPlanes();
+
+	// Release the stream, so that the next registration subscribes with the current stream settings, e.g. after they have been edited.
+	this->EndStreaming();
+	m_latestFrameView.Reset();
+	m_stream.Reset();
 
 	Super::OnUnregister();
 }
 
 void UCameraSeeThroughComponent::BeginPlay()
 {
-	// Receive a tracked camera handle.
-	m_trackedCamera = m_camera == nullptr ? INVALID_TRACKED_CAMERA_HANDLE : this->StartStreaming(m_camera);
+	// Mark component BeginPlay as routed.
+	Super::BeginPlay();
+
+	// If the VR system is still initializing, streaming starts once the camera has been set up.
+	if (m_stream.IsValid())
+		this->BeginStreaming();
+}
+
+void UCameraSeeThroughComponent::BeginStreaming()
+{
+	// Start recording. Frames that wait to be written keep their buffer, so the pool needs to be large enough to hold them in addition.
+	int32 reservedFrames = 0;
 
-	// Create resources.
-	if (m_trackedCamera == INVALID_TRACKED_CAMERA_HANDLE)
+	if (bRecordCameraStream && m_stream.IsValid())
 	{
-		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to start camera streaming."));
+		// The time stamp only has a resolution of one second, so the owner names the file and a unique suffix keeps components from overwriting each other.
+		const FString directory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("UnrealDR"), TEXT("Recordings"));
+		const FString prefix = FString::Printf(TEXT("CameraStream_%s_%s_"), *GetNameSafe(this->GetOwner()), *FDateTime::Now().ToString());
+		const FString fileName = FPaths::CreateTempFilename(*directory, *prefix, TEXT(".udrcap"));
+		m_recorder = MakeUnique<FCameraStreamRecorder>(fileName, RecorderQueueSize);
+
+		if (!m_recorder->Start(*m_stream->GetSource()))
+			m_recorder.Reset();
+		else
+			reservedFrames += m_recorder->GetMaxQueuedFrames();
 	}
-	else
+
+	// Frame views keep their buffer as well.
+	reservedFrames += FMath::Max(FrameViewReservedFrames, 0);
+
+	// Start the shared camera stream.
+	if (!this->StartStreaming(reservedFrames))
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to start camera streaming."));
+}
+
+void UCameraSeeThroughComponent::EndStreaming()
+{
+	// Stop the stream, if this has been the last component displaying it.
+	this->StopStreaming();
+
+	// Write the remaining frames and the frame index.
+	if (m_recorder.IsValid())
 	{
-		// Mark component BeginPlay as routed.
-		Super::BeginPlay();
+		m_recorder->Finish();
+		m_recorder.Reset();
 	}
+
+	// No more frames are received, until streaming begins again.
+	m_onStreamingEnded.Broadcast();
 }
 
 void UCameraSeeThroughComponent::EndPlay(const EEndPlayReason::Type reason)
@@ -241,47 +392,543 @@ void UCameraSeeThroughComponent::EndPlay(const EEndPlayReason::Type reason)
 	if (m_viewPlanes.Contains(vr::Eye_Right))
 		m_viewPlanes[vr::Eye_Right]->DestroyComponent();
 
-	if (m_camera)
-		this->StopStreaming(m_camera, m_trackedCamera);
+	this->EndStreaming();
 
-	m_camera = nullptr;
+	// Release the stream, so that its frame source is released, if no other component displays it.
+	m_latestFrameView.Reset();
+	m_stream.Reset();
 
 	// Mark component EndPlay as routed.
 	Super::EndPlay(reason);
 }
 
-vr::TrackedCameraHandle_t UCameraSeeThroughComponent::StartStreaming(vr::IVRTrackedCamera * camera)
+FCameraFrameSourcePtr UCameraSeeThroughComponent::CreateFrameSource()
+{
+	switch (FrameSource)
+	{
+	case ECameraFrameSourceType::Replay:
+		return FReplayCameraFrameSource::Create(FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), ReplayFile.FilePath), ReplayPlaybackRate, bLoopReplay);
+	case ECameraFrameSourceType::Synthetic:
+		return MakeShared<FSyntheticCameraFrameSource, ESPMode::ThreadSafe>(static_cast<uint32_t>(FMath::Max(SyntheticFrameSize.X, 1)), static_cast<uint32_t>(FMath::Max(SyntheticFrameSize.Y, 1)), SyntheticFrameRate);
+	case ECameraFrameSourceType::OpenVR:
+	default:
+		if (bUndistortOnCpu)
+			return FUndistortedCameraFrameSource::Create(FOpenVRCameraFrameSource::Create(m_system, m_trackedDevice, vr::VRTrackedCameraFrameType_Distorted), static_cast<uint32_t>(FMath::Max(UndistortedFrameSize.X, 2)), static_cast<uint32_t>(FMath::Max(UndistortedFrameSize.Y, 2)), UndistortedFieldOfView);
+		else
+			return FOpenVRCameraFrameSource::Create(m_system, m_trackedDevice);
+	}
+}
+
+bool UCameraSeeThroughComponent::RequiresVirtualRealitySystem() const
+{
+	return FrameSource == ECameraFrameSourceType::OpenVR;
+}
+
+void UCameraSeeThroughComponent::ResolveTrackedDevice()
+{
+	m_trackedDevice = static_cast<vr::TrackedDeviceIndex_t>(FMath::Clamp(TrackedDeviceIndex, 0, static_cast<int32>(vr::k_unMaxTrackedDeviceCount) - 1));
+
+	if (FrameSource != ECameraFrameSourceType::OpenVR || TrackedDeviceSerial.IsEmpty())
+		return;
+
+	// Before the VR system is ready, the serial number cannot be looked up. The device index is used in the meantime, e.g. to find the cached calibration, and the
+	// device is resolved again, once the system is ready and the camera is set up.
+	if (m_system == nullptr)
+		return;
+
+	// Device indices are assigned in the order the devices connect, so the serial number is the more stable way to select a device.
+	const vr::TrackedDeviceIndex_t device = FOpenVRCameraFrameSource::FindDevice(m_system, TrackedDeviceSerial);
+
+	if (device != vr::k_unTrackedDeviceIndexInvalid)
+		m_trackedDevice = device;
+	else
+		UE_LOG(LOG_UNREAL_DR, Warning, TEXT("[UnrealDR] No tracked device with serial number \"%s\" is connected. Falling back to device %u."), *TrackedDeviceSerial, m_trackedDevice);
+}
+
+FString UCameraSeeThroughComponent::GetStreamKey() const
+{
+	// Components share a stream, if they would create identical frame sources.
+	switch (FrameSource)
+	{
+	case ECameraFrameSourceType::Replay:
+		return FString::Printf(TEXT("Replay:%s:%.3f:%d"), *FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), ReplayFile.FilePath), ReplayPlaybackRate, bLoopReplay ? 1 : 0);
+	case ECameraFrameSourceType::Synthetic:
+		return FString::Printf(TEXT("Synthetic:%dx%d:%.3f"), SyntheticFrameSize.X, SyntheticFrameSize.Y, SyntheticFrameRate);
+	case ECameraFrameSourceType::OpenVR:
+	default:
+		if (bUndistortOnCpu)
+			return FString::Printf(TEXT("OpenVR:%u:Undistorted:%dx%d:%.3f"), m_trackedDevice, UndistortedFrameSize.X, UndistortedFrameSize.Y, UndistortedFieldOfView);
+		else
+			return FString::Printf(TEXT("OpenVR:%u"), m_trackedDevice);
+	}
+}
+
+bool UCameraSeeThroughComponent::StartStreaming(int32 reservedFrames)
 {
-	if (camera == nullptr)
-		return INVALID_TRACKED_CAMERA_HANDLE;
+	if (!m_stream.IsValid() || m_streaming)
+		return m_streaming;
 
 	// Reset video stream.
 	m_lastFrameIndex = 0;
-	m_timeSinceLastFrameUpdate = 0;
+	m_noFramesWarningIssued = false;
+	m_poseHistory.Reset();
+	m_framePoseValid = false;
+
+	// The stream only counts the components that started it successfully, so only those stop it again.
+	m_streaming = m_stream->Start(reservedFrames);
+	return m_streaming;
+}
+
+void UCameraSeeThroughComponent::StopStreaming()
+{
+	if (!m_streaming)
+		return;
+
+	m_stream->Stop();
+	m_streaming = false;
+}
+
+void UCameraSeeThroughComponent::BindMaterialParameters()
+{
+	if (CameraImageMaterialInstance == nullptr)
+		return;
+
+	if (StereoImage != nullptr)
+	{
+		// The right eye image is stored in the upper half, the left eye image in the lower half of the stereo image.
+		CameraImageMaterialInstance->SetTextureParameterValue(TEXT("StereoImage"), StereoImage);
+		CameraImageMaterialInstance->SetVectorParameterValue(TEXT("StereoImageLayout"), FLinearColor(0.5f, 0.f, 0.5f, 0.f));
+	}
+	else
+	{
+		CameraImageMaterialInstance->SetTextureParameterValue(TEXT("LeftEye"), LeftEyeImage);
+		CameraImageMaterialInstance->SetTextureParameterValue(TEXT("RightEye"), RightEyeImage);
+	}
+
+	if (LeftEyeBackground != nullptr && RightEyeBackground != nullptr)
+	{
+		CameraImageMaterialInstance->SetTextureParameterValue(TEXT("LeftEyeBackground"), LeftEyeBackground);
+		CameraImageMaterialInstance->SetTextureParameterValue(TEXT("RightEyeBackground"), RightEyeBackground);
+	}
+
+	if (LeftEyeInpainted != nullptr && RightEyeInpainted != nullptr)
+	{
+		CameraImageMaterialInstance->SetTextureParameterValue(TEXT("LeftEyeInpainted"), LeftEyeInpainted);
+		CameraImageMaterialInstance->SetTextureParameterValue(TEXT("RightEyeInpainted"), RightEyeInpainted);
+	}
+
+	if (DepthImage != nullptr)
+		CameraImageMaterialInstance->SetTextureParameterValue(TEXT("DepthImage"), DepthImage);
+
+	if (FlowImage != nullptr)
+	{
+		// The flow image has the layout of the stereo image, so it is addressed like the periphery image.
+		CameraImageMaterialInstance->SetTextureParameterValue(TEXT("FlowImage"), FlowImage);
+		CameraImageMaterialInstance->SetVectorParameterValue(TEXT("FlowImageLayout"), FLinearColor(0.5f, 0.f, 0.5f, 0.f));
+		this->UpdateInterpolationPhase();
+	}
+
+	if (ChromaKeyImage != nullptr)
+	{
+		CameraImageMaterialInstance->SetTextureParameterValue(TEXT("ChromaKeyImage"), ChromaKeyImage);
+		CameraImageMaterialInstance->SetVectorParameterValue(TEXT("ChromaKeyImageLayout"), FLinearColor(0.5f, 0.f, 0.5f, 0.f));
+	}
+
+	if (PeripheryImage != nullptr)
+	{
+		CameraImageMaterialInstance->SetTextureParameterValue(TEXT("PeripheryImage"), PeripheryImage);
+		CameraImageMaterialInstance->SetVectorParameterValue(TEXT("PeripheryImageLayout"), FLinearColor(0.5f, 0.f, 0.5f, 0.f));
+
+		// Force the fovea region to be set on the new material instance.
+		m_boundFoveaRect = FLinearColor(-1.f, -1.f, -1.f, -1.f);
+		this->BindFoveaRect();
+	}
+}
+
+void UCameraSeeThroughComponent::BindFoveaRect()
+{
+	if (CameraImageMaterialInstance == nullptr || PeripheryImage == nullptr || m_frameWidth == 0 || m_frameHeight == 0)
+		return;
+
+	// Only touch the material, when the fovea has moved.
+	const FIntRect& rect = m_stream->GetFoveaRect();
+	const float width = static_cast<float>(m_frameWidth);
+	const float height = static_cast<float>(m_frameHeight / 2);
+	const FLinearColor foveaRect(rect.Min.X / width, rect.Min.Y / height, rect.Max.X / width, rect.Max.Y / height);
+
+	if (foveaRect == m_boundFoveaRect)
+		return;
+
+	m_boundFoveaRect = foveaRect;
+	CameraImageMaterialInstance->SetVectorParameterValue(TEXT("FoveaRect"), m_boundFoveaRect);
+}
+
+void UCameraSeeThroughComponent::UpdateColorStatistics()
+{
+	const FCameraColorStatistics* statistics = m_stream->GetColorStatistics();
+
+	if (statistics == nullptr)
+		return;
+
+	ColorStatistics = statistics->GetSmoothed();
+	FrameColorStatistics = statistics->GetLatest();
+
+	if (CameraImageMaterialInstance == nullptr)
+		return;
+
+	CameraImageMaterialInstance->SetVectorParameterValue(TEXT("CameraAverageColor"), ColorStatistics.AverageColor);
+	CameraImageMaterialInstance->SetVectorParameterValue(TEXT("CameraWhiteBalance"), ColorStatistics.WhiteBalance);
+	CameraImageMaterialInstance->SetVectorParameterValue(TEXT("CameraLuminance"), FLinearColor(ColorStatistics.LowLuminance, ColorStatistics.MedianLuminance, ColorStatistics.HighLuminance, ColorStatistics.AverageLuminance));
+	CameraImageMaterialInstance->SetScalarParameterValue(TEXT("CameraExposureBias"), ColorStatistics.ExposureBias);
+}
+
+void UCameraSeeThroughComponent::UpdateChromaKey()
+{
+	const FCameraChromaKeyResult& result = m_stream->GetChromaKeyResult();
+
+	if (!result.Mask.IsValid() || result.Mask->Header.nFrameSequence == m_chromaKeyFrameIndex)
+		return;
+
+	ChromaKeyBlobs = result.Blobs;
+	m_chromaKeyFrameIndex = result.Mask->Header.nFrameSequence;
+}
+
+void UCameraSeeThroughComponent::UpdateInterpolationPhase()
+{
+	if (FlowImage == nullptr || !m_stream.IsValid())
+		return;
+
+	// The phase refers to the time the current engine frame is displayed, so that the images are warped to when they are seen, not to when they are rendered.
+	InterpolationPhase = m_stream->GetInterpolationPhase(FPlatformTime::Seconds() + this->GetSecondsToPhotons());
+
+	if (CameraImageMaterialInstance != nullptr)
+		CameraImageMaterialInstance->SetScalarParameterValue(TEXT("FlowPhase"), InterpolationPhase);
+}
+
+void UCameraSeeThroughComponent::OnFrameUpdated(const FCameraFrameRef& frame)
+{
+	// Hand the frame to the recorder, which writes it on its own thread.
+	if (m_recorder.IsValid())
+		m_recorder->Enqueue(frame);
+
+	// Remember the pose the frame has been captured at.
+	if (this->IsReprojectionEnabled())
+		m_framePoseValid = this->GetFramePose(*frame, m_framePose);
+
+	// Only create a view of the frame, if anyone is interested in it.
+	m_latestFrameView.Reset();
+
+	if (m_onFrameView.IsBound() || OnFrameReceived.IsBound())
+	{
+		const FCameraFrameViewPtr view = this->GetLatestFrameView();
+		m_onFrameView.Broadcast(view);
+		OnFrameReceived.Broadcast(FCameraFrameHandle(view));
+	}
+}
+
+FCameraFrameViewPtr UCameraSeeThroughComponent::GetLatestFrameView()
+{
+	if (!m_stream.IsValid() || !m_stream->GetLatestFrame().IsValid())
+		return nullptr;
+
+	const FCameraFrameRef& frame = m_stream->GetLatestFrame();
+
+	if (!m_latestFrameView.IsValid() || &m_latestFrameView->GetFrame() != frame.GetReference())
+	{
+		// The view shares the frame buffer with the stream, so creating it does not copy any pixels.
+		FTransform pose;
+		const bool poseValid = this->GetFramePose(*frame, pose);
+		m_latestFrameView = MakeShared<const FCameraFrameView, ESPMode::ThreadSafe>(frame, m_frameWidth, m_frameHeight, pose, poseValid);
+	}
+
+	return m_latestFrameView;
+}
+
+FCameraFrameHandle UCameraSeeThroughComponent::GetLatestFrame()
+{
+	return FCameraFrameHandle(this->GetLatestFrameView());
+}
+
+TArray<FCameraDeviceInfo> UCameraSeeThroughComponent::GetCameraDevices() const
+{
+	TArray<FCameraDeviceInfo> devices;
+	FOpenVRCameraFrameSource::EnumerateDevices(m_system, devices);
+
+	return devices;
+}
+
+FCameraStreamStatistics UCameraSeeThroughComponent::GetStreamStatistics() const
+{
+	return m_stream.IsValid() ? CollectStreamStatistics(*m_stream) : FCameraStreamStatistics();
+}
+
+TArray<FCameraStreamStatistics> UCameraSeeThroughComponent::GetAllStreamStatistics()
+{
+	auto& m = FModuleManager::GetModuleChecked<FUnrealDRModule>("UnrealDR");
+	TArray<FCameraStreamPtr> streams;
+	m.getStreamHub().GetStreams(streams);
+
+	TArray<FCameraStreamStatistics> statistics;
+
+	for (const FCameraStreamPtr& stream : streams)
+	{
+		if (stream->IsStreaming())
+			statistics.Add(CollectStreamStatistics(*stream));
+	}
+
+	return statistics;
+}
+
+FCameraStreamStatistics UCameraSeeThroughComponent::CollectStreamStatistics(const FCameraStream& stream)
+{
+	// The global stats only show the stream that has published last, so the counters are read from each stream directly.
+	FCameraStreamStatistics statistics;
+	statistics.StreamKey = stream.GetKey();
+	statistics.FrameRate = stream.GetFrameRate();
+	statistics.DroppedFrames = stream.GetDroppedFrames();
+	statistics.SkippedFrames = stream.GetSkippedFrames();
+
+	if (const FCameraLatencyStatsPtr& latencyStats = stream.GetLatencyStats())
+	{
+		const FCameraLatencySummary total = latencyStats->GetSummary(ECameraLatencyStage::Total);
+		statistics.CopyLatency = latencyStats->GetSummary(ECameraLatencyStage::Copy).P50;
+		statistics.TotalLatency = total.P50;
+		statistics.TotalLatencyP95 = total.P95;
+		statistics.bExposureLatencyAvailable = latencyStats->IsStageAvailable(ECameraLatencyStage::Exposure);
+	}
+
+	return statistics;
+}
+
+void UCameraSeeThroughComponent::SetInpaintingRegions(const TArray<FIntRect>& leftEyeRegions, const TArray<FIntRect>& rightEyeRegions)
+{
+	if (m_frameWidth == 0 || m_frameHeight == 0)
+		return;
+
+	// Rasterize the regions into a mask. The right eye image is stored in the upper half, the left eye image in the lower half of the frame.
+	const int32 width = static_cast<int32>(m_frameWidth);
+	const int32 eyeHeight = static_cast<int32>(m_frameHeight / 2);
+	TArray<uint8> mask;
+	mask.SetNumZeroed(width * eyeHeight * 2);
+
+	for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+	{
+		const int32 firstRow = e == vr::Eye_Left ? eyeHeight : 0;
+
+		for (const FIntRect& region : e == vr::Eye_Left ? leftEyeRegions : rightEyeRegions)
+		{
+			const FIntRect clipped(FMath::Max(region.Min.X, 0), FMath::Max(region.Min.Y, 0), FMath::Min(region.Max.X, width), FMath::Min(region.Max.Y, eyeHeight));
+
+			for (int32 y = clipped.Min.Y; y < clipped.Max.Y; ++y)
+			{
+				if (clipped.Max.X > clipped.Min.X)
+					FMemory::Memset(mask.GetData() + (firstRow + y) * width + clipped.Min.X, 0xFF, clipped.Max.X - clipped.Min.X);
+			}
+		}
+	}
 
-	// Get a tracked camera handle.
-	vr::TrackedCameraHandle_t cameraHandle{ INVALID_TRACKED_CAMERA_HANDLE };
-	camera->AcquireVideoStreamingService(vr::k_unTrackedDeviceIndex_Hmd, &cameraHandle);
+	this->SetInpaintingMask(MoveTemp(mask));
+}
+
+void UCameraSeeThroughComponent::SetInpaintingMask(TArray<uint8>&& mask)
+{
+	if (!m_stream.IsValid())
+		return;
+
+	m_stream->SetInpaintingMask(MoveTemp(mask));
+}
 
-	return cameraHandle;
+void UCameraSeeThroughComponent::SetFoveaCenter(FVector2D center)
+{
+	if (!m_stream.IsValid())
+		return;
+
+	m_stream->SetFoveaCenter(center);
 }
 
-void UCameraSeeThroughComponent::StopStreaming(vr::IVRTrackedCamera * camera, vr::TrackedCameraHandle_t & trackedCamera) const
+void UCameraSeeThroughComponent::SetRegionOfInterestMask(UTexture2D* mask)
 {
-	camera->ReleaseVideoStreamingService(trackedCamera);
-	trackedCamera = INVALID_TRACKED_CAMERA_HANDLE;
+	if (mask == nullptr || mask->PlatformData == nullptr || mask->PlatformData->Mips.Num() == 0)
+	{
+		UE_LOG(LOG_UNREAL_DR, Warning, TEXT("[UnrealDR] The region of interest mask does not contain any pixel data."));
+		return;
+	}
+
+	const EPixelFormat format = mask->GetPixelFormat();
+
+	if (format != PF_G8 && format != PF_B8G8R8A8)
+	{
+		UE_LOG(LOG_UNREAL_DR, Warning, TEXT("[UnrealDR] The region of interest mask \"%s\" needs to be an uncompressed G8 or BGRA8 texture."), *mask->GetName());
+		return;
+	}
+
+	FTexture2DMipMap& mip = mask->PlatformData->Mips[0];
+	const uint8* data = static_cast<const uint8*>(mip.BulkData.LockReadOnly());
+
+	if (data == nullptr)
+	{
+		mip.BulkData.Unlock();
+		UE_LOG(LOG_UNREAL_DR, Warning, TEXT("[UnrealDR] The pixel data of the region of interest mask \"%s\" is not available on the CPU."), *mask->GetName());
+		return;
+	}
+
+	// Find the bounds of the non-zero texels. For BGRA textures, the red channel is read.
+	const int32 bytesPerPixel = format == PF_G8 ? 1 : 4;
+	const int32 channel = format == PF_G8 ? 0 : 2;
+	FIntPoint min(mip.SizeX, mip.SizeY), max(0, 0);
+
+	for (int32 y = 0; y < mip.SizeY; ++y)
+	{
+		const uint8* row = data + y * mip.SizeX * bytesPerPixel + channel;
+
+		for (int32 x = 0; x < mip.SizeX; ++x)
+		{
+			if (row[x * bytesPerPixel] != 0)
+			{
+				min = min.ComponentMin(FIntPoint(x, y));
+				max = max.ComponentMax(FIntPoint(x + 1, y + 1));
+			}
+		}
+	}
+
+	mip.BulkData.Unlock();
+
+	// An empty mask leaves an empty region of interest, so that only the full frames are uploaded.
+	const FVector2D size(mip.SizeX, mip.SizeY);
+	m_regionOfInterestImageBounds = max.X > min.X ? FBox2D(FVector2D(min) / size, FVector2D(max) / size) : FBox2D(FVector2D::ZeroVector, FVector2D::ZeroVector);
 }
 
-void UCameraSeeThroughComponent::UpdateImages()
+void UCameraSeeThroughComponent::SetRegionOfInterestPolygon(const TArray<FVector2D>& points)
 {
-	// TODO: This can be improved by directly accessing the frame buffer as a texture, so no roudtrip to CPU memory is required.
-	LeftEyeImage->UpdateTextureRegions(0, 1, m_frameBufferRegions[vr::Eye_Left], static_cast<uint32_t>(m_frameWidth * sizeof(uint8_t) * 4), sizeof(uint8_t) * 4, m_frameBuffer, [this](auto rawData, auto region) { this->CleanupFrameBufferRegion(rawData, region); });
-	RightEyeImage->UpdateTextureRegions(0, 1, m_frameBufferRegions[vr::Eye_Right], static_cast<uint32_t>(m_frameWidth * sizeof(uint8_t) * 4), sizeof(uint8_t) * 4, m_frameBuffer, [this](auto rawData, auto region) { this->CleanupFrameBufferRegion(rawData, region); });
+	m_regionOfInterestImageBounds = points.Num() > 0 ? FBox2D(points) : FBox2D(FVector2D::ZeroVector, FVector2D::ZeroVector);
 }
 
-void UCameraSeeThroughComponent::CleanupFrameBufferRegion(uint8_t * rawData, const FUpdateTextureRegion2D * region) const noexcept
+void UCameraSeeThroughComponent::SetRegionOfInterestBounds(FBox bounds)
 {
-	// No need to clean-up.
+	m_regionOfInterestWorldBounds = bounds;
+}
+
+void UCameraSeeThroughComponent::ClearRegionOfInterest()
+{
+	m_regionOfInterestImageBounds.Init();
+	m_regionOfInterestWorldBounds.Init();
+
+	if (m_stream.IsValid())
+		m_stream->ClearRegionsOfInterest();
+}
+
+FIntRect UCameraSeeThroughComponent::GetRegionOfInterest(ECameraEye eye) const
+{
+	if (!m_stream.IsValid() || !m_stream->IsRestrictedToRegionsOfInterest())
+		return FIntRect();
+
+	return m_stream->GetRegionOfInterest(eye == ECameraEye::Left ? vr::Eye_Left : vr::Eye_Right);
+}
+
+void UCameraSeeThroughComponent::SetChromaKey(FColor keyColor, int32 threshold, int32 softness)
+{
+	StreamSettings.ChromaKeyColor = keyColor;
+	StreamSettings.ChromaKeyThreshold = FMath::Clamp(threshold, 0, 510);
+	StreamSettings.ChromaKeySoftness = FMath::Clamp(softness, 1, 255);
+
+	if (!m_stream.IsValid() || !m_stream->IsChromaKeyEnabled())
+		return;
+
+	FCameraChromaKeySettings settings = m_stream->GetChromaKeySettings();
+	settings.KeyColor = StreamSettings.ChromaKeyColor;
+	settings.Threshold = StreamSettings.ChromaKeyThreshold;
+	settings.Softness = StreamSettings.ChromaKeySoftness;
+	m_stream->SetChromaKeySettings(settings);
+}
+
+float UCameraSeeThroughComponent::GetChromaKeyMaskValue(ECameraEye eye, FIntPoint pixel) const
+{
+	if (!m_stream.IsValid())
+		return 0.f;
+
+	const FCameraFrameRef& mask = m_stream->GetChromaKeyResult().Mask;
+	const int32 eyeHeight = static_cast<int32>(m_frameHeight / 2);
+
+	if (!mask.IsValid() || pixel.X < 0 || pixel.Y < 0 || pixel.X >= static_cast<int32>(m_frameWidth) || pixel.Y >= eyeHeight)
+		return 0.f;
+
+	// The right eye is stored in the upper half, the left eye in the lower half of the mask.
+	const int32 row = (eye == ECameraEye::Left ? eyeHeight : 0) + pixel.Y;
+	return mask->Data[row * m_frameWidth + pixel.X] / 255.f;
+}
+
+void UCameraSeeThroughComponent::UpdateRegionOfInterest()
+{
+	if (!m_regionOfInterestImageBounds.bIsValid && !m_regionOfInterestWorldBounds.IsValid)
+		return;
+
+	// Combine the image-space and the projected world-space bounds and pad them, so that the inpainting finds enough of the surroundings.
+	const FVector2D eyeSize(m_frameWidth, m_frameHeight / 2);
+	FIntRect regions[2];
+
+	for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+	{
+		FIntRect& region = regions[e];
+
+		if (m_regionOfInterestImageBounds.bIsValid)
+		{
+			const FVector2D min = m_regionOfInterestImageBounds.Min * eyeSize;
+			const FVector2D max = m_regionOfInterestImageBounds.Max * eyeSize;
+			region = FIntRect(FMath::FloorToInt(min.X), FMath::FloorToInt(min.Y), FMath::CeilToInt(max.X), FMath::CeilToInt(max.Y));
+		}
+
+		if (m_regionOfInterestWorldBounds.IsValid)
+		{
+			const FIntRect projected = this->ProjectBounds(m_regionOfInterestWorldBounds, static_cast<vr::EVREye>(e));
+
+			if (region.Area() <= 0)
+				region = projected;
+			else if (projected.Area() > 0)
+				region.Union(projected);
+		}
+
+		if (region.Area() > 0)
+			region.InflateRect(RegionOfInterestPadding);
+	}
+
+	m_stream->SetRegionsOfInterest(regions[vr::Eye_Left], regions[vr::Eye_Right]);
+}
+
+FIntRect UCameraSeeThroughComponent::ProjectBounds(const FBox& bounds, vr::EVREye eye) const
+{
+	const FIntRect eyeRect(0, 0, static_cast<int32>(m_frameWidth), static_cast<int32>(m_frameHeight / 2));
+
+	if (!m_hasCameraProjection)
+		return eyeRect;
+
+	// Project the corners of the box with the pinhole model of the camera, where X points forward, Y to the right and Z up.
+	const FTransform cameraToWorld = m_cameraTransforms[eye] * this->GetComponentTransform();
+	FVector corners[8];
+	bounds.GetVertices(corners);
+
+	FVector2D min(MAX_flt, MAX_flt), max(-MAX_flt, -MAX_flt);
+
+	for (const FVector& corner : corners)
+	{
+		const FVector point = cameraToWorld.InverseTransformPosition(corner);
+
+		// Corners behind the camera cannot be projected, so the box covers the whole image.
+		if (point.X <= KINDA_SMALL_NUMBER)
+			return eyeRect;
+
+		const FVector2D pixel(m_principalPoints[eye].X + m_focalLengths[eye].X * point.Y / point.X, m_principalPoints[eye].Y - m_focalLengths[eye].Y * point.Z / point.X);
+		min = min.ComponentMin(pixel);
+		max = max.ComponentMax(pixel);
+	}
+
+	// Clip in floating point first, so that far away corners do not overflow.
+	min = min.ComponentMax(FVector2D::ZeroVector);
+	max = max.ComponentMin(FVector2D(eyeRect.Max));
+
+	if (max.X <= min.X || max.Y <= min.Y)
+		return FIntRect();
+
+	return FIntRect(FMath::FloorToInt(min.X), FMath::FloorToInt(min.Y), FMath::CeilToInt(max.X), FMath::CeilToInt(max.Y));
 }
 
 UStaticMeshComponent* UCameraSeeThroughComponent::CreateViewPlaneMesh(FName name, const FVector v, const FVector2D center, const FVector2D focalLength) noexcept
@@ -310,59 +957,128 @@ UStaticMeshComponent* UCameraSeeThroughComponent::CreateViewPlaneMesh(FName name
 	return component;
 }
 
+bool UCameraSeeThroughComponent::IsReprojectionEnabled() const noexcept
+{
+	// Poses of other frame sources and of cameras that are not mounted on the HMD are not related to the current HMD pose.
+	return bReprojectToDisplayPose && m_system != nullptr && FrameSource == ECameraFrameSourceType::OpenVR && m_trackedDevice == vr::k_unTrackedDeviceIndex_Hmd;
+}
+
+bool UCameraSeeThroughComponent::GetHmdPose(float secondsFromNow, FTransform& pose) const
+{
+	if (m_system == nullptr)
+		return false;
+
+	vr::TrackedDevicePose_t devicePose{};
+	m_system->GetDeviceToAbsoluteTrackingPose(vr::TrackingUniverseStanding, secondsFromNow, &devicePose, 1);
+
+	if (!devicePose.bPoseIsValid)
+		return false;
+
+	pose = FHmdPoseHistory::ConvertPose(devicePose.mDeviceToAbsoluteTracking, m_worldToMeters);
+	return true;
+}
+
+float UCameraSeeThroughComponent::GetSecondsToPhotons() const
+{
+	if (m_system == nullptr)
+		return 0.f;
+
+	// Predict until the photons of the next frame leave the display, as recommended by the OpenVR documentation of `GetDeviceToAbsoluteTrackingPose`.
+	float secondsSinceLastVsync = 0.f;
+	m_system->GetTimeSinceLastVsync(&secondsSinceLastVsync, nullptr);
+
+	const float displayFrequency = m_system->GetFloatTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_DisplayFrequency_Float);
+	const float frameDuration = displayFrequency > 0.f ? 1.f / displayFrequency : 0.f;
+	const float vsyncToPhotons = m_system->GetFloatTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_SecondsFromVsyncToPhotons_Float);
+
+	return FMath::Max(frameDuration - secondsSinceLastVsync + vsyncToPhotons, 0.f);
+}
+
+bool UCameraSeeThroughComponent::GetFramePose(const FCameraFrame& frame, FTransform& pose) const
+{
+	// The tracked camera reports the HMD pose at exposure time. Fall back to the pose history, if it is not valid.
+	if (frame.Header.standingTrackedDevicePose.bPoseIsValid)
+	{
+		pose = FHmdPoseHistory::ConvertPose(frame.Header.standingTrackedDevicePose.mDeviceToAbsoluteTracking, m_worldToMeters);
+		return true;
+	}
+
+	return m_poseHistory.Sample(frame.ExposureTime, pose);
+}
+
+void UCameraSeeThroughComponent::ReprojectViewPlanes()
+{
+	// Without a capture or display pose, show the planes at their original place.
+	FTransform displayPose, reprojection = FTransform::Identity;
+
+	if (m_framePoseValid && this->GetHmdPose(this->GetSecondsToPhotons(), displayPose))
+		reprojection = FHmdPoseHistory::ComputeReprojection(m_framePose, displayPose);
+
+	for (auto& plane : m_viewPlanes)
+	{
+		const FTransform* transform = m_viewPlaneTransforms.Find(plane.Key);
+
+		if (transform != nullptr)
+			plane.Value->SetRelativeTransform(*transform * reprojection);
+	}
+}
+
 void UCameraSeeThroughComponent::TickComponent(float deltaTime, ELevelTick tickType, FActorComponentTickFunction * f)
 {
 	if (tickType == ELevelTick::LEVELTICK_PauseTick)
 		return;
 
-	// Only handle valid camera modules.
-	if (m_trackedCamera != INVALID_TRACKED_CAMERA_HANDLE)
+	// Only handle started streams. The frames are copied by the capture worker and uploaded by the stream, so the component only needs to pick up the latest one.
+	if (m_streaming && m_stream->IsStreaming())
 	{
-		// Check frame buffer header for updates.
-		vr::CameraVideoStreamFrameHeader_t frameHeader;
-		vr::EVRTrackedCameraError error = m_camera->GetVideoStreamFrameBuffer(m_trackedCamera, vr::VRTrackedCameraFrameType_Undistorted, nullptr, 0, &frameHeader, sizeof(frameHeader));
+		const bool reproject = this->IsReprojectionEnabled();
+
+		// Record the current HMD pose, so that frames without a valid pose can be matched to the pose at their exposure time.
+		FTransform hmdPose;
+
+		if (reproject && this->GetHmdPose(0.f, hmdPose))
+			m_poseHistory.Add(FPlatformTime::Seconds(), hmdPose);
 
-		if (error != vr::VRTrackedCameraError_None)
+		// Follow the region of interest, before the stream uploads the latest frame.
+		if (StreamSettings.bRestrictToRegionOfInterest)
+			this->UpdateRegionOfInterest();
+
+		// Update the shared stream. Only the first component that ticks within a frame uploads the latest frame.
+		m_stream->Update();
+
+		if (m_stream->GetFrameSequence() == m_lastFrameIndex)
 		{
-			UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to access front camera video stream frame buffer: %d."), error);
+			const float timeSinceLastFrame = m_stream->GetTimeSinceLastFrame();
+
+			if (timeSinceLastFrame > NoFramesWarningTimeout && !m_noFramesWarningIssued)
+			{
+				UE_LOG(LOG_UNREAL_DR, Warning, TEXT("[UnrealDR] No frames arriving for %.1f seconds."), timeSinceLastFrame);
+				m_noFramesWarningIssued = true;
+			}
 		}
 		else
 		{
-			if (frameHeader.nFrameSequence == m_lastFrameIndex)
-			{
-				m_timeSinceLastFrameUpdate += deltaTime;
+			m_noFramesWarningIssued = false;
 
-				if (m_timeSinceLastFrameUpdate > 2000.f)
-				{
-					UE_LOG(LOG_UNREAL_DR, Warning, TEXT("[UnrealDR] No frames arriving."));
-				}
-			}
-			else
-			{
-				// Reset time since last update.
-				m_timeSinceLastFrameUpdate = 0.f;
-
-				// Copy frame buffer.
-				error = m_camera->GetVideoStreamFrameBuffer(m_trackedCamera, vr::VRTrackedCameraFrameType_Undistorted, m_frameBuffer, m_frameBufferSize, &frameHeader, sizeof(frameHeader));
-
-				if (error != vr::VRTrackedCameraError_None)
-				{
-					UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to copy front camera video stream frame buffer."), error);
-				}
-				else
-				{
-					// Push the frame buffer into the left/right eye textures.
-					this->UpdateImages();
-
-					// Update material instance.
-					CameraImageMaterialInstance->SetTextureParameterValue(TEXT("LeftEye"), LeftEyeImage);
-					CameraImageMaterialInstance->SetTextureParameterValue(TEXT("RightEye"), RightEyeImage);
-
-					// Store current frame as last frame.
-					m_lastFrameIndex = frameHeader.nFrameSequence;
-				}
-			}
+			// Pick up the new frame and store it as last frame.
+			const FCameraFrameRef& frame = m_stream->GetLatestFrame();
+			this->OnFrameUpdated(frame);
+			m_lastFrameIndex = frame->Header.nFrameSequence;
+
+			// The fovea and the color statistics only change with a new frame.
+			this->BindFoveaRect();
+			this->UpdateColorStatistics();
 		}
+
+		// The chroma key regions change, whenever keying a frame on the thread pool has finished.
+		this->UpdateChromaKey();
+
+		// Advance the interpolation of the displayed frame to the predicted display time of this engine frame.
+		this->UpdateInterpolationPhase();
+
+		// Move the view planes to the predicted display pose. This happens for every tick, since the head keeps moving while the same frame is displayed.
+		if (reproject)
+			this->ReprojectViewPlanes();
 	}
 
 	Super::TickComponent(deltaTime, tickType, f);
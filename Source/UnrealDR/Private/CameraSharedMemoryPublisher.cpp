@@ -0,0 +1,154 @@
+#include "CameraSharedMemoryPublisher.h"
+#include <HAL/PlatformAtomics.h>
+#include <HAL/PlatformMisc.h>
+#include <HAL/PlatformProcess.h>
+#include <HAL/PlatformTime.h>
+#include <Misc/Crc.h>
+
+DECLARE_CYCLE_STAT(TEXT("Shared Memory Publish"), STAT_UnrealDR_SharedMemoryPublish, STATGROUP_UnrealDR);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Published Frames"), STAT_UnrealDR_PublishedFrames, STATGROUP_UnrealDR);
+
+FCameraSharedMemoryPublisher::FCameraSharedMemoryPublisher(const FString& name, int32 slotCount) :
+	m_name(name), m_slotCount(FMath::Max(slotCount, 2))
+{
+}
+
+FCameraSharedMemoryPublisher::~FCameraSharedMemoryPublisher()
+{
+	this->Close();
+}
+
+bool FCameraSharedMemoryPublisher::Open(const ICameraFrameSource& source)
+{
+	if (m_region != nullptr)
+		return true;
+
+	// Gather the layout and calibration, so that readers do not need to know the frame source.
+	FCameraSharedMemoryHeader header;
+
+	if (!source.GetFrameSize(header.FrameWidth, header.FrameHeight, header.FrameBufferSize))
+		return false;
+
+	for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+		source.GetIntrinsics(static_cast<vr::EVREye>(e), header.FocalLength[e], header.Center[e]);
+
+	source.GetExtrinsics(header.CameraToHead);
+
+	// Align the frame data of each slot to pages, so that readers can hand it to APIs that expect aligned buffers.
+	header.HeaderSize = Align(static_cast<uint32>(sizeof(FCameraSharedMemoryHeader)), UnrealDR::SharedMemory::Alignment);
+	header.DataOffset = Align(static_cast<uint32>(sizeof(FCameraSharedMemorySlot)), UnrealDR::SharedMemory::Alignment);
+	header.SlotCount = static_cast<uint32>(m_slotCount);
+	header.SlotStride = Align(static_cast<uint64>(header.DataOffset) + header.FrameBufferSize, static_cast<uint64>(UnrealDR::SharedMemory::Alignment));
+	header.WriterProcessId = FPlatformProcess::GetCurrentProcessId();
+
+	// Creating a region attaches to an existing one with the same name, so writers would corrupt each other's ring. Regions left behind by a writer that is no
+	// longer running (e.g. after a crash on POSIX platforms) are taken over.
+	if (FPlatformMemory::FSharedMemoryRegion* existing = FPlatformMemory::MapNamedSharedMemoryRegion(m_name, false, FPlatformMemory::ESharedMemoryAccess::Read, sizeof(FCameraSharedMemoryHeader)))
+	{
+		const FCameraSharedMemoryHeader* existingHeader = static_cast<const FCameraSharedMemoryHeader*>(existing->GetAddress());
+		const uint32 writer = existingHeader->Magic == UnrealDR::SharedMemory::Magic ? existingHeader->WriterProcessId : 0;
+		FPlatformMemory::UnmapNamedSharedMemoryRegion(existing);
+
+		if (writer != 0 && FPlatformProcess::IsApplicationRunning(writer))
+		{
+			UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Shared memory region \"%s\" is already used by process %u."), *m_name, writer);
+			return false;
+		}
+	}
+
+	// The name is platform-independent. POSIX platforms prefix it with a slash.
+	const SIZE_T size = header.HeaderSize + header.SlotStride * header.SlotCount;
+	m_region = FPlatformMemory::MapNamedSharedMemoryRegion(m_name, true, FPlatformMemory::ESharedMemoryAccess::Read | FPlatformMemory::ESharedMemoryAccess::Write, size);
+
+	if (m_region == nullptr)
+	{
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to create shared memory region \"%s\" with %llu bytes."), *m_name, static_cast<uint64>(size));
+		return false;
+	}
+
+	// Initialize all slots as empty, before the header tells readers about them.
+	uint8* base = static_cast<uint8*>(m_region->GetAddress());
+
+	for (uint32 s = 0; s < header.SlotCount; ++s)
+		new (base + header.HeaderSize + s * header.SlotStride) FCameraSharedMemorySlot();
+
+	m_header = new (base) FCameraSharedMemoryHeader(header);
+	m_publishedFrames.Reset();
+
+	UE_LOG(LOG_UNREAL_DR, Log, TEXT("[UnrealDR] Publishing camera frames to shared memory region \"%s\" (%u slots)."), *m_name, header.SlotCount);
+	return true;
+}
+
+FString FCameraSharedMemoryPublisher::GetRegionName(const FString& baseName, const FString& streamKey)
+{
+	// Shared memory names are limited in length and must not contain slashes on POSIX platforms.
+	constexpr int32 MaxKeyLength = 48;
+	FString key;
+
+	if (streamKey.Len() > MaxKeyLength)
+		key = FString::Printf(TEXT("%08X"), FCrc::StrCrc32(*streamKey));
+	else
+	{
+		key = streamKey;
+
+		for (TCHAR& c : key.GetCharArray())
+		{
+			if (c != TEXT('\0') && !FChar::IsAlnum(c))
+				c = TEXT('_');
+		}
+	}
+
+	return FString::Printf(TEXT("%s_%s"), *baseName, *key);
+}
+
+void FCameraSharedMemoryPublisher::Close()
+{
+	if (m_region == nullptr)
+		return;
+
+	FPlatformMemory::UnmapNamedSharedMemoryRegion(m_region);
+	m_region = nullptr;
+	m_header = nullptr;
+}
+
+bool FCameraSharedMemoryPublisher::Publish(const FCameraFrame& frame)
+{
+	if (m_header == nullptr || frame.Size > m_header->FrameBufferSize)
+		return false;
+
+	SCOPE_CYCLE_COUNTER(STAT_UnrealDR_SharedMemoryPublish);
+
+	const int64 index = m_header->WriteIndex;
+	uint8* slotAddress = reinterpret_cast<uint8*>(m_header) + m_header->HeaderSize + static_cast<uint64>(index % m_header->SlotCount) * m_header->SlotStride;
+	FCameraSharedMemorySlot* slot = reinterpret_cast<FCameraSharedMemorySlot*>(slotAddress);
+
+	// Mark the slot as being written. The exchange is a full barrier, so readers that see the old data afterwards also see the odd sequence.
+	FPlatformAtomics::InterlockedExchange(&slot->Sequence, 2 * index + 1);
+
+	const vr::CameraVideoStreamFrameHeader_t& header = frame.Header;
+	slot->FrameSequence = header.nFrameSequence;
+	slot->FrameType = static_cast<uint32>(header.eFrameType);
+	slot->Width = m_header->FrameWidth;
+	slot->Height = m_header->FrameHeight;
+	slot->BytesPerPixel = 4;
+	slot->Pitch = m_header->FrameWidth * 4;
+	slot->ExposureTime = frame.ExposureTime;
+	slot->CaptureTime = frame.CaptureTime;
+	slot->PublishTime = FPlatformTime::Seconds();
+	slot->DeviceToAbsoluteTracking = header.standingTrackedDevicePose.mDeviceToAbsoluteTracking;
+	slot->Velocity = header.standingTrackedDevicePose.vVelocity;
+	slot->AngularVelocity = header.standingTrackedDevicePose.vAngularVelocity;
+	slot->TrackingResult = static_cast<uint32>(header.standingTrackedDevicePose.eTrackingResult);
+	slot->PoseIsValid = header.standingTrackedDevicePose.bPoseIsValid ? 1 : 0;
+	FMemory::Memcpy(slotAddress + m_header->DataOffset, frame.Data, frame.Size);
+
+	// Publish the slot, before the index points readers to it.
+	FPlatformMisc::MemoryBarrier();
+	FPlatformAtomics::InterlockedExchange(&slot->Sequence, 2 * index + 2);
+	FPlatformAtomics::InterlockedExchange(&m_header->WriteIndex, index + 1);
+
+	m_publishedFrames.Increment();
+	INC_DWORD_STAT(STAT_UnrealDR_PublishedFrames);
+
+	return true;
+}
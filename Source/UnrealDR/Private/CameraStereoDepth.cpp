@@ -0,0 +1,521 @@
+#include "CameraStereoDepth.h"
+#include "UnrealDRSimd.h"
+#include <Async/ParallelFor.h>
+#include <HAL/ThreadSafeCounter.h>
+
+DECLARE_CYCLE_STAT(TEXT("Stereo Depth"), STAT_UnrealDR_StereoDepth, STATGROUP_UnrealDR);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Valid Depth Pixels"), STAT_UnrealDR_ValidDepthPixels, STATGROUP_UnrealDR);
+
+namespace
+{
+	/// <summary>
+	/// The radius of the census window. The 5x5 window compares 24 neighbors with the center.
+	/// </summary>
+	constexpr int32 CensusRadius = 2;
+
+	/// <summary>
+	/// The matching cost of disparities that point outside of the right image, which equals the largest Hamming distance of two census signatures.
+	/// </summary>
+	constexpr uint8 OutsideCost = 24;
+
+	/// <summary>
+	/// The number of entries of a path buffer: the aggregated costs, preceded and followed by a sentinel, padded for unaligned vector reads.
+	/// </summary>
+	constexpr int32 PathBufferSize = FCameraStereoDepth::MaxDisparityRange + 16;
+
+	/// <summary>
+	/// Returns a column of a 3x4 matrix as vector.
+	/// </summary>
+	FORCEINLINE FVector GetColumn(const vr::HmdMatrix34_t& matrix, int32 column) noexcept
+	{
+		return FVector(matrix.m[0][column], matrix.m[1][column], matrix.m[2][column]);
+	}
+
+	/// <summary>
+	/// Starts a path at a pixel, whose aggregated costs equal its matching costs.
+	/// </summary>
+	int16 InitializePath(const uint8* costs, int16* current, int32 disparities) noexcept
+	{
+		int16 minimum = FCameraStereoDepth::InvalidCost;
+		current[0] = current[disparities + 1] = FCameraStereoDepth::InvalidCost;
+
+		for (int32 d = 0; d < disparities; ++d)
+		{
+			current[d + 1] = costs[d];
+			minimum = FMath::Min<int16>(minimum, costs[d]);
+		}
+
+		return minimum;
+	}
+
+	/// <summary>
+	/// Adds the aggregated costs of a path to the sum of all paths, or initializes the sum with them.
+	/// </summary>
+	FORCEINLINE void AccumulatePath(const int16* path, uint16* aggregated, int32 disparities, bool initialize) noexcept
+	{
+		int32 d = 0;
+
+#if UNREALDR_SIMD_SSE2
+		for (; d + 8 <= disparities; d += 8)
+		{
+			const __m128i costs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(path + 1 + d));
+			__m128i* target = reinterpret_cast<__m128i*>(aggregated + d);
+			_mm_storeu_si128(target, initialize ? costs : _mm_add_epi16(_mm_loadu_si128(target), costs));
+		}
+#endif
+
+		for (; d < disparities; ++d)
+			aggregated[d] = static_cast<uint16>(initialize ? path[d + 1] : aggregated[d] + path[d + 1]);
+	}
+
+#if UNREALDR_SIMD_SSE2
+	/// <summary>
+	/// Counts the set bits of each 32 bit lane.
+	/// </summary>
+	FORCEINLINE __m128i CountBits(__m128i value) noexcept
+	{
+		value = _mm_sub_epi32(value, _mm_and_si128(_mm_srli_epi32(value, 1), _mm_set1_epi32(0x55555555)));
+		value = _mm_add_epi32(_mm_and_si128(value, _mm_set1_epi32(0x33333333)), _mm_and_si128(_mm_srli_epi32(value, 2), _mm_set1_epi32(0x33333333)));
+		value = _mm_and_si128(_mm_add_epi32(value, _mm_srli_epi32(value, 4)), _mm_set1_epi32(0x0F0F0F0F));
+		value = _mm_add_epi32(value, _mm_srli_epi32(value, 8));
+		value = _mm_add_epi32(value, _mm_srli_epi32(value, 16));
+
+		return _mm_and_si128(value, _mm_set1_epi32(0x3F));
+	}
+
+	/// <summary>
+	/// Computes the Hamming distances between a left signature and the four right signatures to the left of and including `right`, in the order of increasing disparity.
+	/// </summary>
+	FORCEINLINE __m128i ComputeDistances(__m128i left, const uint32* right) noexcept
+	{
+		const __m128i signatures = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(right - 3)), _MM_SHUFFLE(0, 1, 2, 3));
+		return CountBits(_mm_xor_si128(left, signatures));
+	}
+#endif
+}
+
+FCameraStereoDepth::FCameraStereoDepth(const FCameraStereoDepthSettings& settings, int32 outputFrames) :
+	m_settings(settings)
+{
+	m_settings.Width = FMath::Max<uint32>(m_settings.Width, 2 * CensusRadius + 1);
+	m_settings.Height = FMath::Max<uint32>(m_settings.Height, 2 * CensusRadius + 1);
+	m_settings.SmallPenalty = FMath::Clamp(m_settings.SmallPenalty, 1, 255);
+	m_settings.LargePenalty = FMath::Clamp(m_settings.LargePenalty, m_settings.SmallPenalty, 255);
+	m_disparities = FMath::Clamp(FMath::DivideAndRoundUp(m_settings.DisparityRange, 16) * 16, 16, MaxDisparityRange);
+
+	const int32 pixels = static_cast<int32>(m_settings.Width * m_settings.Height);
+
+	for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+	{
+		m_rectified[e].SetNumUninitialized(pixels * 4);
+		m_luminance[e].SetNumUninitialized(pixels);
+		m_census[e].SetNumUninitialized(pixels);
+	}
+
+	m_costs.SetNumUninitialized(pixels * m_disparities);
+	m_aggregated.SetNumUninitialized(pixels * m_disparities);
+	m_rightDisparities.SetNumUninitialized(pixels);
+	m_outputPool = MakeShared<FCameraFramePool, ESPMode::ThreadSafe>(static_cast<uint32>(pixels * sizeof(float)), FMath::Max(outputFrames, 1));
+}
+
+bool FCameraStereoDepth::Build(const ICameraFrameSource& source)
+{
+	uint32_t frameWidth, frameHeight, frameBufferSize;
+	vr::HmdMatrix34_t cameraToHead[2];
+
+	if (!source.GetFrameSize(frameWidth, frameHeight, frameBufferSize) || !source.GetExtrinsics(cameraToHead))
+	{
+		UE_LOG(LOG_UNREAL_DR, Warning, TEXT("[UnrealDR] Stereo depth requires the frame size and the extrinsic calibration of the cameras."));
+		return false;
+	}
+
+	// The camera axes in head space, converted from the OpenVR convention (y up, looking along -z) to image coordinates (y down, looking along z).
+	FVector axes[2][3], centers[2];
+	FCameraRemapParameters parameters[2];
+	float focalLength = 0.f;
+
+	for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+	{
+		vr::HmdVector2_t focal, center;
+		FCameraRemapParameters& eyeParameters = parameters[e];
+
+		if (!source.GetIntrinsics(static_cast<vr::EVREye>(e), focal, center) || !source.GetDistortion(static_cast<vr::EVREye>(e), eyeParameters.Distortion))
+		{
+			UE_LOG(LOG_UNREAL_DR, Warning, TEXT("[UnrealDR] Stereo depth requires the intrinsic calibration of both cameras."));
+			return false;
+		}
+
+		eyeParameters.SourceWidth = frameWidth;
+		eyeParameters.SourceHeight = frameHeight / 2;
+		eyeParameters.SourceFocalLength = FVector2D(focal.v[0], focal.v[1]);
+		eyeParameters.SourceCenter = FVector2D(center.v[0], center.v[1]);
+
+		axes[e][0] = GetColumn(cameraToHead[e], 0);
+		axes[e][1] = -GetColumn(cameraToHead[e], 1);
+		axes[e][2] = -GetColumn(cameraToHead[e], 2);
+		centers[e] = GetColumn(cameraToHead[e], 3);
+		focalLength += focal.v[0] * 0.5f;
+	}
+
+	// Both rectified cameras share an orientation: the x axis points along the baseline and the z axis is as close as possible to the mean view direction.
+	const FVector baseline = centers[vr::Eye_Right] - centers[vr::Eye_Left];
+
+	if (baseline.Size() < 0.001f)
+	{
+		UE_LOG(LOG_UNREAL_DR, Warning, TEXT("[UnrealDR] Stereo depth requires two cameras with a baseline, but they are %.2f mm apart."), baseline.Size() * 1000.f);
+		return false;
+	}
+
+	const FVector rectifiedX = baseline.GetSafeNormal();
+	const FVector forward = (axes[vr::Eye_Left][2] + axes[vr::Eye_Right][2]).GetSafeNormal();
+	const FVector rectifiedZ = (forward - rectifiedX * FVector::DotProduct(forward, rectifiedX)).GetSafeNormal();
+	const FVector rectifiedY = FVector::CrossProduct(rectifiedZ, rectifiedX);
+	const FVector rectified[3] = { rectifiedX, rectifiedY, rectifiedZ };
+
+	// Scale the focal length with the resolution, so that the rectified images keep the horizontal field of view of the cameras.
+	m_calibration.Width = m_settings.Width;
+	m_calibration.Height = m_settings.Height;
+	m_calibration.FocalLength = focalLength * static_cast<float>(m_settings.Width) / static_cast<float>(frameWidth);
+	m_calibration.Center = FVector2D(m_settings.Width / 2.f, m_settings.Height / 2.f);
+	m_calibration.Baseline = baseline.Size();
+
+	for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+	{
+		FCameraRemapParameters& eyeParameters = parameters[e];
+		eyeParameters.TargetWidth = m_settings.Width;
+		eyeParameters.TargetHeight = m_settings.Height;
+		eyeParameters.TargetFocalLength = FVector2D(m_calibration.FocalLength, m_calibration.FocalLength);
+		eyeParameters.TargetCenter = m_calibration.Center;
+
+		// Each row contains a rectified axis in the coordinates of the camera.
+		for (int32 r = 0; r < 3; ++r)
+			eyeParameters.TargetRotation.SetAxis(r, FVector(FVector::DotProduct(rectified[r], axes[e][0]), FVector::DotProduct(rectified[r], axes[e][1]), FVector::DotProduct(rectified[r], axes[e][2])));
+
+		if (!m_rectification[e].Build(eyeParameters))
+			return false;
+	}
+
+	// Report the pose of the rectified left camera in the convention of the extrinsics.
+	for (int32 r = 0; r < 3; ++r)
+	{
+		m_calibration.RectifiedToHead.m[r][0] = rectifiedX[r];
+		m_calibration.RectifiedToHead.m[r][1] = -rectifiedY[r];
+		m_calibration.RectifiedToHead.m[r][2] = -rectifiedZ[r];
+		m_calibration.RectifiedToHead.m[r][3] = centers[vr::Eye_Left][r];
+	}
+
+	UE_LOG(LOG_UNREAL_DR, Log, TEXT("[UnrealDR] Stereo depth: %dx%d pixels, %d disparities, %.1f mm baseline, depth from %.2f m."), m_settings.Width, m_settings.Height, m_disparities,
+		m_calibration.Baseline * 1000.f, m_calibration.FocalLength * m_calibration.Baseline / (m_disparities - 1));
+
+	return true;
+}
+
+FCameraFrameRef FCameraStereoDepth::Compute(const FCameraFrame& frame)
+{
+	const FCameraRemapParameters& parameters = m_rectification[vr::Eye_Left].GetParameters();
+
+	if (!this->IsValid() || frame.Size != parameters.SourceWidth * parameters.SourceHeight * 8)
+		return FCameraFrameRef();
+
+	FCameraFrameRef output = m_outputPool->Acquire();
+
+	if (!output.IsValid())
+		return output;
+
+	SCOPE_CYCLE_COUNTER(STAT_UnrealDR_StereoDepth);
+
+	// The right eye image is stored in the upper half, the left eye image in the lower half of the frame buffer.
+	const uint32 pitch = parameters.SourceWidth * 4;
+	m_rectification[vr::Eye_Left].Apply(frame.Data + parameters.SourceHeight * pitch, pitch, m_rectified[vr::Eye_Left].GetData(), m_settings.Width * 4);
+	m_rectification[vr::Eye_Right].Apply(frame.Data, pitch, m_rectified[vr::Eye_Right].GetData(), m_settings.Width * 4);
+
+	this->ComputeCensus(vr::Eye_Left);
+	this->ComputeCensus(vr::Eye_Right);
+
+	// Each pass only depends on the result of the previous one. Horizontal paths never cross rows and vertical paths never cross columns.
+	const int32 height = static_cast<int32>(m_settings.Height);
+	const int32 width = static_cast<int32>(m_settings.Width);
+
+	ParallelFor(height, [this](int32 y) { this->ComputeCosts(y); });
+	ParallelFor(height, [this](int32 y) { this->AggregateRow(y); });
+	ParallelFor(FMath::DivideAndRoundUp(width, ColumnBlockSize), [this, width](int32 block) { this->AggregateColumns(block * ColumnBlockSize, FMath::Min((block + 1) * ColumnBlockSize, width)); });
+
+	float* depth = reinterpret_cast<float*>(output->Data);
+	ParallelFor(height, [this, depth, width](int32 y) { this->SelectDisparities(y, depth + y * width); });
+
+	output->Header = frame.Header;
+	output->ExposureTime = frame.ExposureTime;
+	output->bHasExposureTime = frame.bHasExposureTime;
+	output->HeaderPollTime = frame.HeaderPollTime;
+	output->CaptureTime = frame.CaptureTime;
+
+	return output;
+}
+
+int16 FCameraStereoDepth::AggregatePixel(const uint8* costs, const int16* previous, int16 previousMin, int16* current, int32 disparities, int16 smallPenalty, int16 largePenalty) noexcept
+{
+	// L(d) = C(d) + min(L'(d), L'(d - 1) + P1, L'(d + 1) + P1, min L' + P2) - min L'. The sentinels at both ends of the previous costs keep the neighbors of the first
+	// and last disparity from being chosen. All values stay far below the range of signed 16 bit integers.
+	int16 minimum = InvalidCost;
+	int32 d = 0;
+
+	current[0] = current[disparities + 1] = InvalidCost;
+
+#if UNREALDR_SIMD_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i penalty = _mm_set1_epi16(smallPenalty);
+	const __m128i jump = _mm_set1_epi16(static_cast<int16>(previousMin + largePenalty));
+	const __m128i base = _mm_set1_epi16(previousMin);
+	__m128i minimums = _mm_set1_epi16(InvalidCost);
+
+	for (; d + 8 <= disparities; d += 8)
+	{
+		const __m128i same = _mm_loadu_si128(reinterpret_cast<const __m128i*>(previous + 1 + d));
+		const __m128i lower = _mm_add_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(previous + d)), penalty);
+		const __m128i upper = _mm_add_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(previous + 2 + d)), penalty);
+		const __m128i best = _mm_min_epi16(_mm_min_epi16(same, jump), _mm_min_epi16(lower, upper));
+
+		const __m128i matching = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(costs + d)), zero);
+		const __m128i result = _mm_sub_epi16(_mm_add_epi16(matching, best), base);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(current + 1 + d), result);
+		minimums = _mm_min_epi16(minimums, result);
+	}
+
+	minimums = _mm_min_epi16(minimums, _mm_srli_si128(minimums, 8));
+	minimums = _mm_min_epi16(minimums, _mm_srli_si128(minimums, 4));
+	minimums = _mm_min_epi16(minimums, _mm_srli_si128(minimums, 2));
+	minimum = static_cast<int16>(_mm_extract_epi16(minimums, 0));
+#endif
+
+	for (; d < disparities; ++d)
+	{
+		const int16 best = FMath::Min(FMath::Min<int16>(previous[d + 1], previousMin + largePenalty), FMath::Min<int16>(previous[d] + smallPenalty, previous[d + 2] + smallPenalty));
+		const int16 result = static_cast<int16>(costs[d] + best - previousMin);
+
+		current[d + 1] = result;
+		minimum = FMath::Min(minimum, result);
+	}
+
+	return minimum;
+}
+
+void FCameraStereoDepth::ComputeCensus(int32 eye)
+{
+	const int32 width = static_cast<int32>(m_settings.Width);
+	const int32 height = static_cast<int32>(m_settings.Height);
+	const uint8* image = m_rectified[eye].GetData();
+	uint8* luminance = m_luminance[eye].GetData();
+	uint32* census = m_census[eye].GetData();
+
+	// Convert to luminance (BT.601 weights in 8 bit fixed point).
+	ParallelFor(height, [image, luminance, width](int32 y) {
+		const uint8* pixel = image + y * width * 4;
+
+		for (int32 x = 0; x < width; ++x, pixel += 4)
+			luminance[y * width + x] = static_cast<uint8>((pixel[0] * 77 + pixel[1] * 150 + pixel[2] * 29) >> 8);
+	});
+
+	// Compare each pixel with its neighbors. Neighbors outside of the image are clamped to the border.
+	ParallelFor(height, [luminance, census, width, height](int32 y) {
+		for (int32 x = 0; x < width; ++x)
+		{
+			const uint8 center = luminance[y * width + x];
+			uint32 signature = 0;
+
+			for (int32 dy = -CensusRadius; dy <= CensusRadius; ++dy)
+			{
+				const uint8* row = luminance + FMath::Clamp(y + dy, 0, height - 1) * width;
+
+				for (int32 dx = -CensusRadius; dx <= CensusRadius; ++dx)
+				{
+					if (dx != 0 || dy != 0)
+						signature = (signature << 1) | (row[FMath::Clamp(x + dx, 0, width - 1)] < center ? 1u : 0u);
+				}
+			}
+
+			census[y * width + x] = signature;
+		}
+	});
+}
+
+void FCameraStereoDepth::ComputeCosts(int32 y)
+{
+	const int32 width = static_cast<int32>(m_settings.Width);
+	const int32 disparities = m_disparities;
+	const uint32* left = m_census[vr::Eye_Left].GetData() + y * width;
+	const uint32* right = m_census[vr::Eye_Right].GetData() + y * width;
+	uint8* costs = m_costs.GetData() + static_cast<SIZE_T>(y) * width * disparities;
+
+	for (int32 x = 0; x < width; ++x, costs += disparities)
+	{
+		int32 d = 0;
+
+#if UNREALDR_SIMD_SSE2
+		// Pixels whose disparities all stay inside the right image compare 16 disparities at once.
+		if (x >= disparities - 1)
+		{
+			const __m128i signature = _mm_set1_epi32(static_cast<int32>(left[x]));
+
+			for (; d < disparities; d += 16)
+			{
+				const __m128i low = _mm_packs_epi32(ComputeDistances(signature, right + x - d), ComputeDistances(signature, right + x - d - 4));
+				const __m128i high = _mm_packs_epi32(ComputeDistances(signature, right + x - d - 8), ComputeDistances(signature, right + x - d - 12));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(costs + d), _mm_packus_epi16(low, high));
+			}
+		}
+#endif
+
+		for (; d < disparities; ++d)
+			costs[d] = x - d >= 0 ? static_cast<uint8>(FPlatformMath::CountBits(left[x] ^ right[x - d])) : OutsideCost;
+	}
+}
+
+void FCameraStereoDepth::AggregateRow(int32 y)
+{
+	const int32 width = static_cast<int32>(m_settings.Width);
+	const int32 disparities = m_disparities;
+	const int16 smallPenalty = static_cast<int16>(m_settings.SmallPenalty);
+	const int16 largePenalty = static_cast<int16>(m_settings.LargePenalty);
+	const uint8* costs = m_costs.GetData() + static_cast<SIZE_T>(y) * width * disparities;
+	uint16* aggregated = m_aggregated.GetData() + static_cast<SIZE_T>(y) * width * disparities;
+
+	alignas(16) int16 buffers[2][PathBufferSize];
+	int16* previous = buffers[0];
+	int16* current = buffers[1];
+
+	// Left to right, which initializes the sum of all paths.
+	int16 minimum = InitializePath(costs, previous, disparities);
+	AccumulatePath(previous, aggregated, disparities, true);
+
+	for (int32 x = 1; x < width; ++x)
+	{
+		minimum = AggregatePixel(costs + x * disparities, previous, minimum, current, disparities, smallPenalty, largePenalty);
+		AccumulatePath(current, aggregated + x * disparities, disparities, true);
+		Swap(previous, current);
+	}
+
+	// Right to left.
+	minimum = InitializePath(costs + (width - 1) * disparities, previous, disparities);
+	AccumulatePath(previous, aggregated + (width - 1) * disparities, disparities, false);
+
+	for (int32 x = width - 2; x >= 0; --x)
+	{
+		minimum = AggregatePixel(costs + x * disparities, previous, minimum, current, disparities, smallPenalty, largePenalty);
+		AccumulatePath(current, aggregated + x * disparities, disparities, false);
+		Swap(previous, current);
+	}
+}
+
+void FCameraStereoDepth::AggregateColumns(int32 x0, int32 x1)
+{
+	const int32 width = static_cast<int32>(m_settings.Width);
+	const int32 height = static_cast<int32>(m_settings.Height);
+	const int32 disparities = m_disparities;
+	const int16 smallPenalty = static_cast<int16>(m_settings.SmallPenalty);
+	const int16 largePenalty = static_cast<int16>(m_settings.LargePenalty);
+
+	// Each column of the block has its own pair of path buffers, so that the block is processed row by row.
+	alignas(16) int16 buffers[ColumnBlockSize][2][PathBufferSize];
+	int16 minimums[ColumnBlockSize];
+
+	for (int32 pass = 0; pass < 2; ++pass)
+	{
+		// Top to bottom, then bottom to top.
+		const int32 startY = pass == 0 ? 0 : height - 1;
+		const int32 stepY = pass == 0 ? 1 : -1;
+
+		for (int32 y = startY, row = 0; row < height; y += stepY, ++row)
+		{
+			for (int32 x = x0; x < x1; ++x)
+			{
+				const SIZE_T offset = (static_cast<SIZE_T>(y) * width + x) * disparities;
+				int16* previous = buffers[x - x0][row & 1];
+				int16* current = buffers[x - x0][(row + 1) & 1];
+
+				if (row == 0)
+				{
+					minimums[x - x0] = InitializePath(m_costs.GetData() + offset, current, disparities);
+				}
+				else
+				{
+					minimums[x - x0] = AggregatePixel(m_costs.GetData() + offset, previous, minimums[x - x0], current, disparities, smallPenalty, largePenalty);
+				}
+
+				AccumulatePath(current, m_aggregated.GetData() + offset, disparities, false);
+			}
+		}
+	}
+}
+
+void FCameraStereoDepth::SelectDisparities(int32 y, float* depth)
+{
+	const int32 width = static_cast<int32>(m_settings.Width);
+	const int32 disparities = m_disparities;
+	const uint16* aggregated = m_aggregated.GetData() + static_cast<SIZE_T>(y) * width * disparities;
+	uint8* rightDisparities = m_rightDisparities.GetData() + y * width;
+
+	// The disparity of a right pixel is the one with the lowest cost among the left pixels that map onto it.
+	if (m_settings.bLeftRightCheck)
+	{
+		for (int32 x = 0; x < width; ++x)
+		{
+			uint32 best = MAX_uint32;
+			uint8 disparity = 0;
+
+			for (int32 d = 0; d < disparities && x + d < width; ++d)
+			{
+				const uint32 cost = aggregated[(x + d) * disparities + d];
+
+				if (cost < best)
+				{
+					best = cost;
+					disparity = static_cast<uint8>(d);
+				}
+			}
+
+			rightDisparities[x] = disparity;
+		}
+	}
+
+	const float scale = m_calibration.FocalLength * m_calibration.Baseline;
+	uint32 validPixels = 0;
+
+	for (int32 x = 0; x < width; ++x)
+	{
+		// Only disparities that keep the pixel inside the right image are considered.
+		const uint16* costs = aggregated + x * disparities;
+		const int32 maxDisparity = FMath::Min(disparities - 1, x);
+		int32 disparity = 0;
+
+		for (int32 d = 1; d <= maxDisparity; ++d)
+		{
+			if (costs[d] < costs[disparity])
+				disparity = d;
+		}
+
+		depth[x] = 0.f;
+
+		if (m_settings.bLeftRightCheck && FMath::Abs(rightDisparities[x - disparity] - disparity) > 1)
+			continue;
+
+		// Fit a parabola through the costs around the minimum.
+		float refined = static_cast<float>(disparity);
+
+		if (disparity > 0 && disparity < maxDisparity)
+		{
+			const int32 curvature = costs[disparity - 1] - 2 * costs[disparity] + costs[disparity + 1];
+
+			if (curvature > 0)
+				refined += static_cast<float>(costs[disparity - 1] - costs[disparity + 1]) / (2.f * curvature);
+		}
+
+		if (refined >= 0.5f)
+		{
+			depth[x] = scale / refined;
+			++validPixels;
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_UnrealDR_ValidDepthPixels, validPixels);
+}
@@ -0,0 +1,960 @@
+#include "CameraStream.h"
+#include <Misc/Paths.h>
+#include <Misc/DateTime.h>
+#include <HAL/PlatformTime.h>
+#include <CoreGlobals.h>
+#include <Async/Async.h>
+#include <Async/ParallelFor.h>
+
+DECLARE_CYCLE_STAT(TEXT("Dirty Tile Detection"), STAT_UnrealDR_DirtyTileDetection, STATGROUP_UnrealDR);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Dirty Tiles"), STAT_UnrealDR_DirtyTiles, STATGROUP_UnrealDR);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Uploaded Bytes"), STAT_UnrealDR_UploadedBytes, STATGROUP_UnrealDR);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Uploaded Periphery Bytes"), STAT_UnrealDR_UploadedPeripheryBytes, STATGROUP_UnrealDR);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Region Of Interest Pixels"), STAT_UnrealDR_RegionOfInterestPixels, STATGROUP_UnrealDR);
+
+namespace
+{
+	/// <summary>
+	/// The size of the blocks (in pixels) the regions of interest are aligned to. Alignment keeps the inpainting state from being reset by small movements.
+	/// </summary>
+	constexpr int32 RegionOfInterestAlignment = 16;
+}
+
+FCameraStream::FCameraStream(const FString& key, FCameraFrameSourcePtr source, const FCameraStreamSettings& settings, FCameraTexturePoolPtr texturePool) :
+	m_key(key), m_source(source), m_settings(settings), m_texturePool(texturePool)
+{
+	// Settings that are set from C++ or Blueprints bypass the clamps of the editor.
+	m_settings.Validate();
+	m_chromaKeySettings = m_settings.GetChromaKeySettings();
+
+	if (!m_source.IsValid() || !m_source->GetFrameSize(m_frameWidth, m_frameHeight, m_frameBufferSize))
+		return;
+
+	// The right eye image is stored in the upper half, the left eye image in the lower half of the frame buffer.
+	m_frameBufferRegions[vr::Eye_Left] = FUpdateTextureRegion2D(0, 0, 0, m_frameHeight / 2, m_frameWidth, m_frameHeight / 2);
+	m_frameBufferRegions[vr::Eye_Right] = FUpdateTextureRegion2D(0, 0, 0, 0, m_frameWidth, m_frameHeight / 2);
+	m_stereoRegion = FUpdateTextureRegion2D(0, 0, 0, 0, m_frameWidth, m_frameHeight);
+	m_foveaRect = FIntRect(0, 0, m_frameWidth, m_frameHeight / 2);
+	m_requestedFoveaRect = m_foveaRect;
+
+	if (m_settings.bUploadStereoImage)
+	{
+		// Use a single texture with the layout of the frame buffer, so that both eyes are uploaded with a single render command.
+		m_stereoImage = m_texturePool->AcquireTexture(m_frameWidth, m_frameHeight, EPixelFormat::PF_R8G8B8A8);
+	}
+	else
+	{
+		// Use left and right eye textures. They are kept alive by the stream and shared with all subscribers.
+		m_eyeImages[vr::Eye_Left] = m_texturePool->AcquireTexture(m_frameWidth, m_frameHeight / 2, EPixelFormat::PF_R8G8B8A8);
+		m_eyeImages[vr::Eye_Right] = m_texturePool->AcquireTexture(m_frameWidth, m_frameHeight / 2, EPixelFormat::PF_R8G8B8A8);
+	}
+
+	// Use background images, which receive the background model.
+	if (m_settings.bEnableBackgroundModel)
+	{
+		m_backgroundImages[vr::Eye_Left] = m_texturePool->AcquireTexture(m_frameWidth, m_frameHeight / 2, EPixelFormat::PF_R8G8B8A8);
+		m_backgroundImages[vr::Eye_Right] = m_texturePool->AcquireTexture(m_frameWidth, m_frameHeight / 2, EPixelFormat::PF_R8G8B8A8);
+	}
+
+	// Use inpainted images, which receive the frames with the masked regions filled.
+	if (m_settings.bEnableInpainting)
+	{
+		m_inpaintedImages[vr::Eye_Left] = m_texturePool->AcquireTexture(m_frameWidth, m_frameHeight / 2, EPixelFormat::PF_R8G8B8A8);
+		m_inpaintedImages[vr::Eye_Right] = m_texturePool->AcquireTexture(m_frameWidth, m_frameHeight / 2, EPixelFormat::PF_R8G8B8A8);
+	}
+
+	// Use a depth image, which receives the depth maps.
+	if (m_settings.bEnableStereoDepth)
+		m_depthImage = m_texturePool->AcquireTexture(m_settings.StereoDepthSize.X, m_settings.StereoDepthSize.Y, EPixelFormat::PF_R32_FLOAT);
+
+	// Use a flow image, which receives one motion vector per block of both eyes in the layout of the frame buffer.
+	if (m_settings.bEnableFrameInterpolation)
+	{
+		m_opticalFlow = MakeShared<FCameraOpticalFlow, ESPMode::ThreadSafe>(m_frameWidth, m_frameHeight, m_settings.GetOpticalFlowSettings());
+
+		uint32 fieldWidth, fieldHeight;
+		m_opticalFlow->GetFieldSize(fieldWidth, fieldHeight);
+
+		if (fieldWidth > 0 && fieldHeight > 0)
+			m_flowImage = m_texturePool->AcquireTexture(fieldWidth, fieldHeight * 2, EPixelFormat::PF_G16R16F);
+		else
+			m_opticalFlow.Reset();
+	}
+
+	// Measure the color statistics of each frame.
+	if (m_settings.bEnableColorStatistics)
+		m_colorStatistics = MakeUnique<FCameraColorStatistics>(static_cast<uint32>(m_settings.ColorStatisticsStride), m_settings.ColorStatisticsSmoothingTime);
+
+	// Key each frame, and upload the mask into an image in the layout of the frame buffer, if requested.
+	if (m_settings.bEnableChromaKey)
+	{
+		m_chromaKey = MakeShared<FCameraChromaKey, ESPMode::ThreadSafe>(m_frameWidth, m_frameHeight, m_chromaKeySettings);
+
+		if (m_settings.bUploadChromaKeyMask)
+			m_chromaKeyImage = m_texturePool->AcquireTexture(m_frameWidth, m_frameHeight, EPixelFormat::PF_G8);
+	}
+
+	// Use a periphery image, which receives both downsampled eye images in the layout of the frame buffer, and start with a centered fovea.
+	if (m_settings.bFoveatedUpload)
+	{
+		const int32 levels = m_settings.PeripheryLevels;
+		m_peripheryPyramids[vr::Eye_Left] = MakeUnique<FCameraImagePyramid>(m_frameWidth, m_frameHeight / 2, levels);
+		m_peripheryPyramids[vr::Eye_Right] = MakeUnique<FCameraImagePyramid>(m_frameWidth, m_frameHeight / 2, levels);
+		m_peripheryPyramids[vr::Eye_Left]->GetLevelSize(levels, m_peripheryWidth, m_peripheryHeight);
+
+		m_peripheryPool = MakeShared<FCameraFramePool, ESPMode::ThreadSafe>(m_peripheryWidth * m_peripheryHeight * 2 * 4, 3);
+		m_peripheryImage = m_texturePool->AcquireTexture(m_peripheryWidth, m_peripheryHeight * 2, EPixelFormat::PF_R8G8B8A8);
+		this->SetFoveaCenter(FVector2D(0.5f, 0.5f));
+		m_foveaRect = m_requestedFoveaRect;
+	}
+}
+
+FCameraStream::~FCameraStream()
+{
+	// Force the stream to stop, even if subscribers did not stop it.
+	m_playerCount = FMath::Min(m_playerCount, 1);
+	this->Stop();
+
+	// Return the textures to the pool, so that the next stream can reuse them. Pending uploads keep writing into them, until they are updated by their new owner.
+	for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+	{
+		m_texturePool->ReleaseTexture(m_eyeImages[e]);
+		m_texturePool->ReleaseTexture(m_backgroundImages[e]);
+		m_texturePool->ReleaseTexture(m_inpaintedImages[e]);
+	}
+
+	m_texturePool->ReleaseTexture(m_stereoImage);
+	m_texturePool->ReleaseTexture(m_depthImage);
+	m_texturePool->ReleaseTexture(m_flowImage);
+	m_texturePool->ReleaseTexture(m_chromaKeyImage);
+	m_texturePool->ReleaseTexture(m_peripheryImage);
+}
+
+bool FCameraStream::Start(int32 reservedFrames)
+{
+	// Subscribers are only counted once the stream is running, so a failed start does not make later subscribers believe it is.
+	if (m_playerCount > 0)
+	{
+		// The pool cannot grow while frames are in flight, so later subscribers have to share the reserved frames.
+		if (reservedFrames > 0 && m_framePool->GetPoolSize() < this->GetFramePoolSize(reservedFrames))
+			UE_LOG(LOG_UNREAL_DR, Warning, TEXT("[UnrealDR] Camera stream \"%s\" is already running. Frames reserved by the subscriber are shared with the other subscribers."), *m_key);
+
+		++m_playerCount;
+		return true;
+	}
+
+	// Acquire the frame source. Without a valid frame size, no images have been created.
+	if (!m_source.IsValid() || m_frameBufferSize == 0 || !m_source->Acquire())
+	{
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to start camera streaming."));
+		return false;
+	}
+
+	// Allocate the frame buffers up-front, so that no allocations are required while streaming.
+	const int32 poolSize = this->GetFramePoolSize(reservedFrames);
+
+	if (!m_framePool.IsValid() || m_framePool->GetBufferSize() != m_frameBufferSize || m_framePool->GetPoolSize() != poolSize)
+		m_framePool = MakeShared<FCameraFramePool, ESPMode::ThreadSafe>(m_frameBufferSize, poolSize);
+
+	// Measure the latencies along the pipeline.
+	m_latencyStats = MakeShared<FCameraLatencyStats, ESPMode::ThreadSafe>();
+	m_latencyStats->RegisterRenderFrameCallback();
+
+	if (m_settings.bWriteLatencyCsv)
+		m_latencyStats->EnableCsvExport(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("UnrealDR"), TEXT("Latency"), FString::Printf(TEXT("Latency_%s.csv"), *FDateTime::Now().ToString())));
+
+	// Track changed tiles from scratch, so that the first frame is uploaded as a whole.
+	m_dirtyTileTrackers.Empty();
+
+	if (m_settings.bUploadDirtyTilesOnly && !m_settings.bFoveatedUpload && !m_settings.bRestrictToRegionOfInterest)
+	{
+		m_dirtyTileTrackers.Emplace(m_frameWidth, m_frameHeight / 2, static_cast<uint32>(m_settings.DirtyTileSize));
+		m_dirtyTileTrackers.Emplace(m_frameWidth, m_frameHeight / 2, static_cast<uint32>(m_settings.DirtyTileSize));
+	}
+
+	// Estimate the background from scratch.
+	if (m_settings.bEnableBackgroundModel)
+	{
+		m_backgroundModel = MakeShared<FCameraBackgroundModel, ESPMode::ThreadSafe>(m_frameBufferSize, static_cast<uint8>(m_settings.BackgroundAdaptationStep));
+		m_backgroundFrames = 0;
+	}
+
+	// Start inpainting without a field from previous frames.
+	if (m_settings.bEnableInpainting)
+		m_inpainting = MakeShared<FCameraInpainting, ESPMode::ThreadSafe>(m_frameWidth, m_frameHeight, m_settings.GetInpaintingSettings());
+
+	// Rectify the stereo images with the calibration of the source. The stream holds on to the latest depth map, which needs an additional output frame.
+	if (m_settings.bEnableStereoDepth)
+	{
+		m_stereoDepth = MakeShared<FCameraStereoDepth, ESPMode::ThreadSafe>(m_settings.GetStereoDepthSettings(), 4);
+
+		if (!m_stereoDepth->Build(*m_source))
+		{
+			UE_LOG(LOG_UNREAL_DR, Warning, TEXT("[UnrealDR] Stereo depth of camera stream \"%s\" is disabled, since the calibration of the cameras is not available."), *m_key);
+			m_stereoDepth.Reset();
+		}
+	}
+
+	// Estimate the motion from scratch, so that no flow is applied before the first pair of frames has been matched.
+	if (m_opticalFlow.IsValid())
+	{
+		m_opticalFlow->Reset();
+		m_flowInterval = 0.0;
+	}
+
+	// Smooth the color statistics from scratch.
+	if (m_colorStatistics.IsValid())
+		m_colorStatistics->Reset();
+
+	// Start keying without a previous mask, so that the first mask is uploaded as a whole.
+	m_chromaKeyResult = FCameraChromaKeyResult();
+	m_chromaKeyImageInitialized = false;
+
+	// Create the shared memory ring, which starts over with every start of the stream.
+	if (m_settings.bPublishToSharedMemory)
+	{
+		m_publisher = MakeShared<FCameraSharedMemoryPublisher, ESPMode::ThreadSafe>(FCameraSharedMemoryPublisher::GetRegionName(m_settings.SharedMemoryName, m_key), m_settings.SharedMemorySlots);
+		m_unpublishedFrames = 0;
+
+		if (!m_publisher->Open(*m_source))
+		{
+			UE_LOG(LOG_UNREAL_DR, Warning, TEXT("[UnrealDR] Camera stream \"%s\" is not published to shared memory."), *m_key);
+			m_publisher.Reset();
+		}
+	}
+
+	// Start copying frames on a dedicated thread.
+	m_captureWorker = MakeUnique<FCameraCaptureWorker>(m_source, m_framePool, 1, FString::Printf(TEXT("UnrealDR Camera Capture (%s)"), *m_key));
+
+	if (!m_captureWorker->Start())
+	{
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to start camera capture worker."));
+		this->Shutdown();
+		return false;
+	}
+
+	m_latestFrame.SafeRelease();
+	m_latestFrameTime = FPlatformTime::Seconds();
+	m_frameRate = 0.f;
+	m_frameRateWindowStart = m_latestFrameTime;
+	m_frameRateWindowFrames = 0;
+	m_lastFullFrameUploadTime = 0.0;
+	m_playerCount = 1;
+
+	return true;
+}
+
+int32 FCameraStream::GetFramePoolSize(int32 reservedFrames) const
+{
+	// The stream holds on to the latest frame, which needs an additional buffer. The pending flow estimation also holds on to the frame before it, and each other
+	// pending task on the thread pool holds on to the frame it has been started with.
+	const int32 pendingTasks = (m_settings.bEnableBackgroundModel ? 1 : 0) + (m_settings.bEnableInpainting ? 1 : 0) + (m_settings.bEnableStereoDepth ? 1 : 0) +
+		(m_settings.bPublishToSharedMemory ? 1 : 0) + (m_chromaKey.IsValid() ? 1 : 0);
+
+	return m_settings.FrameBufferPoolSize + reservedFrames + 1 + (m_opticalFlow.IsValid() ? 1 : 0) + pendingTasks;
+}
+
+void FCameraStream::Stop()
+{
+	if (m_playerCount == 0 || --m_playerCount > 0)
+		return;
+
+	this->Shutdown();
+}
+
+void FCameraStream::Shutdown()
+{
+	// Stop the capture worker before releasing the stream it reads from.
+	m_captureWorker.Reset();
+	m_latestFrame.SafeRelease();
+
+	// Wait for the pending background model update, which still reads the frame it has been started with.
+	if (m_backgroundTask.IsValid())
+	{
+		m_backgroundTask.Wait();
+		m_backgroundTask = TFuture<FCameraFrameRef>();
+	}
+
+	m_backgroundModel.Reset();
+
+	if (m_inpaintingTask.IsValid())
+	{
+		m_inpaintingTask.Wait();
+		m_inpaintingTask = TFuture<FCameraFrameRef>();
+	}
+
+	m_inpainting.Reset();
+
+	if (m_stereoDepthTask.IsValid())
+	{
+		m_stereoDepthTask.Wait();
+		m_stereoDepthTask = TFuture<FCameraFrameRef>();
+	}
+
+	m_latestDepthMap.SafeRelease();
+	m_stereoDepth.Reset();
+
+	if (m_opticalFlowTask.IsValid())
+	{
+		m_opticalFlowTask.Wait();
+		m_opticalFlowTask = TFuture<FCameraFrameRef>();
+	}
+
+	m_previousFrame.SafeRelease();
+
+	if (m_chromaKeyTask.IsValid())
+	{
+		m_chromaKeyTask.Wait();
+		m_chromaKeyTask = TFuture<FCameraChromaKeyResult>();
+	}
+
+	m_chromaKeyResult = FCameraChromaKeyResult();
+
+	if (m_publishTask.IsValid())
+	{
+		m_publishTask.Wait();
+		m_publishTask = TFuture<bool>();
+	}
+
+	m_publisher.Reset();
+
+	if (m_source.IsValid())
+		m_source->Release();
+
+	// Stop measuring latencies. Pending uploads keep the statistics alive until they are finished.
+	if (m_latencyStats.IsValid())
+	{
+		m_latencyStats->UnregisterRenderFrameCallback();
+		m_latencyStats->FlushCsv();
+		m_latencyStats.Reset();
+	}
+}
+
+void FCameraStream::Update()
+{
+	// Only update once per engine frame, no matter how many subscribers there are.
+	if (!this->IsStreaming() || m_lastUpdateFrame == GFrameCounter)
+		return;
+
+	m_lastUpdateFrame = GFrameCounter;
+
+	const bool hasNewFrame = m_captureWorker->HasNewFrame();
+
+	if (!hasNewFrame)
+	{
+		m_latencyStats->MarkRepeatedFrame();
+	}
+	else
+	{
+		// Swap to the newest frame and push it into the eye or stereo textures.
+		m_latestFrame = m_captureWorker->SwapToLatestFrame();
+		m_latestFrameTime = FPlatformTime::Seconds();
+		this->UpdateImages(m_latestFrame);
+
+		// The statistics are cheap enough to be measured on the game thread, so that they always belong to the displayed frame.
+		if (m_colorStatistics.IsValid())
+			m_colorStatistics->Update(*m_latestFrame, m_frameWidth, m_frameHeight);
+	}
+
+	if (m_backgroundModel.IsValid())
+		this->UpdateBackground(hasNewFrame ? m_latestFrame : FCameraFrameRef());
+
+	if (m_inpainting.IsValid())
+		this->UpdateInpainting(hasNewFrame ? m_latestFrame : FCameraFrameRef());
+
+	if (m_stereoDepth.IsValid())
+		this->UpdateStereoDepth(hasNewFrame ? m_latestFrame : FCameraFrameRef());
+
+	if (m_opticalFlow.IsValid())
+		this->UpdateOpticalFlow(hasNewFrame ? m_latestFrame : FCameraFrameRef());
+
+	if (m_chromaKey.IsValid())
+		this->UpdateChromaKey(hasNewFrame ? m_latestFrame : FCameraFrameRef());
+
+	if (m_publisher.IsValid() && hasNewFrame)
+		this->UpdatePublisher(m_latestFrame);
+
+	// Measure the frame rate of the camera over windows of a second, so that the rates of multiple devices can be compared.
+	const double now = FPlatformTime::Seconds();
+
+	if (now - m_frameRateWindowStart >= 1.0)
+	{
+		const int32 receivedFrames = m_captureWorker->GetCapturedFrames() + m_captureWorker->GetDroppedFrames();
+		m_frameRate = static_cast<float>((receivedFrames - m_frameRateWindowFrames) / (now - m_frameRateWindowStart));
+		m_frameRateWindowStart = now;
+		m_frameRateWindowFrames = receivedFrames;
+	}
+
+	m_latencyStats->PublishStats(m_captureWorker->GetDroppedFrames(), m_captureWorker->GetSkippedFrames());
+}
+
+float FCameraStream::GetTimeSinceLastFrame() const
+{
+	return static_cast<float>(FPlatformTime::Seconds() - m_latestFrameTime);
+}
+
+float FCameraStream::GetInterpolationPhase(double displayTime) const
+{
+	if (!m_latestFrame.IsValid() || m_flowInterval <= 0.0)
+		return 0.f;
+
+	return FMath::Clamp(static_cast<float>((displayTime - m_latestFrame->ExposureTime) / m_flowInterval), 0.f, m_settings.MaxInterpolationPhase);
+}
+
+void FCameraStream::UpdateImages(const FCameraFrameRef& frame)
+{
+	// TODO: This can be improved by directly accessing the frame buffer as a texture, so no roudtrip to CPU memory is required.
+	// Each upload holds a reference to the frame, so that it does not return to the pool before the render thread has finished reading it. The lambdas also hold a
+	// reference to the pool, so that it outlives the pending uploads, even if the stream gets destroyed in the meantime.
+	FCameraFrame* frameBuffer = frame.GetReference();
+	const uint32 pitch = static_cast<uint32_t>(m_frameWidth * sizeof(uint8_t) * 4);
+
+	if (m_peripheryImage != nullptr)
+	{
+		this->UpdateFoveatedImages(frame);
+		return;
+	}
+
+	// Between two full frames, only the regions of interest are uploaded, so that the cost scales with the masked area instead of the sensor resolution.
+	if (this->IsRestrictedToRegionsOfInterest())
+	{
+		const double now = FPlatformTime::Seconds();
+
+		if (now - m_lastFullFrameUploadTime < m_settings.FullFrameRefreshInterval)
+		{
+			this->UpdateRegionsOfInterest(frame);
+			return;
+		}
+
+		m_lastFullFrameUploadTime = now;
+	}
+
+	if (m_dirtyTileTrackers.Num() == 0 && m_stereoImage != nullptr)
+	{
+		// Upload the stereo image as a whole.
+		m_latencyStats->MarkUploadEnqueued(*frameBuffer, 1);
+		this->UploadImage(m_stereoImage, frameBuffer, m_framePool, &m_stereoRegion, 1, m_latencyStats);
+
+		SET_DWORD_STAT(STAT_UnrealDR_UploadedBytes, m_frameBufferSize);
+		return;
+	}
+
+	if (m_dirtyTileTrackers.Num() == 0)
+	{
+		// Upload both eye images as a whole.
+		m_latencyStats->MarkUploadEnqueued(*frameBuffer, 2);
+
+		this->UploadImage(m_eyeImages[vr::Eye_Left], frameBuffer, m_framePool, &m_frameBufferRegions[vr::Eye_Left], 1, m_latencyStats);
+		this->UploadImage(m_eyeImages[vr::Eye_Right], frameBuffer, m_framePool, &m_frameBufferRegions[vr::Eye_Right], 1, m_latencyStats);
+
+		SET_DWORD_STAT(STAT_UnrealDR_UploadedBytes, m_frameBufferSize);
+		return;
+	}
+
+	// Find the regions that have changed since the last upload.
+	TArray<FUpdateTextureRegion2D, TInlineAllocator<64>> regions[2];
+	uint32 dirtyTiles = 0;
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_UnrealDR_DirtyTileDetection);
+		TArray<FUpdateTextureRegion2D> eyeRegions;
+
+		for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+		{
+			const FUpdateTextureRegion2D& fullRegion = m_frameBufferRegions[e];
+			dirtyTiles += m_dirtyTileTrackers[e].Update(frameBuffer->Data, pitch, fullRegion.SrcX, fullRegion.SrcY, m_settings.MaxDirtyTileRatio, eyeRegions);
+			regions[e].Append(eyeRegions);
+		}
+	}
+
+	if (m_stereoImage != nullptr)
+	{
+		// The stereo image has the layout of the frame buffer, so the regions of both eyes are uploaded to where they are read from, with a single render command.
+		uint32 uploadedBytes = 0;
+
+		for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+		{
+			for (auto& region : regions[e])
+			{
+				region.DestX = region.SrcX;
+				region.DestY = region.SrcY;
+				uploadedBytes += region.Width * region.Height * 4;
+			}
+		}
+
+		regions[vr::Eye_Left].Append(regions[vr::Eye_Right]);
+
+		if (regions[vr::Eye_Left].Num() > 0)
+		{
+			m_latencyStats->MarkUploadEnqueued(*frameBuffer, 1);
+			this->UploadImage(m_stereoImage, frameBuffer, m_framePool, regions[vr::Eye_Left].GetData(), static_cast<uint32>(regions[vr::Eye_Left].Num()), m_latencyStats);
+		}
+
+		SET_DWORD_STAT(STAT_UnrealDR_DirtyTiles, dirtyTiles);
+		SET_DWORD_STAT(STAT_UnrealDR_UploadedBytes, uploadedBytes);
+		return;
+	}
+
+	// Eyes without changes are not uploaded at all.
+	const int32 uploads = (regions[vr::Eye_Left].Num() > 0 ? 1 : 0) + (regions[vr::Eye_Right].Num() > 0 ? 1 : 0);
+	uint32 uploadedBytes = 0;
+
+	if (uploads > 0)
+		m_latencyStats->MarkUploadEnqueued(*frameBuffer, uploads);
+
+	for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+	{
+		if (regions[e].Num() == 0)
+			continue;
+
+		for (const auto& region : regions[e])
+			uploadedBytes += region.Width * region.Height * 4;
+
+		this->UploadImage(m_eyeImages[e], frameBuffer, m_framePool, regions[e].GetData(), static_cast<uint32>(regions[e].Num()), m_latencyStats);
+	}
+
+	SET_DWORD_STAT(STAT_UnrealDR_DirtyTiles, dirtyTiles);
+	SET_DWORD_STAT(STAT_UnrealDR_UploadedBytes, uploadedBytes);
+}
+
+void FCameraStream::UpdateFoveatedImages(const FCameraFrameRef& frame)
+{
+	FCameraFrame* frameBuffer = frame.GetReference();
+	const uint32 pitch = static_cast<uint32_t>(m_frameWidth * sizeof(uint8_t) * 4);
+	const uint32 peripheryPitch = m_peripheryWidth * 4;
+
+	// Only move the fovea with a new frame, so that it always matches the region that has been uploaded last.
+	m_foveaRect = m_requestedFoveaRect;
+
+	// Downsample both eyes into the layout of the frame buffer. If all periphery frames are still being uploaded, the previous periphery is kept for this frame.
+	FCameraFrameRef periphery = m_peripheryPool->Acquire();
+
+	if (periphery.IsValid())
+	{
+		ParallelFor(2, [this, frameBuffer, pitch, peripheryPitch, &periphery](int32 e) {
+			const uint32 firstRow = e == vr::Eye_Left ? m_peripheryHeight : 0;
+			m_peripheryPyramids[e]->Build(frameBuffer->Data + m_frameBufferRegions[e].SrcY * pitch, pitch, periphery->Data + firstRow * peripheryPitch, peripheryPitch);
+		});
+
+		periphery->Header = frameBuffer->Header;
+		periphery->ExposureTime = frameBuffer->ExposureTime;
+		periphery->bHasExposureTime = frameBuffer->bHasExposureTime;
+		periphery->HeaderPollTime = frameBuffer->HeaderPollTime;
+		periphery->CaptureTime = frameBuffer->CaptureTime;
+	}
+
+	// The fovea of each eye is read from the frame buffer and written to the same position of the eye image, or to where it is read from in the stereo image.
+	FUpdateTextureRegion2D regions[2];
+
+	for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+	{
+		const uint32 srcY = m_frameBufferRegions[e].SrcY + m_foveaRect.Min.Y;
+		regions[e] = FUpdateTextureRegion2D(m_foveaRect.Min.X, m_stereoImage != nullptr ? srcY : m_foveaRect.Min.Y, m_foveaRect.Min.X, srcY, m_foveaRect.Width(), m_foveaRect.Height());
+	}
+
+	const int32 uploads = (m_stereoImage != nullptr ? 1 : 2) + (periphery.IsValid() ? 1 : 0);
+	m_latencyStats->MarkUploadEnqueued(*frameBuffer, uploads);
+
+	if (m_stereoImage != nullptr)
+	{
+		this->UploadImage(m_stereoImage, frameBuffer, m_framePool, regions, 2, m_latencyStats);
+	}
+	else
+	{
+		this->UploadImage(m_eyeImages[vr::Eye_Left], frameBuffer, m_framePool, &regions[vr::Eye_Left], 1, m_latencyStats);
+		this->UploadImage(m_eyeImages[vr::Eye_Right], frameBuffer, m_framePool, &regions[vr::Eye_Right], 1, m_latencyStats);
+	}
+
+	if (periphery.IsValid())
+	{
+		const FUpdateTextureRegion2D region(0, 0, 0, 0, m_peripheryWidth, m_peripheryHeight * 2);
+		this->UploadImage(m_peripheryImage, periphery.GetReference(), m_peripheryPool, &region, 1, m_latencyStats, peripheryPitch);
+	}
+
+	SET_DWORD_STAT(STAT_UnrealDR_UploadedBytes, m_foveaRect.Area() * 2 * 4);
+	SET_DWORD_STAT(STAT_UnrealDR_UploadedPeripheryBytes, periphery.IsValid() ? m_peripheryWidth * m_peripheryHeight * 2 * 4 : 0);
+}
+
+void FCameraStream::UpdateRegionsOfInterest(const FCameraFrameRef& frame)
+{
+	FCameraFrame* frameBuffer = frame.GetReference();
+
+	// Each region is read from the frame buffer and written to the same position of the eye image, or to where it is read from in the stereo image.
+	FUpdateTextureRegion2D regions[2];
+	uint32 regionCount = 0;
+	uint32 pixels = 0;
+
+	for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+	{
+		const FIntRect& roi = m_regionsOfInterest[e];
+
+		if (roi.Area() <= 0)
+			continue;
+
+		const uint32 srcY = m_frameBufferRegions[e].SrcY + roi.Min.Y;
+		regions[regionCount++] = FUpdateTextureRegion2D(roi.Min.X, m_stereoImage != nullptr ? srcY : roi.Min.Y, roi.Min.X, srcY, roi.Width(), roi.Height());
+		pixels += roi.Area();
+	}
+
+	SET_DWORD_STAT(STAT_UnrealDR_RegionOfInterestPixels, pixels);
+	SET_DWORD_STAT(STAT_UnrealDR_UploadedBytes, pixels * 4);
+
+	if (regionCount == 0)
+		return;
+
+	if (m_stereoImage != nullptr)
+	{
+		m_latencyStats->MarkUploadEnqueued(*frameBuffer, 1);
+		this->UploadImage(m_stereoImage, frameBuffer, m_framePool, regions, regionCount, m_latencyStats);
+		return;
+	}
+
+	m_latencyStats->MarkUploadEnqueued(*frameBuffer, regionCount);
+	uint32 region = 0;
+
+	for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+	{
+		if (m_regionsOfInterest[e].Area() > 0)
+			this->UploadImage(m_eyeImages[e], frameBuffer, m_framePool, &regions[region++], 1, m_latencyStats);
+	}
+}
+
+void FCameraStream::UpdateBackground(const FCameraFrameRef& frame)
+{
+	// Upload the result of the last update, once it is ready.
+	if (m_backgroundTask.IsValid() && m_backgroundTask.IsReady())
+	{
+		FCameraFrameRef background = m_backgroundTask.Get();
+		m_backgroundTask = TFuture<FCameraFrameRef>();
+
+		if (background.IsValid())
+		{
+			const FCameraFramePoolPtr& pool = m_backgroundModel->GetOutputPool();
+			this->UploadImage(m_backgroundImages[vr::Eye_Left], background.GetReference(), pool, &m_frameBufferRegions[vr::Eye_Left], 1, nullptr);
+			this->UploadImage(m_backgroundImages[vr::Eye_Right], background.GetReference(), pool, &m_frameBufferRegions[vr::Eye_Right], 1, nullptr);
+		}
+	}
+
+	// Feed every n-th frame into the model. If the previous update is still running, the frame is skipped, so that the model never holds back the stream.
+	if (!frame.IsValid() || m_backgroundTask.IsValid() || m_backgroundFrames++ % static_cast<uint32>(m_settings.BackgroundUpdateStride) != 0)
+		return;
+
+	FCameraBackgroundModelPtr model = m_backgroundModel;
+
+	m_backgroundTask = Async(EAsyncExecution::ThreadPool, [model, frame]() {
+		return model->Update(*frame);
+	});
+}
+
+void FCameraStream::UpdateInpainting(const FCameraFrameRef& frame)
+{
+	// Upload the last inpainted frame, once it is ready.
+	if (m_inpaintingTask.IsValid() && m_inpaintingTask.IsReady())
+	{
+		FCameraFrameRef inpainted = m_inpaintingTask.Get();
+		m_inpaintingTask = TFuture<FCameraFrameRef>();
+
+		if (inpainted.IsValid())
+		{
+			const FCameraFramePoolPtr& pool = m_inpainting->GetOutputPool();
+
+			for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+			{
+				// Outside of the regions of interest, the inpainted frame is a copy of the camera frame, which is never sampled from the inpainted image.
+				const FIntRect& roi = m_inpaintingRegions[e];
+				const FUpdateTextureRegion2D region(roi.Min.X, roi.Min.Y, roi.Min.X, m_frameBufferRegions[e].SrcY + roi.Min.Y, roi.Width(), roi.Height());
+
+				if (roi.Area() > 0)
+					this->UploadImage(m_inpaintedImages[e], inpainted.GetReference(), pool, &region, 1, nullptr);
+			}
+		}
+	}
+
+	// Inpaint the latest frame, unless the previous one is still being inpainted. The time budget of the inpainting keeps it from falling behind for long.
+	if (!frame.IsValid() || m_inpaintingTask.IsValid() || !m_inpaintingMask.IsValid())
+		return;
+
+	FCameraInpaintingPtr inpainting = m_inpainting;
+	TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> mask = m_inpaintingMask;
+
+	for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+		m_inpaintingRegions[e] = this->IsRestrictedToRegionsOfInterest() ? m_regionsOfInterest[e] : FIntRect(0, 0, m_frameWidth, m_frameHeight / 2);
+
+	const FIntRect left = m_inpaintingRegions[vr::Eye_Left];
+	const FIntRect right = m_inpaintingRegions[vr::Eye_Right];
+
+	m_inpaintingTask = Async(EAsyncExecution::ThreadPool, [inpainting, mask, frame, left, right]() {
+		const FIntRect regions[2] = { left, right };
+		return inpainting->Inpaint(*frame, *mask, regions);
+	});
+}
+
+void FCameraStream::UpdateStereoDepth(const FCameraFrameRef& frame)
+{
+	// Keep and upload the last depth map, once it is ready.
+	if (m_stereoDepthTask.IsValid() && m_stereoDepthTask.IsReady())
+	{
+		FCameraFrameRef depthMap = m_stereoDepthTask.Get();
+		m_stereoDepthTask = TFuture<FCameraFrameRef>();
+
+		if (depthMap.IsValid())
+		{
+			const FCameraDepthCalibration& calibration = m_stereoDepth->GetCalibration();
+			const FUpdateTextureRegion2D region(0, 0, 0, 0, calibration.Width, calibration.Height);
+
+			m_latestDepthMap = depthMap;
+			this->UploadImage(m_depthImage, depthMap.GetReference(), m_stereoDepth->GetOutputPool(), &region, 1, nullptr, calibration.Width * sizeof(float), sizeof(float));
+		}
+	}
+
+	// Estimate the depth of the latest frame, unless the previous one is still being processed. Frames that arrive in the meantime are skipped.
+	if (!frame.IsValid() || m_stereoDepthTask.IsValid())
+		return;
+
+	FCameraStereoDepthPtr stereoDepth = m_stereoDepth;
+
+	m_stereoDepthTask = Async(EAsyncExecution::ThreadPool, [stereoDepth, frame]() {
+		return stereoDepth->Compute(*frame);
+	});
+}
+
+void FCameraStream::UpdateOpticalFlow(const FCameraFrameRef& frame)
+{
+	// Upload the last flow field, once it is ready. Until the next one is ready, it keeps being applied to the newer frames, which assumes constant motion.
+	if (m_opticalFlowTask.IsValid() && m_opticalFlowTask.IsReady())
+	{
+		FCameraFrameRef flowField = m_opticalFlowTask.Get();
+		m_opticalFlowTask = TFuture<FCameraFrameRef>();
+
+		if (flowField.IsValid())
+		{
+			uint32 fieldWidth, fieldHeight;
+			m_opticalFlow->GetFieldSize(fieldWidth, fieldHeight);
+			const FUpdateTextureRegion2D region(0, 0, 0, 0, fieldWidth, fieldHeight * 2);
+
+			m_flowInterval = m_pendingFlowInterval;
+			this->UploadImage(m_flowImage, flowField.GetReference(), m_opticalFlow->GetOutputPool(), &region, 1, nullptr, fieldWidth * 4, 4);
+		}
+	}
+
+	if (!frame.IsValid())
+		return;
+
+	// Match the latest frame against the one before it, unless the previous estimation is still running. Frames that arrive in the meantime are not matched, so
+	// that the flow never falls behind by more than one estimation.
+	const FCameraFrameRef previous = m_previousFrame;
+	m_previousFrame = frame;
+
+	if (!previous.IsValid() || m_opticalFlowTask.IsValid() || frame->ExposureTime <= previous->ExposureTime)
+		return;
+
+	FCameraOpticalFlowPtr opticalFlow = m_opticalFlow;
+	m_pendingFlowInterval = frame->ExposureTime - previous->ExposureTime;
+
+	m_opticalFlowTask = Async(EAsyncExecution::ThreadPool, [opticalFlow, previous, frame]() {
+		return opticalFlow->Compute(*previous, *frame);
+	});
+}
+
+void FCameraStream::UpdateChromaKey(const FCameraFrameRef& frame)
+{
+	// Keep the last mask and upload it, once it is ready. Until the next one is ready, the previous mask and regions are presented.
+	if (m_chromaKeyTask.IsValid() && m_chromaKeyTask.IsReady())
+	{
+		FCameraChromaKeyResult result = m_chromaKeyTask.Get();
+		m_chromaKeyTask = TFuture<FCameraChromaKeyResult>();
+
+		if (result.Mask.IsValid())
+		{
+			m_chromaKeyResult = MoveTemp(result);
+
+			if (m_chromaKeyImage != nullptr)
+			{
+				// Outside of the keyed regions, the mask is `0`. As long as the regions do not change, only they are uploaded.
+				const FCameraChromaKeyResult& latest = m_chromaKeyResult;
+				FUpdateTextureRegion2D regions[2];
+				uint32 regionCount = 0;
+
+				if (m_chromaKeyImageInitialized && latest.Regions[vr::Eye_Left] == m_uploadedChromaKeyRegions[vr::Eye_Left] && latest.Regions[vr::Eye_Right] == m_uploadedChromaKeyRegions[vr::Eye_Right])
+				{
+					for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+					{
+						const FIntRect& region = latest.Regions[e];
+						const uint32 y = m_frameBufferRegions[e].SrcY + region.Min.Y;
+
+						if (region.Area() > 0)
+							regions[regionCount++] = FUpdateTextureRegion2D(region.Min.X, y, region.Min.X, y, region.Width(), region.Height());
+					}
+				}
+				else
+				{
+					regions[regionCount++] = FUpdateTextureRegion2D(0, 0, 0, 0, m_frameWidth, m_frameHeight);
+					m_uploadedChromaKeyRegions[vr::Eye_Left] = latest.Regions[vr::Eye_Left];
+					m_uploadedChromaKeyRegions[vr::Eye_Right] = latest.Regions[vr::Eye_Right];
+					m_chromaKeyImageInitialized = true;
+				}
+
+				if (regionCount > 0)
+					this->UploadImage(m_chromaKeyImage, latest.Mask.GetReference(), m_chromaKey->GetOutputPool(), regions, regionCount, nullptr, m_frameWidth, 1);
+			}
+		}
+	}
+
+	// Key the latest frame, unless the previous one is still being keyed. Frames that arrive in the meantime are skipped. While updates are restricted to the
+	// regions of interest, only they are keyed.
+	if (!frame.IsValid() || m_chromaKeyTask.IsValid())
+		return;
+
+	if (m_chromaKeySettingsChanged)
+	{
+		m_chromaKey->SetSettings(m_chromaKeySettings);
+		m_chromaKeySettingsChanged = false;
+	}
+
+	FCameraChromaKeyPtr chromaKey = m_chromaKey;
+	const bool restricted = this->IsRestrictedToRegionsOfInterest();
+	const FIntRect left = m_regionsOfInterest[vr::Eye_Left];
+	const FIntRect right = m_regionsOfInterest[vr::Eye_Right];
+
+	m_chromaKeyTask = Async(EAsyncExecution::ThreadPool, [chromaKey, frame, restricted, left, right]() {
+		const FIntRect regions[2] = { left, right };
+		return chromaKey->Update(*frame, restricted ? regions : nullptr);
+	});
+}
+
+void FCameraStream::UpdatePublisher(const FCameraFrameRef& frame)
+{
+	if (m_publishTask.IsValid() && m_publishTask.IsReady())
+		m_publishTask = TFuture<bool>();
+
+	// Publishing never holds back the stream, so frames that arrive while the previous one is still being copied are skipped.
+	if (m_publishTask.IsValid())
+	{
+		++m_unpublishedFrames;
+		return;
+	}
+
+	FCameraSharedMemoryPublisherPtr publisher = m_publisher;
+
+	m_publishTask = Async(EAsyncExecution::ThreadPool, [publisher, frame]() {
+		return publisher->Publish(*frame);
+	});
+}
+
+void FCameraStream::SetFoveaCenter(const FVector2D& center)
+{
+	if (m_peripheryImage == nullptr)
+		return;
+
+	// Round the fovea to whole pixels and move it back into the image, if it would leave it.
+	const int32 width = static_cast<int32>(m_frameWidth);
+	const int32 height = static_cast<int32>(m_frameHeight / 2);
+	const int32 foveaWidth = FMath::Clamp(FMath::RoundToInt(width * m_settings.FoveaSize.X), 1, width);
+	const int32 foveaHeight = FMath::Clamp(FMath::RoundToInt(height * m_settings.FoveaSize.Y), 1, height);
+	const int32 x = FMath::Clamp(FMath::RoundToInt(width * center.X - foveaWidth * 0.5f), 0, width - foveaWidth);
+	const int32 y = FMath::Clamp(FMath::RoundToInt(height * center.Y - foveaHeight * 0.5f), 0, height - foveaHeight);
+
+	m_requestedFoveaRect = FIntRect(x, y, x + foveaWidth, y + foveaHeight);
+}
+
+void FCameraStream::SetChromaKeySettings(const FCameraChromaKeySettings& settings)
+{
+	// The keyer may be busy with a frame, so the settings are passed to it, before the next frame is keyed.
+	m_chromaKeySettings = settings;
+	m_chromaKeySettingsChanged = true;
+}
+
+void FCameraStream::SetRegionsOfInterest(const FIntRect& left, const FIntRect& right)
+{
+	// Expand the regions to whole blocks and clip them to the eye images.
+	const FIntRect eyeRect(0, 0, static_cast<int32>(m_frameWidth), static_cast<int32>(m_frameHeight / 2));
+	const FIntRect regions[2] = { left, right };
+
+	for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+	{
+		FIntRect roi = regions[e];
+
+		if (roi.Area() > 0)
+		{
+			roi.Min = FIntPoint(FMath::DivideAndRoundDown(roi.Min.X, RegionOfInterestAlignment), FMath::DivideAndRoundDown(roi.Min.Y, RegionOfInterestAlignment)) * RegionOfInterestAlignment;
+			roi.Max = FIntPoint(FMath::DivideAndRoundUp(roi.Max.X, RegionOfInterestAlignment), FMath::DivideAndRoundUp(roi.Max.Y, RegionOfInterestAlignment)) * RegionOfInterestAlignment;
+			roi.Clip(eyeRect);
+		}
+
+		m_regionsOfInterest[e] = roi.Area() > 0 ? roi : FIntRect();
+	}
+
+	m_hasRegionsOfInterest = true;
+}
+
+void FCameraStream::ClearRegionsOfInterest()
+{
+	m_regionsOfInterest[vr::Eye_Left] = FIntRect();
+	m_regionsOfInterest[vr::Eye_Right] = FIntRect();
+	m_hasRegionsOfInterest = false;
+}
+
+void FCameraStream::SetInpaintingMask(TArray<uint8>&& mask)
+{
+	if (mask.Num() == 0)
+	{
+		m_inpaintingMask.Reset();
+		return;
+	}
+
+	if (static_cast<uint32>(mask.Num()) != m_frameWidth * m_frameHeight)
+	{
+		UE_LOG(LOG_UNREAL_DR, Warning, TEXT("[UnrealDR] The inpainting mask of camera stream \"%s\" needs to contain %dx%d values."), *m_key, m_frameWidth, m_frameHeight);
+		return;
+	}
+
+	m_inpaintingMask = MakeShared<const TArray<uint8>, ESPMode::ThreadSafe>(MoveTemp(mask));
+}
+
+void FCameraStream::UploadImage(UTexture2D* texture, FCameraFrame* frame, const FCameraFramePoolPtr& pool, const FUpdateTextureRegion2D* regions, uint32 regionCount, const FCameraLatencyStatsPtr& stats, uint32 pitch, uint32 bytesPerPixel)
+{
+	// Without a resource (e.g. before the texture has been initialized or while it is released), the texture update is skipped and never calls the cleanup. The
+	// frame and the regions must not be referenced in this case, or they would never be returned to their pools.
+	if (texture == nullptr || texture->Resource == nullptr)
+		return;
+
+	// Frames are read with the pitch of the frame buffer, unless the image has a different layout.
+	if (pitch == 0)
+		pitch = static_cast<uint32_t>(m_frameWidth * sizeof(uint8_t) * 4);
+
+	// The texture update does not copy the regions, so they need to stay alive until the upload has been finished, even if the stream gets destroyed in the meantime.
+	// They are copied into a pooled block, which is returned by the cleanup on the render thread.
+	FCameraUploadRegions* uploadRegions = m_texturePool->AcquireRegions(regions, regionCount);
+	FCameraTexturePoolPtr texturePool = m_texturePool;
+
+	frame->AddRef();
+	texture->UpdateTextureRegions(0, regionCount, uploadRegions->Regions.GetData(), pitch, bytesPerPixel, frame->Data, [frame, pool, stats, texturePool, uploadRegions](auto rawData, auto region) {
+		CleanupFrameBufferRegion(frame, rawData, region, stats.Get());
+		texturePool->ReleaseRegions(uploadRegions);
+	});
+}
+
+void FCameraStream::CleanupFrameBufferRegion(const FCameraFrame* frame, uint8_t* rawData, const FUpdateTextureRegion2D* region, FCameraLatencyStats* stats) noexcept
+{
+	// The cleanup is called from the render thread, after the upload has been finished.
+	if (stats != nullptr)
+		stats->MarkUploadDone(frame->Header.nFrameSequence);
+
+	// Return the frame to the pool, if this has been the last upload referencing it.
+	frame->Release();
+}
+
+void FCameraStream::AddReferencedObjects(FReferenceCollector& collector)
+{
+	collector.AddReferencedObject(m_eyeImages[vr::Eye_Left]);
+	collector.AddReferencedObject(m_eyeImages[vr::Eye_Right]);
+	collector.AddReferencedObject(m_stereoImage);
+	collector.AddReferencedObject(m_backgroundImages[vr::Eye_Left]);
+	collector.AddReferencedObject(m_backgroundImages[vr::Eye_Right]);
+	collector.AddReferencedObject(m_inpaintedImages[vr::Eye_Left]);
+	collector.AddReferencedObject(m_inpaintedImages[vr::Eye_Right]);
+	collector.AddReferencedObject(m_depthImage);
+	collector.AddReferencedObject(m_flowImage);
+	collector.AddReferencedObject(m_chromaKeyImage);
+	collector.AddReferencedObject(m_peripheryImage);
+}
@@ -0,0 +1,64 @@
+#include "CameraStreamHub.h"
+
+FCameraStreamPtr FCameraStreamHub::Subscribe(const FString& key, TFunctionRef<FCameraFrameSourcePtr()> createSource, const FCameraStreamSettings& settings)
+{
+	check(IsInGameThread());
+
+	// Share a live stream.
+	if (const TWeakPtr<FCameraStream>* existing = m_streams.Find(key))
+	{
+		FCameraStreamPtr stream = existing->Pin();
+
+		if (stream.IsValid())
+			return stream;
+	}
+
+	// Remove streams, whose subscribers are all gone, and release the textures they have left unused for too long.
+	for (auto it = m_streams.CreateIterator(); it; ++it)
+	{
+		if (!it.Value().IsValid())
+			it.RemoveCurrent();
+	}
+
+	m_texturePool->Trim();
+
+	FCameraFrameSourcePtr source = createSource();
+
+	if (!source.IsValid())
+		return nullptr;
+
+	FCameraStreamPtr stream = MakeShared<FCameraStream>(key, source, settings, m_texturePool);
+	m_streams.Add(key, stream);
+
+	UE_LOG(LOG_UNREAL_DR, Log, TEXT("[UnrealDR] Created camera stream \"%s\" from the %s source."), *key, source->GetName());
+	return stream;
+}
+
+int32 FCameraStreamHub::GetStreamCount() const
+{
+	int32 count = 0;
+
+	for (const auto& stream : m_streams)
+	{
+		if (stream.Value.IsValid())
+			++count;
+	}
+
+	return count;
+}
+
+void FCameraStreamHub::GetStreams(TArray<FCameraStreamPtr>& streams) const
+{
+	check(IsInGameThread());
+	streams.Reset();
+
+	for (const auto& stream : m_streams)
+	{
+		FCameraStreamPtr pinned = stream.Value.Pin();
+
+		if (pinned.IsValid())
+			streams.Add(pinned);
+	}
+
+	streams.Sort([](const FCameraStreamPtr& a, const FCameraStreamPtr& b) { return a->GetKey() < b->GetKey(); });
+}
@@ -0,0 +1,193 @@
+#include "CameraStreamRecorder.h"
+#include <HAL/PlatformFilemanager.h>
+#include <HAL/PlatformProcess.h>
+#include <Misc/Compression.h>
+#include <Misc/Paths.h>
+
+FCameraStreamRecorder::FCameraStreamRecorder(const FString& fileName, int32 maxQueuedFrames) :
+	m_fileName(fileName), m_maxQueuedFrames(FMath::Max(maxQueuedFrames, 1))
+{
+}
+
+FCameraStreamRecorder::~FCameraStreamRecorder()
+{
+	this->Finish();
+}
+
+bool FCameraStreamRecorder::Start(const ICameraFrameSource& source)
+{
+	if (m_thread != nullptr)
+		return true;
+
+	// Gather the calibration, so that a replay can provide it.
+	FCameraStreamFileHeader header;
+
+	if (!source.GetFrameSize(header.FrameWidth, header.FrameHeight, header.FrameBufferSize))
+		return false;
+
+	for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+		source.GetIntrinsics(static_cast<vr::EVREye>(e), header.FocalLength[e], header.Center[e]);
+
+	source.GetExtrinsics(header.CameraToHead);
+
+	// Create the capture file.
+	IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+	platformFile.CreateDirectoryTree(*FPaths::GetPath(m_fileName));
+	m_file.Reset(platformFile.OpenWrite(*m_fileName));
+
+	if (!m_file.IsValid() || !m_file->Write(reinterpret_cast<const uint8*>(&header), sizeof(header)))
+	{
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to create camera stream capture file \"%s\"."), *m_fileName);
+		m_file.Reset();
+		return false;
+	}
+
+	m_index.Reset();
+	m_compressionBuffer.SetNumUninitialized(FCompression::CompressMemoryBound(NAME_LZ4, header.FrameBufferSize));
+
+	// Start the writer.
+	m_wakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	m_running = true;
+	m_thread = FRunnableThread::Create(this, TEXT("UnrealDR Camera Stream Recorder"), 0, TPri_BelowNormal);
+
+	if (m_thread == nullptr)
+	{
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to create camera stream recorder thread."));
+		m_running = false;
+		FPlatformProcess::ReturnSynchEventToPool(m_wakeEvent);
+		m_wakeEvent = nullptr;
+		m_file.Reset();
+		return false;
+	}
+
+	UE_LOG(LOG_UNREAL_DR, Log, TEXT("[UnrealDR] Recording camera stream to \"%s\"."), *m_fileName);
+	return true;
+}
+
+void FCameraStreamRecorder::Finish()
+{
+	if (m_thread == nullptr)
+		return;
+
+	// Kill calls Stop() and waits for the writer to flush the queue and return from Run().
+	m_thread->Kill(true);
+	delete m_thread;
+	m_thread = nullptr;
+
+	FPlatformProcess::ReturnSynchEventToPool(m_wakeEvent);
+	m_wakeEvent = nullptr;
+
+	this->WriteIndex();
+	m_file.Reset();
+
+	UE_LOG(LOG_UNREAL_DR, Log, TEXT("[UnrealDR] Finished recording %d frames (%d dropped) to \"%s\"."), m_writtenFrames.GetValue(), m_droppedFrames.GetValue(), *m_fileName);
+}
+
+bool FCameraStreamRecorder::Enqueue(const FCameraFrameRef& frame)
+{
+	if (!m_running || !frame.IsValid())
+		return false;
+
+	// Drop the frame, if the writer has fallen behind.
+	if (m_queuedFrames.GetValue() >= m_maxQueuedFrames)
+	{
+		m_droppedFrames.Increment();
+		return false;
+	}
+
+	m_queuedFrames.Increment();
+	m_queue.Enqueue(frame);
+	m_wakeEvent->Trigger();
+
+	return true;
+}
+
+uint32 FCameraStreamRecorder::Run()
+{
+	while (m_running)
+	{
+		m_wakeEvent->Wait();
+		this->WriteQueuedFrames();
+	}
+
+	// Flush the frames that have been enqueued before stopping.
+	this->WriteQueuedFrames();
+
+	return 0;
+}
+
+void FCameraStreamRecorder::Stop()
+{
+	m_running = false;
+
+	if (m_wakeEvent != nullptr)
+		m_wakeEvent->Trigger();
+}
+
+void FCameraStreamRecorder::WriteQueuedFrames()
+{
+	FCameraFrameRef frame;
+
+	while (m_queue.Dequeue(frame))
+	{
+		if (this->WriteFrame(*frame))
+			m_writtenFrames.Increment();
+
+		// Return the frame to the pool before decrementing the counter, so that the number of referenced frames never exceeds the limit.
+		frame.SafeRelease();
+		m_queuedFrames.Decrement();
+	}
+}
+
+bool FCameraStreamRecorder::WriteFrame(const FCameraFrame& frame)
+{
+	FCameraStreamIndexEntry entry;
+	entry.Offset = static_cast<uint64>(m_file->Tell());
+	entry.CaptureTime = frame.CaptureTime;
+	entry.Header = frame.Header;
+
+	// Compress the frame. Store it uncompressed, if compression does not pay off.
+	int32 compressedSize = m_compressionBuffer.Num();
+
+	if (FCompression::CompressMemory(NAME_LZ4, m_compressionBuffer.GetData(), compressedSize, frame.Data, static_cast<int32>(frame.Size)) && static_cast<uint32>(compressedSize) < frame.Size)
+	{
+		entry.StoredSize = static_cast<uint32>(compressedSize);
+		entry.Compressed = 1;
+	}
+	else
+	{
+		entry.StoredSize = frame.Size;
+		entry.Compressed = 0;
+	}
+
+	if (!m_file->Write(entry.Compressed ? m_compressionBuffer.GetData() : frame.Data, entry.StoredSize))
+	{
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to write frame %d to camera stream capture file."), frame.Header.nFrameSequence);
+		return false;
+	}
+
+	m_index.Add(entry);
+	return true;
+}
+
+void FCameraStreamRecorder::WriteIndex()
+{
+	if (!m_file.IsValid())
+		return;
+
+	// Align the index, so that it can be accessed in place when the file is memory-mapped.
+	const uint8 padding[alignof(FCameraStreamIndexEntry)]{};
+	const int64 misalignment = m_file->Tell() % alignof(FCameraStreamIndexEntry);
+
+	if (misalignment != 0)
+		m_file->Write(padding, alignof(FCameraStreamIndexEntry) - misalignment);
+
+	FCameraStreamFileFooter footer;
+	footer.IndexOffset = static_cast<uint64>(m_file->Tell());
+	footer.FrameCount = static_cast<uint32>(m_index.Num());
+
+	if (!m_file->Write(reinterpret_cast<const uint8*>(m_index.GetData()), m_index.Num() * sizeof(FCameraStreamIndexEntry)) || !m_file->Write(reinterpret_cast<const uint8*>(&footer), sizeof(footer)))
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to write frame index to camera stream capture file \"%s\"."), *m_fileName);
+
+	m_file->Flush();
+}
@@ -0,0 +1,70 @@
+#include "CameraStreamSettings.h"
+
+void FCameraStreamSettings::Validate()
+{
+	FrameBufferPoolSize = FMath::Max(FrameBufferPoolSize, 4);
+	DirtyTileSize = FMath::Max(DirtyTileSize, 8);
+	BackgroundUpdateStride = FMath::Max(BackgroundUpdateStride, 1);
+	BackgroundAdaptationStep = FMath::Clamp(BackgroundAdaptationStep, 1, 255);
+	StereoDepthSize = FIntPoint(FMath::Max(StereoDepthSize.X, 16), FMath::Max(StereoDepthSize.Y, 16));
+	FlowPyramidLevel = FMath::Clamp(FlowPyramidLevel, 0, 4);
+	FlowSearchRadius = FMath::Clamp(FlowSearchRadius, 1, FCameraOpticalFlow::MaxSearchRadius);
+	FlowZeroMotionBias = FMath::Max(FlowZeroMotionBias, 0);
+	MaxInterpolationPhase = FMath::Clamp(MaxInterpolationPhase, 0.f, 2.f);
+	FoveaSize = FVector2D(FMath::Clamp(FoveaSize.X, 0.05f, 1.f), FMath::Clamp(FoveaSize.Y, 0.05f, 1.f));
+	PeripheryLevels = FMath::Clamp(PeripheryLevels, 1, 4);
+	SharedMemorySlots = FMath::Clamp(SharedMemorySlots, 2, 16);
+	ColorStatisticsStride = FMath::Clamp(ColorStatisticsStride, 1, 32);
+	ColorStatisticsSmoothingTime = FMath::Max(ColorStatisticsSmoothingTime, 0.f);
+	ChromaKeyThreshold = FMath::Clamp(ChromaKeyThreshold, 0, 510);
+	ChromaKeySoftness = FMath::Clamp(ChromaKeySoftness, 1, 255);
+	ChromaKeyMinBlobArea = FMath::Max(ChromaKeyMinBlobArea, 1);
+	ChromaKeyMaxBlobs = FMath::Clamp(ChromaKeyMaxBlobs, 1, 1024);
+	FullFrameRefreshInterval = FMath::Max(FullFrameRefreshInterval, 0.f);
+}
+
+FCameraInpaintingSettings FCameraStreamSettings::GetInpaintingSettings() const
+{
+	FCameraInpaintingSettings settings;
+	settings.PyramidLevels = InpaintingPyramidLevels;
+	settings.Iterations = InpaintingIterations;
+	settings.SteadyStateIterations = InpaintingSteadyStateIterations;
+	settings.TimeBudget = InpaintingTimeBudget / 1000.f;
+
+	return settings;
+}
+
+FCameraStereoDepthSettings FCameraStreamSettings::GetStereoDepthSettings() const
+{
+	FCameraStereoDepthSettings settings;
+	settings.Width = static_cast<uint32>(StereoDepthSize.X);
+	settings.Height = static_cast<uint32>(StereoDepthSize.Y);
+	settings.DisparityRange = StereoDepthDisparityRange;
+	settings.SmallPenalty = StereoDepthSmallPenalty;
+	settings.LargePenalty = StereoDepthLargePenalty;
+	settings.bLeftRightCheck = bStereoDepthLeftRightCheck;
+
+	return settings;
+}
+
+FCameraOpticalFlowSettings FCameraStreamSettings::GetOpticalFlowSettings() const
+{
+	FCameraOpticalFlowSettings settings;
+	settings.PyramidLevel = FlowPyramidLevel;
+	settings.SearchRadius = FlowSearchRadius;
+	settings.ZeroMotionBias = static_cast<uint32>(FlowZeroMotionBias);
+
+	return settings;
+}
+
+FCameraChromaKeySettings FCameraStreamSettings::GetChromaKeySettings() const
+{
+	FCameraChromaKeySettings settings;
+	settings.KeyColor = ChromaKeyColor;
+	settings.Threshold = ChromaKeyThreshold;
+	settings.Softness = ChromaKeySoftness;
+	settings.MinBlobArea = ChromaKeyMinBlobArea;
+	settings.MaxBlobs = ChromaKeyMaxBlobs;
+
+	return settings;
+}
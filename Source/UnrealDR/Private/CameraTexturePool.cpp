@@ -0,0 +1,151 @@
+#include "CameraTexturePool.h"
+#include <HAL/PlatformTime.h>
+#include <UObject/Package.h>
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pooled Textures"), STAT_UnrealDR_PooledTextures, STATGROUP_UnrealDR);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Free Pooled Textures"), STAT_UnrealDR_FreePooledTextures, STATGROUP_UnrealDR);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Texture Pool Hit Rate"), STAT_UnrealDR_TexturePoolHitRate, STATGROUP_UnrealDR);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pooled Upload Region Blocks"), STAT_UnrealDR_PooledRegionBlocks, STATGROUP_UnrealDR);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Upload Region Pool Hit Rate"), STAT_UnrealDR_RegionPoolHitRate, STATGROUP_UnrealDR);
+
+FCameraTexturePool::~FCameraTexturePool()
+{
+	// Pending uploads hold a reference to the pool, so all region blocks have been returned at this point.
+	for (auto block : m_regionBlocks)
+		delete block;
+}
+
+UTexture2D* FCameraTexturePool::AcquireTexture(int32 width, int32 height, EPixelFormat format)
+{
+	check(IsInGameThread());
+
+	this->Trim();
+
+	// Reuse the most recently returned texture with a matching size and format.
+	UTexture2D* texture = nullptr;
+
+	for (int32 t = m_freeTextures.Num() - 1; t >= 0; --t)
+	{
+		UTexture2D* candidate = m_freeTextures[t].Texture;
+
+		if (candidate->GetSizeX() == width && candidate->GetSizeY() == height && candidate->GetPixelFormat() == format)
+		{
+			texture = candidate;
+			m_freeTextures.RemoveAt(t);
+			++m_textureHits;
+			break;
+		}
+	}
+
+	if (texture == nullptr)
+	{
+		texture = UTexture2D::CreateTransient(width, height, format, MakeUniqueObjectName(GetTransientPackage(), UTexture2D::StaticClass(), TEXT("CameraImage")));
+
+		if (texture == nullptr)
+		{
+			UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to create a %dx%d camera texture."), width, height);
+			return nullptr;
+		}
+
+		texture->UpdateResource();
+		++m_textureMisses;
+	}
+
+	m_usedTextures.Add(texture);
+	this->PublishStats();
+
+	return texture;
+}
+
+void FCameraTexturePool::ReleaseTexture(UTexture2D* texture)
+{
+	check(IsInGameThread());
+
+	if (texture == nullptr || m_usedTextures.RemoveSingleSwap(texture) == 0)
+		return;
+
+	m_freeTextures.Add({ texture, FPlatformTime::Seconds() });
+
+	// Release the oldest textures, if there are too many to keep.
+	if (m_freeTextures.Num() > MaxFreeTextures)
+		m_freeTextures.RemoveAt(0, m_freeTextures.Num() - MaxFreeTextures);
+
+	this->Trim();
+}
+
+FCameraUploadRegions* FCameraTexturePool::AcquireRegions(const FUpdateTextureRegion2D* regions, uint32 regionCount)
+{
+	FCameraUploadRegions* block = m_freeRegionBlocks.Pop();
+
+	if (block != nullptr)
+	{
+		m_regionHits.Increment();
+	}
+	else
+	{
+		block = new FCameraUploadRegions();
+		m_regionBlocks.Add(block);
+		m_regionMisses.Increment();
+	}
+
+	// The allocation of the block grows to the largest upload it has been used for, so that it does not need to grow again.
+	block->Regions.Reset();
+	block->Regions.Append(regions, static_cast<int32>(regionCount));
+
+	SET_DWORD_STAT(STAT_UnrealDR_PooledRegionBlocks, this->GetRegionBlockCount());
+	SET_FLOAT_STAT(STAT_UnrealDR_RegionPoolHitRate, this->GetRegionHitRate() * 100.f);
+
+	return block;
+}
+
+void FCameraTexturePool::ReleaseRegions(FCameraUploadRegions* block)
+{
+	if (block != nullptr)
+		m_freeRegionBlocks.Push(block);
+}
+
+void FCameraTexturePool::Trim(bool all)
+{
+	check(IsInGameThread());
+
+	// Free textures are sorted by the time they have been returned, so only the oldest ones need to be checked. Dropping the reference lets the garbage collector
+	// release them.
+	const double expiration = FPlatformTime::Seconds() - FreeTextureLifetime;
+	int32 expired = 0;
+
+	while (expired < m_freeTextures.Num() && (all || m_freeTextures[expired].ReleaseTime < expiration))
+		++expired;
+
+	if (expired > 0)
+		m_freeTextures.RemoveAt(0, expired);
+
+	this->PublishStats();
+}
+
+float FCameraTexturePool::GetTextureHitRate() const noexcept
+{
+	const uint32 requests = m_textureHits + m_textureMisses;
+	return requests > 0 ? static_cast<float>(m_textureHits) / requests : 0.f;
+}
+
+float FCameraTexturePool::GetRegionHitRate() const
+{
+	const int32 hits = m_regionHits.GetValue();
+	const int32 requests = hits + m_regionMisses.GetValue();
+	return requests > 0 ? static_cast<float>(hits) / requests : 0.f;
+}
+
+void FCameraTexturePool::PublishStats() const
+{
+	SET_DWORD_STAT(STAT_UnrealDR_PooledTextures, this->GetTextureCount());
+	SET_DWORD_STAT(STAT_UnrealDR_FreePooledTextures, this->GetFreeTextureCount());
+	SET_FLOAT_STAT(STAT_UnrealDR_TexturePoolHitRate, this->GetTextureHitRate() * 100.f);
+}
+
+void FCameraTexturePool::AddReferencedObjects(FReferenceCollector& collector)
+{
+	collector.AddReferencedObjects(m_usedTextures);
+
+	for (auto& freeTexture : m_freeTextures)
+		collector.AddReferencedObject(freeTexture.Texture);
+}
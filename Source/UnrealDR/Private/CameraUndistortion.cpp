@@ -0,0 +1,191 @@
+#include "CameraUndistortion.h"
+#include "UnrealDRSimd.h"
+#include <Async/ParallelFor.h>
+
+namespace
+{
+	/// <summary>
+	/// The color of target pixels that map outside of the source image (opaque black, in RGBA byte order).
+	/// </summary>
+	constexpr uint8 OutsideColor[4] = { 0, 0, 0, 255 };
+
+	/// <summary>
+	/// Interpolates between four RGBA pixels in 8 bit fixed point. The scalar and vector paths produce identical results.
+	/// </summary>
+	/// <param name="top">The top-left pixel. The top-right pixel follows directly.</param>
+	/// <param name="bottom">The bottom-left pixel. The bottom-right pixel follows directly.</param>
+	/// <param name="wx">The weight of the right pixels in the range `[0, 256]`.</param>
+	/// <param name="wy">The weight of the bottom pixels in the range `[0, 256]`.</param>
+	/// <param name="target">The target pixel.</param>
+	FORCEINLINE void InterpolateBilinear(const uint8* top, const uint8* bottom, uint32 wx, uint32 wy, uint8* target) noexcept
+	{
+#if UNREALDR_SIMD_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i weightsX = _mm_set_epi16(wx, wx, wx, wx, 256 - wx, 256 - wx, 256 - wx, 256 - wx);
+
+		// Weight the left and right pixel of each row and add them up. The result is at most 255 * 256 and therefore fits into 16 bits.
+		__m128i upper = _mm_mullo_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(top)), zero), weightsX);
+		__m128i lower = _mm_mullo_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(bottom)), zero), weightsX);
+		upper = _mm_srli_epi16(_mm_add_epi16(upper, _mm_srli_si128(upper, 8)), 8);
+		lower = _mm_srli_epi16(_mm_add_epi16(lower, _mm_srli_si128(lower, 8)), 8);
+
+		// Weight both rows and add them up.
+		const __m128i result = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(upper, _mm_set1_epi16(static_cast<int16>(256 - wy))), _mm_mullo_epi16(lower, _mm_set1_epi16(static_cast<int16>(wy)))), 8);
+		const int32 pixel = _mm_cvtsi128_si32(_mm_packus_epi16(result, result));
+		FMemory::Memcpy(target, &pixel, 4);
+#else
+		for (int32 c = 0; c < 4; ++c)
+		{
+			const uint32 upper = (top[c] * (256 - wx) + top[c + 4] * wx) >> 8;
+			const uint32 lower = (bottom[c] * (256 - wx) + bottom[c + 4] * wx) >> 8;
+			target[c] = static_cast<uint8>((upper * (256 - wy) + lower * wy) >> 8);
+		}
+#endif
+	}
+}
+
+bool FCameraRemapParameters::operator==(const FCameraRemapParameters& other) const noexcept
+{
+	return SourceWidth == other.SourceWidth && SourceHeight == other.SourceHeight && SourceFocalLength == other.SourceFocalLength && SourceCenter == other.SourceCenter &&
+		Distortion.Function == other.Distortion.Function && FMemory::Memcmp(Distortion.Coefficients, other.Distortion.Coefficients, sizeof(Distortion.Coefficients)) == 0 &&
+		TargetWidth == other.TargetWidth && TargetHeight == other.TargetHeight && TargetFocalLength == other.TargetFocalLength && TargetCenter == other.TargetCenter &&
+		TargetRotation == other.TargetRotation;
+}
+
+bool FCameraUndistortion::Build(const FCameraRemapParameters& parameters)
+{
+	if (this->IsValid() && parameters == m_parameters)
+		return true;
+
+	// Coordinates are stored in 16 bits and the interpolation reads two pixels in each direction.
+	if (parameters.SourceWidth < 2 || parameters.SourceHeight < 2 || parameters.SourceWidth >= MAX_uint16 || parameters.SourceHeight >= MAX_uint16 || parameters.TargetWidth == 0 || parameters.TargetHeight == 0)
+	{
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to build undistortion table for %dx%d to %dx%d pixels."), parameters.SourceWidth, parameters.SourceHeight, parameters.TargetWidth, parameters.TargetHeight);
+		m_table.Empty();
+		return false;
+	}
+
+	if (parameters.Distortion.Function == vr::VRDistortionFunctionType_Extended_FTheta)
+		UE_LOG(LOG_UNREAL_DR, Warning, TEXT("[UnrealDR] The extended f-theta distortion model is approximated by the f-theta model. Only the first four coefficients are used."));
+
+	m_parameters = parameters;
+	m_tilesX = FMath::DivideAndRoundUp(parameters.TargetWidth, TileSize);
+	m_tilesY = FMath::DivideAndRoundUp(parameters.TargetHeight, TileSize);
+	m_table.SetNumUninitialized(static_cast<int32>(m_tilesX * m_tilesY * TileSize * TileSize));
+
+	const float maxX = static_cast<float>(parameters.SourceWidth - 1);
+	const float maxY = static_cast<float>(parameters.SourceHeight - 1);
+
+	ParallelFor(static_cast<int32>(m_tilesY), [this, &parameters, maxX, maxY](int32 tileY) {
+		for (uint32 tileX = 0; tileX < m_tilesX; ++tileX)
+		{
+			FRemapEntry* tile = m_table.GetData() + (tileY * m_tilesX + tileX) * TileSize * TileSize;
+
+			for (uint32 y = 0; y < TileSize; ++y)
+			{
+				for (uint32 x = 0; x < TileSize; ++x)
+				{
+					FRemapEntry& entry = tile[y * TileSize + x];
+					entry = { MAX_uint16, 0, 0, 0 };
+
+					const uint32 targetX = tileX * TileSize + x;
+					const uint32 targetY = tileY * TileSize + y;
+
+					if (targetX >= parameters.TargetWidth || targetY >= parameters.TargetHeight)
+						continue;
+
+					// Project the pixel center onto the normalized image plane, rotate it into the source camera, apply the lens distortion and project it into the source
+					// image. Rays that point behind the source camera do not hit the source image.
+					const FVector ray = parameters.TargetRotation.TransformVector(FVector((targetX + 0.5f - parameters.TargetCenter.X) / parameters.TargetFocalLength.X, (targetY + 0.5f - parameters.TargetCenter.Y) / parameters.TargetFocalLength.Y, 1.f));
+
+					if (ray.Z <= SMALL_NUMBER)
+						continue;
+
+					const FVector2D distorted = Distort(parameters.Distortion, FVector2D(ray.X / ray.Z, ray.Y / ray.Z));
+					const float sourceX = distorted.X * parameters.SourceFocalLength.X + parameters.SourceCenter.X - 0.5f;
+					const float sourceY = distorted.Y * parameters.SourceFocalLength.Y + parameters.SourceCenter.Y - 0.5f;
+
+					if (!(sourceX >= 0.f && sourceX <= maxX && sourceY >= 0.f && sourceY <= maxY))
+						continue;
+
+					// Keep the right and bottom neighbor inside the image, by moving the last column or row into the weight.
+					const uint32 left = FMath::Min(static_cast<uint32>(sourceX), parameters.SourceWidth - 2);
+					const uint32 top = FMath::Min(static_cast<uint32>(sourceY), parameters.SourceHeight - 2);
+
+					entry.X = static_cast<uint16>(left);
+					entry.Y = static_cast<uint16>(top);
+					entry.WeightX = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt((sourceX - left) * 256.f), 0, 256));
+					entry.WeightY = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt((sourceY - top) * 256.f), 0, 256));
+				}
+			}
+		}
+	});
+
+	return true;
+}
+
+void FCameraUndistortion::Apply(const uint8* source, uint32 sourcePitch, uint8* target, uint32 targetPitch) const
+{
+	if (!this->IsValid())
+		return;
+
+	ParallelFor(static_cast<int32>(m_tilesY), [this, source, sourcePitch, target, targetPitch](int32 tileY) {
+		this->ApplyTileRow(source, sourcePitch, target, targetPitch, static_cast<uint32>(tileY));
+	});
+}
+
+void FCameraUndistortion::ApplyTileRow(const uint8* source, uint32 sourcePitch, uint8* target, uint32 targetPitch, uint32 tileY) const
+{
+	const uint32 height = FMath::Min(TileSize, m_parameters.TargetHeight - tileY * TileSize);
+
+	for (uint32 tileX = 0; tileX < m_tilesX; ++tileX)
+	{
+		const FRemapEntry* tile = m_table.GetData() + (tileY * m_tilesX + tileX) * TileSize * TileSize;
+		const uint32 width = FMath::Min(TileSize, m_parameters.TargetWidth - tileX * TileSize);
+
+		for (uint32 y = 0; y < height; ++y)
+		{
+			const FRemapEntry* entry = tile + y * TileSize;
+			uint8* pixel = target + static_cast<SIZE_T>(tileY * TileSize + y) * targetPitch + static_cast<SIZE_T>(tileX * TileSize) * 4;
+
+			for (uint32 x = 0; x < width; ++x, ++entry, pixel += 4)
+			{
+				if (entry->X == MAX_uint16)
+				{
+					FMemory::Memcpy(pixel, OutsideColor, 4);
+					continue;
+				}
+
+				const uint8* top = source + static_cast<SIZE_T>(entry->Y) * sourcePitch + static_cast<SIZE_T>(entry->X) * 4;
+				InterpolateBilinear(top, top + sourcePitch, entry->WeightX, entry->WeightY, pixel);
+			}
+		}
+	}
+}
+
+FVector2D FCameraUndistortion::Distort(const FCameraDistortion& distortion, const FVector2D& point) noexcept
+{
+	switch (distortion.Function)
+	{
+	case vr::VRDistortionFunctionType_FTheta:
+	case vr::VRDistortionFunctionType_Extended_FTheta:
+	{
+		// Equidistant fisheye model: theta_d = theta * (1 + k0 * theta^2 + k1 * theta^4 + k2 * theta^6 + k3 * theta^8).
+		const double radius = FMath::Sqrt(static_cast<double>(point.X) * point.X + static_cast<double>(point.Y) * point.Y);
+
+		if (radius < SMALL_NUMBER)
+			return point;
+
+		const double theta = FMath::Atan(radius);
+		const double theta2 = theta * theta;
+		const double* k = distortion.Coefficients;
+		const double thetaDistorted = theta * (1.0 + theta2 * (k[0] + theta2 * (k[1] + theta2 * (k[2] + theta2 * k[3]))));
+		const double scale = thetaDistorted / radius;
+
+		return FVector2D(static_cast<float>(point.X * scale), static_cast<float>(point.Y * scale));
+	}
+	case vr::VRDistortionFunctionType_None:
+	default:
+		return point;
+	}
+}
@@ -0,0 +1,99 @@
+#include "HmdPoseHistory.h"
+
+FHmdPoseHistory::FHmdPoseHistory(int32 capacity)
+{
+	m_poses.SetNum(FMath::Max(capacity, 2));
+}
+
+void FHmdPoseHistory::Add(double time, const FTransform& pose)
+{
+	// Ignore samples that would break the chronological order.
+	if (m_count > 0 && time < m_poses[(m_next + m_poses.Num() - 1) % m_poses.Num()].Time)
+		return;
+
+	FTimedPose& sample = m_poses[m_next];
+	sample.Time = time;
+	sample.Rotation = pose.GetRotation();
+	sample.Translation = pose.GetTranslation();
+
+	m_next = (m_next + 1) % m_poses.Num();
+	m_count = FMath::Min(m_count + 1, m_poses.Num());
+}
+
+bool FHmdPoseHistory::Sample(double time, FTransform& pose) const
+{
+	if (m_count == 0)
+		return false;
+
+	const int32 capacity = m_poses.Num();
+	const int32 oldest = (m_next + capacity - m_count) % capacity;
+	const int32 newest = (m_next + capacity - 1) % capacity;
+
+	// Clamp to the recorded range.
+	if (time >= m_poses[newest].Time)
+	{
+		pose = FTransform(m_poses[newest].Rotation, m_poses[newest].Translation);
+		return true;
+	}
+
+	if (time <= m_poses[oldest].Time)
+	{
+		pose = FTransform(m_poses[oldest].Rotation, m_poses[oldest].Translation);
+		return true;
+	}
+
+	// Search backwards, since recent poses are requested most of the time.
+	int32 later = newest;
+
+	for (int32 i = 1; i < m_count; ++i)
+	{
+		const int32 earlier = (newest + capacity - i) % capacity;
+
+		if (m_poses[earlier].Time <= time)
+		{
+			const FTimedPose& a = m_poses[earlier];
+			const FTimedPose& b = m_poses[later];
+			const double span = b.Time - a.Time;
+			const float alpha = span > 0.0 ? static_cast<float>((time - a.Time) / span) : 1.f;
+
+			pose = FTransform(FQuat::Slerp(a.Rotation, b.Rotation, alpha), FMath::Lerp(a.Translation, b.Translation, alpha));
+			return true;
+		}
+
+		later = earlier;
+	}
+
+	pose = FTransform(m_poses[oldest].Rotation, m_poses[oldest].Translation);
+	return true;
+}
+
+void FHmdPoseHistory::Reset() noexcept
+{
+	m_next = 0;
+	m_count = 0;
+}
+
+FTransform FHmdPoseHistory::ConvertPose(const vr::HmdMatrix34_t& deviceToTracking, float worldToMeters) noexcept
+{
+	// OpenVR matrices transform column vectors, Unreal Engine matrices transform row vectors.
+	const FMatrix pose(
+		FPlane(deviceToTracking.m[0][0], deviceToTracking.m[1][0], deviceToTracking.m[2][0], 0.f),
+		FPlane(deviceToTracking.m[0][1], deviceToTracking.m[1][1], deviceToTracking.m[2][1], 0.f),
+		FPlane(deviceToTracking.m[0][2], deviceToTracking.m[1][2], deviceToTracking.m[2][2], 0.f),
+		FPlane(deviceToTracking.m[0][3], deviceToTracking.m[1][3], deviceToTracking.m[2][3], 1.f));
+
+	// Swap the axes and flip handedness.
+	FQuat rotation(pose);
+	rotation = FQuat(-rotation.Z, rotation.X, rotation.Y, -rotation.W);
+	rotation.Normalize();
+
+	const FVector translation = FVector(-pose.M[3][2], pose.M[3][0], pose.M[3][1]) * worldToMeters;
+
+	return FTransform(rotation, translation);
+}
+
+FTransform FHmdPoseHistory::ComputeReprojection(const FTransform& capturePose, const FTransform& displayPose) noexcept
+{
+	// Capture head space -> tracking space -> display head space.
+	return capturePose * displayPose.Inverse();
+}
@@ -0,0 +1,215 @@
+#include "OpenVRCameraFrameSource.h"
+
+FOpenVRCameraFrameSource::FOpenVRCameraFrameSource(vr::IVRSystem* system, vr::IVRTrackedCamera* camera, vr::TrackedDeviceIndex_t device, vr::EVRTrackedCameraFrameType frameType) :
+	m_system(system), m_camera(camera), m_device(device), m_frameType(frameType)
+{
+}
+
+FOpenVRCameraFrameSource::~FOpenVRCameraFrameSource()
+{
+	this->Release();
+}
+
+FCameraFrameSourcePtr FOpenVRCameraFrameSource::Create(vr::IVRSystem* system, vr::TrackedDeviceIndex_t device, vr::EVRTrackedCameraFrameType frameType)
+{
+	if (system == nullptr)
+	{
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] VR System is not initialized. Make sure the VR HMD is turned on and SteamVR has been launched."));
+		return nullptr;
+	}
+
+	// Get a tracked camera interface.
+	auto camera = vr::VRTrackedCamera();
+
+	if (camera == nullptr)
+	{
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to retrieve HMD camera interface."));
+		return nullptr;
+	}
+
+	// Check if a camera is available.
+	bool hasCamera{ false };
+	auto cameraError = camera->HasCamera(device, &hasCamera);
+
+	if (cameraError != vr::EVRTrackedCameraError::VRTrackedCameraError_None)
+	{
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to retrieve camera: %d."), cameraError);
+		return nullptr;
+	}
+	else if (!hasCamera)
+	{
+		UE_LOG(LOG_UNREAL_DR, Warning, TEXT("[UnrealDR] The tracked device %u does not provide camera access."), device);
+		return nullptr;
+	}
+
+	return MakeShared<FOpenVRCameraFrameSource, ESPMode::ThreadSafe>(system, camera, device, frameType);
+}
+
+void FOpenVRCameraFrameSource::EnumerateDevices(vr::IVRSystem* system, TArray<FCameraDeviceInfo>& devices)
+{
+	devices.Reset();
+
+	if (system == nullptr)
+		return;
+
+	auto camera = vr::VRTrackedCamera();
+
+	if (camera == nullptr)
+		return;
+
+	for (vr::TrackedDeviceIndex_t device = 0; device < vr::k_unMaxTrackedDeviceCount; ++device)
+	{
+		bool hasCamera{ false };
+
+		if (!system->IsTrackedDeviceConnected(device) || camera->HasCamera(device, &hasCamera) != vr::VRTrackedCameraError_None || !hasCamera)
+			continue;
+
+		FCameraDeviceInfo& info = devices.AddDefaulted_GetRef();
+		info.DeviceIndex = static_cast<int32>(device);
+		info.Serial = GetStringProperty(system, device, vr::Prop_SerialNumber_String);
+		info.Model = GetStringProperty(system, device, vr::Prop_ModelNumber_String);
+		info.bIsHmd = system->GetTrackedDeviceClass(device) == vr::TrackedDeviceClass_HMD;
+
+		uint32_t width, height, frameBufferSize;
+
+		if (camera->GetCameraFrameSize(device, vr::VRTrackedCameraFrameType_Undistorted, &width, &height, &frameBufferSize) == vr::VRTrackedCameraError_None)
+			info.FrameSize = FIntPoint(static_cast<int32>(width), static_cast<int32>(height));
+	}
+}
+
+FString FOpenVRCameraFrameSource::GetStringProperty(vr::IVRSystem* system, vr::TrackedDeviceIndex_t device, vr::ETrackedDeviceProperty property)
+{
+	char value[vr::k_unMaxPropertyStringSize];
+	vr::ETrackedPropertyError error;
+
+	if (system == nullptr || system->GetStringTrackedDeviceProperty(device, property, value, sizeof(value), &error) == 0 || error != vr::TrackedProp_Success)
+		return FString();
+
+	return FString(UTF8_TO_TCHAR(value));
+}
+
+vr::TrackedDeviceIndex_t FOpenVRCameraFrameSource::FindDevice(vr::IVRSystem* system, const FString& serial)
+{
+	if (system == nullptr)
+		return vr::k_unTrackedDeviceIndexInvalid;
+
+	for (vr::TrackedDeviceIndex_t device = 0; device < vr::k_unMaxTrackedDeviceCount; ++device)
+	{
+		if (system->IsTrackedDeviceConnected(device) && GetStringProperty(system, device, vr::Prop_SerialNumber_String) == serial)
+			return device;
+	}
+
+	return vr::k_unTrackedDeviceIndexInvalid;
+}
+
+bool FOpenVRCameraFrameSource::GetFrameSize(uint32_t& width, uint32_t& height, uint32_t& frameBufferSize) const
+{
+	if (m_camera->GetCameraFrameSize(m_device, m_frameType, &width, &height, &frameBufferSize) != vr::VRTrackedCameraError_None)
+	{
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to request front camera frame buffer bounds."));
+		return false;
+	}
+
+	return true;
+}
+
+bool FOpenVRCameraFrameSource::GetIntrinsics(vr::EVREye eye, vr::HmdVector2_t& focalLength, vr::HmdVector2_t& center) const
+{
+	auto intrinsicsError = m_camera->GetCameraIntrinsics(m_device, eye, m_frameType, &focalLength, &center);
+
+	if (intrinsicsError != vr::EVRTrackedCameraError::VRTrackedCameraError_None)
+	{
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to get intristics for camera %d: %d."), static_cast<int>(eye), intrinsicsError);
+		return false;
+	}
+
+	return true;
+}
+
+bool FOpenVRCameraFrameSource::GetExtrinsics(vr::HmdMatrix34_t (&cameraToHead)[2]) const
+{
+	vr::ETrackedPropertyError extrinsicsError;
+
+	if (m_system->GetArrayTrackedDeviceProperty(m_device, vr::Prop_CameraToHeadTransforms_Matrix34_Array, vr::k_unHmdMatrix34PropertyTag, cameraToHead, sizeof(cameraToHead), &extrinsicsError) == 0 || extrinsicsError != vr::ETrackedPropertyError::TrackedProp_Success)
+	{
+		UE_LOG(LOG_UNREAL_DR, Warning, TEXT("[UnrealDR] Unable to request camera extrinsic calibration matrices: %d."), extrinsicsError);
+		return false;
+	}
+
+	return true;
+}
+
+bool FOpenVRCameraFrameSource::Acquire()
+{
+	if (this->IsAcquired())
+		return true;
+
+	// Get a tracked camera handle.
+	m_camera->AcquireVideoStreamingService(m_device, &m_trackedCamera);
+
+	return this->IsAcquired();
+}
+
+void FOpenVRCameraFrameSource::Release()
+{
+	if (!this->IsAcquired())
+		return;
+
+	m_camera->ReleaseVideoStreamingService(m_trackedCamera);
+	m_trackedCamera = INVALID_TRACKED_CAMERA_HANDLE;
+}
+
+bool FOpenVRCameraFrameSource::GetNextFrame(uint32_t lastFrameSequence, uint8_t* buffer, uint32_t bufferSize, vr::CameraVideoStreamFrameHeader_t& header)
+{
+	if (!this->IsAcquired())
+		return false;
+
+	// Check frame buffer header for updates.
+	vr::EVRTrackedCameraError error = m_camera->GetVideoStreamFrameBuffer(m_trackedCamera, m_frameType, nullptr, 0, &header, sizeof(header));
+
+	if (error != vr::VRTrackedCameraError_None || header.nFrameSequence == lastFrameSequence)
+		return false;
+	else if (buffer == nullptr)
+		return true;
+
+	// Copy frame buffer.
+	error = m_camera->GetVideoStreamFrameBuffer(m_trackedCamera, m_frameType, buffer, bufferSize, &header, sizeof(header));
+
+	if (error != vr::VRTrackedCameraError_None)
+	{
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to copy front camera video stream frame buffer: %d."), error);
+		return false;
+	}
+
+	return true;
+}
+
+bool FOpenVRCameraFrameSource::GetDistortion(vr::EVREye eye, FCameraDistortion& distortion) const
+{
+	distortion = FCameraDistortion();
+
+	// The runtime already removes the distortion from undistorted frames.
+	if (m_frameType != vr::VRTrackedCameraFrameType_Distorted)
+		return true;
+
+	// Both properties store the values of all cameras of the device consecutively.
+	int32_t functions[vr::k_unMaxCameras]{};
+	float coefficients[vr::k_unMaxCameras * vr::k_unMaxDistortionFunctionParameters]{};
+	vr::ETrackedPropertyError functionError, coefficientError;
+
+	m_system->GetArrayTrackedDeviceProperty(m_device, vr::Prop_CameraDistortionFunction_Int32_Array, vr::k_unInt32PropertyTag, functions, sizeof(functions), &functionError);
+	m_system->GetArrayTrackedDeviceProperty(m_device, vr::Prop_CameraDistortionCoefficients_Float_Array, vr::k_unFloatPropertyTag, coefficients, sizeof(coefficients), &coefficientError);
+
+	if (functionError != vr::ETrackedPropertyError::TrackedProp_Success || coefficientError != vr::ETrackedPropertyError::TrackedProp_Success)
+	{
+		UE_LOG(LOG_UNREAL_DR, Warning, TEXT("[UnrealDR] Unable to request camera distortion for camera %d: %d, %d."), static_cast<int>(eye), functionError, coefficientError);
+		return false;
+	}
+
+	distortion.Function = static_cast<vr::EVRDistortionFunctionType>(functions[eye]);
+
+	for (uint32_t i = 0; i < vr::k_unMaxDistortionFunctionParameters; ++i)
+		distortion.Coefficients[i] = coefficients[eye * vr::k_unMaxDistortionFunctionParameters + i];
+
+	return true;
+}
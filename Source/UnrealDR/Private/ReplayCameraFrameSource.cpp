@@ -0,0 +1,221 @@
+#include "ReplayCameraFrameSource.h"
+#include <Async/MappedFileHandle.h>
+#include <HAL/PlatformFilemanager.h>
+#include <HAL/PlatformTime.h>
+#include <Misc/Compression.h>
+#include <Algo/BinarySearch.h>
+
+FReplayCameraFrameSource::FReplayCameraFrameSource(const FString& fileName, float playbackRate, bool loop) :
+	m_fileName(fileName), m_playbackRate(FMath::Max(playbackRate, 0.f)), m_loop(loop)
+{
+}
+
+FReplayCameraFrameSource::~FReplayCameraFrameSource()
+{
+	m_mappedRegion.Reset();
+	m_mappedFile.Reset();
+}
+
+FCameraFrameSourcePtr FReplayCameraFrameSource::Create(const FString& fileName, float playbackRate, bool loop)
+{
+	auto source = MakeShared<FReplayCameraFrameSource, ESPMode::ThreadSafe>(fileName, playbackRate, loop);
+	return source->Open() ? source : nullptr;
+}
+
+bool FReplayCameraFrameSource::Open()
+{
+	m_mappedFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*m_fileName));
+
+	if (!m_mappedFile.IsValid())
+	{
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to open camera stream capture file \"%s\"."), *m_fileName);
+		return false;
+	}
+
+	const int64 fileSize = m_mappedFile->GetFileSize();
+
+	if (fileSize < static_cast<int64>(sizeof(FCameraStreamFileHeader) + sizeof(FCameraStreamFileFooter)))
+	{
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Camera stream capture file \"%s\" is truncated."), *m_fileName);
+		return false;
+	}
+
+	m_mappedRegion.Reset(m_mappedFile->MapRegion(0, fileSize));
+
+	if (!m_mappedRegion.IsValid())
+	{
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to map camera stream capture file \"%s\"."), *m_fileName);
+		return false;
+	}
+
+	// Validate header and footer.
+	const uint8* data = m_mappedRegion->GetMappedPtr();
+	FMemory::Memcpy(&m_header, data, sizeof(m_header));
+
+	FCameraStreamFileFooter footer;
+	FMemory::Memcpy(&footer, data + fileSize - sizeof(footer), sizeof(footer));
+
+	if (m_header.Magic != UnrealDR::CameraStream::FileMagic || m_header.Version != UnrealDR::CameraStream::FileVersion || footer.Magic != UnrealDR::CameraStream::FileMagic)
+	{
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] \"%s\" is not a valid camera stream capture file or has not been finalized."), *m_fileName);
+		return false;
+	}
+
+	const uint64 indexSize = static_cast<uint64>(footer.FrameCount) * sizeof(FCameraStreamIndexEntry);
+
+	if (m_header.FrameBufferSize == 0 || footer.FrameCount == 0 || footer.FrameCount > static_cast<uint32>(MAX_int32) || footer.IndexOffset < sizeof(m_header) || footer.IndexOffset > static_cast<uint64>(fileSize) ||
+		footer.IndexOffset + indexSize + sizeof(footer) != static_cast<uint64>(fileSize))
+	{
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Camera stream capture file \"%s\" does not contain a valid frame index."), *m_fileName);
+		return false;
+	}
+
+	// Copy the index, since its offset within the file is not necessarily aligned for the entries.
+	m_index.SetNumUninitialized(static_cast<int32>(footer.FrameCount));
+	FMemory::Memcpy(m_index.GetData(), data + footer.IndexOffset, indexSize);
+
+	// Validate every entry once, so that frames can be decoded without further checks. Frames are stored between the header and the index, uncompressed frames
+	// have the size of a frame buffer, and capture times must not decrease, since frames are looked up by them.
+	for (int32 i = 0; i < m_index.Num(); ++i)
+	{
+		const FCameraStreamIndexEntry& entry = m_index[i];
+		const bool validSize = entry.Compressed ? entry.StoredSize > 0 && entry.StoredSize <= static_cast<uint32>(MAX_int32) : entry.StoredSize == m_header.FrameBufferSize;
+		const bool validOffset = entry.Offset >= sizeof(m_header) && entry.Offset <= footer.IndexOffset && entry.StoredSize <= footer.IndexOffset - entry.Offset;
+
+		if (!validSize || !validOffset || (i > 0 && entry.CaptureTime < m_index[i - 1].CaptureTime))
+		{
+			UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Frame %d of camera stream capture file \"%s\" is corrupted."), i, *m_fileName);
+			m_index.Empty();
+			return false;
+		}
+	}
+
+	m_frameCount = footer.FrameCount;
+
+	return true;
+}
+
+bool FReplayCameraFrameSource::DecodeFrame(uint32 frameIndex, uint8_t* buffer, uint32_t bufferSize, vr::CameraVideoStreamFrameHeader_t& header) const
+{
+	if (frameIndex >= m_frameCount)
+		return false;
+
+	const FCameraStreamIndexEntry& entry = m_index[frameIndex];
+	header = entry.Header;
+
+	if (buffer == nullptr)
+		return true;
+	else if (bufferSize < m_header.FrameBufferSize)
+		return false;
+
+	const uint8* frameData = m_mappedRegion->GetMappedPtr() + entry.Offset;
+
+	if (!entry.Compressed)
+	{
+		FMemory::Memcpy(buffer, frameData, m_header.FrameBufferSize);
+		return true;
+	}
+	else if (!FCompression::UncompressMemory(NAME_LZ4, buffer, static_cast<int32>(m_header.FrameBufferSize), frameData, static_cast<int32>(entry.StoredSize)))
+	{
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to decompress frame %d of camera stream capture file \"%s\"."), frameIndex, *m_fileName);
+		return false;
+	}
+
+	return true;
+}
+
+bool FReplayCameraFrameSource::GetFrameSize(uint32_t& width, uint32_t& height, uint32_t& frameBufferSize) const
+{
+	width = m_header.FrameWidth;
+	height = m_header.FrameHeight;
+	frameBufferSize = m_header.FrameBufferSize;
+
+	return m_frameCount > 0;
+}
+
+bool FReplayCameraFrameSource::GetIntrinsics(vr::EVREye eye, vr::HmdVector2_t& focalLength, vr::HmdVector2_t& center) const
+{
+	focalLength = m_header.FocalLength[eye];
+	center = m_header.Center[eye];
+
+	return m_frameCount > 0;
+}
+
+bool FReplayCameraFrameSource::GetExtrinsics(vr::HmdMatrix34_t (&cameraToHead)[2]) const
+{
+	cameraToHead[vr::Eye_Left] = m_header.CameraToHead[vr::Eye_Left];
+	cameraToHead[vr::Eye_Right] = m_header.CameraToHead[vr::Eye_Right];
+
+	return m_frameCount > 0;
+}
+
+bool FReplayCameraFrameSource::Acquire()
+{
+	if (m_frameCount == 0)
+		return false;
+
+	// The frame is reset before the start time is published, so that the capture thread never sees an acquired source with the frame of a previous replay.
+	if (!this->IsAcquired())
+	{
+		m_currentFrame.Set(-1);
+		m_startCycles.Set(static_cast<int64>(FPlatformTime::Cycles64()));
+	}
+
+	return true;
+}
+
+void FReplayCameraFrameSource::Release()
+{
+	m_startCycles.Set(-1);
+}
+
+bool FReplayCameraFrameSource::GetNextFrame(uint32_t lastFrameSequence, uint8_t* buffer, uint32_t bufferSize, vr::CameraVideoStreamFrameHeader_t& header)
+{
+	const int64 startCycles = m_startCycles.GetValue();
+
+	if (startCycles < 0)
+		return false;
+
+	// Find the frame to replay. Frames are counted continuously across loops.
+	const int64 currentFrame = m_currentFrame.GetValue();
+	int64 frame;
+
+	if (m_playbackRate <= 0.f)
+	{
+		frame = currentFrame + 1;
+	}
+	else
+	{
+		// Replay the frames at the times they have been captured.
+		const double firstCaptureTime = m_index[0].CaptureTime;
+		const double frameInterval = m_frameCount > 1 ? (m_index[m_frameCount - 1].CaptureTime - firstCaptureTime) / (m_frameCount - 1) : 1.0;
+		const double duration = m_index[m_frameCount - 1].CaptureTime - firstCaptureTime + frameInterval;
+		double elapsed = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - static_cast<uint64>(startCycles)) * m_playbackRate;
+		int64 loop = 0;
+
+		if (m_loop)
+		{
+			loop = static_cast<int64>(elapsed / duration);
+			elapsed -= loop * duration;
+		}
+
+		// Find the last frame that has been captured before the elapsed time.
+		const int32 next = Algo::UpperBoundBy(m_index, firstCaptureTime + elapsed, [](const FCameraStreamIndexEntry& entry) { return entry.CaptureTime; });
+		frame = loop * m_frameCount + FMath::Max(next - 1, 0);
+	}
+
+	if (!m_loop && frame >= m_frameCount)
+		return false;
+
+	if (frame == currentFrame)
+		return false;
+
+	if (!this->DecodeFrame(static_cast<uint32>(frame % m_frameCount), buffer, bufferSize, header))
+		return false;
+
+	// Renumber the frames, so that sequence numbers keep increasing when looping.
+	header.nFrameSequence = static_cast<uint32_t>(frame + 1);
+	m_currentFrame.Set(frame);
+
+	return header.nFrameSequence != lastFrameSequence;
+}
@@ -0,0 +1,149 @@
+#include "SyntheticCameraFrameSource.h"
+#include <HAL/PlatformTime.h>
+
+namespace
+{
+	/// <summary>
+	/// The size of a checkerboard square in pixels. The pattern repeats after two squares.
+	/// </summary>
+	constexpr uint32_t SquareSize = 32;
+	constexpr uint32_t PatternPeriod = SquareSize * 2;
+
+	/// <summary>
+	/// The distance (in pixels) the pattern is scrolled between two frames.
+	/// </summary>
+	constexpr uint32_t ScrollSpeed = 4;
+
+	/// <summary>
+	/// The horizontal offset (in pixels) of the right eye image.
+	/// </summary>
+	constexpr uint32_t Disparity = 8;
+
+	/// <summary>
+	/// Half the distance (in meters) between both virtual cameras.
+	/// </summary>
+	constexpr float HalfBaseline = 0.0325f;
+}
+
+FSyntheticCameraFrameSource::FSyntheticCameraFrameSource(uint32_t eyeWidth, uint32_t eyeHeight, float frameRate, float fieldOfView) :
+	m_eyeWidth(eyeWidth), m_eyeHeight(eyeHeight), m_frameRate(FMath::Max(frameRate, 1.f)), m_fieldOfView(FMath::Clamp(fieldOfView, 1.f, 179.f))
+{
+	// Pre-compute the pattern, so that generating a frame only requires copying rows.
+	const uint32_t patternWidth = m_eyeWidth + PatternPeriod;
+	m_pattern.SetNumUninitialized(patternWidth * m_eyeHeight * 4);
+
+	for (uint32_t y = 0; y < m_eyeHeight; ++y)
+	{
+		uint8* row = m_pattern.GetData() + y * patternWidth * 4;
+
+		for (uint32_t x = 0; x < patternWidth; ++x)
+		{
+			const bool white = ((x / SquareSize) + (y / SquareSize)) % 2 == 0;
+			row[x * 4 + 0] = static_cast<uint8>((x % m_eyeWidth) * 255 / FMath::Max(m_eyeWidth - 1, 1u));
+			row[x * 4 + 1] = static_cast<uint8>(y * 255 / FMath::Max(m_eyeHeight - 1, 1u));
+			row[x * 4 + 2] = white ? 255 : 32;
+			row[x * 4 + 3] = 255;
+		}
+	}
+}
+
+void FSyntheticCameraFrameSource::GenerateFrame(uint32_t frameSequence, uint8_t* buffer) const
+{
+	const uint32_t patternWidth = m_eyeWidth + PatternPeriod;
+	const uint32_t rowPitch = m_eyeWidth * 4;
+	const uint32_t scroll = (frameSequence * ScrollSpeed) % PatternPeriod;
+
+	// The right eye image is stored in the upper half, the left eye image in the lower half of the frame.
+	for (uint32_t y = 0; y < m_eyeHeight; ++y)
+	{
+		const uint8* row = m_pattern.GetData() + y * patternWidth * 4;
+		FMemory::Memcpy(buffer + y * rowPitch, row + ((scroll + Disparity) % PatternPeriod) * 4, rowPitch);
+		FMemory::Memcpy(buffer + (m_eyeHeight + y) * rowPitch, row + scroll * 4, rowPitch);
+	}
+}
+
+double FSyntheticCameraFrameSource::GetExposureTime(uint32_t frameSequence) const noexcept
+{
+	if (!this->IsAcquired() || frameSequence == 0)
+		return 0.0;
+
+	return m_startTime + static_cast<double>(frameSequence - 1) / m_frameRate;
+}
+
+bool FSyntheticCameraFrameSource::GetFrameSize(uint32_t& width, uint32_t& height, uint32_t& frameBufferSize) const
+{
+	width = m_eyeWidth;
+	height = m_eyeHeight * 2;
+	frameBufferSize = width * height * 4;
+
+	return width > 0 && height > 0;
+}
+
+bool FSyntheticCameraFrameSource::GetIntrinsics(vr::EVREye eye, vr::HmdVector2_t& focalLength, vr::HmdVector2_t& center) const
+{
+	const float focal = (static_cast<float>(m_eyeWidth) / 2.f) / FMath::Tan(FMath::DegreesToRadians(m_fieldOfView) / 2.f);
+
+	focalLength.v[0] = focalLength.v[1] = focal;
+	center.v[0] = static_cast<float>(m_eyeWidth) / 2.f;
+	center.v[1] = static_cast<float>(m_eyeHeight) / 2.f;
+
+	return true;
+}
+
+bool FSyntheticCameraFrameSource::GetExtrinsics(vr::HmdMatrix34_t (&cameraToHead)[2]) const
+{
+	for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+	{
+		cameraToHead[e] = vr::HmdMatrix34_t{ {
+			{ 1.f, 0.f, 0.f, e == vr::Eye_Left ? -HalfBaseline : HalfBaseline },
+			{ 0.f, 1.f, 0.f, 0.f },
+			{ 0.f, 0.f, 1.f, 0.f }
+		} };
+	}
+
+	return true;
+}
+
+bool FSyntheticCameraFrameSource::Acquire()
+{
+	if (!this->IsAcquired())
+		m_startTime = FPlatformTime::Seconds();
+
+	return true;
+}
+
+void FSyntheticCameraFrameSource::Release()
+{
+	m_startTime = -1.0;
+}
+
+bool FSyntheticCameraFrameSource::GetNextFrame(uint32_t lastFrameSequence, uint8_t* buffer, uint32_t bufferSize, vr::CameraVideoStreamFrameHeader_t& header)
+{
+	if (!this->IsAcquired() || (buffer != nullptr && bufferSize < m_eyeWidth * m_eyeHeight * 8))
+		return false;
+
+	// The sequence number only depends on the time since the source has been acquired.
+	const uint32_t frameSequence = static_cast<uint32_t>((FPlatformTime::Seconds() - m_startTime) * m_frameRate) + 1;
+
+	if (frameSequence == lastFrameSequence)
+		return false;
+
+	if (buffer != nullptr)
+		this->GenerateFrame(frameSequence, buffer);
+
+	header = vr::CameraVideoStreamFrameHeader_t{};
+	header.eFrameType = vr::VRTrackedCameraFrameType_Undistorted;
+	header.nWidth = m_eyeWidth;
+	header.nHeight = m_eyeHeight * 2;
+	header.nBytesPerPixel = 4;
+	header.nFrameSequence = frameSequence;
+
+	// The virtual cameras never move.
+	auto& pose = header.standingTrackedDevicePose;
+	pose.mDeviceToAbsoluteTracking = vr::HmdMatrix34_t{ { { 1.f, 0.f, 0.f, 0.f }, { 0.f, 1.f, 0.f, 0.f }, { 0.f, 0.f, 1.f, 0.f } } };
+	pose.eTrackingResult = vr::TrackingResult_Running_OK;
+	pose.bPoseIsValid = true;
+	pose.bDeviceIsConnected = true;
+
+	return true;
+}
@@ -0,0 +1,113 @@
+#include "UndistortedCameraFrameSource.h"
+
+DECLARE_CYCLE_STAT(TEXT("Frame Undistortion"), STAT_UnrealDR_FrameUndistortion, STATGROUP_UnrealDR);
+
+FUndistortedCameraFrameSource::FUndistortedCameraFrameSource(FCameraFrameSourcePtr source, uint32_t eyeWidth, uint32_t eyeHeight, float fieldOfView) :
+	m_source(source), m_eyeWidth(eyeWidth), m_eyeHeight(eyeHeight), m_fieldOfView(FMath::Clamp(fieldOfView, 1.f, 179.f))
+{
+}
+
+FCameraFrameSourcePtr FUndistortedCameraFrameSource::Create(FCameraFrameSourcePtr source, uint32_t eyeWidth, uint32_t eyeHeight, float fieldOfView)
+{
+	if (!source.IsValid())
+		return nullptr;
+
+	return MakeShared<FUndistortedCameraFrameSource, ESPMode::ThreadSafe>(source, eyeWidth, eyeHeight, fieldOfView);
+}
+
+bool FUndistortedCameraFrameSource::BuildRemapTables()
+{
+	uint32_t sourceBufferSize;
+
+	if (!m_source->GetFrameSize(m_sourceWidth, m_sourceHeight, sourceBufferSize))
+		return false;
+
+	m_sourceBuffer.SetNumUninitialized(sourceBufferSize);
+
+	for (int e = vr::Eye_Left; e <= vr::Eye_Right; ++e)
+	{
+		auto eye = static_cast<vr::EVREye>(e);
+
+		FCameraRemapParameters parameters;
+		vr::HmdVector2_t focalLength, center;
+
+		if (!m_source->GetIntrinsics(eye, focalLength, center) || !m_source->GetDistortion(eye, parameters.Distortion))
+			return false;
+
+		parameters.SourceWidth = m_sourceWidth;
+		parameters.SourceHeight = m_sourceHeight / 2;
+		parameters.SourceFocalLength = FVector2D(focalLength.v[0], focalLength.v[1]);
+		parameters.SourceCenter = FVector2D(center.v[0], center.v[1]);
+
+		this->GetIntrinsics(eye, focalLength, center);
+		parameters.TargetWidth = m_eyeWidth;
+		parameters.TargetHeight = m_eyeHeight;
+		parameters.TargetFocalLength = FVector2D(focalLength.v[0], focalLength.v[1]);
+		parameters.TargetCenter = FVector2D(center.v[0], center.v[1]);
+
+		// Only re-builds the table, if the calibration has changed.
+		if (!m_undistortion[e].Build(parameters))
+			return false;
+	}
+
+	return true;
+}
+
+bool FUndistortedCameraFrameSource::GetFrameSize(uint32_t& width, uint32_t& height, uint32_t& frameBufferSize) const
+{
+	width = m_eyeWidth;
+	height = m_eyeHeight * 2;
+	frameBufferSize = width * height * 4;
+
+	return width > 0 && height > 0;
+}
+
+bool FUndistortedCameraFrameSource::GetIntrinsics(vr::EVREye eye, vr::HmdVector2_t& focalLength, vr::HmdVector2_t& center) const
+{
+	// The undistorted images use a pinhole projection with square pixels, centered in the image.
+	const float focal = static_cast<float>(m_eyeWidth) / 2.f / FMath::Tan(FMath::DegreesToRadians(m_fieldOfView) / 2.f);
+	focalLength.v[0] = focalLength.v[1] = focal;
+	center.v[0] = static_cast<float>(m_eyeWidth) / 2.f;
+	center.v[1] = static_cast<float>(m_eyeHeight) / 2.f;
+
+	return true;
+}
+
+bool FUndistortedCameraFrameSource::Acquire()
+{
+	if (!m_source->Acquire())
+		return false;
+
+	if (!this->BuildRemapTables())
+	{
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to undistort frames from the %s source."), m_source->GetName());
+		m_source->Release();
+		return false;
+	}
+
+	return true;
+}
+
+bool FUndistortedCameraFrameSource::GetNextFrame(uint32_t lastFrameSequence, uint8_t* buffer, uint32_t bufferSize, vr::CameraVideoStreamFrameHeader_t& header)
+{
+	if (buffer == nullptr)
+		return m_source->GetNextFrame(lastFrameSequence, nullptr, 0, header);
+
+	if (bufferSize < m_eyeWidth * m_eyeHeight * 2 * 4 || !m_source->GetNextFrame(lastFrameSequence, m_sourceBuffer.GetData(), static_cast<uint32_t>(m_sourceBuffer.Num()), header))
+		return false;
+
+	SCOPE_CYCLE_COUNTER(STAT_UnrealDR_FrameUndistortion);
+
+	// The right eye image is stored in the upper half, the left eye image in the lower half of both frames.
+	const uint32 sourcePitch = m_sourceWidth * 4;
+	const uint32 targetPitch = m_eyeWidth * 4;
+
+	m_undistortion[vr::Eye_Right].Apply(m_sourceBuffer.GetData(), sourcePitch, buffer, targetPitch);
+	m_undistortion[vr::Eye_Left].Apply(m_sourceBuffer.GetData() + (m_sourceHeight / 2) * sourcePitch, sourcePitch, buffer + m_eyeHeight * targetPitch, targetPitch);
+
+	header.eFrameType = vr::VRTrackedCameraFrameType_Undistorted;
+	header.nWidth = m_eyeWidth;
+	header.nHeight = m_eyeHeight * 2;
+
+	return true;
+}
@@ -1,48 +1,238 @@
 #include "UnrealDR.h"
+#include "CameraStreamHub.h"
+#include <Async/Async.h>
+#include <Containers/Ticker.h>
+#include <HAL/PlatformTime.h>
+#include <Misc/ScopeLock.h>
 
 #define LOCTEXT_NAMESPACE "FUnrealDRModule"
 
+namespace
+{
+	/// <summary>
+	/// The time (in seconds) after which a failed initialization of the VR system is retried, when the system is requested again.
+	/// </summary>
+	constexpr double InitializationRetryInterval = 5.0;
+}
+
 void FUnrealDRModule::StartupModule()
+{
+	// Create the hub that shares camera streams between components. Its streams acquire their textures from a pool, which keeps them across streams.
+	m_streamHub = MakeUnique<FCameraStreamHub>(MakeShared<FCameraTexturePool, ESPMode::ThreadSafe>());
+
+	// The VR system is not initialized here, since this can take a long time, if SteamVR is slow to respond or not installed. Instead, it is initialized on a
+	// background thread, when a component requests it for the first time.
+}
+
+void FUnrealDRModule::ShutdownModule()
+{
+	// Release the hub before the VR system, so that no stream outlives it. Pending uploads keep the texture pool alive, until they are finished.
+	m_streamHub->GetTexturePool()->Trim(true);
+	m_streamHub.Reset();
+
+	// Stop retrying a failed initialization and wait for a pending one, before unloading OpenVR.
+	if (m_retryHandle.IsValid())
+		FTicker::GetCoreTicker().RemoveTicker(m_retryHandle);
+
+	m_retryHandle.Reset();
+	TSharedFuture<vr::IVRSystem*> future;
+
+	{
+		FScopeLock lock(&m_systemLock);
+		future = m_systemFuture;
+		m_systemCallbacks.Empty();
+	}
+
+	if (future.IsValid())
+		future.Wait();
+
+	// Unload OpenVR.
+	if (m_system != nullptr)
+		vr::VR_Shutdown();
+
+	m_system = nullptr;
+}
+
+vr::IVRSystem* FUnrealDRModule::getVirtualRealitySystem() const
+{
+	// Never block: if the system is not ready yet, start initializing it and return `nullptr`.
+	TSharedFuture<vr::IVRSystem*> future = this->requestVirtualRealitySystem();
+	return future.IsReady() ? future.Get() : nullptr;
+}
+
+TSharedFuture<vr::IVRSystem*> FUnrealDRModule::requestVirtualRealitySystem() const
+{
+	FScopeLock lock(&m_systemLock);
+
+	// Return the pending or successful initialization. Failed initializations are retried after some time, e.g. if SteamVR has been started in the meantime.
+	if (m_systemFuture.IsValid() && (!m_systemFuture.IsReady() || m_systemFuture.Get() != nullptr || FPlatformTime::Seconds() - m_lastInitializationTime < InitializationRetryInterval))
+		return m_systemFuture;
+
+	return this->beginInitializingVirtualRealitySystem();
+}
+
+FDelegateHandle FUnrealDRModule::whenVirtualRealitySystemReady(TFunction<void(vr::IVRSystem*)> callback)
+{
+	check(IsInGameThread());
+
+	TSharedFuture<vr::IVRSystem*> future = this->requestVirtualRealitySystem();
+	FDelegateHandle handle;
+	bool deferred = false, failed = false;
+
+	{
+		FScopeLock lock(&m_systemLock);
+
+		// Defer the callback, until an initialization has succeeded. The completion is only reported on the game thread, so the callbacks can not be missed.
+		if (!future.IsReady() || future.Get() == nullptr || m_systemCallbacks.Num() > 0)
+		{
+			handle = FDelegateHandle(FDelegateHandle::GenerateNewHandle);
+			m_systemCallbacks.Emplace(handle, MoveTemp(callback));
+			deferred = true;
+			failed = future.IsReady() && future.Get() == nullptr;
+		}
+	}
+
+	// A failed initialization, whose completion has already been reported, is not retried by itself.
+	if (!deferred)
+		callback(future.Get());
+	else if (failed)
+		this->scheduleVirtualRealitySystemRetry();
+
+	return handle;
+}
+
+void FUnrealDRModule::cancelVirtualRealitySystemCallback(FDelegateHandle handle)
+{
+	check(IsInGameThread());
+
+	if (!handle.IsValid())
+		return;
+
+	// A pending retry keeps running, since other callbacks could still be waiting. Without callbacks, it only initializes the system.
+	FScopeLock lock(&m_systemLock);
+	m_systemCallbacks.RemoveAll([&handle](const TTuple<FDelegateHandle, TFunction<void(vr::IVRSystem*)>>& callback) { return callback.Get<0>() == handle; });
+}
+
+TSharedFuture<vr::IVRSystem*> FUnrealDRModule::beginInitializingVirtualRealitySystem() const
+{
+	// Must be called with the system lock held. Failures of retries are not reported again, since retries are repeated, until the system is available.
+	const bool retry = m_systemFuture.IsValid();
+	m_lastInitializationTime = FPlatformTime::Seconds();
+
+	m_systemFuture = Async(EAsyncExecution::ThreadPool, [this, retry]() { return this->initializeVirtualRealitySystem(retry); }, []() {
+		// Notify the waiting callbacks on the game thread. The module is looked up again, since it could have been unloaded in the meantime.
+		AsyncTask(ENamedThreads::GameThread, []() {
+			auto module = FModuleManager::GetModulePtr<FUnrealDRModule>("UnrealDR");
+
+			if (module != nullptr)
+				module->notifyVirtualRealitySystemReady();
+		});
+	}).Share();
+
+	return m_systemFuture;
+}
+
+vr::IVRSystem* FUnrealDRModule::initializeVirtualRealitySystem(bool retry) const
 {
 	// Check if the HMD is available.
 	if (!vr::VR_IsHmdPresent())
 	{
-		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] No virtual reality HMD has been detected."));
-		return;
+		if (!retry)
+			UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] No virtual reality HMD has been detected."));
+
+		return nullptr;
 	}
 
 	// Check if the SteamVR runtime is installed.
 	if (!vr::VR_IsRuntimeInstalled())
 	{
-		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] SteamVR runtime is not installed."));
-		return;
+		if (!retry)
+			UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] SteamVR runtime is not installed."));
+
+		return nullptr;
 	}
 
 	// Create a VR system.
 	vr::EVRInitError error{ vr::EVRInitError::VRInitError_None };
-	m_system = vr::VR_Init(&error, vr::VRApplication_Background);
+	vr::IVRSystem* system = vr::VR_Init(&error, vr::VRApplication_Background);
 
-	if (error != vr::EVRInitError::VRInitError_None) 
+	if (error != vr::EVRInitError::VRInitError_None)
 	{
-		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to initialize VR system: %d."), error);
+		if (!retry)
+			UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to initialize VR system: %d."), error);
+
+		return nullptr;
+	}
+
+	UE_LOG(LOG_UNREAL_DR, Log, TEXT("[UnrealDR] VR system has been initialized."));
+
+	FScopeLock lock(&m_systemLock);
+	m_system = system;
+	return system;
+}
+
+void FUnrealDRModule::notifyVirtualRealitySystemReady()
+{
+	TArray<TTuple<FDelegateHandle, TFunction<void(vr::IVRSystem*)>>> callbacks;
+	vr::IVRSystem* system;
+	bool waiting;
+
+	{
+		FScopeLock lock(&m_systemLock);
+		system = m_system;
+		waiting = m_systemCallbacks.Num() > 0;
+
+		// If the initialization has failed, the callbacks keep waiting for a retry.
+		if (system != nullptr)
+		{
+			callbacks = MoveTemp(m_systemCallbacks);
+			m_systemCallbacks.Reset();
+		}
+	}
+
+	if (system == nullptr)
+	{
+		if (waiting)
+			this->scheduleVirtualRealitySystemRetry();
+
 		return;
 	}
+
+	for (auto& callback : callbacks)
+		callback.Get<1>()(system);
 }
 
-void FUnrealDRModule::ShutdownModule()
+void FUnrealDRModule::scheduleVirtualRealitySystemRetry()
 {
-	// Unload OpenVR.
-	if (m_system != nullptr)
-		vr::VR_Shutdown();
+	check(IsInGameThread());
 
-	m_system = nullptr;
+	if (m_retryHandle.IsValid())
+		return;
+
+	double delay;
+
+	{
+		FScopeLock lock(&m_systemLock);
+		delay = FMath::Max(InitializationRetryInterval - (FPlatformTime::Seconds() - m_lastInitializationTime), 0.0);
+	}
+
+	// Retry on the game thread, once the retry interval has passed. The completion of the retry notifies the waiting callbacks or schedules the next retry.
+	m_retryHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([this](float) {
+		m_retryHandle.Reset();
+		FScopeLock lock(&m_systemLock);
+
+		if (m_systemFuture.IsValid() && m_systemFuture.IsReady() && m_systemFuture.Get() == nullptr)
+			this->beginInitializingVirtualRealitySystem();
+
+		return false;
+	}), static_cast<float>(delay));
 }
 
-vr::IVRSystem* FUnrealDRModule::getVirtualRealitySystem() const
+FCameraStreamHub& FUnrealDRModule::getStreamHub()
 {
-	return m_system;
+	return *m_streamHub;
 }
 
 #undef LOCTEXT_NAMESPACE
 	
-IMPLEMENT_MODULE(FUnrealDRModule, UnrealDR)
\ No newline at end of file
+IMPLEMENT_MODULE(FUnrealDRModule, UnrealDR)
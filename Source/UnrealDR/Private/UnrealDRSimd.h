@@ -0,0 +1,12 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// SSE2 is part of the x86-64 baseline, so it can be used without runtime checks whenever vector intrinsics are enabled. All other platforms use the scalar paths,
+// which must produce the same results.
+#if PLATFORM_ENABLE_VECTORINTRINSICS && PLATFORM_CPU_X86_FAMILY
+#define UNREALDR_SIMD_SSE2 1
+#include <emmintrin.h>
+#else
+#define UNREALDR_SIMD_SSE2 0
+#endif
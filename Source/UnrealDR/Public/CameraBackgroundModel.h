@@ -0,0 +1,96 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "UnrealDR.h"
+#include "CameraFramePool.h"
+
+/// <summary>
+/// Estimates the static background of a camera stream, which can be used to fill regions of the camera images that objects are removed from.
+/// </summary>
+/// <remarks>
+/// The model stores a running approximate median for each channel of each pixel of both eye images: for every frame fed into the model, each value is moved towards
+/// the frame by at most <see cref="GetAdaptationStep" />. Objects that only pass by do not leave a trace, while the model converges to changes that persist. The
+/// update is a handful of saturating byte operations per pixel, which are vectorized and run over blocks of the frame in parallel, so that it keeps up with the native
+/// frame rate of the camera at full resolution. The result of each update is written into a frame from a small pool owned by the model, so that it can be uploaded
+/// while the next update is running. Updates must not overlap, but may be called from any thread.
+/// </remarks>
+class UNREALDR_API FCameraBackgroundModel
+{
+public:
+	/// <summary>
+	/// The number of bytes of a frame that are updated as a single block by one worker.
+	/// </summary>
+	static constexpr uint32 BlockSize = 64 * 1024;
+
+private:
+	/// <summary>
+	/// The size of a frame in bytes.
+	/// </summary>
+	uint32 m_bufferSize{ 0 };
+
+	/// <summary>
+	/// The maximum change of each value per update.
+	/// </summary>
+	uint8 m_adaptationStep{ 1 };
+
+	/// <summary>
+	/// The current background estimate, in the layout of the camera frames.
+	/// </summary>
+	TArray<uint8> m_model;
+
+	/// <summary>
+	/// `true`, if the model has been initialized from a frame.
+	/// </summary>
+	bool m_initialized{ false };
+
+	/// <summary>
+	/// The pool of frames the results are written into.
+	/// </summary>
+	FCameraFramePoolPtr m_outputPool;
+
+public:
+	FCameraBackgroundModel(uint32 bufferSize, uint8 adaptationStep = 1, int32 outputFrames = 3);
+	virtual ~FCameraBackgroundModel() = default;
+
+	FCameraBackgroundModel(const FCameraBackgroundModel&) = delete;
+	FCameraBackgroundModel& operator=(const FCameraBackgroundModel&) = delete;
+
+public:
+	/// <summary>
+	/// Feeds a frame into the model. The first frame initializes it.
+	/// </summary>
+	/// <param name="frame">The camera frame. Must have the size the model has been created for.</param>
+	/// <returns>A copy of the updated model, or an invalid reference, if all output frames are still in use. The model is updated in either case.</returns>
+	FCameraFrameRef Update(const FCameraFrame& frame);
+
+	/// <summary>
+	/// Discards the model, so that it is initialized from the next frame.
+	/// </summary>
+	void Reset() noexcept { m_initialized = false; }
+
+	/// <summary>
+	/// Returns the maximum change of each value per update.
+	/// </summary>
+	uint8 GetAdaptationStep() const noexcept { return m_adaptationStep; }
+
+	/// <summary>
+	/// Returns the pool the results are written into. It must outlive all pending uploads of a result.
+	/// </summary>
+	const FCameraFramePoolPtr& GetOutputPool() const noexcept { return m_outputPool; }
+
+	/// <summary>
+	/// Moves each value of <paramref name="model" /> towards the corresponding value of <paramref name="frame" /> by at most <paramref name="step" />.
+	/// </summary>
+	/// <param name="frame">The new values.</param>
+	/// <param name="model">The model values, which are updated in place.</param>
+	/// <param name="output">Receives a copy of the updated model values. May be `nullptr`.</param>
+	/// <param name="size">The number of values.</param>
+	/// <param name="step">The maximum change of each value.</param>
+	static void UpdateApproximateMedian(const uint8* frame, uint8* model, uint8* output, SIZE_T size, uint8 step) noexcept;
+};
+
+/// <summary>
+/// Thread-safe shared pointer to a background model.
+/// </summary>
+using FCameraBackgroundModelPtr = TSharedPtr<FCameraBackgroundModel, ESPMode::ThreadSafe>;
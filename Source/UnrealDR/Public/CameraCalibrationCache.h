@@ -0,0 +1,133 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "UnrealDR.h"
+#include "CameraFrameSource.h"
+
+// Layout of a calibration cache file:
+//
+//   FCameraCalibration
+//
+// Each file stores the calibration of a single camera configuration, keyed by the serial number and tracking system of the device and the frame options. The record
+// is stored in native byte order, like camera stream capture files, and is discarded, if its magic number or version do not match.
+namespace UnrealDR
+{
+	namespace CalibrationCache
+	{
+		constexpr uint32 FileMagic = 0x4B524455;		// "UDRK"
+		constexpr uint32 FileVersion = 1;
+		constexpr int32 MaxStringLength = 64;
+	}
+}
+
+/// <summary>
+/// The calibration of a stereo camera and the display it is shown on, as it is stored in the calibration cache.
+/// </summary>
+struct FCameraCalibration
+{
+	uint32 Magic{ UnrealDR::CalibrationCache::FileMagic };
+	uint32 Version{ UnrealDR::CalibrationCache::FileVersion };
+
+	/// <summary>
+	/// The index of the tracked device, the serial number and the tracking system it has been queried from, as null-terminated UTF-8 strings.
+	/// </summary>
+	uint32 DeviceIndex{ 0 };
+	ANSICHAR Serial[UnrealDR::CalibrationCache::MaxStringLength]{};
+	ANSICHAR TrackingSystem[UnrealDR::CalibrationCache::MaxStringLength]{};
+
+	/// <summary>
+	/// Describes the frame options (e.g. undistortion on the CPU), which the calibration depends on.
+	/// </summary>
+	ANSICHAR Variant[UnrealDR::CalibrationCache::MaxStringLength]{};
+
+	uint32 FrameWidth{ 0 };
+	uint32 FrameHeight{ 0 };
+	uint32 FrameBufferSize{ 0 };
+
+	/// <summary>
+	/// `1`, if the extrinsics are available, otherwise `0`.
+	/// </summary>
+	uint32 HasExtrinsics{ 0 };
+
+	vr::HmdVector2_t FocalLength[2]{};
+	vr::HmdVector2_t Center[2]{};
+	vr::HmdMatrix34_t CameraToHead[2]{};
+	FCameraDistortion Distortion[2];
+
+	/// <summary>
+	/// The tangents of the left, right, top and bottom half angles of the display projection of each eye, or of the camera, if no display is available.
+	/// </summary>
+	float Projection[2][4]{};
+
+	/// <summary>
+	/// Returns `true`, if both calibrations describe the same camera setup, regardless of where they have been queried from.
+	/// </summary>
+	bool IsEquivalent(const FCameraCalibration& other) const noexcept;
+};
+
+/// <summary>
+/// Caches the calibration of tracked cameras in small binary files under `Saved/UnrealDR/Calibration`.
+/// </summary>
+/// <remarks>
+/// Querying the calibration from the runtime requires the VR system to be initialized and involves several round trips to the compositor, which is why components
+/// load the cached calibration synchronously and revalidate it against the live device in the background. All methods are static and may be called from any
+/// thread, but concurrent writes of the same key are not synchronized.
+/// </remarks>
+class UNREALDR_API FCameraCalibrationCache
+{
+public:
+	/// <summary>
+	/// Returns the key of a device configuration, which is a valid file name.
+	/// </summary>
+	/// <param name="serial">The serial number of the device.</param>
+	/// <param name="trackingSystem">The name of the tracking system, that provides the device.</param>
+	/// <param name="variant">Describes the frame options, the calibration depends on.</param>
+	static FString GetKey(const FString& serial, const FString& trackingSystem, const FString& variant);
+
+	/// <summary>
+	/// Returns the name of the file that stores the calibration for a key.
+	/// </summary>
+	static FString GetFileName(const FString& key);
+
+	/// <summary>
+	/// Loads the calibration for a key.
+	/// </summary>
+	/// <returns>`true`, if a valid calibration has been found, otherwise `false`.</returns>
+	static bool Load(const FString& key, FCameraCalibration& calibration);
+
+	/// <summary>
+	/// Loads the most recently stored calibration of a device, if its serial number is not known yet, e.g. because the runtime has not been started.
+	/// </summary>
+	/// <param name="serial">The serial number of the device or an empty string to find the device by its index.</param>
+	/// <param name="deviceIndex">The index of the tracked device, used if no serial number is given.</param>
+	/// <param name="variant">Describes the frame options, the calibration depends on.</param>
+	/// <param name="calibration">Receives the calibration.</param>
+	/// <returns>`true`, if a valid calibration has been found, otherwise `false`.</returns>
+	static bool FindLatest(const FString& serial, uint32 deviceIndex, const FString& variant, FCameraCalibration& calibration);
+
+	/// <summary>
+	/// Stores the calibration for a key, replacing the previous one. The previous file is only removed, once the new one has been written and moved into place.
+	/// </summary>
+	/// <returns>`true`, if the calibration has been written, otherwise `false`.</returns>
+	static bool Save(const FString& key, const FCameraCalibration& calibration);
+
+	/// <summary>
+	/// Queries the live calibration of a frame source.
+	/// </summary>
+	/// <param name="source">The frame source.</param>
+	/// <param name="system">The VR system instance, which provides the device properties and display projection, or `nullptr`.</param>
+	/// <param name="device">The index of the tracked device, that provides the frames.</param>
+	/// <param name="variant">Describes the frame options, the calibration depends on.</param>
+	/// <param name="calibration">Receives the calibration.</param>
+	/// <returns>`true`, if the frame size and the intrinsics are available, otherwise `false`.</returns>
+	static bool Query(const ICameraFrameSource& source, vr::IVRSystem* system, vr::TrackedDeviceIndex_t device, const FString& variant, FCameraCalibration& calibration);
+
+	/// <summary>
+	/// Returns the key of a calibration, as it has been queried.
+	/// </summary>
+	static FString GetKey(const FCameraCalibration& calibration);
+
+private:
+	static bool Read(const FString& fileName, FCameraCalibration& calibration);
+};
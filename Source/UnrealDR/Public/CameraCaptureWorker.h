@@ -0,0 +1,148 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "HAL/Event.h"
+#include "Containers/TripleBuffer.h"
+
+#include "UnrealDR.h"
+#include "CameraFrameSource.h"
+#include "CameraFramePool.h"
+
+/// <summary>
+/// Polls a camera frame source on a dedicated thread and publishes new frames into a lock-free triple buffer.
+/// </summary>
+/// <remarks>
+/// The worker is the only writer of the triple buffer, whilst the game thread is the only reader. The reader can call <see cref="SwapToLatestFrame" /> at any
+/// time to retrieve the most recent frame, without ever blocking the capture thread. Frames that are published faster than they are consumed are overwritten.
+/// Frame buffers are acquired from a <see cref="FCameraFramePool" />. If the pool is exhausted, because all frames are still in use by consumers, new frames are
+/// dropped instead of waiting for a buffer to become available.
+/// </remarks>
+class UNREALDR_API FCameraCaptureWorker : public FRunnable
+{
+private:
+	/// <summary>
+	/// The source to copy the frames from.
+	/// </summary>
+	FCameraFrameSourcePtr m_source;
+
+	/// <summary>
+	/// The pool to acquire frame buffers from.
+	/// </summary>
+	FCameraFramePoolPtr m_pool;
+
+	/// <summary>
+	/// The frame that receives the next copy from the frame source.
+	/// </summary>
+	FCameraFrameRef m_pendingFrame;
+
+	/// <summary>
+	/// Index of last streamed image.
+	/// </summary>
+	uint32_t m_lastFrameIndex{ 0 };
+
+	/// <summary>
+	/// The triple buffer that receives the frames.
+	/// </summary>
+	TTripleBuffer<FCameraFrameRef> m_frames;
+
+	/// <summary>
+	/// The thread that runs the worker.
+	/// </summary>
+	FRunnableThread* m_thread{ nullptr };
+
+	/// <summary>
+	/// Event used to wait between two polls of the camera stream, so that the worker can be woken up when stopping.
+	/// </summary>
+	FEvent* m_wakeEvent{ nullptr };
+
+	/// <summary>
+	/// `true`, as long as the worker should keep polling the camera stream.
+	/// </summary>
+	FThreadSafeBool m_running{ false };
+
+	/// <summary>
+	/// The number of frames that have been published, but overwritten before they have been read.
+	/// </summary>
+	FThreadSafeCounter m_skippedFrames;
+
+	/// <summary>
+	/// The number of frames that have been dropped, because no frame buffer was available.
+	/// </summary>
+	FThreadSafeCounter m_droppedFrames;
+
+	/// <summary>
+	/// The number of frames that have been copied from the frame source.
+	/// </summary>
+	FThreadSafeCounter m_capturedFrames;
+
+	/// <summary>
+	/// The time (in milliseconds) to wait between two header polls, if no new frame has been available.
+	/// </summary>
+	uint32 m_pollInterval{ 1 };
+
+	/// <summary>
+	/// The name of the capture thread.
+	/// </summary>
+	FString m_threadName;
+
+public:
+	FCameraCaptureWorker(FCameraFrameSourcePtr source, FCameraFramePoolPtr pool, uint32 pollInterval = 1, const FString& threadName = TEXT("UnrealDR Camera Capture"));
+	virtual ~FCameraCaptureWorker();
+
+	FCameraCaptureWorker(const FCameraCaptureWorker&) = delete;
+	FCameraCaptureWorker& operator=(const FCameraCaptureWorker&) = delete;
+
+public:
+	/// <summary>
+	/// Starts the capture thread.
+	/// </summary>
+	/// <returns>`true`, if the thread has been started successfully, otherwise `false`.</returns>
+	bool Start();
+
+	/// <summary>
+	/// Signals the capture thread to stop and waits for it to exit.
+	/// </summary>
+	void Shutdown();
+
+	/// <summary>
+	/// Returns `true`, if a frame has been published since the last call to <see cref="SwapToLatestFrame" />.
+	/// </summary>
+	bool HasNewFrame() const;
+
+	/// <summary>
+	/// Swaps the read slot to the latest published frame and returns it.
+	/// </summary>
+	/// <remarks>
+	/// The read slot keeps a reference to the frame until the next call to this method. It must only be called from a single thread.
+	/// </remarks>
+	FCameraFrameRef SwapToLatestFrame();
+
+	/// <summary>
+	/// Returns the number of frames that have been overwritten by the worker before they have been read.
+	/// </summary>
+	int32 GetSkippedFrames() const;
+
+	/// <summary>
+	/// Returns the number of frames that have been dropped, because the frame pool has been exhausted.
+	/// </summary>
+	int32 GetDroppedFrames() const;
+
+	/// <summary>
+	/// Returns the number of frames that have been copied from the frame source.
+	/// </summary>
+	int32 GetCapturedFrames() const;
+
+	// FRunnable
+public:
+	virtual bool Init() override;
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	virtual void Exit() override;
+
+protected:
+	virtual bool PollFrame();
+};
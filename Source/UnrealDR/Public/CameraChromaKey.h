@@ -0,0 +1,241 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "UnrealDR.h"
+#include "CameraFramePool.h"
+#include "CameraFrameView.h"
+#include "CameraChromaKey.generated.h"
+
+/// <summary>
+/// A connected region of keyed pixels in an eye image.
+/// </summary>
+USTRUCT(BlueprintType)
+struct UNREALDR_API FCameraChromaKeyBlob
+{
+	GENERATED_BODY()
+
+	/// <summary>
+	/// The eye image the region has been found in.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Chroma Key") ECameraEye Eye { ECameraEye::Left };
+
+	/// <summary>
+	/// The bounding box of the region in pixels of the eye image. The maximum is exclusive.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Chroma Key") FIntRect Bounds;
+
+	/// <summary>
+	/// The number of keyed pixels of the region.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Chroma Key") int32 Area { 0 };
+
+	/// <summary>
+	/// The center of the keyed pixels in pixels of the eye image.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Chroma Key") FVector2D Centroid { 0.f, 0.f };
+};
+
+/// <summary>
+/// Settings of the chroma keying.
+/// </summary>
+struct FCameraChromaKeySettings
+{
+	/// <summary>
+	/// The color of the backdrop that is keyed.
+	/// </summary>
+	FColor KeyColor{ 0, 177, 64, 255 };
+
+	/// <summary>
+	/// The chroma distance to the key color, below which pixels are fully keyed. The distance is the sum of the absolute differences of both chroma channels.
+	/// </summary>
+	int32 Threshold{ 32 };
+
+	/// <summary>
+	/// The width of the soft edge beyond the threshold, in which the mask falls off to `0`. It is clamped to `[1, 255]`.
+	/// </summary>
+	int32 Softness{ 32 };
+
+	/// <summary>
+	/// The mask value, from which pixels belong to a connected region.
+	/// </summary>
+	uint8 BlobThreshold{ 128 };
+
+	/// <summary>
+	/// The number of pixels, below which regions are discarded.
+	/// </summary>
+	int32 MinBlobArea{ 64 };
+
+	/// <summary>
+	/// The largest number of regions that are kept, starting with the largest one.
+	/// </summary>
+	int32 MaxBlobs{ 32 };
+};
+
+/// <summary>
+/// The mask and the connected regions of a keyed frame.
+/// </summary>
+struct FCameraChromaKeyResult
+{
+	/// <summary>
+	/// The mask in the layout of the frame buffer with one byte per pixel, or an invalid reference, if the frame has not been keyed. Pixels outside of the keyed
+	/// regions are `0`.
+	/// </summary>
+	FCameraFrameRef Mask;
+
+	/// <summary>
+	/// The regions of the left and right eye image (in pixels) that have been keyed. An empty region means that the eye has been skipped.
+	/// </summary>
+	FIntRect Regions[2];
+
+	/// <summary>
+	/// The connected regions of the mask, sorted by decreasing area.
+	/// </summary>
+	TArray<FCameraChromaKeyBlob> Blobs;
+};
+
+/// <summary>
+/// A horizontal run of keyed pixels, which is the unit the connected regions are labeled in.
+/// </summary>
+struct FCameraChromaKeyRun
+{
+	/// <summary>
+	/// The first and one past the last pixel of the run.
+	/// </summary>
+	int32 Start{ 0 };
+	int32 End{ 0 };
+
+	/// <summary>
+	/// The row of the run within the eye image.
+	/// </summary>
+	int32 Row{ 0 };
+
+	/// <summary>
+	/// The run this run has been merged into, or its own index, if it is the representative of its region.
+	/// </summary>
+	int32 Parent{ 0 };
+};
+
+/// <summary>
+/// Computes a chroma key mask of both eye images on the CPU and extracts the connected regions of keyed pixels, so that other work can be limited to them.
+/// </summary>
+/// <remarks>
+/// Each pixel is converted to the chroma channels of BT.601 YCbCr in 8 bit fixed point, eight pixels at a time with SSE2. Its mask value falls off linearly from
+/// `255` at the threshold to `0` at the threshold plus the softness, so that edges stay soft like in a keying material. Rows are keyed in parallel into an 8 bit
+/// mask with the layout of the frame buffer (right eye in the upper half, left eye in the lower half). The connected regions (8-connectivity) are labeled from
+/// the runs of pixels above the blob threshold: strips of rows are labeled in parallel with a union-find over their runs, then the strips are merged along their
+/// borders and the area, bounding box and centroid of each region are accumulated. Keying and labeling can be restricted to a region of each eye image, so that
+/// the cost scales with its area. Calls must not overlap, but may happen on any thread.
+/// </remarks>
+class UNREALDR_API FCameraChromaKey
+{
+public:
+	/// <summary>
+	/// The number of rows of a strip that is labeled by one worker.
+	/// </summary>
+	static constexpr int32 StripHeight = 32;
+
+private:
+	/// <summary>
+	/// The settings of the keying.
+	/// </summary>
+	FCameraChromaKeySettings m_settings;
+
+	/// <summary>
+	/// The size of the frames in pixels.
+	/// </summary>
+	uint32 m_frameWidth{ 0 };
+	uint32 m_frameHeight{ 0 };
+
+	/// <summary>
+	/// The runs of each strip of both eye images, whose parents refer to runs of the same strip.
+	/// </summary>
+	TArray<TArray<FCameraChromaKeyRun>> m_stripRuns;
+
+	/// <summary>
+	/// The number of strips of an eye image.
+	/// </summary>
+	int32 m_stripsPerEye{ 0 };
+
+	/// <summary>
+	/// The runs of all strips of an eye image, whose parents refer to runs of the whole eye image.
+	/// </summary>
+	TArray<FCameraChromaKeyRun> m_runs;
+
+	/// <summary>
+	/// The index of the region of each run in <see cref="m_runs" />, or `INDEX_NONE`, if the region has not been reached yet.
+	/// </summary>
+	TArray<int32> m_labels;
+
+	/// <summary>
+	/// The pool of frames the masks are written into.
+	/// </summary>
+	FCameraFramePoolPtr m_outputPool;
+
+public:
+	FCameraChromaKey(uint32 frameWidth, uint32 frameHeight, const FCameraChromaKeySettings& settings, int32 outputFrames = 4);
+	virtual ~FCameraChromaKey() = default;
+	FCameraChromaKey(const FCameraChromaKey&) = delete;
+	FCameraChromaKey& operator=(const FCameraChromaKey&) = delete;
+
+public:
+	/// <summary>
+	/// Keys a frame and extracts the connected regions of its mask.
+	/// </summary>
+	/// <param name="frame">The camera frame.</param>
+	/// <param name="regions">The regions of the left and right eye image (in pixels) to key, or `nullptr` to key the whole images. An empty region skips the eye.
+	/// </param>
+	/// <returns>The mask and its connected regions. The mask is invalid, if all output frames are still in use. It is not modified, while it is referenced.</returns>
+	FCameraChromaKeyResult Update(const FCameraFrame& frame, const FIntRect* regions = nullptr);
+
+	/// <summary>
+	/// Changes the settings of the keying, which are used from the next frame on. It must not be called while a frame is keyed.
+	/// </summary>
+	void SetSettings(const FCameraChromaKeySettings& settings);
+
+	/// <summary>
+	/// Returns the settings of the keying.
+	/// </summary>
+	const FCameraChromaKeySettings& GetSettings() const noexcept { return m_settings; }
+
+	/// <summary>
+	/// Returns the pool the masks are written into. It must outlive all pending uploads of a mask.
+	/// </summary>
+	const FCameraFramePoolPtr& GetOutputPool() const noexcept { return m_outputPool; }
+
+	/// <summary>
+	/// Keys a row of RGBA pixels.
+	/// </summary>
+	/// <param name="row">The first pixel of the row.</param>
+	/// <param name="width">The width of the row in pixels.</param>
+	/// <param name="keyCb">The blue-difference chroma of the key color, as returned by <see cref="GetChroma" />.</param>
+	/// <param name="keyCr">The red-difference chroma of the key color.</param>
+	/// <param name="threshold">The chroma distance, below which pixels are fully keyed.</param>
+	/// <param name="softness">The width of the soft edge in `[1, 255]`.</param>
+	/// <param name="mask">Receives the mask value of each pixel.</param>
+	static void KeyRow(const uint8* row, uint32 width, int32 keyCb, int32 keyCr, int32 threshold, int32 softness, uint8* mask) noexcept;
+
+	/// <summary>
+	/// Returns the chroma channels of a color in 8 bit fixed point, centered around `0`.
+	/// </summary>
+	static void GetChroma(const FColor& color, int32& cb, int32& cr) noexcept;
+
+	/// <summary>
+	/// Appends the runs of a mask row, whose values are at least the threshold.
+	/// </summary>
+	/// <param name="mask">The first value of the row.</param>
+	/// <param name="width">The width of the row in pixels.</param>
+	/// <param name="row">The row of the runs within the eye image.</param>
+	/// <param name="threshold">The smallest value of a run.</param>
+	/// <param name="runs">Receives the runs, whose parents are set to their own index.</param>
+	static void FindRuns(const uint8* mask, int32 width, int32 row, uint8 threshold, TArray<FCameraChromaKeyRun>& runs);
+
+private:
+	void LabelStrip(const uint8* mask, int32 eye, int32 strip, const FIntRect& region);
+	void ExtractBlobs(int32 eye, const FIntRect& region, TArray<FCameraChromaKeyBlob>& blobs);
+};
+
+/// <summary>
+/// Thread-safe shared pointer to a chroma keyer.
+/// </summary>
+using FCameraChromaKeyPtr = TSharedPtr<FCameraChromaKey, ESPMode::ThreadSafe>;
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "UnrealDR.h"
+#include "CameraFramePool.h"
+#include "CameraColorStatistics.generated.h"
+
+/// <summary>
+/// Color and luminance statistics of a camera frame, used to match the lighting of virtual content to the camera images.
+/// </summary>
+/// <remarks>
+/// All values are measured on the encoded (sRGB) camera pixels and normalized to `[0, 1]`, unless noted otherwise.
+/// </remarks>
+USTRUCT(BlueprintType)
+struct UNREALDR_API FCameraColorStats
+{
+	GENERATED_BODY()
+
+	/// <summary>
+	/// The average color of the sampled pixels.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Color Statistics") FLinearColor AverageColor { 0.f, 0.f, 0.f, 1.f };
+
+	/// <summary>
+	/// The average luminance of the sampled pixels.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Color Statistics") float AverageLuminance { 0.f };
+
+	/// <summary>
+	/// The 5th percentile of the luminance, i.e. the black level of the image.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Color Statistics") float LowLuminance { 0.f };
+
+	/// <summary>
+	/// The median luminance.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Color Statistics") float MedianLuminance { 0.f };
+
+	/// <summary>
+	/// The 95th percentile of the luminance, i.e. the white level of the image.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Color Statistics") float HighLuminance { 0.f };
+
+	/// <summary>
+	/// The exposure (in stops) of the median luminance relative to middle gray, measured in linear space. Positive values indicate a bright image.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Color Statistics") float ExposureBias { 0.f };
+
+	/// <summary>
+	/// The gains that map the average color to gray (gray world assumption), relative to the green channel.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Color Statistics") FLinearColor WhiteBalance { 1.f, 1.f, 1.f, 1.f };
+
+	/// <summary>
+	/// The number of sampled pixels for each luminance value. Empty for temporally smoothed statistics.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Color Statistics") TArray<int32> Histogram;
+
+	/// <summary>
+	/// The number of sampled pixels.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Color Statistics") int32 SampleCount { 0 };
+};
+
+/// <summary>
+/// Measures the color and luminance statistics of camera frames and smoothes them over time.
+/// </summary>
+/// <remarks>
+/// Every n-th row of a frame is sampled, and within each sampled row every n-th block of four pixels, so that the cost scales with the square of the stride. The
+/// luminance of each sample is computed with integer Rec. 709 weights, four pixels at a time, and counted into a histogram with 256 bins, from which the
+/// percentiles are derived. The temporally smoothed statistics follow the statistics of each frame with a time constant based on the exposure times of the frames.
+/// Calls must not overlap, but may happen on any thread.
+/// </remarks>
+class UNREALDR_API FCameraColorStatistics
+{
+public:
+	/// <summary>
+	/// The number of luminance values.
+	/// </summary>
+	static constexpr int32 HistogramBins = 256;
+
+private:
+	/// <summary>
+	/// The distance between sampled rows and between sampled blocks of pixels.
+	/// </summary>
+	uint32 m_stride{ 4 };
+
+	/// <summary>
+	/// The time constant (in seconds) of the temporal smoothing.
+	/// </summary>
+	float m_smoothingTime{ 0.5f };
+
+	/// <summary>
+	/// The statistics of the latest frame.
+	/// </summary>
+	FCameraColorStats m_latest;
+
+	/// <summary>
+	/// The temporally smoothed statistics.
+	/// </summary>
+	FCameraColorStats m_smoothed;
+
+	/// <summary>
+	/// The exposure time of the latest frame, or a negative value, if no frame has been measured yet.
+	/// </summary>
+	double m_latestExposureTime{ -1.0 };
+
+public:
+	FCameraColorStatistics(uint32 stride = 4, float smoothingTime = 0.5f);
+	virtual ~FCameraColorStatistics() = default;
+
+public:
+	/// <summary>
+	/// Measures the statistics of a frame and updates the smoothed statistics.
+	/// </summary>
+	/// <param name="frame">The frame to measure.</param>
+	/// <param name="width">The width of the frame in pixels.</param>
+	/// <param name="height">The height of the frame (i.e. both eye images) in pixels.</param>
+	void Update(const FCameraFrame& frame, uint32 width, uint32 height);
+
+	/// <summary>
+	/// Forgets the smoothed statistics, so that the next frame is taken as is.
+	/// </summary>
+	void Reset();
+
+	/// <summary>
+	/// Returns the statistics of the latest frame.
+	/// </summary>
+	const FCameraColorStats& GetLatest() const noexcept { return m_latest; }
+
+	/// <summary>
+	/// Returns the temporally smoothed statistics.
+	/// </summary>
+	const FCameraColorStats& GetSmoothed() const noexcept { return m_smoothed; }
+
+	/// <summary>
+	/// Samples a row of RGBA pixels.
+	/// </summary>
+	/// <param name="row">The first pixel of the row.</param>
+	/// <param name="width">The width of the row in pixels.</param>
+	/// <param name="stride">Only every n-th block of four pixels is sampled.</param>
+	/// <param name="histogram">The histogram of <see cref="HistogramBins" /> luminance values, which the samples are counted into.</param>
+	/// <param name="sums">The sums of the red, green and blue channels, which the samples are added to.</param>
+	/// <returns>The number of samples.</returns>
+	static uint32 SampleRow(const uint8* row, uint32 width, uint32 stride, uint32* histogram, uint64 (&sums)[3]) noexcept;
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RHI.h"
+
+#include "UnrealDR.h"
+
+/// <summary>
+/// Detects which tiles of an eye image have changed since the last upload, so that only those need to be uploaded.
+/// </summary>
+/// <remarks>
+/// The image is divided into square tiles. For each tile, a position-sensitive checksum is computed and compared to the checksum of the previous upload. Adjacent
+/// dirty tiles within a row of tiles are merged into a single region, to keep the number of texture updates low. If the ratio of dirty tiles exceeds a threshold,
+/// a single region covering the whole image is returned instead, since many small updates are slower than one large update.
+/// </remarks>
+class UNREALDR_API FCameraDirtyTileTracker
+{
+private:
+	/// <summary>
+	/// The width of the image in pixels.
+	/// </summary>
+	uint32 m_width{ 0 };
+
+	/// <summary>
+	/// The height of the image in pixels.
+	/// </summary>
+	uint32 m_height{ 0 };
+
+	/// <summary>
+	/// The edge length of a tile in pixels.
+	/// </summary>
+	uint32 m_tileSize{ 32 };
+
+	/// <summary>
+	/// The number of tiles in horizontal direction.
+	/// </summary>
+	uint32 m_tilesX{ 0 };
+
+	/// <summary>
+	/// The number of tiles in vertical direction.
+	/// </summary>
+	uint32 m_tilesY{ 0 };
+
+	/// <summary>
+	/// The checksums of the tiles of the last upload.
+	/// </summary>
+	TArray<uint64> m_hashes;
+
+	/// <summary>
+	/// `true`, if <see cref="m_hashes" /> contains the checksums of a previous upload.
+	/// </summary>
+	bool m_valid{ false };
+
+public:
+	FCameraDirtyTileTracker() = default;
+	FCameraDirtyTileTracker(uint32 width, uint32 height, uint32 tileSize = 32);
+
+public:
+	/// <summary>
+	/// Hashes the tiles of an RGBA image and returns the regions that have changed since the last call.
+	/// </summary>
+	/// <param name="data">The RGBA frame buffer.</param>
+	/// <param name="pitch">The number of bytes between two rows of the frame buffer.</param>
+	/// <param name="srcX">The horizontal offset of the image within the frame buffer.</param>
+	/// <param name="srcY">The vertical offset of the image within the frame buffer.</param>
+	/// <param name="maxDirtyRatio">The ratio of dirty tiles, above which a single region covering the whole image is returned.</param>
+	/// <param name="regions">Receives the dirty regions. The source offsets are relative to the frame buffer.</param>
+	/// <returns>The number of dirty tiles.</returns>
+	uint32 Update(const uint8* data, uint32 pitch, uint32 srcX, uint32 srcY, float maxDirtyRatio, TArray<FUpdateTextureRegion2D>& regions);
+
+	/// <summary>
+	/// Forgets the checksums of the last upload, so that the next update reports the whole image as dirty.
+	/// </summary>
+	void Invalidate() noexcept { m_valid = false; }
+
+	/// <summary>
+	/// Returns the total number of tiles.
+	/// </summary>
+	uint32 GetTileCount() const noexcept { return m_tilesX * m_tilesY; }
+
+	/// <summary>
+	/// Returns the edge length of a tile in pixels.
+	/// </summary>
+	uint32 GetTileSize() const noexcept { return m_tileSize; }
+
+	/// <summary>
+	/// Computes the checksum of a rectangular block of RGBA pixels.
+	/// </summary>
+	/// <param name="data">Pointer to the first pixel of the block.</param>
+	/// <param name="pitch">The number of bytes between two rows.</param>
+	/// <param name="width">The width of the block in pixels.</param>
+	/// <param name="height">The height of the block in pixels.</param>
+	static uint64 HashTile(const uint8* data, uint32 pitch, uint32 width, uint32 height) noexcept;
+};
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Containers/LockFreeList.h"
+#include "Templates/RefCounting.h"
+
+#include "UnrealDR.h"
+
+class FCameraFramePool;
+
+/// <summary>
+/// Thread-safe shared pointer to a frame pool.
+/// </summary>
+using FCameraFramePoolPtr = TSharedPtr<FCameraFramePool, ESPMode::ThreadSafe>;
+
+/// <summary>
+/// A single camera frame, backed by an aligned buffer that is owned by a <see cref="FCameraFramePool" />.
+/// </summary>
+/// <remarks>
+/// Frames are reference counted. When the last reference is released, the frame is returned to the pool it has been acquired from. This allows to hand out the same
+/// frame to multiple consumers (e.g. the render thread for uploading both eye textures) without copying it and without the risk of it being overwritten, while it is
+/// still in use. While a frame is in use, it keeps its pool alive, so consumers can hold on to it after the owner of the pool has released it.
+/// </remarks>
+class UNREALDR_API FCameraFrame
+{
+	friend class FCameraFramePool;
+
+public:
+	/// <summary>
+	/// The frame header, as returned by the frame source.
+	/// </summary>
+	vr::CameraVideoStreamFrameHeader_t Header{};
+
+	/// <summary>
+	/// The raw RGBA frame buffer, containing the images of both eyes.
+	/// </summary>
+	uint8* Data{ nullptr };
+
+	/// <summary>
+	/// The size of <see cref="Data" /> in bytes.
+	/// </summary>
+	uint32 Size{ 0 };
+
+	/// <summary>
+	/// The platform time (in seconds), the frame has been exposed. If the frame source does not provide exposure times, this equals <see cref="HeaderPollTime" />.
+	/// </summary>
+	double ExposureTime{ 0.0 };
+
+	/// <summary>
+	/// `true`, if <see cref="ExposureTime" /> has been reported by the frame source, `false` if it has been estimated from the header poll.
+	/// </summary>
+	bool bHasExposureTime{ false };
+
+	/// <summary>
+	/// The platform time (in seconds), the frame source has been polled, when it returned the frame.
+	/// </summary>
+	double HeaderPollTime{ 0.0 };
+
+	/// <summary>
+	/// The platform time (in seconds), the frame has been copied from the stream.
+	/// </summary>
+	double CaptureTime{ 0.0 };
+
+private:
+	/// <summary>
+	/// The pool that owns the frame, while the frame is in use. Free frames do not reference the pool, since the pool would never be released otherwise.
+	/// </summary>
+	FCameraFramePoolPtr m_pool;
+
+	/// <summary>
+	/// The number of references to the frame.
+	/// </summary>
+	mutable FThreadSafeCounter m_references;
+
+private:
+	FCameraFrame(uint32 size, uint32 alignment);
+	~FCameraFrame();
+
+public:
+	FCameraFrame(const FCameraFrame&) = delete;
+	FCameraFrame& operator=(const FCameraFrame&) = delete;
+
+public:
+	uint32 AddRef() const;
+	uint32 Release() const;
+	uint32 GetRefCount() const;
+};
+
+/// <summary>
+/// A reference to a pooled camera frame.
+/// </summary>
+using FCameraFrameRef = TRefCountPtr<FCameraFrame>;
+
+/// <summary>
+/// A fixed-size pool of aligned camera frame buffers.
+/// </summary>
+/// <remarks>
+/// All buffers are allocated up-front, so that acquiring a frame never allocates. If no frame is available, <see cref="Acquire" /> does not block, but returns an
+/// invalid reference instead. Acquiring and returning frames is lock-free and may happen from any thread. Frames that are in use keep the pool alive (e.g. frame
+/// views that outlive the stream), which is why it must be created as a shared pointer.
+/// </remarks>
+class UNREALDR_API FCameraFramePool : public TSharedFromThis<FCameraFramePool, ESPMode::ThreadSafe>
+{
+	friend class FCameraFrame;
+
+private:
+	/// <summary>
+	/// All frames owned by the pool.
+	/// </summary>
+	TArray<FCameraFrame*> m_frames;
+
+	/// <summary>
+	/// The frames that are currently not referenced.
+	/// </summary>
+	TLockFreePointerListUnordered<FCameraFrame, PLATFORM_CACHE_LINE_SIZE> m_freeFrames;
+
+	/// <summary>
+	/// The number of frames that are currently not referenced.
+	/// </summary>
+	FThreadSafeCounter m_freeCount;
+
+	/// <summary>
+	/// The size of each frame buffer in bytes.
+	/// </summary>
+	uint32 m_bufferSize{ 0 };
+
+public:
+	FCameraFramePool(uint32 bufferSize, int32 poolSize, uint32 alignment = PLATFORM_CACHE_LINE_SIZE);
+	virtual ~FCameraFramePool();
+
+	FCameraFramePool(const FCameraFramePool&) = delete;
+	FCameraFramePool& operator=(const FCameraFramePool&) = delete;
+
+public:
+	/// <summary>
+	/// Acquires a free frame from the pool.
+	/// </summary>
+	/// <returns>A reference to the frame or an invalid reference, if all frames are currently in use.</returns>
+	FCameraFrameRef Acquire();
+
+	/// <summary>
+	/// Returns the size of each frame buffer in bytes.
+	/// </summary>
+	uint32 GetBufferSize() const noexcept { return m_bufferSize; }
+
+	/// <summary>
+	/// Returns the total number of frames in the pool.
+	/// </summary>
+	int32 GetPoolSize() const noexcept { return m_frames.Num(); }
+
+	/// <summary>
+	/// Returns the number of frames that are currently not in use.
+	/// </summary>
+	int32 GetFreeCount() const { return m_freeCount.GetValue(); }
+
+private:
+	void Return(FCameraFrame* frame);
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintAsyncActionBase.h"
+
+#include "UnrealDR.h"
+#include "CameraFrameView.h"
+#include "CameraFrameSampleAction.generated.h"
+
+class UCameraSeeThroughComponent;
+
+/// <summary>
+/// Called with the sampled pixels of a camera frame, row by row, the region they have been sampled from and their average color.
+/// </summary>
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_FourParams(FOnCameraFrameSampled, const FCameraFrameHandle&, Frame, const TArray<FColor>&, Pixels, FIntRect, Region, FLinearColor, Average);
+
+/// <summary>
+/// Blueprint node that samples a region of a camera frame on the CPU, without reading back the eye images from the GPU.
+/// </summary>
+/// <remarks>
+/// The node samples either the latest frame or waits for the next one. Pixels are copied from the frame view on the thread pool, so that large regions do not stall
+/// the game thread. The result is delivered on the game thread.
+/// </remarks>
+UCLASS()
+class UNREALDR_API UCameraFrameSampleAction : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+private:
+	/// <summary>
+	/// The component to sample frames from.
+	/// </summary>
+	TWeakObjectPtr<UCameraSeeThroughComponent> m_component;
+
+	/// <summary>
+	/// The eye to sample.
+	/// </summary>
+	ECameraEye m_eye{ ECameraEye::Left };
+
+	/// <summary>
+	/// The region of the eye image to sample in pixels.
+	/// </summary>
+	FIntRect m_region;
+
+	/// <summary>
+	/// If enabled, the next frame is sampled instead of the latest one.
+	/// </summary>
+	bool m_waitForNewFrame{ false };
+
+	/// <summary>
+	/// The handle of the frame view delegate, while waiting for a frame.
+	/// </summary>
+	FDelegateHandle m_frameViewHandle;
+
+	/// <summary>
+	/// The handle of the streaming ended delegate, while waiting for a frame.
+	/// </summary>
+	FDelegateHandle m_streamingEndedHandle;
+
+public:
+	/// <summary>
+	/// Called with the sampled pixels.
+	/// </summary>
+	UPROPERTY(BlueprintAssignable) FOnCameraFrameSampled Completed;
+
+	/// <summary>
+	/// Called, if the component does not exist, stops streaming before a frame has been received or the region is outside of the eye image.
+	/// </summary>
+	UPROPERTY(BlueprintAssignable) FOnCameraFrameSampled Failed;
+
+public:
+	/// <summary>
+	/// Samples a region of an eye image of a camera frame. To sample a single pixel, use a region of one pixel.
+	/// </summary>
+	/// <param name="component">The component to sample frames from.</param>
+	/// <param name="eye">The eye to sample.</param>
+	/// <param name="region">The region of the eye image to sample in pixels. It is clipped to the image.</param>
+	/// <param name="bWaitForNewFrame">If enabled, the next frame is sampled, otherwise the latest one.</param>
+	UFUNCTION(BlueprintCallable, Meta = (BlueprintInternalUseOnly = "true"), Category = "UnrealDR|Frames") static UCameraFrameSampleAction* SampleCameraFrame(UCameraSeeThroughComponent* component, ECameraEye eye, FIntRect region, bool bWaitForNewFrame = false);
+
+	// UBlueprintAsyncActionBase
+public:
+	virtual void Activate() override;
+	virtual void SetReadyToDestroy() override;
+
+private:
+	void OnFrameView(const FCameraFrameViewPtr& view);
+	void OnStreamingEnded();
+	void StopWaiting();
+	void Sample(const FCameraFrameViewPtr& view);
+	void Fail();
+};
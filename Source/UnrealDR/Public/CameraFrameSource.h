@@ -0,0 +1,112 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "UnrealDR.h"
+
+/// <summary>
+/// The lens distortion model of a camera, as reported by the OpenVR runtime.
+/// </summary>
+struct FCameraDistortion
+{
+	/// <summary>
+	/// The distortion function. `VRDistortionFunctionType_None`, if the frames are not distorted.
+	/// </summary>
+	vr::EVRDistortionFunctionType Function{ vr::VRDistortionFunctionType_None };
+
+	/// <summary>
+	/// The parameters of the distortion function.
+	/// </summary>
+	double Coefficients[vr::k_unMaxDistortionFunctionParameters]{};
+};
+
+/// <summary>
+/// Interface for a source of stereo camera frames.
+/// </summary>
+/// <remarks>
+/// A frame source provides frames in the same layout as the OpenVR tracked camera: a single RGBA buffer of `width x height` pixels, where the upper half contains the
+/// right eye image and the lower half contains the left eye image. Frame sources are set up on the game thread, but <see cref="GetNextFrame" /> is called from the
+/// capture worker thread, so implementations must not rely on game thread state when copying frames.
+/// </remarks>
+class UNREALDR_API ICameraFrameSource
+{
+public:
+	virtual ~ICameraFrameSource() = default;
+
+public:
+	/// <summary>
+	/// Returns a human-readable name of the source, used for logging.
+	/// </summary>
+	virtual const TCHAR* GetName() const noexcept = 0;
+
+	/// <summary>
+	/// Returns the size of the frames provided by the source.
+	/// </summary>
+	/// <param name="width">The width of a frame in pixels.</param>
+	/// <param name="height">The height of a frame (i.e. both eye images) in pixels.</param>
+	/// <param name="frameBufferSize">The size of a frame buffer in bytes.</param>
+	/// <returns>`true`, if the frame size could be determined, otherwise `false`.</returns>
+	virtual bool GetFrameSize(uint32_t& width, uint32_t& height, uint32_t& frameBufferSize) const = 0;
+
+	/// <summary>
+	/// Returns the intrinsic calibration of the camera for an eye.
+	/// </summary>
+	/// <param name="eye">The eye to request the intrinsics for.</param>
+	/// <param name="focalLength">The focal length in pixels.</param>
+	/// <param name="center">The principal point in pixels.</param>
+	/// <returns>`true`, if the intrinsics could be determined, otherwise `false`.</returns>
+	virtual bool GetIntrinsics(vr::EVREye eye, vr::HmdVector2_t& focalLength, vr::HmdVector2_t& center) const = 0;
+
+	/// <summary>
+	/// Returns the extrinsic calibration (i.e. the camera to head transform in OpenVR coordinates) of both cameras.
+	/// </summary>
+	/// <param name="cameraToHead">The transforms for the left and right camera.</param>
+	/// <returns>`true`, if the extrinsics could be determined, otherwise `false`.</returns>
+	virtual bool GetExtrinsics(vr::HmdMatrix34_t (&cameraToHead)[2]) const = 0;
+
+	/// <summary>
+	/// Acquires the source, so that it starts to provide frames.
+	/// </summary>
+	/// <returns>`true`, if the source has been acquired, otherwise `false`.</returns>
+	virtual bool Acquire() = 0;
+
+	/// <summary>
+	/// Releases the source, so that it stops providing frames.
+	/// </summary>
+	virtual void Release() = 0;
+
+	/// <summary>
+	/// Returns `true`, if the source is currently acquired.
+	/// </summary>
+	virtual bool IsAcquired() const noexcept = 0;
+
+	/// <summary>
+	/// Copies the next frame into a buffer, if it is newer than the last frame that has been received.
+	/// </summary>
+	/// <param name="lastFrameSequence">The sequence number of the last frame that has been received.</param>
+	/// <param name="buffer">The buffer to copy the frame into. If this is `nullptr`, only the header of the next frame is returned.</param>
+	/// <param name="bufferSize">The size of <paramref name="buffer" /> in bytes.</param>
+	/// <param name="header">The header of the frame that has been copied.</param>
+	/// <returns>`true`, if a new frame has been copied, otherwise `false`.</returns>
+	virtual bool GetNextFrame(uint32_t lastFrameSequence, uint8_t* buffer, uint32_t bufferSize, vr::CameraVideoStreamFrameHeader_t& header) = 0;
+
+	/// <summary>
+	/// Returns the platform time (in seconds) the frame described by a header has been exposed.
+	/// </summary>
+	/// <param name="header">The header of a frame, returned by <see cref="GetNextFrame" />.</param>
+	/// <returns>The exposure time or `0`, if the source is not able to provide it.</returns>
+	virtual double GetExposureTime(const vr::CameraVideoStreamFrameHeader_t& header) const { return 0.0; }
+
+	/// <summary>
+	/// Returns the lens distortion of the camera for an eye. Sources that provide undistorted frames report no distortion.
+	/// </summary>
+	/// <param name="eye">The eye to request the distortion for.</param>
+	/// <param name="distortion">The distortion model.</param>
+	/// <returns>`true`, if the distortion could be determined, otherwise `false`.</returns>
+	virtual bool GetDistortion(vr::EVREye eye, FCameraDistortion& distortion) const { distortion = FCameraDistortion(); return true; }
+};
+
+/// <summary>
+/// Thread-safe shared pointer to a frame source, as it is shared between a component and its capture worker.
+/// </summary>
+using FCameraFrameSourcePtr = TSharedPtr<ICameraFrameSource, ESPMode::ThreadSafe>;
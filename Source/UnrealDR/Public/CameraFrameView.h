@@ -0,0 +1,180 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "UnrealDR.h"
+#include "CameraFramePool.h"
+#include "CameraFrameView.generated.h"
+
+/// <summary>
+/// An eye of the stereo camera.
+/// </summary>
+UENUM(BlueprintType)
+enum class ECameraEye : uint8
+{
+	Left UMETA(DisplayName = "Left Eye"),
+	Right UMETA(DisplayName = "Right Eye")
+};
+
+/// <summary>
+/// An immutable view of a camera frame, which gives CPU access to the pixels without copying them.
+/// </summary>
+/// <remarks>
+/// The view holds a reference to the pooled frame buffer the frame has been captured into. Frame buffers are never written while they are referenced, so the pixels
+/// stay valid and unchanged for the lifetime of the view, on any thread. In turn, the frame buffer does not return to the pool, before all views of it have been
+/// released, so consumers that hold on to views for longer than a frame need to reserve additional frame buffers. The frame keeps its pool alive, so views may
+/// outlive the stream they have been created from.
+/// </remarks>
+class UNREALDR_API FCameraFrameView
+{
+private:
+	/// <summary>
+	/// The frame the view refers to.
+	/// </summary>
+	FCameraFrameRef m_frame;
+
+	/// <summary>
+	/// The size of the frame (i.e. both eye images) in pixels.
+	/// </summary>
+	uint32 m_width{ 0 };
+	uint32 m_height{ 0 };
+
+	/// <summary>
+	/// The pose of the HMD in tracking space, when the frame has been exposed.
+	/// </summary>
+	FTransform m_pose;
+
+	/// <summary>
+	/// `true`, if <see cref="m_pose" /> is known.
+	/// </summary>
+	bool m_poseValid{ false };
+
+public:
+	FCameraFrameView(const FCameraFrameRef& frame, uint32 width, uint32 height, const FTransform& pose, bool poseValid);
+	virtual ~FCameraFrameView() = default;
+
+	FCameraFrameView(const FCameraFrameView&) = delete;
+	FCameraFrameView& operator=(const FCameraFrameView&) = delete;
+
+public:
+	/// <summary>
+	/// Returns the width of the frame in pixels.
+	/// </summary>
+	uint32 GetWidth() const noexcept { return m_width; }
+
+	/// <summary>
+	/// Returns the height of the frame (i.e. both eye images) in pixels.
+	/// </summary>
+	uint32 GetHeight() const noexcept { return m_height; }
+
+	/// <summary>
+	/// Returns the number of bytes between two rows of the frame.
+	/// </summary>
+	uint32 GetPitch() const noexcept { return m_width * 4; }
+
+	/// <summary>
+	/// Returns the RGBA pixels of the frame. The right eye image is stored in the upper half, the left eye image in the lower half.
+	/// </summary>
+	const uint8* GetData() const noexcept { return m_frame->Data; }
+
+	/// <summary>
+	/// Returns the region of the frame (in pixels) that contains the image of an eye.
+	/// </summary>
+	FIntRect GetEyeRect(vr::EVREye eye) const noexcept;
+
+	/// <summary>
+	/// Returns the first pixel of the image of an eye. Rows are <see cref="GetPitch" /> bytes apart.
+	/// </summary>
+	const uint8* GetEyeData(vr::EVREye eye) const noexcept { return m_frame->Data + this->GetEyeRect(eye).Min.Y * this->GetPitch(); }
+
+	/// <summary>
+	/// Returns a pixel of the image of an eye. Coordinates outside of the image are clamped to its edges.
+	/// </summary>
+	FColor GetPixel(vr::EVREye eye, int32 x, int32 y) const noexcept;
+
+	/// <summary>
+	/// Copies a region of the image of an eye.
+	/// </summary>
+	/// <param name="eye">The eye to copy from.</param>
+	/// <param name="region">The region in pixels of the eye image. It is clipped to the image.</param>
+	/// <param name="pixels">Receives the pixels of the clipped region row by row.</param>
+	/// <returns>The clipped region.</returns>
+	FIntRect CopyRegion(vr::EVREye eye, const FIntRect& region, TArray<FColor>& pixels) const;
+
+	/// <summary>
+	/// Returns the header of the frame, as it has been returned by the frame source.
+	/// </summary>
+	const vr::CameraVideoStreamFrameHeader_t& GetHeader() const noexcept { return m_frame->Header; }
+
+	/// <summary>
+	/// Returns the sequence number of the frame.
+	/// </summary>
+	uint32 GetFrameSequence() const noexcept { return m_frame->Header.nFrameSequence; }
+
+	/// <summary>
+	/// Returns the platform time (in seconds), the frame has been exposed.
+	/// </summary>
+	double GetExposureTime() const noexcept { return m_frame->ExposureTime; }
+
+	/// <summary>
+	/// Returns the platform time (in seconds), the frame has been copied from the stream.
+	/// </summary>
+	double GetCaptureTime() const noexcept { return m_frame->CaptureTime; }
+
+	/// <summary>
+	/// Returns the pose of the HMD in tracking space, when the frame has been exposed.
+	/// </summary>
+	const FTransform& GetPose() const noexcept { return m_pose; }
+
+	/// <summary>
+	/// Returns `true`, if the pose of the frame is known.
+	/// </summary>
+	bool IsPoseValid() const noexcept { return m_poseValid; }
+
+	/// <summary>
+	/// Returns the frame the view refers to.
+	/// </summary>
+	const FCameraFrame& GetFrame() const noexcept { return *m_frame; }
+};
+
+/// <summary>
+/// Thread-safe shared pointer to an immutable frame view.
+/// </summary>
+using FCameraFrameViewPtr = TSharedPtr<const FCameraFrameView, ESPMode::ThreadSafe>;
+
+/// <summary>
+/// Blueprint handle of a camera frame. It keeps the frame alive, as long as it is stored, so it should not be held on to for longer than needed.
+/// </summary>
+USTRUCT(BlueprintType)
+struct UNREALDR_API FCameraFrameHandle
+{
+	GENERATED_BODY()
+
+	/// <summary>
+	/// The sequence number of the frame.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Frames") int32 FrameSequence { 0 };
+
+	/// <summary>
+	/// The size of each eye image in pixels.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Frames") FIntPoint EyeSize { 0, 0 };
+
+	/// <summary>
+	/// The pose of the HMD in tracking space, when the frame has been exposed.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Frames") FTransform Pose;
+
+	/// <summary>
+	/// `true`, if the pose of the frame is known.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Frames") bool bPoseValid { false };
+
+	/// <summary>
+	/// The view of the frame, or an invalid pointer, if the handle is empty.
+	/// </summary>
+	FCameraFrameViewPtr View;
+
+	FCameraFrameHandle() = default;
+	FCameraFrameHandle(const FCameraFrameViewPtr& view);
+};
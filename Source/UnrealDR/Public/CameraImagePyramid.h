@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "UnrealDR.h"
+
+/// <summary>
+/// Downsamples RGBA images by powers of two, e.g. to upload a low resolution periphery of the camera images.
+/// </summary>
+/// <remarks>
+/// Each level halves the size of the previous one with a 2x2 box filter, rounding odd sizes up by repeating the last column or row. Intermediate levels are kept in
+/// scratch buffers that are allocated once, so that building the pyramid does not allocate. Only the last level is written into the target image. Calls must not
+/// overlap, but may happen on any thread.
+/// </remarks>
+class UNREALDR_API FCameraImagePyramid
+{
+private:
+	/// <summary>
+	/// The size of the source image in pixels.
+	/// </summary>
+	uint32 m_width{ 0 };
+	uint32 m_height{ 0 };
+
+	/// <summary>
+	/// The number of times the source image is halved.
+	/// </summary>
+	int32 m_levels{ 0 };
+
+	/// <summary>
+	/// The intermediate levels, which alternate between both buffers.
+	/// </summary>
+	TArray<uint8> m_scratch[2];
+
+public:
+	FCameraImagePyramid(uint32 width, uint32 height, int32 levels);
+	virtual ~FCameraImagePyramid() = default;
+
+public:
+	/// <summary>
+	/// Returns the size of a level in pixels, where level `0` is the source image.
+	/// </summary>
+	void GetLevelSize(int32 level, uint32& width, uint32& height) const noexcept;
+
+	/// <summary>
+	/// Returns the number of times the source image is halved.
+	/// </summary>
+	int32 GetLevels() const noexcept { return m_levels; }
+
+	/// <summary>
+	/// Downsamples an image to the last level of the pyramid.
+	/// </summary>
+	/// <param name="image">Pointer to the first pixel of the source image.</param>
+	/// <param name="pitch">The number of bytes between two rows of the source image.</param>
+	/// <param name="target">Pointer to the first pixel of the target image, which has the size of the last level.</param>
+	/// <param name="targetPitch">The number of bytes between two rows of the target image.</param>
+	void Build(const uint8* image, uint32 pitch, uint8* target, uint32 targetPitch);
+
+	/// <summary>
+	/// Halves an RGBA image with a 2x2 box filter. Each target channel is the rounded average of the rounded averages of both rows.
+	/// </summary>
+	/// <param name="source">Pointer to the first pixel of the source image.</param>
+	/// <param name="sourcePitch">The number of bytes between two rows of the source image.</param>
+	/// <param name="width">The width of the source image in pixels.</param>
+	/// <param name="height">The height of the source image in pixels.</param>
+	/// <param name="target">Pointer to the first pixel of the target image, which is `(width + 1) / 2` x `(height + 1) / 2` pixels large.</param>
+	/// <param name="targetPitch">The number of bytes between two rows of the target image.</param>
+	static void Downsample(const uint8* source, uint32 sourcePitch, uint32 width, uint32 height, uint8* target, uint32 targetPitch) noexcept;
+};
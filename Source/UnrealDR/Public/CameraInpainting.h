@@ -0,0 +1,213 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "UnrealDR.h"
+#include "CameraFramePool.h"
+
+/// <summary>
+/// Settings of the inpainting of masked regions.
+/// </summary>
+struct FCameraInpaintingSettings
+{
+	/// <summary>
+	/// The maximum number of pyramid levels, including the full resolution.
+	/// </summary>
+	int32 PyramidLevels{ 4 };
+
+	/// <summary>
+	/// The number of search and reconstruction iterations on each pyramid level, if the image is solved from scratch.
+	/// </summary>
+	int32 Iterations{ 4 };
+
+	/// <summary>
+	/// The number of iterations at full resolution, if the nearest-neighbor field of the previous frame can be reused.
+	/// </summary>
+	int32 SteadyStateIterations{ 2 };
+
+	/// <summary>
+	/// The time (in seconds) per frame, after which no further iterations are started.
+	/// </summary>
+	float TimeBudget{ 0.008f };
+};
+
+/// <summary>
+/// Fills masked regions of both eye images with content synthesized from their surroundings, using PatchMatch.
+/// </summary>
+/// <remarks>
+/// For each masked pixel, a nearest-neighbor field (NNF) stores the center of the unmasked patch that looks most like the patch around it. The field is improved by
+/// propagating good matches from neighbors and by a random search with shrinking radius, after which every masked pixel is reconstructed from the matches of all
+/// patches overlapping it. Images are solved coarse-to-fine on a pyramid, so that large holes are filled with coherent structure. Search and reconstruction process
+/// tiles of rows in parallel: within a tile, matches are propagated in scan order, while neighbors from other tiles are read from a snapshot taken at the start of the
+/// iteration. The field of the previous frame is used as the starting point of the next one, so that the result is temporally coherent and, as long as the mask does
+/// not change much, only a few iterations at full resolution are required. No further iterations are started, once the time budget is exhausted; the remaining
+/// levels are only reconstructed from the upsampled field. Masked pixels without any unmasked patch at the coarsest level are left unchanged. Calls must not overlap,
+/// but may happen on any thread.
+/// </remarks>
+class UNREALDR_API FCameraInpainting
+{
+public:
+	/// <summary>
+	/// The radius of a patch in pixels. Patches are `2 * PatchRadius + 1` pixels wide and high.
+	/// </summary>
+	static constexpr int32 PatchRadius = 3;
+
+	/// <summary>
+	/// The number of rows of a tile that is processed by one worker.
+	/// </summary>
+	static constexpr int32 TileRows = 16;
+
+private:
+	/// <summary>
+	/// A single entry of the nearest-neighbor field, storing the center of the matching patch.
+	/// </summary>
+	struct FMatch
+	{
+		int16 X;
+		int16 Y;
+	};
+
+	/// <summary>
+	/// An image of the pyramid.
+	/// </summary>
+	struct FLevel
+	{
+		/// <summary>
+		/// The size of the image in pixels.
+		/// </summary>
+		int32 Width{ 0 };
+		int32 Height{ 0 };
+
+		/// <summary>
+		/// The RGBA image with a replicated border of <see cref="PatchRadius" /> pixels on each side, so that patches around any pixel can be read.
+		/// </summary>
+		TArray<uint8> Image;
+
+		/// <summary>
+		/// `1` for each masked pixel, otherwise `0`.
+		/// </summary>
+		TArray<uint8> Holes;
+
+		/// <summary>
+		/// `1` for each pixel whose patch is fully inside the image and does not contain a masked pixel, otherwise `0`.
+		/// </summary>
+		TArray<uint8> Sources;
+
+		/// <summary>
+		/// The indices of all pixels with a valid source patch.
+		/// </summary>
+		TArray<int32> SourceIndices;
+
+		/// <summary>
+		/// The nearest-neighbor field. Unmasked pixels match themselves.
+		/// </summary>
+		TArray<FMatch> Field;
+
+		/// <summary>
+		/// A copy of the field taken at the start of each search iteration, from which neighbors in other tiles are read.
+		/// </summary>
+		TArray<FMatch> Snapshot;
+
+		int32 GetPitch() const noexcept { return (Width + 2 * PatchRadius) * 4; }
+		uint8* GetPixel(int32 x, int32 y) noexcept { return Image.GetData() + (y + PatchRadius) * this->GetPitch() + (x + PatchRadius) * 4; }
+		const uint8* GetPixel(int32 x, int32 y) const noexcept { return Image.GetData() + (y + PatchRadius) * this->GetPitch() + (x + PatchRadius) * 4; }
+	};
+
+	/// <summary>
+	/// The state of a single eye.
+	/// </summary>
+	struct FEyeState
+	{
+		/// <summary>
+		/// The image pyramid, starting at full resolution.
+		/// </summary>
+		TArray<FLevel> Levels;
+
+		/// <summary>
+		/// The full resolution nearest-neighbor field of the previous frame. Its matches are relative to the region the frame has been inpainted in.
+		/// </summary>
+		TArray<FMatch> PreviousField;
+
+		/// <summary>
+		/// The upper left corner of the region of the previous frame within the eye image.
+		/// </summary>
+		FIntPoint PreviousOrigin{ 0, 0 };
+	};
+
+	/// <summary>
+	/// The size of a frame in pixels, containing both eye images.
+	/// </summary>
+	uint32 m_frameWidth{ 0 };
+	uint32 m_frameHeight{ 0 };
+
+	/// <summary>
+	/// The settings of the inpainting.
+	/// </summary>
+	FCameraInpaintingSettings m_settings;
+
+	/// <summary>
+	/// The state of the left and right eye.
+	/// </summary>
+	FEyeState m_eyes[2];
+
+	/// <summary>
+	/// The pool of frames the results are written into.
+	/// </summary>
+	FCameraFramePoolPtr m_outputPool;
+
+public:
+	FCameraInpainting(uint32 frameWidth, uint32 frameHeight, const FCameraInpaintingSettings& settings, int32 outputFrames = 3);
+	virtual ~FCameraInpainting() = default;
+
+	FCameraInpainting(const FCameraInpainting&) = delete;
+	FCameraInpainting& operator=(const FCameraInpainting&) = delete;
+
+public:
+	/// <summary>
+	/// Fills the masked regions of both eye images of a frame.
+	/// </summary>
+	/// <param name="frame">The camera frame.</param>
+	/// <param name="mask">An 8 bit mask in the layout of the frame. Pixels with non-zero values are filled.</param>
+	/// <param name="regions">The regions of the left and right eye image (in pixels) to inpaint, or `nullptr` to inpaint the whole images. Only the unmasked pixels
+	/// within a region are used as sources, so regions should include enough of the surroundings of the mask. An empty region skips the eye.</param>
+	/// <returns>A copy of the frame with the masked regions filled, or an invalid reference, if all output frames are still in use.</returns>
+	FCameraFrameRef Inpaint(const FCameraFrame& frame, const TArray<uint8>& mask, const FIntRect* regions = nullptr);
+
+	/// <summary>
+	/// Discards the nearest-neighbor fields of the previous frame, so that the next frame is solved from scratch.
+	/// </summary>
+	void Reset() noexcept;
+
+	/// <summary>
+	/// Returns the pool the results are written into. It must outlive all pending uploads of a result.
+	/// </summary>
+	const FCameraFramePoolPtr& GetOutputPool() const noexcept { return m_outputPool; }
+
+	/// <summary>
+	/// Computes the sum of absolute differences between two RGBA patches.
+	/// </summary>
+	/// <param name="a">The top-left pixel of the first patch.</param>
+	/// <param name="aPitch">The pitch of the first image in bytes.</param>
+	/// <param name="b">The top-left pixel of the second patch.</param>
+	/// <param name="bPitch">The pitch of the second image in bytes.</param>
+	static uint32 ComputePatchDistance(const uint8* a, int32 aPitch, const uint8* b, int32 bPitch) noexcept;
+
+private:
+	bool InpaintEye(FEyeState& eye, uint8* image, uint32 pitch, const uint8* mask, uint32 maskPitch, const FIntPoint& origin, int32 width, int32 height, uint32 seed, double deadline);
+	void BuildPyramid(FEyeState& eye, int32 levels);
+	void InitializeCoarsest(FLevel& level, uint32 seed);
+	bool ReuseField(FLevel& level, const TArray<FMatch>& previousField, const FIntPoint& offset, uint32 seed);
+	void Upsample(const FLevel& coarse, FLevel& fine, uint32 seed);
+	void Search(FLevel& level, uint32 seed, bool reverse);
+	void Reconstruct(FLevel& level);
+
+	static void ResizeLevel(FLevel& level, int32 width, int32 height);
+	static void ComputeSources(FLevel& level);
+	static void ExtendBorder(FLevel& level);
+	static uint32 ComputeCost(const FLevel& level, int32 x, int32 y, int32 sourceX, int32 sourceY) noexcept;
+};
+
+/// <summary>
+/// Thread-safe shared pointer to an inpainting engine.
+/// </summary>
+using FCameraInpaintingPtr = TSharedPtr<FCameraInpainting, ESPMode::ThreadSafe>;
@@ -0,0 +1,236 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "Async/Future.h"
+
+#include "UnrealDR.h"
+#include "CameraFramePool.h"
+
+/// <summary>
+/// The stages of the camera pipeline, for which latencies are measured.
+/// </summary>
+enum class ECameraLatencyStage : uint8
+{
+	/// <summary>
+	/// From exposure to the header poll that returned the frame. Unavailable, if the frame source does not report exposure times (e.g. OpenVR).
+	/// </summary>
+	Exposure = 0,
+
+	/// <summary>
+	/// From the header poll to the frame being copied into a frame buffer.
+	/// </summary>
+	Copy,
+
+	/// <summary>
+	/// From the frame being copied to the texture upload being enqueued on the game thread.
+	/// </summary>
+	Publish,
+
+	/// <summary>
+	/// From the texture upload being enqueued to the render thread finishing the upload.
+	/// </summary>
+	Upload,
+
+	/// <summary>
+	/// From the upload being finished to the end of the first render frame that samples the new texture.
+	/// </summary>
+	Render,
+
+	/// <summary>
+	/// From exposure to the end of the first render frame that samples the new texture. If the frame source does not report exposure times, this starts at the
+	/// header poll instead.
+	/// </summary>
+	Total,
+
+	Count
+};
+
+/// <summary>
+/// Summary of the latencies of a pipeline stage over the measurement window.
+/// </summary>
+struct FCameraLatencySummary
+{
+	float Min{ 0.f };
+	float Avg{ 0.f };
+	float P50{ 0.f };
+	float P95{ 0.f };
+	float P99{ 0.f };
+};
+
+/// <summary>
+/// Collects per-frame timestamps along the camera pipeline and computes latency statistics from them.
+/// </summary>
+/// <remarks>
+/// Timestamps are reported from the capture worker (through the frame), the game thread and the render thread, which is why all methods are thread-safe. Once a
+/// frame has been rendered, its stage latencies are stored in a sliding window of the most recent frames and, if enabled, appended to a CSV file for offline
+/// analysis. The statistics are published to the `STAT UnrealDR` group by calling <see cref="PublishStats" /> on the game thread.
+/// </remarks>
+class UNREALDR_API FCameraLatencyStats : public TSharedFromThis<FCameraLatencyStats, ESPMode::ThreadSafe>
+{
+private:
+	/// <summary>
+	/// The timestamps of a frame that has not yet been rendered.
+	/// </summary>
+	struct FPendingFrame
+	{
+		uint32 Sequence{ 0 };
+		double Exposure{ 0.0 };
+		bool bHasExposure{ false };
+		double HeaderPoll{ 0.0 };
+		double CopyDone{ 0.0 };
+		double UploadEnqueued{ 0.0 };
+		double UploadDone{ 0.0 };
+		int32 PendingUploads{ 0 };
+	};
+
+private:
+	mutable FCriticalSection m_lock;
+
+	/// <summary>
+	/// Frames that have been enqueued for upload, but not yet rendered.
+	/// </summary>
+	TArray<FPendingFrame> m_pendingFrames;
+
+	/// <summary>
+	/// The latencies (in milliseconds) of the most recent frames for each stage.
+	/// </summary>
+	TArray<float> m_samples[static_cast<int32>(ECameraLatencyStage::Count)];
+
+	/// <summary>
+	/// The index of the next sample to overwrite in the sliding window of each stage. Stages can be skipped for frames that do not provide their timestamps.
+	/// </summary>
+	int32 m_nextSample[static_cast<int32>(ECameraLatencyStage::Count)]{};
+
+	/// <summary>
+	/// The number of samples in the sliding window.
+	/// </summary>
+	int32 m_windowSize{ 256 };
+
+	/// <summary>
+	/// The number of frames that have been rendered.
+	/// </summary>
+	uint32 m_renderedFrames{ 0 };
+
+	/// <summary>
+	/// The number of game ticks that did not receive a new frame and kept showing the previous one.
+	/// </summary>
+	uint32 m_repeatedFrames{ 0 };
+
+	/// <summary>
+	/// The path of the CSV file or an empty string, if CSV export is disabled.
+	/// </summary>
+	FString m_csvFileName;
+
+	/// <summary>
+	/// CSV lines that have not yet been written to disk.
+	/// </summary>
+	FString m_csvBuffer;
+
+	/// <summary>
+	/// The number of lines in <see cref="m_csvBuffer" />.
+	/// </summary>
+	int32 m_csvBufferedLines{ 0 };
+
+	/// <summary>
+	/// CSV lines that have been flushed, but not yet been written by the writer task.
+	/// </summary>
+	FString m_csvPending;
+
+	/// <summary>
+	/// `true`, while the writer task appends <see cref="m_csvPending" /> to the file. Only one writer runs at a time, so batches are written in order.
+	/// </summary>
+	bool m_csvWriting{ false };
+
+	/// <summary>
+	/// The most recently started writer task.
+	/// </summary>
+	TFuture<void> m_csvWriter;
+
+	/// <summary>
+	/// The handle of the end of frame callback on the render thread. Must only be accessed from the render thread.
+	/// </summary>
+	FDelegateHandle m_endFrameHandle;
+
+public:
+	FCameraLatencyStats(int32 windowSize = 256);
+	virtual ~FCameraLatencyStats();
+
+public:
+	/// <summary>
+	/// Enables exporting per-frame timestamps and latencies to a CSV file. Lines are written in batches on a background thread.
+	/// </summary>
+	/// <param name="fileName">The path of the CSV file.</param>
+	void EnableCsvExport(const FString& fileName);
+
+	/// <summary>
+	/// Writes all buffered CSV lines to disk. Lines are appended by a single writer task on the thread pool, so they are written in order.
+	/// </summary>
+	/// <param name="wait">`true`, to wait until all lines have been written, `false` to return immediately.</param>
+	void FlushCsv(bool wait = false);
+
+	/// <summary>
+	/// Starts receiving end of frame notifications from the render thread, which are used to determine when a frame has been rendered.
+	/// </summary>
+	void RegisterRenderFrameCallback();
+
+	/// <summary>
+	/// Stops receiving end of frame notifications from the render thread.
+	/// </summary>
+	void UnregisterRenderFrameCallback();
+
+	/// <summary>
+	/// Records that the texture uploads for a frame have been enqueued. Must be called before the uploads can complete.
+	/// </summary>
+	/// <param name="frame">The frame that is uploaded.</param>
+	/// <param name="uploads">The number of uploads that have been enqueued for the frame.</param>
+	void MarkUploadEnqueued(const FCameraFrame& frame, int32 uploads);
+
+	/// <summary>
+	/// Records that an upload of a frame has been finished. Called from the render thread.
+	/// </summary>
+	void MarkUploadDone(uint32 sequence);
+
+	/// <summary>
+	/// Records the end of a render frame. All frames, whose uploads have been finished before, are considered rendered. Called from the render thread.
+	/// </summary>
+	void MarkRenderFrameEnd();
+
+	/// <summary>
+	/// Records that a game tick did not receive a new frame.
+	/// </summary>
+	void MarkRepeatedFrame();
+
+	/// <summary>
+	/// Returns the latency summary of a pipeline stage in milliseconds.
+	/// </summary>
+	FCameraLatencySummary GetSummary(ECameraLatencyStage stage) const;
+
+	/// <summary>
+	/// Returns `true`, if the sliding window contains samples for a pipeline stage. The exposure stage is unavailable, if the frame source does not report
+	/// exposure times, in which case its summary must not be reported as zero latency.
+	/// </summary>
+	bool IsStageAvailable(ECameraLatencyStage stage) const;
+
+	/// <summary>
+	/// Publishes the latency summaries and frame counters to the `STAT UnrealDR` group.
+	/// </summary>
+	/// <param name="droppedFrames">The number of frames dropped, because no frame buffer was available.</param>
+	/// <param name="skippedFrames">The number of frames that have been overwritten before the game thread picked them up.</param>
+	void PublishStats(int32 droppedFrames, int32 skippedFrames) const;
+
+	/// <summary>
+	/// Returns the name of a pipeline stage.
+	/// </summary>
+	static const TCHAR* GetStageName(ECameraLatencyStage stage) noexcept;
+
+private:
+	void CompleteFrame(const FPendingFrame& frame, double renderTime);
+	void WriteCsv();
+	void WaitForCsvWriter();
+};
+
+/// <summary>
+/// Thread-safe shared pointer to latency statistics, as they are shared with render commands.
+/// </summary>
+using FCameraLatencyStatsPtr = TSharedPtr<FCameraLatencyStats, ESPMode::ThreadSafe>;
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/Float16.h"
+
+#include "UnrealDR.h"
+#include "CameraFramePool.h"
+#include "CameraImagePyramid.h"
+
+/// <summary>
+/// Settings of the optical flow estimation.
+/// </summary>
+struct FCameraOpticalFlowSettings
+{
+	/// <summary>
+	/// The number of times the eye images are halved, before blocks are matched. The level is lowered, if the eye images become too small.
+	/// </summary>
+	int32 PyramidLevel{ 2 };
+
+	/// <summary>
+	/// The largest displacement (in pixels of the pyramid level) that is searched in each direction.
+	/// </summary>
+	int32 SearchRadius{ 4 };
+
+	/// <summary>
+	/// The matching cost, by which a displacement has to beat zero motion to be chosen. It keeps noise in flat regions from being mistaken for motion.
+	/// </summary>
+	uint32 ZeroMotionBias{ 32 };
+};
+
+/// <summary>
+/// Estimates the motion between two consecutive camera frames with block matching, so that the images can be warped to the time of each rendered frame.
+/// </summary>
+/// <remarks>
+/// Both eye images of each frame are downsampled with a <see cref="FCameraImagePyramid" /> and converted to luminance. The current image is divided into blocks of
+/// 8x8 pixels, and each block is searched exhaustively in the previous image within the search radius, using the sum of absolute differences (SAD) as matching
+/// cost. Rows of blocks are matched in parallel, and the SAD of each candidate is computed on two rows at a time with SSE2. The displacement with the lowest cost is
+/// refined to sub-pixel precision by fitting a parabola to the costs of its neighbors. The luminance of the current frame is kept, so that the next call only has to
+/// downsample its new frame, if it is called with consecutive frames. The result contains the motion of each block from the previous to the current frame in
+/// texture coordinates of the eye image, as pairs of 16 bit floats in the layout of the frame buffer (right eye in the upper half, left eye in the lower half).
+/// Calls must not overlap, but may happen on any thread.
+/// </remarks>
+class UNREALDR_API FCameraOpticalFlow
+{
+public:
+	/// <summary>
+	/// The edge length (in pixels of the pyramid level) of the blocks that are matched.
+	/// </summary>
+	static constexpr int32 BlockSize = 8;
+
+	/// <summary>
+	/// The largest supported search radius.
+	/// </summary>
+	static constexpr int32 MaxSearchRadius = 16;
+
+private:
+	/// <summary>
+	/// The settings of the flow estimation.
+	/// </summary>
+	FCameraOpticalFlowSettings m_settings;
+
+	/// <summary>
+	/// The size of the frames in pixels.
+	/// </summary>
+	uint32 m_frameWidth{ 0 };
+	uint32 m_frameHeight{ 0 };
+
+	/// <summary>
+	/// The size of the eye images at the pyramid level in pixels.
+	/// </summary>
+	uint32 m_width{ 0 };
+	uint32 m_height{ 0 };
+
+	/// <summary>
+	/// The number of blocks in each row and column of an eye image.
+	/// </summary>
+	int32 m_columns{ 0 };
+	int32 m_rows{ 0 };
+
+	/// <summary>
+	/// Downsample the images of the left and right eye.
+	/// </summary>
+	TUniquePtr<FCameraImagePyramid> m_pyramids[2];
+
+	/// <summary>
+	/// The downsampled RGBA images of the left and right eye.
+	/// </summary>
+	TArray<uint8> m_downsampled[2];
+
+	/// <summary>
+	/// The luminance of the left and right eye image of two frames, which alternate between previous and current frame.
+	/// </summary>
+	TArray<uint8> m_luminance[2][2];
+
+	/// <summary>
+	/// The index of the luminance images of the current frame.
+	/// </summary>
+	int32 m_current{ 0 };
+
+	/// <summary>
+	/// The sequence number and exposure time of the current frame, or a negative exposure time, if no frame has been converted yet.
+	/// </summary>
+	uint32 m_currentSequence{ 0 };
+	double m_currentExposureTime{ -1.0 };
+
+	/// <summary>
+	/// The pool of frames the flow fields are written into.
+	/// </summary>
+	FCameraFramePoolPtr m_outputPool;
+
+public:
+	FCameraOpticalFlow(uint32 frameWidth, uint32 frameHeight, const FCameraOpticalFlowSettings& settings, int32 outputFrames = 3);
+	virtual ~FCameraOpticalFlow() = default;
+	FCameraOpticalFlow(const FCameraOpticalFlow&) = delete;
+	FCameraOpticalFlow& operator=(const FCameraOpticalFlow&) = delete;
+
+public:
+	/// <summary>
+	/// Estimates the motion between two frames.
+	/// </summary>
+	/// <param name="previous">The earlier frame.</param>
+	/// <param name="current">The later frame.</param>
+	/// <returns>A frame containing the flow field with the header and exposure time of the current frame, or an invalid reference, if all output frames are still
+	/// in use.</returns>
+	FCameraFrameRef Compute(const FCameraFrame& previous, const FCameraFrame& current);
+
+	/// <summary>
+	/// Forgets the luminance of the current frame, e.g. after a gap in the stream.
+	/// </summary>
+	void Reset() noexcept { m_currentExposureTime = -1.0; }
+
+	/// <summary>
+	/// Returns the size of the flow field of an eye image, which contains one flow vector per block. The flow field of both eyes is twice as high.
+	/// </summary>
+	void GetFieldSize(uint32& width, uint32& height) const noexcept { width = static_cast<uint32>(m_columns); height = static_cast<uint32>(m_rows); }
+
+	/// <summary>
+	/// Returns the pool the flow fields are written into. It must outlive all pending uploads of a flow field.
+	/// </summary>
+	const FCameraFramePoolPtr& GetOutputPool() const noexcept { return m_outputPool; }
+
+	/// <summary>
+	/// Computes the sum of absolute differences between two blocks of <see cref="BlockSize" /> x <see cref="BlockSize" /> 8 bit values.
+	/// </summary>
+	/// <param name="block">The first value of the block.</param>
+	/// <param name="reference">The first value of the block it is compared with.</param>
+	/// <param name="pitch">The number of bytes between two rows of both blocks.</param>
+	static uint32 ComputeBlockCost(const uint8* block, const uint8* reference, uint32 pitch) noexcept;
+
+private:
+	void ConvertFrame(const FCameraFrame& frame, int32 index);
+	void MatchBlockRow(int32 eye, int32 row, FFloat16* field) const;
+};
+
+/// <summary>
+/// Thread-safe shared pointer to an optical flow engine.
+/// </summary>
+using FCameraOpticalFlowPtr = TSharedPtr<FCameraOpticalFlow, ESPMode::ThreadSafe>;
@@ -9,8 +9,102 @@
 #endif // WITH_EDITORONLY_DATA
 
 #include "UnrealDR.h"
+#include "CameraFrameSource.h"
+#include "OpenVRCameraFrameSource.h"
+#include "CameraStream.h"
+#include "CameraCalibrationCache.h"
+#include "CameraStreamRecorder.h"
+#include "HmdPoseHistory.h"
+#include "CameraFrameView.h"
 #include "CameraSeeThroughComponent.generated.h"
 
+/// <summary>
+/// Called with a view of each new camera frame.
+/// </summary>
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnCameraFrameView, const FCameraFrameViewPtr&);
+
+/// <summary>
+/// Called, when a component stops streaming, because play has ended or it has been unregistered.
+/// </summary>
+DECLARE_MULTICAST_DELEGATE(FOnCameraStreamingEnded);
+
+/// <summary>
+/// Called with a handle of each new camera frame.
+/// </summary>
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnCameraFrameReceived, const FCameraFrameHandle&, Frame);
+
+/// <summary>
+/// The source the camera frames are streamed from.
+/// </summary>
+UENUM(BlueprintType)
+enum class ECameraFrameSourceType : uint8
+{
+	/// <summary>
+	/// Streams frames from the OpenVR tracked camera of the HMD or another tracked device.
+	/// </summary>
+	OpenVR UMETA(DisplayName = "OpenVR Tracked Camera"),
+
+	/// <summary>
+	/// Generates deterministic frames, so that the pipeline can be run without an HMD.
+	/// </summary>
+	Synthetic UMETA(DisplayName = "Synthetic"),
+
+	/// <summary>
+	/// Replays a camera stream capture file.
+	/// </summary>
+	Replay UMETA(DisplayName = "Replay")
+};
+
+/// <summary>
+/// Frame rate and latency counters of a camera stream, e.g. to compare multiple tracked devices that are streamed in parallel.
+/// </summary>
+USTRUCT(BlueprintType)
+struct UNREALDR_API FCameraStreamStatistics
+{
+	GENERATED_BODY()
+
+	/// <summary>
+	/// The key that identifies the stream, which includes the tracked device index for OpenVR streams.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Statistics") FString StreamKey;
+
+	/// <summary>
+	/// The rate (in frames per second) at which the camera delivers frames, measured over the last second.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Statistics") float FrameRate { 0.f };
+
+	/// <summary>
+	/// The median latency (in milliseconds) from polling a frame to it being copied by the capture worker.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Statistics") float CopyLatency { 0.f };
+
+	/// <summary>
+	/// The median latency (in milliseconds) from exposure to the first render frame that samples a frame. If <see cref="bExposureLatencyAvailable" /> is
+	/// `false`, this starts at the header poll instead.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Statistics") float TotalLatency { 0.f };
+
+	/// <summary>
+	/// The 95th percentile of the latency (in milliseconds) from exposure to the first render frame that samples a frame.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Statistics") float TotalLatencyP95 { 0.f };
+
+	/// <summary>
+	/// `true`, if the frame source reports exposure times, so that the total latency includes the time from exposure to the header poll.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Statistics") bool bExposureLatencyAvailable { false };
+
+	/// <summary>
+	/// The number of frames dropped, because no frame buffer was available.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Statistics") int32 DroppedFrames { 0 };
+
+	/// <summary>
+	/// The number of frames that have been overwritten before the game thread picked them up.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Statistics") int32 SkippedFrames { 0 };
+};
+
 UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
 class UNREALDR_API UCameraSeeThroughComponent : public USceneComponent
 {
@@ -23,14 +117,24 @@ private:
 	vr::IVRSystem* m_system{ nullptr };
 
 	/// <summary>
-	/// Interface pointer to the tracked camera instance.
+	/// The handle of the callback that finishes the setup, once the VR system is ready. Valid, while the callback is pending.
+	/// </summary>
+	FDelegateHandle m_systemReadyHandle;
+
+	/// <summary>
+	/// The index of the tracked device, whose camera is streamed, resolved from <see cref="TrackedDeviceIndex" /> and <see cref="TrackedDeviceSerial" />.
 	/// </summary>
-	vr::IVRTrackedCamera* m_camera{ nullptr };
+	vr::TrackedDeviceIndex_t m_trackedDevice{ vr::k_unTrackedDeviceIndex_Hmd };
 
 	/// <summary>
-	/// Handle of the tracked camera.
+	/// The camera stream, which is shared with all other components that display the same frame source.
 	/// </summary>
-	vr::TrackedCameraHandle_t m_trackedCamera{ INVALID_TRACKED_CAMERA_HANDLE };
+	FCameraStreamPtr m_stream;
+
+	/// <summary>
+	/// `true`, if the component has started the camera stream.
+	/// </summary>
+	bool m_streaming{ false };
 
 	/// <summary>
 	/// Camera stream frame buffer width.
@@ -42,36 +146,97 @@ private:
 	/// </summary>
 	uint32_t m_frameHeight{ 0 };
 	
-	/// <summary>
-	/// Camera stream frame buffer size in bytes.
-	/// </summary>
-	uint32_t m_frameBufferSize{ 0 };
-	
 	/// <summary>
 	/// Index of last streamed image.
 	/// </summary>
 	uint32_t m_lastFrameIndex{ 0 };
-	
+
 	/// <summary>
-	/// Pointer to the camera stream frame buffer.
+	/// Index of the frame the chroma key regions have been taken from.
 	/// </summary>
-	uint8_t* m_frameBuffer{ nullptr };
+	uint32_t m_chromaKeyFrameIndex{ 0 };
 
 	/// <summary>
-	/// The regions of the frame images to update from the frame buffer. One for each eye.
+	/// The fovea region that has been passed to the material, relative to the size of an eye image.
 	/// </summary>
-	TMap<vr::EVREye, FUpdateTextureRegion2D*> m_frameBufferRegions;
+	FLinearColor m_boundFoveaRect{ -1.f, -1.f, -1.f, -1.f };
+	
+	/// <summary>
+	/// The recorder that writes the camera stream to disk, if recording is enabled.
+	/// </summary>
+	TUniquePtr<FCameraStreamRecorder> m_recorder;
 
 	/// <summary>
-	/// Time since last valid image update from camera stream.
+	/// `true`, if a warning about missing frames has been issued since the last valid image update.
 	/// </summary>
-	float m_timeSinceLastFrameUpdate{ 0 };
+	bool m_noFramesWarningIssued{ false };
 
 	/// <summary>
 	/// The planes that receive the camera images for each eye.
 	/// </summary>
 	TMap<vr::EVREye, UStaticMeshComponent*> m_viewPlanes;
 
+	/// <summary>
+	/// The relative transforms of the view planes without reprojection.
+	/// </summary>
+	TMap<vr::EVREye, FTransform> m_viewPlaneTransforms;
+
+	/// <summary>
+	/// The recent HMD poses, used to look up the pose at the exposure time of a frame.
+	/// </summary>
+	FHmdPoseHistory m_poseHistory;
+
+	/// <summary>
+	/// The HMD pose at the exposure time of the currently displayed frame.
+	/// </summary>
+	FTransform m_framePose;
+
+	/// <summary>
+	/// `true`, if <see cref="m_framePose" /> is known.
+	/// </summary>
+	bool m_framePoseValid{ false };
+
+	/// <summary>
+	/// The view of the latest frame, which is created when it is first requested.
+	/// </summary>
+	FCameraFrameViewPtr m_latestFrameView;
+
+	/// <summary>
+	/// Called with a view of each new camera frame.
+	/// </summary>
+	FOnCameraFrameView m_onFrameView;
+
+	/// <summary>
+	/// Called, when the component stops streaming, so that consumers that wait for a frame do not wait forever.
+	/// </summary>
+	FOnCameraStreamingEnded m_onStreamingEnded;
+
+	/// <summary>
+	/// The bounds of the region of interest relative to the size of an eye image, set from a mask texture or polygon.
+	/// </summary>
+	FBox2D m_regionOfInterestImageBounds{ ForceInit };
+
+	/// <summary>
+	/// The world-space bounds of the region of interest, which are projected into both eye images.
+	/// </summary>
+	FBox m_regionOfInterestWorldBounds{ ForceInit };
+
+	/// <summary>
+	/// The poses of the left and right camera relative to the component, which the world-space region of interest is projected with.
+	/// </summary>
+	FTransform m_cameraTransforms[2];
+
+	/// <summary>
+	/// The focal lengths and principal points of the left and right camera in pixels.
+	/// </summary>
+	FVector2D m_focalLengths[2];
+	FVector2D m_principalPoints[2];
+
+	/// <summary>
+	/// `true`, if the calibration of both cameras is available to project the world-space region of interest.
+	/// </summary>
+	bool m_hasCameraProjection{ false };
+
 	/// <summary>
 	/// The unit scale from world coordinates to actual meters.
 	/// </summary>
@@ -103,15 +268,84 @@ public:
 	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Camera Stream") UMaterialInstanceDynamic* CameraImageMaterialInstance { nullptr };
 
 	/// <summary>
-	/// The image captured for the left eye.
+	/// The image captured for the left eye. Shared with all components that display the same camera stream.
 	/// </summary>
 	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Camera Stream") UTexture2D* LeftEyeImage { nullptr };
 
 	/// <summary>
-	/// The image captured for the right eye.
+	/// The image captured for the right eye. Shared with all components that display the same camera stream.
 	/// </summary>
 	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Camera Stream") UTexture2D* RightEyeImage { nullptr };
 
+	/// <summary>
+	/// The image containing both eyes, if <see cref="FCameraStreamSettings::bUploadStereoImage" /> is enabled. The right eye image is stored in the upper half, the
+	/// left eye image in the lower half. Shared with all components that display the same camera stream.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Camera Stream") UTexture2D* StereoImage { nullptr };
+
+	/// <summary>
+	/// The estimated background of the left eye image, if the background model is enabled. Materials can sample it to fill regions objects are removed from.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Background Model") UTexture2D* LeftEyeBackground { nullptr };
+
+	/// <summary>
+	/// The estimated background of the right eye image, if the background model is enabled. Materials can sample it to fill regions objects are removed from.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Background Model") UTexture2D* RightEyeBackground { nullptr };
+
+	/// <summary>
+	/// The left eye image with the masked regions filled, if inpainting is enabled.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Inpainting") UTexture2D* LeftEyeInpainted { nullptr };
+
+	/// <summary>
+	/// The right eye image with the masked regions filled, if inpainting is enabled.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Inpainting") UTexture2D* RightEyeInpainted { nullptr };
+
+	/// <summary>
+	/// The depth (in meters) of each pixel of the rectified left camera, if stereo depth is enabled. Pixels without a valid depth are `0`.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Stereo Depth") UTexture2D* DepthImage { nullptr };
+
+	/// <summary>
+	/// The motion of each block of both eye images between the latest two frames in texture coordinates of the eye image, if frame interpolation is enabled. The
+	/// right eye is stored in the upper half, the left eye in the lower half.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Frame Interpolation") UTexture2D* FlowImage { nullptr };
+
+	/// <summary>
+	/// The time between the exposure of the latest frame and the predicted display time of the current engine frame, as multiple of the frame interval.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Frame Interpolation") float InterpolationPhase { 0.f };
+
+	/// <summary>
+	/// The downsampled images of both eyes, if foveated upload is enabled. The right eye image is stored in the upper half, the left eye image in the lower half.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Foveated Upload") UTexture2D* PeripheryImage { nullptr };
+
+	/// <summary>
+	/// The temporally smoothed color and luminance statistics of the camera frames, if they are enabled.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Color Statistics") FCameraColorStats ColorStatistics;
+
+	/// <summary>
+	/// The color and luminance statistics of the latest camera frame, including its luminance histogram, if they are enabled.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Color Statistics") FCameraColorStats FrameColorStatistics;
+
+	/// <summary>
+	/// The chroma key mask of both eye images, if chroma keying and the upload of its mask are enabled. The right eye is stored in the upper half, the left eye in the
+	/// lower half.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Chroma Key") UTexture2D* ChromaKeyImage { nullptr };
+
+	/// <summary>
+	/// The connected regions of keyed pixels of the most recently keyed camera frame, sorted by decreasing area, if chroma keying is enabled. Frames are keyed on the
+	/// thread pool, so the regions may lag behind the displayed frame.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Chroma Key") TArray<FCameraChromaKeyBlob> ChromaKeyBlobs;
+
 	/// <summary>
 	/// Anchor position for the left eye.
 	/// </summary>
@@ -121,22 +355,263 @@ public:
 	/// Anchor position for the right eye.
 	/// </summary>
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Meta = (ExposeOnSpawn = true), Category = "UnrealDR|Camera Settings") FVector RightEyeAnchor = FVector((10.f - 0.071f), 0.0325f, 0.0026f);
+
+	/// <summary>
+	/// If enabled, the view planes are moved by the head motion between the exposure of the displayed frame and the predicted display time, so that the camera image
+	/// stays in place when turning the head. Only applies to frames streamed from the OpenVR tracked camera. Expects the component to be attached to the HMD camera.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Meta = (ExposeOnSpawn = true), Category = "UnrealDR|Camera Settings") bool bReprojectToDisplayPose = true;
+
+	/// <summary>
+	/// The source the camera frames are streamed from.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Meta = (ExposeOnSpawn = true), Category = "UnrealDR|Camera Source") ECameraFrameSourceType FrameSource = ECameraFrameSourceType::OpenVR;
+
+	/// <summary>
+	/// The size of a single eye image generated by the synthetic frame source.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Meta = (ExposeOnSpawn = true, EditCondition = "FrameSource == ECameraFrameSourceType::Synthetic"), Category = "UnrealDR|Camera Source") FIntPoint SyntheticFrameSize = FIntPoint(612, 460);
+
+	/// <summary>
+	/// The number of frames per second generated by the synthetic frame source.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Meta = (ExposeOnSpawn = true, ClampMin = 1, EditCondition = "FrameSource == ECameraFrameSourceType::Synthetic"), Category = "UnrealDR|Camera Source") float SyntheticFrameRate = 60.f;
+
+	/// <summary>
+	/// The index of the tracked device, whose camera is streamed. The HMD always has index `0`. Components that stream different devices run separate capture
+	/// workers in parallel.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Meta = (ExposeOnSpawn = true, ClampMin = 0, ClampMax = 63, EditCondition = "FrameSource == ECameraFrameSourceType::OpenVR"), Category = "UnrealDR|Camera Source") int32 TrackedDeviceIndex = 0;
+
+	/// <summary>
+	/// The serial number of the tracked device, whose camera is streamed. If set, it takes precedence over the device index, which may change between sessions.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Meta = (ExposeOnSpawn = true, EditCondition = "FrameSource == ECameraFrameSourceType::OpenVR"), Category = "UnrealDR|Camera Source") FString TrackedDeviceSerial;
+
+	/// <summary>
+	/// If enabled, the calibration of the tracked camera is cached under `Saved/UnrealDR/Calibration`, so that the component can be set up without querying the runtime
+	/// on every registration. The cached calibration is revalidated against the device in the background.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, AdvancedDisplay, Meta = (EditCondition = "FrameSource == ECameraFrameSourceType::OpenVR"), Category = "UnrealDR|Camera Source") bool bCacheCalibration = true;
+
+	/// <summary>
+	/// If enabled, distorted frames are requested from the tracked camera and undistorted on the CPU, instead of letting the runtime undistort them.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Meta = (ExposeOnSpawn = true, EditCondition = "FrameSource == ECameraFrameSourceType::OpenVR"), Category = "UnrealDR|Camera Source") bool bUndistortOnCpu = false;
+
+	/// <summary>
+	/// The size of a single eye image after undistortion on the CPU.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Meta = (ExposeOnSpawn = true, EditCondition = "bUndistortOnCpu"), Category = "UnrealDR|Camera Source") FIntPoint UndistortedFrameSize = FIntPoint(612, 460);
+
+	/// <summary>
+	/// The horizontal field of view (in degrees) of the eye images after undistortion on the CPU. Smaller values crop the image.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Meta = (ExposeOnSpawn = true, ClampMin = 10, ClampMax = 170, EditCondition = "bUndistortOnCpu"), Category = "UnrealDR|Camera Source") float UndistortedFieldOfView = 100.f;
+
+	/// <summary>
+	/// The settings of the camera stream, which control how frames are uploaded and which results are computed from them.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Meta = (ExposeOnSpawn = true, ShowOnlyInnerProperties), Category = "UnrealDR|Camera Stream") FCameraStreamSettings StreamSettings;
+
+	/// <summary>
+	/// The number of pixels the region of interest is expanded by on each side, so that it covers the surroundings the inpainting takes its content from. Only
+	/// applies, if updates are restricted to the region of interest.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Meta = (ClampMin = 0, ClampMax = 256), Category = "UnrealDR|Region Of Interest") int32 RegionOfInterestPadding = 32;
+
+	/// <summary>
+	/// The camera stream capture file to replay.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Meta = (ExposeOnSpawn = true, FilePathFilter = "udrcap", EditCondition = "FrameSource == ECameraFrameSourceType::Replay"), Category = "UnrealDR|Camera Source") FFilePath ReplayFile;
+
+	/// <summary>
+	/// The replay speed relative to the recorded frame rate. If set to `0`, a new frame is replayed as soon as the previous one has been consumed.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Meta = (ExposeOnSpawn = true, ClampMin = 0, EditCondition = "FrameSource == ECameraFrameSourceType::Replay"), Category = "UnrealDR|Camera Source") float ReplayPlaybackRate = 1.f;
+
+	/// <summary>
+	/// If enabled, the replay starts over after the last frame.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Meta = (ExposeOnSpawn = true, EditCondition = "FrameSource == ECameraFrameSourceType::Replay"), Category = "UnrealDR|Camera Source") bool bLoopReplay = true;
+
+	/// <summary>
+	/// If enabled, the camera stream is recorded to a capture file under `Saved/UnrealDR/Recordings/` during play.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Meta = (ExposeOnSpawn = true), Category = "UnrealDR|Recording") bool bRecordCameraStream = false;
+
+	/// <summary>
+	/// The maximum number of frames that wait to be written by the recorder. If the recorder falls behind, further frames are not recorded.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, AdvancedDisplay, Meta = (ClampMin = 1, ClampMax = 16, EditCondition = "bRecordCameraStream"), Category = "UnrealDR|Recording") int32 RecorderQueueSize = 2;
+
+	/// <summary>
+	/// The number of frames consumers of frame views and handles hold on to at the same time, in addition to the latest one. They are added to the frame buffer pool, so
+	/// that held frames do not cause the stream to drop frames.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, AdvancedDisplay, Meta = (ClampMin = 0, ClampMax = 16), Category = "UnrealDR|Frames") int32 FrameViewReservedFrames = 0;
+
+	/// <summary>
+	/// Called with a handle of each new camera frame.
+	/// </summary>
+	UPROPERTY(BlueprintAssignable, Category = "UnrealDR|Frames") FOnCameraFrameReceived OnFrameReceived;
+
+	/// <summary>
+	/// The time (in seconds) without new frames, after which a warning is issued.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, AdvancedDisplay, Meta = (ClampMin = 0), Category = "UnrealDR|Camera Stream") float NoFramesWarningTimeout = 2.f;
 	
 public:	
 	UCameraSeeThroughComponent();
 
+public:
+	/// <summary>
+	/// Sets the regions of both eye images that are filled by inpainting.
+	/// </summary>
+	/// <param name="leftEyeRegions">The regions of the left eye image in pixels.</param>
+	/// <param name="rightEyeRegions">The regions of the right eye image in pixels.</param>
+	UFUNCTION(BlueprintCallable, Category = "UnrealDR|Inpainting") void SetInpaintingRegions(const TArray<FIntRect>& leftEyeRegions, const TArray<FIntRect>& rightEyeRegions);
+
+	/// <summary>
+	/// Sets the mask of the regions that are filled by inpainting.
+	/// </summary>
+	/// <param name="mask">An 8 bit mask in the layout of the camera frames (right eye in the upper, left eye in the lower half), where non-zero values mark pixels to
+	/// fill. An empty mask stops inpainting.</param>
+	void SetInpaintingMask(TArray<uint8>&& mask);
+
+	/// <summary>
+	/// Moves the fovea region, e.g. to follow the gaze. It is shared by all components that display the same camera stream.
+	/// </summary>
+	/// <param name="center">The center of the fovea region relative to the size of an eye image, where `(0.5, 0.5)` is the image center.</param>
+	UFUNCTION(BlueprintCallable, Category = "UnrealDR|Foveated Upload") void SetFoveaCenter(FVector2D center);
+
+	/// <summary>
+	/// Sets the region of interest to the bounds of the non-zero texels of a mask, which is stretched over each eye image. The region of interest is shared by all
+	/// components that display the same camera stream.
+	/// </summary>
+	/// <param name="mask">An uncompressed 8 bit grayscale or BGRA texture, whose pixel data is available on the CPU. For BGRA textures, the red channel is used.</param>
+	UFUNCTION(BlueprintCallable, Category = "UnrealDR|Region Of Interest") void SetRegionOfInterestMask(UTexture2D* mask);
+
+	/// <summary>
+	/// Sets the region of interest to the bounds of a polygon.
+	/// </summary>
+	/// <param name="points">The points of the polygon relative to the size of an eye image, where `(0, 0)` is the upper left corner. The polygon applies to both eyes.</param>
+	UFUNCTION(BlueprintCallable, Category = "UnrealDR|Region Of Interest") void SetRegionOfInterestPolygon(const TArray<FVector2D>& points);
+
+	/// <summary>
+	/// Sets the region of interest to a world-space bounding box, which is projected into both eye images every frame. It is combined with the bounds of a mask or
+	/// polygon.
+	/// </summary>
+	/// <param name="bounds">The bounding box in world space, e.g. the bounds of the object to remove.</param>
+	UFUNCTION(BlueprintCallable, Category = "UnrealDR|Region Of Interest") void SetRegionOfInterestBounds(FBox bounds);
+
+	/// <summary>
+	/// Removes the region of interest, so that the whole frames are uploaded and inpainted again.
+	/// </summary>
+	UFUNCTION(BlueprintCallable, Category = "UnrealDR|Region Of Interest") void ClearRegionOfInterest();
+
+	/// <summary>
+	/// Returns the region of interest of an eye image in pixels, or an empty rectangle, if updates are not restricted to it.
+	/// </summary>
+	UFUNCTION(BlueprintCallable, Category = "UnrealDR|Region Of Interest") FIntRect GetRegionOfInterest(ECameraEye eye) const;
+
+	/// <summary>
+	/// Changes the key color and tolerances of the chroma keying, which are used from the next frame on. They are shared by all components that display the same
+	/// camera stream.
+	/// </summary>
+	/// <param name="keyColor">The color of the backdrop.</param>
+	/// <param name="threshold">The chroma distance to the key color, below which pixels are fully keyed.</param>
+	/// <param name="softness">The width of the soft edge beyond the threshold.</param>
+	UFUNCTION(BlueprintCallable, Category = "UnrealDR|Chroma Key") void SetChromaKey(FColor keyColor, int32 threshold, int32 softness);
+
+	/// <summary>
+	/// Returns the mask value of a pixel of the latest chroma key mask in `[0, 1]`, or `0`, if chroma keying is not enabled or the pixel is outside of the eye image.
+	/// While updates are restricted to the region of interest, pixels outside of it are `0`.
+	/// </summary>
+	/// <param name="eye">The eye image.</param>
+	/// <param name="pixel">The pixel of the eye image, where `(0, 0)` is the upper left corner.</param>
+	UFUNCTION(BlueprintCallable, Category = "UnrealDR|Chroma Key") float GetChromaKeyMaskValue(ECameraEye eye, FIntPoint pixel) const;
+
+	/// <summary>
+	/// Returns the camera stream the component displays, or an invalid pointer, if the camera has not been set up.
+	/// </summary>
+	const FCameraStreamPtr& GetCameraStream() const noexcept { return m_stream; }
+
+	/// <summary>
+	/// Returns an immutable view of the latest frame, or an invalid pointer, if no frame has been received yet. The view can be passed to other threads.
+	/// </summary>
+	FCameraFrameViewPtr GetLatestFrameView();
+
+	/// <summary>
+	/// Returns a handle of the latest frame, which is empty, if no frame has been received yet.
+	/// </summary>
+	UFUNCTION(BlueprintCallable, Category = "UnrealDR|Frames") FCameraFrameHandle GetLatestFrame();
+
+	/// <summary>
+	/// Returns the delegate that is called on the game thread with a view of each new frame.
+	/// </summary>
+	FOnCameraFrameView& OnFrameView() noexcept { return m_onFrameView; }
+
+	/// <summary>
+	/// Returns the delegate that is called on the game thread, when the component stops streaming, because play has ended or it has been unregistered.
+	/// </summary>
+	FOnCameraStreamingEnded& OnStreamingEnded() noexcept { return m_onStreamingEnded; }
+
+	/// <summary>
+	/// Returns the connected tracked devices that provide a camera, or an empty array, if the VR system is not available.
+	/// </summary>
+	UFUNCTION(BlueprintCallable, Category = "UnrealDR|Devices") TArray<FCameraDeviceInfo> GetCameraDevices() const;
+
+	/// <summary>
+	/// Returns the frame rate and latency counters of the camera stream the component displays.
+	/// </summary>
+	UFUNCTION(BlueprintCallable, Category = "UnrealDR|Statistics") FCameraStreamStatistics GetStreamStatistics() const;
+
+	/// <summary>
+	/// Returns the frame rate and latency counters of all running camera streams.
+	/// </summary>
+	UFUNCTION(BlueprintCallable, Category = "UnrealDR|Statistics") static TArray<FCameraStreamStatistics> GetAllStreamStatistics();
+
 protected:
 	virtual void OnRegister() override;
 	virtual void OnUnregister() override;
+	virtual void OnVirtualRealitySystemReady(vr::IVRSystem* system);
+	virtual void SetupCamera();
+	virtual void SetupViewPlanes(const FCameraCalibration& calibration);
+	void DestroyViewPlanes();
+	bool UsesCalibrationCache() const;
+	FString GetCalibrationVariant() const;
+	bool LoadCachedCalibration(FCameraCalibration& calibration) const;
+	void RevalidateCalibration(const FCameraFrameSourcePtr& source, const FCameraCalibration& cached);
+	virtual void OnCalibrationChanged(const FCameraCalibration& calibration);
 
 	virtual void BeginPlay() override;
 	virtual void EndPlay(const EEndPlayReason::Type reason) override;
+	void BeginStreaming();
+	void EndStreaming();
+
+	virtual bool RequiresVirtualRealitySystem() const;
+	void ResolveTrackedDevice();
+	static FCameraStreamStatistics CollectStreamStatistics(const FCameraStream& stream);
 
-	vr::TrackedCameraHandle_t StartStreaming(vr::IVRTrackedCamera* camera);
-	void StopStreaming(vr::IVRTrackedCamera* camera, vr::TrackedCameraHandle_t& trackedCamera) const;
-	virtual void UpdateImages();
-	virtual void CleanupFrameBufferRegion(uint8_t* rawData, const FUpdateTextureRegion2D* region) const noexcept;
+	virtual FCameraFrameSourcePtr CreateFrameSource();
+	virtual FString GetStreamKey() const;
+	bool StartStreaming(int32 reservedFrames = 0);
+	void StopStreaming();
+	virtual void BindMaterialParameters();
+	void BindFoveaRect();
+	void UpdateColorStatistics();
+	void UpdateChromaKey();
+	void UpdateInterpolationPhase();
+	void UpdateRegionOfInterest();
+	FIntRect ProjectBounds(const FBox& bounds, vr::EVREye eye) const;
+	virtual void OnFrameUpdated(const FCameraFrameRef& frame);
 	virtual UStaticMeshComponent* CreateViewPlaneMesh(FName name, const FVector view, const FVector2D center, const FVector2D focalLength) noexcept;
+	bool IsReprojectionEnabled() const noexcept;
+	bool GetHmdPose(float secondsFromNow, FTransform& pose) const;
+	float GetSecondsToPhotons() const;
+	bool GetFramePose(const FCameraFrame& frame, FTransform& pose) const;
+	virtual void ReprojectViewPlanes();
 
 protected:
 	static const FTransform& OpenVRToUnrealEngine() noexcept
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/ThreadSafeCounter.h"
+
+#include "UnrealDR.h"
+#include "CameraFramePool.h"
+#include "CameraFrameSource.h"
+
+// Layout of a shared memory ring:
+//
+//   FCameraSharedMemoryHeader, padded to HeaderSize
+//   SlotCount slots of SlotStride bytes each:
+//     FCameraSharedMemorySlot, padded to DataOffset
+//     Frame data (RGBA, right eye in the upper half, left eye in the lower half), FrameBufferSize bytes
+//
+// The ring has a single writer and any number of readers, which never block each other. Frame n (counting from 0) is written into slot `n % SlotCount`. While it is
+// written, the sequence of the slot is `2n + 1`, afterwards it is `2n + 2`, and WriteIndex becomes `n + 1`. Readers map the region read-only and use the frames in
+// place:
+//
+//   1. Read WriteIndex. If it is 0, no frame has been published yet. Otherwise, the latest frame is n = WriteIndex - 1.
+//   2. Read the sequence of slot `n % SlotCount`. If it is not `2n + 2`, the slot is already being overwritten, so start over.
+//   3. Use the slot header and frame data.
+//   4. Read the sequence again. If it has changed, the writer has lapped the reader while it was reading and the data must be discarded.
+//
+// Readers that remember the last frame they have processed can tell how many frames they missed from the difference to WriteIndex. Sequences and WriteIndex are
+// 64 bit integers that are written atomically, and all structures are stored in native byte order. Timestamps are seconds of the monotonic platform clock.
+namespace UnrealDR
+{
+	namespace SharedMemory
+	{
+		constexpr uint32 Magic = 0x4D524455;		// "UDRM"
+		constexpr uint32 Version = 1;
+		constexpr uint32 Alignment = 4096;
+	}
+}
+
+/// <summary>
+/// The header at the start of a shared memory ring, which describes the layout of the ring and the calibration of the cameras.
+/// </summary>
+struct FCameraSharedMemoryHeader
+{
+	uint32 Magic{ UnrealDR::SharedMemory::Magic };
+	uint32 Version{ UnrealDR::SharedMemory::Version };
+	uint32 HeaderSize{ 0 };
+	uint32 SlotCount{ 0 };
+	uint64 SlotStride{ 0 };
+	uint32 DataOffset{ 0 };
+	uint32 FrameWidth{ 0 };
+	uint32 FrameHeight{ 0 };
+	uint32 FrameBufferSize{ 0 };
+	uint32 WriterProcessId{ 0 };
+	uint32 Reserved{ 0 };
+	vr::HmdVector2_t FocalLength[2]{};
+	vr::HmdVector2_t Center[2]{};
+	vr::HmdMatrix34_t CameraToHead[2]{};
+	volatile int64 WriteIndex{ 0 };
+};
+
+/// <summary>
+/// The header of a slot of a shared memory ring, which describes the frame stored in the slot.
+/// </summary>
+struct FCameraSharedMemorySlot
+{
+	volatile int64 Sequence{ 0 };
+	uint32 FrameSequence{ 0 };
+	uint32 FrameType{ 0 };
+	uint32 Width{ 0 };
+	uint32 Height{ 0 };
+	uint32 BytesPerPixel{ 4 };
+	uint32 Pitch{ 0 };
+	double ExposureTime{ 0.0 };
+	double CaptureTime{ 0.0 };
+	double PublishTime{ 0.0 };
+	vr::HmdMatrix34_t DeviceToAbsoluteTracking{};
+	vr::HmdVector3_t Velocity{};
+	vr::HmdVector3_t AngularVelocity{};
+	uint32 TrackingResult{ 0 };
+	uint32 PoseIsValid{ 0 };
+};
+
+/// <summary>
+/// Publishes camera frames into a named shared memory ring, so that other processes on the same machine can use them without acquiring the camera themselves.
+/// </summary>
+/// <remarks>
+/// The ring is created by <see cref="Open" /> and removed by <see cref="Close" />. Each call to <see cref="Publish" /> copies one frame into the next slot, so that
+/// readers can use it in place until the writer wraps around. On POSIX platforms, the region is a POSIX shared memory object named `/<name>`, on Windows a named file
+/// mapping. Calls to <see cref="Publish" /> must not overlap, but may happen on any thread.
+/// </remarks>
+class UNREALDR_API FCameraSharedMemoryPublisher
+{
+private:
+	/// <summary>
+	/// The name of the shared memory region.
+	/// </summary>
+	FString m_name;
+
+	/// <summary>
+	/// The number of slots of the ring.
+	/// </summary>
+	int32 m_slotCount{ 4 };
+
+	/// <summary>
+	/// The mapped shared memory region, or `nullptr`, if the ring is not open.
+	/// </summary>
+	FPlatformMemory::FSharedMemoryRegion* m_region{ nullptr };
+
+	/// <summary>
+	/// The header at the start of the mapped region.
+	/// </summary>
+	FCameraSharedMemoryHeader* m_header{ nullptr };
+
+	/// <summary>
+	/// The number of frames that have been published since the ring has been opened.
+	/// </summary>
+	FThreadSafeCounter m_publishedFrames;
+
+public:
+	FCameraSharedMemoryPublisher(const FString& name, int32 slotCount = 4);
+	virtual ~FCameraSharedMemoryPublisher();
+
+	FCameraSharedMemoryPublisher(const FCameraSharedMemoryPublisher&) = delete;
+	FCameraSharedMemoryPublisher& operator=(const FCameraSharedMemoryPublisher&) = delete;
+
+public:
+	/// <summary>
+	/// Creates the shared memory region and writes the layout of the ring and the calibration of the frame source into it.
+	/// </summary>
+	/// <param name="source">The source the published frames are streamed from.</param>
+	/// <returns>`true`, if the ring has been created, `false`, if it could not be created or another writer that is still running uses the name.</returns>
+	bool Open(const ICameraFrameSource& source);
+
+	/// <summary>
+	/// Unmaps and removes the shared memory region. Readers that still have it mapped keep their mapping.
+	/// </summary>
+	void Close();
+
+	/// <summary>
+	/// Copies a frame into the next slot of the ring.
+	/// </summary>
+	/// <param name="frame">The frame to publish.</param>
+	/// <returns>`true`, if the frame has been published, `false`, if the ring is not open or the frame does not fit into a slot.</returns>
+	bool Publish(const FCameraFrame& frame);
+
+	/// <summary>
+	/// Returns `true`, if the ring is open.
+	/// </summary>
+	bool IsOpen() const noexcept { return m_header != nullptr; }
+
+	/// <summary>
+	/// Returns the number of frames that have been published since the ring has been opened.
+	/// </summary>
+	int32 GetPublishedFrames() const { return m_publishedFrames.GetValue(); }
+
+	/// <summary>
+	/// Returns the name of the shared memory region.
+	/// </summary>
+	const FString& GetName() const noexcept { return m_name; }
+
+	/// <summary>
+	/// Returns the name of the region a stream publishes into, which appends the stream key to the base name. Characters other than letters and digits are replaced
+	/// by underscores, and long keys (e.g. the file names of replays) are replaced by their hash.
+	/// </summary>
+	/// <param name="baseName">The base name of the region.</param>
+	/// <param name="streamKey">The key that identifies the stream.</param>
+	/// <returns>The name of the shared memory region.</returns>
+	static FString GetRegionName(const FString& baseName, const FString& streamKey);
+};
+
+/// <summary>
+/// Thread-safe shared pointer to a shared memory publisher.
+/// </summary>
+using FCameraSharedMemoryPublisherPtr = TSharedPtr<FCameraSharedMemoryPublisher, ESPMode::ThreadSafe>;
@@ -0,0 +1,217 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "UnrealDR.h"
+#include "CameraFrameSource.h"
+#include "CameraFramePool.h"
+#include "CameraUndistortion.h"
+
+/// <summary>
+/// Settings of the stereo depth estimation.
+/// </summary>
+struct FCameraStereoDepthSettings
+{
+	/// <summary>
+	/// The size of the depth map in pixels. The camera images are rectified to this resolution, before they are matched.
+	/// </summary>
+	uint32 Width{ 160 };
+	uint32 Height{ 120 };
+
+	/// <summary>
+	/// The number of disparities (in pixels of the depth map) that are searched. It is rounded up to a multiple of 16.
+	/// </summary>
+	int32 DisparityRange{ 48 };
+
+	/// <summary>
+	/// The penalty of a disparity change by one pixel between neighbors (P1).
+	/// </summary>
+	int32 SmallPenalty{ 6 };
+
+	/// <summary>
+	/// The penalty of larger disparity changes between neighbors (P2).
+	/// </summary>
+	int32 LargePenalty{ 48 };
+
+	/// <summary>
+	/// If enabled, disparities that do not match the disparities of the right image are rejected, which removes most mismatches in occluded regions.
+	/// </summary>
+	bool bLeftRightCheck{ true };
+};
+
+/// <summary>
+/// The geometry of a depth map.
+/// </summary>
+struct FCameraDepthCalibration
+{
+	/// <summary>
+	/// The size of the depth map in pixels.
+	/// </summary>
+	uint32 Width{ 0 };
+	uint32 Height{ 0 };
+
+	/// <summary>
+	/// The focal length and principal point of the rectified left camera in pixels of the depth map.
+	/// </summary>
+	float FocalLength{ 1.f };
+	FVector2D Center{ 0.f, 0.f };
+
+	/// <summary>
+	/// The distance between both cameras in meters.
+	/// </summary>
+	float Baseline{ 0.f };
+
+	/// <summary>
+	/// The transform from the rectified left camera to the head, in the convention of the camera extrinsics reported by OpenVR.
+	/// </summary>
+	vr::HmdMatrix34_t RectifiedToHead{};
+};
+
+/// <summary>
+/// Estimates a low resolution depth map from the stereo camera images with semi-global matching (SGM).
+/// </summary>
+/// <remarks>
+/// Both eye images are rectified and scaled to the size of the depth map with a single remap table each, which is built from the calibration of the frame source. The
+/// rectified images are converted to luminance and census transformed (5x5), so that matching does not depend on the exposure of the cameras. The matching cost of
+/// each pixel and disparity is the Hamming distance between the census signatures. Costs are aggregated along four paths (left, right, top and bottom): horizontal
+/// paths are processed in parallel across scanlines, vertical paths in parallel across column blocks, and every path step is vectorized across disparities. The
+/// disparity with the lowest aggregated cost is refined to sub-pixel precision and optionally checked against the disparity of the right image. The result contains
+/// the depth (in meters along the view axis of the rectified left camera) for each pixel, or `0`, if no valid disparity has been found. Calls must not overlap, but
+/// may happen on any thread.
+/// </remarks>
+class UNREALDR_API FCameraStereoDepth
+{
+public:
+	/// <summary>
+	/// The largest supported disparity range.
+	/// </summary>
+	static constexpr int32 MaxDisparityRange = 128;
+
+	/// <summary>
+	/// The number of columns of a block, whose vertical paths are aggregated by one worker.
+	/// </summary>
+	static constexpr int32 ColumnBlockSize = 16;
+
+	/// <summary>
+	/// The cost used for disparities that point outside of the right image, and for the ends of the disparity range.
+	/// </summary>
+	static constexpr int16 InvalidCost = 0x3FFF;
+
+private:
+	/// <summary>
+	/// The settings of the depth estimation.
+	/// </summary>
+	FCameraStereoDepthSettings m_settings;
+
+	/// <summary>
+	/// The number of disparities that are searched, as a multiple of 16.
+	/// </summary>
+	int32 m_disparities{ 0 };
+
+	/// <summary>
+	/// The geometry of the depth map.
+	/// </summary>
+	FCameraDepthCalibration m_calibration;
+
+	/// <summary>
+	/// The remap tables that rectify the left and right eye images.
+	/// </summary>
+	FCameraUndistortion m_rectification[2];
+
+	/// <summary>
+	/// The rectified RGBA images of the left and right eye.
+	/// </summary>
+	TArray<uint8> m_rectified[2];
+
+	/// <summary>
+	/// The luminance of the rectified images.
+	/// </summary>
+	TArray<uint8> m_luminance[2];
+
+	/// <summary>
+	/// The census signatures of the left and right image.
+	/// </summary>
+	TArray<uint32> m_census[2];
+
+	/// <summary>
+	/// The matching costs for each pixel and disparity.
+	/// </summary>
+	TArray<uint8> m_costs;
+
+	/// <summary>
+	/// The aggregated costs for each pixel and disparity.
+	/// </summary>
+	TArray<uint16> m_aggregated;
+
+	/// <summary>
+	/// The disparities of the right image, used for the left-right check.
+	/// </summary>
+	TArray<uint8> m_rightDisparities;
+
+	/// <summary>
+	/// The pool of frames the depth maps are written into.
+	/// </summary>
+	FCameraFramePoolPtr m_outputPool;
+
+public:
+	FCameraStereoDepth(const FCameraStereoDepthSettings& settings, int32 outputFrames = 3);
+	virtual ~FCameraStereoDepth() = default;
+
+	FCameraStereoDepth(const FCameraStereoDepth&) = delete;
+	FCameraStereoDepth& operator=(const FCameraStereoDepth&) = delete;
+
+public:
+	/// <summary>
+	/// Builds the rectification from the calibration of a frame source.
+	/// </summary>
+	/// <param name="source">The frame source the frames are streamed from.</param>
+	/// <returns>`true`, if the source provides a usable stereo calibration, otherwise `false`.</returns>
+	bool Build(const ICameraFrameSource& source);
+
+	/// <summary>
+	/// Estimates the depth map of a frame.
+	/// </summary>
+	/// <param name="frame">The camera frame.</param>
+	/// <returns>A frame containing the depth map as 32 bit floats, or an invalid reference, if all output frames are still in use or no rectification has been built.</returns>
+	FCameraFrameRef Compute(const FCameraFrame& frame);
+
+	/// <summary>
+	/// Returns `true`, if the rectification has been built.
+	/// </summary>
+	bool IsValid() const noexcept { return m_rectification[vr::Eye_Left].IsValid() && m_rectification[vr::Eye_Right].IsValid(); }
+
+	/// <summary>
+	/// Returns the geometry of the depth map.
+	/// </summary>
+	const FCameraDepthCalibration& GetCalibration() const noexcept { return m_calibration; }
+
+	/// <summary>
+	/// Returns the pool the depth maps are written into. It must outlive all pending uploads of a depth map.
+	/// </summary>
+	const FCameraFramePoolPtr& GetOutputPool() const noexcept { return m_outputPool; }
+
+	/// <summary>
+	/// Aggregates the costs of a single pixel along a path.
+	/// </summary>
+	/// <param name="costs">The matching costs of the pixel.</param>
+	/// <param name="previous">The aggregated costs of the previous pixel on the path, preceded and followed by <see cref="InvalidCost" />.</param>
+	/// <param name="previousMin">The minimum of the aggregated costs of the previous pixel.</param>
+	/// <param name="current">Receives the aggregated costs of the pixel, in the same layout as <paramref name="previous" />.</param>
+	/// <param name="disparities">The number of disparities, which must be a multiple of 8.</param>
+	/// <param name="smallPenalty">The penalty of a disparity change by one.</param>
+	/// <param name="largePenalty">The penalty of larger disparity changes.</param>
+	/// <returns>The minimum of the aggregated costs of the pixel.</returns>
+	static int16 AggregatePixel(const uint8* costs, const int16* previous, int16 previousMin, int16* current, int32 disparities, int16 smallPenalty, int16 largePenalty) noexcept;
+
+private:
+	void ComputeCensus(int32 eye);
+	void ComputeCosts(int32 y);
+	void AggregateRow(int32 y);
+	void AggregateColumns(int32 x0, int32 x1);
+	void SelectDisparities(int32 y, float* depth);
+};
+
+/// <summary>
+/// Thread-safe shared pointer to a stereo depth engine.
+/// </summary>
+using FCameraStereoDepthPtr = TSharedPtr<FCameraStereoDepth, ESPMode::ThreadSafe>;
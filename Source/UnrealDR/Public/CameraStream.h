@@ -0,0 +1,598 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/GCObject.h"
+#include "Engine/Texture2D.h"
+
+#include "UnrealDR.h"
+#include "CameraFrameSource.h"
+#include "CameraFramePool.h"
+#include "CameraCaptureWorker.h"
+#include "CameraLatencyStats.h"
+#include "CameraDirtyTileTracker.h"
+#include "CameraBackgroundModel.h"
+#include "CameraInpainting.h"
+#include "CameraStereoDepth.h"
+#include "CameraOpticalFlow.h"
+#include "CameraImagePyramid.h"
+#include "CameraSharedMemoryPublisher.h"
+#include "CameraColorStatistics.h"
+#include "CameraChromaKey.h"
+#include "CameraTexturePool.h"
+#include "CameraStreamSettings.h"
+
+/// <summary>
+/// A camera stream that is shared between all components that display the same frame source.
+/// </summary>
+/// <remarks>
+/// The stream owns the frame source, the frame pool and the capture worker and acquires its textures from the <see cref="FCameraTexturePool" /> of the module.
+/// Streaming starts, when the first subscriber calls <see cref="Start" /> and stops, when the last one calls <see cref="Stop" />. While streaming,
+/// <see cref="Update" /> picks up the latest frame and uploads it into the eye textures, or into a single stereo texture. It may be called by every subscriber on
+/// every tick, but only does work once per engine frame, so the cost of copying and uploading a frame does not depend on the number of subscribers. If enabled, the
+/// stream also feeds the frames into a background model, the inpainting, the stereo depth estimation and the chroma keying on the thread pool and uploads their
+/// results into the background, inpainted, depth and chroma key images. In foveated mode, only the fovea region is uploaded into the eye or stereo textures, while the rest of each eye is
+/// uploaded from a downsampled copy into the periphery image, so that materials have to composite both. The frames can also be published into a shared memory ring
+/// on the thread pool, so that other processes can use them without acquiring the camera. The color statistics of each frame are measured right after its upload.
+/// With frame interpolation, the motion between the latest two frames is estimated on the thread pool and uploaded into the flow image, which materials use to
+/// warp the eye images by the interpolation phase of each rendered frame.
+/// Streams are created and shared through the <see cref="FCameraStreamHub" /> and must only be used from the game thread. When a stream is destroyed, its textures
+/// are returned to the pool, so that re-registered components and changed configurations do not create new textures.
+/// </remarks>
+class UNREALDR_API FCameraStream : public FGCObject
+{
+private:
+	/// <summary>
+	/// The key that identifies the stream within the hub.
+	/// </summary>
+	FString m_key;
+
+	/// <summary>
+	/// The source the camera frames are streamed from.
+	/// </summary>
+	FCameraFrameSourcePtr m_source;
+
+	/// <summary>
+	/// The settings of the stream.
+	/// </summary>
+	FCameraStreamSettings m_settings;
+
+	/// <summary>
+	/// The pool the textures and upload regions are acquired from.
+	/// </summary>
+	FCameraTexturePoolPtr m_texturePool;
+
+	/// <summary>
+	/// Camera stream frame buffer width.
+	/// </summary>
+	uint32_t m_frameWidth{ 0 };
+
+	/// <summary>
+	/// Camera stream frame buffer height.
+	/// </summary>
+	uint32_t m_frameHeight{ 0 };
+
+	/// <summary>
+	/// Camera stream frame buffer size in bytes.
+	/// </summary>
+	uint32_t m_frameBufferSize{ 0 };
+
+	/// <summary>
+	/// The number of subscribers that have started streaming.
+	/// </summary>
+	int32 m_playerCount{ 0 };
+
+	/// <summary>
+	/// The pool of frame buffers the capture worker copies frames into.
+	/// </summary>
+	FCameraFramePoolPtr m_framePool;
+
+	/// <summary>
+	/// The worker that copies frames from the camera stream on a dedicated thread.
+	/// </summary>
+	TUniquePtr<FCameraCaptureWorker> m_captureWorker;
+
+	/// <summary>
+	/// Collects the latencies of the frames along the pipeline.
+	/// </summary>
+	FCameraLatencyStatsPtr m_latencyStats;
+
+	/// <summary>
+	/// The rate (in frames per second) at which the capture worker has received frames during the last measurement window.
+	/// </summary>
+	float m_frameRate{ 0.f };
+
+	/// <summary>
+	/// The time at which the current frame rate measurement window has started.
+	/// </summary>
+	double m_frameRateWindowStart{ 0.0 };
+
+	/// <summary>
+	/// The number of frames the capture worker had received, when the current frame rate measurement window has started.
+	/// </summary>
+	int32 m_frameRateWindowFrames{ 0 };
+
+	/// <summary>
+	/// The images of the left and right eye.
+	/// </summary>
+	UTexture2D* m_eyeImages[2]{ nullptr, nullptr };
+
+	/// <summary>
+	/// The image containing both eyes in the layout of the frame buffer, if the stereo image is uploaded instead of the eye images.
+	/// </summary>
+	UTexture2D* m_stereoImage{ nullptr };
+
+	/// <summary>
+	/// The regions of the frame buffer that contain the image of each eye.
+	/// </summary>
+	FUpdateTextureRegion2D m_frameBufferRegions[2];
+
+	/// <summary>
+	/// The region of the frame buffer that contains both eye images.
+	/// </summary>
+	FUpdateTextureRegion2D m_stereoRegion;
+
+	/// <summary>
+	/// Detects the changed tiles of the image of each eye, if only dirty tiles are uploaded.
+	/// </summary>
+	TArray<FCameraDirtyTileTracker, TInlineAllocator<2>> m_dirtyTileTrackers;
+
+	/// <summary>
+	/// The background images of the left and right eye, if the background model is enabled.
+	/// </summary>
+	UTexture2D* m_backgroundImages[2]{ nullptr, nullptr };
+
+	/// <summary>
+	/// Estimates the background from the frames, if enabled.
+	/// </summary>
+	FCameraBackgroundModelPtr m_backgroundModel;
+
+	/// <summary>
+	/// The pending update of the background model, which returns the updated model.
+	/// </summary>
+	TFuture<FCameraFrameRef> m_backgroundTask;
+
+	/// <summary>
+	/// The number of frames received since the background model has been started.
+	/// </summary>
+	uint32 m_backgroundFrames{ 0 };
+
+	/// <summary>
+	/// The inpainted images of the left and right eye, if inpainting is enabled.
+	/// </summary>
+	UTexture2D* m_inpaintedImages[2]{ nullptr, nullptr };
+
+	/// <summary>
+	/// Fills the masked regions of the frames, if enabled.
+	/// </summary>
+	FCameraInpaintingPtr m_inpainting;
+
+	/// <summary>
+	/// The pending inpainting, which returns the inpainted frame.
+	/// </summary>
+	TFuture<FCameraFrameRef> m_inpaintingTask;
+
+	/// <summary>
+	/// The mask of the regions to fill, in the layout of the frames. It is replaced as a whole, so that pending tasks can keep reading the previous one.
+	/// </summary>
+	TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> m_inpaintingMask;
+
+	/// <summary>
+	/// The depth image, if stereo depth is enabled.
+	/// </summary>
+	UTexture2D* m_depthImage{ nullptr };
+
+	/// <summary>
+	/// Estimates depth maps from the frames, if enabled.
+	/// </summary>
+	FCameraStereoDepthPtr m_stereoDepth;
+
+	/// <summary>
+	/// The pending depth estimation, which returns the depth map.
+	/// </summary>
+	TFuture<FCameraFrameRef> m_stereoDepthTask;
+
+	/// <summary>
+	/// The most recent depth map.
+	/// </summary>
+	FCameraFrameRef m_latestDepthMap;
+
+	/// <summary>
+	/// The flow image, if frame interpolation is enabled.
+	/// </summary>
+	UTexture2D* m_flowImage{ nullptr };
+
+	/// <summary>
+	/// Estimates the motion between consecutive frames, if frame interpolation is enabled.
+	/// </summary>
+	FCameraOpticalFlowPtr m_opticalFlow;
+
+	/// <summary>
+	/// The pending flow estimation, which returns the flow field.
+	/// </summary>
+	TFuture<FCameraFrameRef> m_opticalFlowTask;
+
+	/// <summary>
+	/// The frame the next flow estimation starts from.
+	/// </summary>
+	FCameraFrameRef m_previousFrame;
+
+	/// <summary>
+	/// The time (in seconds) between the exposures of the frames of the uploaded flow field, or `0`, if no flow field has been uploaded yet.
+	/// </summary>
+	double m_flowInterval{ 0.0 };
+
+	/// <summary>
+	/// The time (in seconds) between the exposures of the frames of the pending flow estimation.
+	/// </summary>
+	double m_pendingFlowInterval{ 0.0 };
+
+	/// <summary>
+	/// The image containing the downsampled eye images in the layout of the frame buffer, if foveated upload is enabled.
+	/// </summary>
+	UTexture2D* m_peripheryImage{ nullptr };
+
+	/// <summary>
+	/// Downsample the images of the left and right eye into the periphery image, if foveated upload is enabled.
+	/// </summary>
+	TUniquePtr<FCameraImagePyramid> m_peripheryPyramids[2];
+
+	/// <summary>
+	/// The pool of frames the periphery images are written into.
+	/// </summary>
+	FCameraFramePoolPtr m_peripheryPool;
+
+	/// <summary>
+	/// The size of the periphery image of each eye in pixels.
+	/// </summary>
+	uint32 m_peripheryWidth{ 0 };
+	uint32 m_peripheryHeight{ 0 };
+
+	/// <summary>
+	/// The region of each eye image (in pixels) that has been uploaded at full resolution, if foveated upload is enabled.
+	/// </summary>
+	FIntRect m_foveaRect;
+
+	/// <summary>
+	/// The region of each eye image (in pixels) that is uploaded at full resolution with the next frame.
+	/// </summary>
+	FIntRect m_requestedFoveaRect;
+
+	/// <summary>
+	/// Measures the color and luminance statistics of the frames, if enabled.
+	/// </summary>
+	TUniquePtr<FCameraColorStatistics> m_colorStatistics;
+
+	/// <summary>
+	/// Keys the frames and extracts the connected regions of the mask, if enabled.
+	/// </summary>
+	FCameraChromaKeyPtr m_chromaKey;
+
+	/// <summary>
+	/// The pending chroma keying, which returns the mask and its connected regions.
+	/// </summary>
+	TFuture<FCameraChromaKeyResult> m_chromaKeyTask;
+
+	/// <summary>
+	/// The mask and the connected regions of the most recently keyed frame.
+	/// </summary>
+	FCameraChromaKeyResult m_chromaKeyResult;
+
+	/// <summary>
+	/// The settings of the chroma keying, which can be changed while streaming.
+	/// </summary>
+	FCameraChromaKeySettings m_chromaKeySettings;
+
+	/// <summary>
+	/// `true`, if the settings of the chroma keying have changed and are passed to the keyer with the next frame.
+	/// </summary>
+	bool m_chromaKeySettingsChanged{ false };
+
+	/// <summary>
+	/// The image containing the chroma key mask in the layout of the frame buffer, if it is uploaded.
+	/// </summary>
+	UTexture2D* m_chromaKeyImage{ nullptr };
+
+	/// <summary>
+	/// The keyed regions of the last mask that has been uploaded. The rest of the chroma key image is `0`, so masks with the same regions only upload them.
+	/// </summary>
+	FIntRect m_uploadedChromaKeyRegions[2];
+
+	/// <summary>
+	/// `true`, if a whole mask has been uploaded into the chroma key image since streaming has been started.
+	/// </summary>
+	bool m_chromaKeyImageInitialized{ false };
+
+	/// <summary>
+	/// The regions of the left and right eye image (in pixels) that are uploaded and inpainted, if updates are restricted to them.
+	/// </summary>
+	FIntRect m_regionsOfInterest[2];
+
+	/// <summary>
+	/// `true`, if regions of interest have been set.
+	/// </summary>
+	bool m_hasRegionsOfInterest{ false };
+
+	/// <summary>
+	/// The regions of interest the pending inpainting has been started with, which are the only parts of the inpainted frame that are uploaded.
+	/// </summary>
+	FIntRect m_inpaintingRegions[2];
+
+	/// <summary>
+	/// The time at which the full frame has been uploaded last.
+	/// </summary>
+	double m_lastFullFrameUploadTime{ 0.0 };
+
+	/// <summary>
+	/// Publishes the frames into shared memory, if enabled.
+	/// </summary>
+	FCameraSharedMemoryPublisherPtr m_publisher;
+
+	/// <summary>
+	/// The pending publication of a frame.
+	/// </summary>
+	TFuture<bool> m_publishTask;
+
+	/// <summary>
+	/// The number of frames that have not been published, because the previous frame was still being copied.
+	/// </summary>
+	int32 m_unpublishedFrames{ 0 };
+
+	/// <summary>
+	/// The most recent frame.
+	/// </summary>
+	FCameraFrameRef m_latestFrame;
+
+	/// <summary>
+	/// The platform time (in seconds), the most recent frame has been received or streaming has been started.
+	/// </summary>
+	double m_latestFrameTime{ 0.0 };
+
+	/// <summary>
+	/// The engine frame, the stream has been updated the last time.
+	/// </summary>
+	uint64 m_lastUpdateFrame{ MAX_uint64 };
+
+public:
+	FCameraStream(const FString& key, FCameraFrameSourcePtr source, const FCameraStreamSettings& settings, FCameraTexturePoolPtr texturePool);
+	virtual ~FCameraStream();
+
+	FCameraStream(const FCameraStream&) = delete;
+	FCameraStream& operator=(const FCameraStream&) = delete;
+
+public:
+	/// <summary>
+	/// Starts streaming, if this is the first subscriber to start it.
+	/// </summary>
+	/// <param name="reservedFrames">The number of frame buffers the subscriber holds on to (e.g. for recording), which are added to the pool.</param>
+	/// <returns>`true`, if the stream is streaming, otherwise `false`.</returns>
+	bool Start(int32 reservedFrames = 0);
+
+	/// <summary>
+	/// Stops streaming, if this is the last subscriber that has started it.
+	/// </summary>
+	void Stop();
+
+	/// <summary>
+	/// Picks up the latest frame and uploads it into the eye or stereo textures. Only does work once per engine frame.
+	/// </summary>
+	void Update();
+
+	/// <summary>
+	/// Returns `true`, if the stream is currently streaming.
+	/// </summary>
+	bool IsStreaming() const noexcept { return m_captureWorker.IsValid(); }
+
+	/// <summary>
+	/// Returns the key that identifies the stream within the hub.
+	/// </summary>
+	const FString& GetKey() const noexcept { return m_key; }
+
+	/// <summary>
+	/// Returns the source the camera frames are streamed from.
+	/// </summary>
+	const FCameraFrameSourcePtr& GetSource() const noexcept { return m_source; }
+
+	/// <summary>
+	/// Returns the size of a frame, containing both eye images.
+	/// </summary>
+	void GetFrameSize(uint32_t& width, uint32_t& height) const noexcept { width = m_frameWidth; height = m_frameHeight; }
+
+	/// <summary>
+	/// Returns the image of an eye, or `nullptr`, if the stereo image is uploaded instead.
+	/// </summary>
+	UTexture2D* GetEyeImage(vr::EVREye eye) const noexcept { return m_eyeImages[eye]; }
+
+	/// <summary>
+	/// Returns the image containing both eyes, or `nullptr`, if the eye images are uploaded instead. The right eye image is stored in the upper half, the left eye
+	/// image in the lower half.
+	/// </summary>
+	UTexture2D* GetStereoImage() const noexcept { return m_stereoImage; }
+
+	/// <summary>
+	/// Returns the background image of an eye, or `nullptr`, if the background model is not enabled.
+	/// </summary>
+	UTexture2D* GetBackgroundImage(vr::EVREye eye) const noexcept { return m_backgroundImages[eye]; }
+
+	/// <summary>
+	/// Returns the inpainted image of an eye, or `nullptr`, if inpainting is not enabled.
+	/// </summary>
+	UTexture2D* GetInpaintedImage(vr::EVREye eye) const noexcept { return m_inpaintedImages[eye]; }
+
+	/// <summary>
+	/// Returns the depth image, or `nullptr`, if stereo depth is not enabled. It contains the depth (in meters) of each pixel of the rectified left camera as 32 bit
+	/// float, or `0`, where no depth has been found.
+	/// </summary>
+	UTexture2D* GetDepthImage() const noexcept { return m_depthImage; }
+
+	/// <summary>
+	/// Returns the most recent depth map, or an invalid reference, if none has been estimated yet. The depth map has the layout of the depth image and is not modified,
+	/// while it is referenced.
+	/// </summary>
+	const FCameraFrameRef& GetLatestDepthMap() const noexcept { return m_latestDepthMap; }
+
+	/// <summary>
+	/// Returns the stereo depth engine, which describes the geometry of the depth maps, or an invalid pointer, if stereo depth is not enabled or the stream is not
+	/// streaming.
+	/// </summary>
+	const FCameraStereoDepthPtr& GetStereoDepth() const noexcept { return m_stereoDepth; }
+
+	/// <summary>
+	/// Returns the flow image, or `nullptr`, if frame interpolation is not enabled. It has the layout of the stereo image and contains one 16 bit float vector per
+	/// block, which is the motion of the block between the latest two frames in texture coordinates of the eye image. Sampling an eye image at
+	/// `UV - Flow * Phase` extrapolates it by the interpolation phase.
+	/// </summary>
+	UTexture2D* GetFlowImage() const noexcept { return m_flowImage; }
+
+	/// <summary>
+	/// Returns the interpolation phase of the latest frame at a point in time, i.e. the time since its exposure as multiple of the interval of the flow field.
+	/// </summary>
+	/// <param name="displayTime">The platform time (in seconds), the image is displayed.</param>
+	/// <returns>The phase, clamped to the largest interpolation phase, or `0`, if no flow field has been uploaded yet.</returns>
+	float GetInterpolationPhase(double displayTime) const;
+
+	/// <summary>
+	/// Returns the downsampled image containing both eyes, or `nullptr`, if foveated upload is not enabled. It has the layout of the stereo image.
+	/// </summary>
+	UTexture2D* GetPeripheryImage() const noexcept { return m_peripheryImage; }
+
+	/// <summary>
+	/// Returns the region of each eye image (in pixels) that has been uploaded at full resolution with the latest frame. Without foveated upload, it covers the whole
+	/// image.
+	/// </summary>
+	const FIntRect& GetFoveaRect() const noexcept { return m_foveaRect; }
+
+	/// <summary>
+	/// Moves the fovea region, e.g. to follow the gaze. The region moves with the next frame.
+	/// </summary>
+	/// <param name="center">The center of the fovea region relative to the size of an eye image. The region is kept inside the image.</param>
+	void SetFoveaCenter(const FVector2D& center);
+
+	/// <summary>
+	/// Returns the color and luminance statistics of the frames, or `nullptr`, if they are not enabled.
+	/// </summary>
+	const FCameraColorStatistics* GetColorStatistics() const noexcept { return m_colorStatistics.Get(); }
+
+	/// <summary>
+	/// Returns `true`, if the frames are chroma keyed.
+	/// </summary>
+	bool IsChromaKeyEnabled() const noexcept { return m_chromaKey.IsValid(); }
+
+	/// <summary>
+	/// Returns the mask and the connected regions of the most recently keyed frame. The mask is invalid, if chroma keying is not enabled or no frame has been keyed
+	/// yet. Keying runs on the thread pool, so the result may belong to an earlier frame than the latest one.
+	/// </summary>
+	const FCameraChromaKeyResult& GetChromaKeyResult() const noexcept { return m_chromaKeyResult; }
+
+	/// <summary>
+	/// Returns the settings of the chroma keying.
+	/// </summary>
+	const FCameraChromaKeySettings& GetChromaKeySettings() const noexcept { return m_chromaKeySettings; }
+
+	/// <summary>
+	/// Changes the settings of the chroma keying, which are used from the next keyed frame on.
+	/// </summary>
+	void SetChromaKeySettings(const FCameraChromaKeySettings& settings);
+
+	/// <summary>
+	/// Returns the chroma key image, or `nullptr`, if the mask is not uploaded. It has the layout of the stereo image and contains one 8 bit mask value per pixel.
+	/// </summary>
+	UTexture2D* GetChromaKeyImage() const noexcept { return m_chromaKeyImage; }
+
+	/// <summary>
+	/// Sets the regions of the eye images, outside of which the frames are only uploaded at a lower rate and not inpainted. The regions change with the next frame.
+	/// </summary>
+	/// <param name="left">The region of the left eye image in pixels. It is expanded to whole blocks and clipped to the image. An empty region skips the eye.</param>
+	/// <param name="right">The region of the right eye image in pixels.</param>
+	void SetRegionsOfInterest(const FIntRect& left, const FIntRect& right);
+
+	/// <summary>
+	/// Removes the regions of interest, so that the whole frames are uploaded and inpainted again.
+	/// </summary>
+	void ClearRegionsOfInterest();
+
+	/// <summary>
+	/// Returns `true`, if updates are currently restricted to the regions of interest.
+	/// </summary>
+	bool IsRestrictedToRegionsOfInterest() const noexcept { return m_settings.bRestrictToRegionOfInterest && m_hasRegionsOfInterest; }
+
+	/// <summary>
+	/// Returns the region of interest of an eye image in pixels, which is only meaningful, if updates are restricted to the regions of interest.
+	/// </summary>
+	const FIntRect& GetRegionOfInterest(vr::EVREye eye) const noexcept { return m_regionsOfInterest[eye]; }
+
+	/// <summary>
+	/// Returns the shared memory publisher, or an invalid pointer, if publishing is not enabled or the stream is not streaming.
+	/// </summary>
+	const FCameraSharedMemoryPublisherPtr& GetPublisher() const noexcept { return m_publisher; }
+
+	/// <summary>
+	/// Returns the number of frames that have not been published, because the previous frame was still being copied into shared memory.
+	/// </summary>
+	int32 GetUnpublishedFrames() const noexcept { return m_unpublishedFrames; }
+
+	/// <summary>
+	/// Sets the mask of the regions to fill by inpainting.
+	/// </summary>
+	/// <param name="mask">An 8 bit mask in the layout of the frames, where non-zero values mark pixels to fill. An empty mask disables inpainting.</param>
+	void SetInpaintingMask(TArray<uint8>&& mask);
+
+	/// <summary>
+	/// Returns the most recent frame, or an invalid reference, if no frame has been received yet.
+	/// </summary>
+	const FCameraFrameRef& GetLatestFrame() const noexcept { return m_latestFrame; }
+
+	/// <summary>
+	/// Returns the sequence number of the most recent frame, or `0`, if no frame has been received yet.
+	/// </summary>
+	uint32 GetFrameSequence() const noexcept { return m_latestFrame.IsValid() ? m_latestFrame->Header.nFrameSequence : 0; }
+
+	/// <summary>
+	/// Returns the time (in seconds) since the most recent frame has been received or streaming has been started.
+	/// </summary>
+	float GetTimeSinceLastFrame() const;
+
+	/// <summary>
+	/// Returns the number of frames that have been dropped, because the frame pool has been exhausted, or `0`, if the stream is not streaming.
+	/// </summary>
+	int32 GetDroppedFrames() const { return m_captureWorker.IsValid() ? m_captureWorker->GetDroppedFrames() : 0; }
+
+	/// <summary>
+	/// Returns the number of frames that have been overwritten by the capture worker before they have been read, or `0`, if the stream is not streaming.
+	/// </summary>
+	int32 GetSkippedFrames() const { return m_captureWorker.IsValid() ? m_captureWorker->GetSkippedFrames() : 0; }
+
+	/// <summary>
+	/// Returns the latency statistics of the stream, or an invalid pointer, if it is not streaming.
+	/// </summary>
+	const FCameraLatencyStatsPtr& GetLatencyStats() const noexcept { return m_latencyStats; }
+
+	/// <summary>
+	/// Returns the rate (in frames per second) at which the camera delivers frames to the capture worker, including dropped frames, measured over the last second.
+	/// </summary>
+	float GetFrameRate() const noexcept { return m_frameRate; }
+
+protected:
+	int32 GetFramePoolSize(int32 reservedFrames) const;
+	void Shutdown();
+	virtual void UpdateImages(const FCameraFrameRef& frame);
+	virtual void UpdateFoveatedImages(const FCameraFrameRef& frame);
+	virtual void UpdateRegionsOfInterest(const FCameraFrameRef& frame);
+	virtual void UpdateBackground(const FCameraFrameRef& frame);
+	virtual void UpdateInpainting(const FCameraFrameRef& frame);
+	virtual void UpdateStereoDepth(const FCameraFrameRef& frame);
+	virtual void UpdateOpticalFlow(const FCameraFrameRef& frame);
+	virtual void UpdateChromaKey(const FCameraFrameRef& frame);
+	virtual void UpdatePublisher(const FCameraFrameRef& frame);
+	void UploadImage(UTexture2D* texture, FCameraFrame* frame, const FCameraFramePoolPtr& pool, const FUpdateTextureRegion2D* regions, uint32 regionCount, const FCameraLatencyStatsPtr& stats, uint32 pitch = 0, uint32 bytesPerPixel = 4);
+	static void CleanupFrameBufferRegion(const FCameraFrame* frame, uint8_t* rawData, const FUpdateTextureRegion2D* region, FCameraLatencyStats* stats) noexcept;
+
+	// FGCObject
+public:
+	virtual void AddReferencedObjects(FReferenceCollector& collector) override;
+	virtual FString GetReferencerName() const override { return TEXT("FCameraStream"); }
+};
+
+/// <summary>
+/// Shared pointer to a camera stream, held by each subscriber.
+/// </summary>
+using FCameraStreamPtr = TSharedPtr<FCameraStream>;
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "UnrealDR.h"
+
+// Layout of a camera stream capture file:
+//
+//   FCameraStreamFileHeader
+//   Frame data (compressed or stored), one block per frame
+//   FCameraStreamIndexEntry[FrameCount]
+//   FCameraStreamFileFooter
+//
+// The index is written when the recording is finalized. It allows to seek to any frame without scanning the file. All structures are stored in native byte order,
+// since captures are meant to be replayed on the same kind of machine they are recorded on. Frame data is compressed with LZ4, unless compression does not reduce
+// its size.
+namespace UnrealDR
+{
+	namespace CameraStream
+	{
+		constexpr uint32 FileMagic = 0x43524455;		// "UDRC"
+		constexpr uint32 FileVersion = 1;
+	}
+}
+
+/// <summary>
+/// The header at the start of a camera stream capture file.
+/// </summary>
+struct FCameraStreamFileHeader
+{
+	uint32 Magic{ UnrealDR::CameraStream::FileMagic };
+	uint32 Version{ UnrealDR::CameraStream::FileVersion };
+	uint32 FrameWidth{ 0 };
+	uint32 FrameHeight{ 0 };
+	uint32 FrameBufferSize{ 0 };
+	uint32 Reserved{ 0 };
+	vr::HmdVector2_t FocalLength[2]{};
+	vr::HmdVector2_t Center[2]{};
+	vr::HmdMatrix34_t CameraToHead[2]{};
+};
+
+/// <summary>
+/// Describes where a frame is stored in a camera stream capture file.
+/// </summary>
+struct FCameraStreamIndexEntry
+{
+	/// <summary>
+	/// The offset of the frame data from the beginning of the file.
+	/// </summary>
+	uint64 Offset{ 0 };
+
+	/// <summary>
+	/// The size of the frame data in the file.
+	/// </summary>
+	uint32 StoredSize{ 0 };
+
+	/// <summary>
+	/// `1`, if the frame data is compressed, `0`, if it is stored uncompressed.
+	/// </summary>
+	uint32 Compressed{ 0 };
+
+	/// <summary>
+	/// The platform time (in seconds), the frame has been captured.
+	/// </summary>
+	double CaptureTime{ 0.0 };
+
+	/// <summary>
+	/// The header of the frame, as it has been returned by the frame source.
+	/// </summary>
+	vr::CameraVideoStreamFrameHeader_t Header{};
+};
+
+/// <summary>
+/// The footer at the end of a camera stream capture file.
+/// </summary>
+struct FCameraStreamFileFooter
+{
+	uint64 IndexOffset{ 0 };
+	uint32 FrameCount{ 0 };
+	uint32 Magic{ UnrealDR::CameraStream::FileMagic };
+};
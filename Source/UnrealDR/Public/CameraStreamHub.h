@@ -0,0 +1,61 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "UnrealDR.h"
+#include "CameraStream.h"
+
+/// <summary>
+/// Shares camera streams between all components that display the same frame source.
+/// </summary>
+/// <remarks>
+/// Streams are identified by a key that describes the frame source and its configuration (e.g. the tracked device). Subscribing to a key that already has a live
+/// stream returns that stream, so that the frames are only acquired, copied and uploaded once. The hub only holds weak references: a stream is destroyed and its
+/// source is released, when the last subscriber drops its pointer. The hub is owned by the <see cref="FUnrealDRModule" /> and must only be used from the game thread.
+/// </remarks>
+class UNREALDR_API FCameraStreamHub
+{
+private:
+	/// <summary>
+	/// The live streams by their keys.
+	/// </summary>
+	TMap<FString, TWeakPtr<FCameraStream>> m_streams;
+
+	/// <summary>
+	/// The pool the streams acquire their textures from.
+	/// </summary>
+	FCameraTexturePoolPtr m_texturePool;
+
+public:
+	FCameraStreamHub(FCameraTexturePoolPtr texturePool) : m_texturePool(texturePool) { }
+	~FCameraStreamHub() = default;
+
+	FCameraStreamHub(const FCameraStreamHub&) = delete;
+	FCameraStreamHub& operator=(const FCameraStreamHub&) = delete;
+
+public:
+	/// <summary>
+	/// Returns the stream for a key, creating it if it does not exist.
+	/// </summary>
+	/// <param name="key">The key that identifies the frame source and its configuration.</param>
+	/// <param name="createSource">Creates the frame source, if no stream exists for the key.</param>
+	/// <param name="settings">The stream settings, used if no stream exists for the key.</param>
+	/// <returns>The stream or `nullptr`, if no frame source could be created.</returns>
+	FCameraStreamPtr Subscribe(const FString& key, TFunctionRef<FCameraFrameSourcePtr()> createSource, const FCameraStreamSettings& settings);
+
+	/// <summary>
+	/// Returns the number of live streams.
+	/// </summary>
+	int32 GetStreamCount() const;
+
+	/// <summary>
+	/// Returns all live streams.
+	/// </summary>
+	/// <param name="streams">Receives the streams, ordered by their keys.</param>
+	void GetStreams(TArray<FCameraStreamPtr>& streams) const;
+
+	/// <summary>
+	/// Returns the pool the streams acquire their textures from.
+	/// </summary>
+	const FCameraTexturePoolPtr& GetTexturePool() const noexcept { return m_texturePool; }
+};
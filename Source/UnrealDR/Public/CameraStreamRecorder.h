@@ -0,0 +1,145 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "HAL/Event.h"
+#include "Containers/Queue.h"
+
+#include "UnrealDR.h"
+#include "CameraFramePool.h"
+#include "CameraFrameSource.h"
+#include "CameraStreamFormat.h"
+
+class IFileHandle;
+
+/// <summary>
+/// Records camera frames and their headers into a compressed, indexed capture file on a background thread.
+/// </summary>
+/// <remarks>
+/// Frames are handed to the recorder by reference, so that enqueuing a frame never copies or compresses on the calling thread. The number of frames waiting to be
+/// written is bounded. If the writer falls behind, new frames are dropped and counted instead of stalling the caller. Captures can be replayed using the
+/// <see cref="FReplayCameraFrameSource" />.
+/// </remarks>
+class UNREALDR_API FCameraStreamRecorder : public FRunnable
+{
+private:
+	/// <summary>
+	/// The path of the capture file.
+	/// </summary>
+	FString m_fileName;
+
+	/// <summary>
+	/// The handle of the capture file.
+	/// </summary>
+	TUniquePtr<IFileHandle> m_file;
+
+	/// <summary>
+	/// The frames that are waiting to be written.
+	/// </summary>
+	TQueue<FCameraFrameRef, EQueueMode::Spsc> m_queue;
+
+	/// <summary>
+	/// The number of frames in <see cref="m_queue" />.
+	/// </summary>
+	FThreadSafeCounter m_queuedFrames;
+
+	/// <summary>
+	/// The maximum number of frames that may wait to be written, before new frames are dropped.
+	/// </summary>
+	int32 m_maxQueuedFrames{ 2 };
+
+	/// <summary>
+	/// The index entries of all frames that have been written so far.
+	/// </summary>
+	TArray<FCameraStreamIndexEntry> m_index;
+
+	/// <summary>
+	/// Scratch buffer that receives the compressed frame data.
+	/// </summary>
+	TArray<uint8> m_compressionBuffer;
+
+	/// <summary>
+	/// The number of frames that have been written.
+	/// </summary>
+	FThreadSafeCounter m_writtenFrames;
+
+	/// <summary>
+	/// The number of frames that have been dropped, because the writer has fallen behind.
+	/// </summary>
+	FThreadSafeCounter m_droppedFrames;
+
+	/// <summary>
+	/// The thread that runs the writer.
+	/// </summary>
+	FRunnableThread* m_thread{ nullptr };
+
+	/// <summary>
+	/// Event that is triggered, if a new frame has been enqueued or the writer should stop.
+	/// </summary>
+	FEvent* m_wakeEvent{ nullptr };
+
+	/// <summary>
+	/// `true`, as long as the writer should keep waiting for new frames.
+	/// </summary>
+	FThreadSafeBool m_running{ false };
+
+public:
+	FCameraStreamRecorder(const FString& fileName, int32 maxQueuedFrames = 2);
+	virtual ~FCameraStreamRecorder();
+
+	FCameraStreamRecorder(const FCameraStreamRecorder&) = delete;
+	FCameraStreamRecorder& operator=(const FCameraStreamRecorder&) = delete;
+
+public:
+	/// <summary>
+	/// Creates the capture file, writes the calibration of the frame source into it and starts the writer thread.
+	/// </summary>
+	/// <param name="source">The source the recorded frames are streamed from.</param>
+	/// <returns>`true`, if the recording has been started, otherwise `false`.</returns>
+	bool Start(const ICameraFrameSource& source);
+
+	/// <summary>
+	/// Writes all pending frames, appends the frame index and closes the capture file.
+	/// </summary>
+	void Finish();
+
+	/// <summary>
+	/// Enqueues a frame to be written. This never blocks.
+	/// </summary>
+	/// <param name="frame">The frame to record.</param>
+	/// <returns>`true`, if the frame has been enqueued, `false`, if it has been dropped.</returns>
+	bool Enqueue(const FCameraFrameRef& frame);
+
+	/// <summary>
+	/// Returns the maximum number of frames the recorder holds references to at any time.
+	/// </summary>
+	int32 GetMaxQueuedFrames() const noexcept { return m_maxQueuedFrames; }
+
+	/// <summary>
+	/// Returns the number of frames that have been written.
+	/// </summary>
+	int32 GetWrittenFrames() const { return m_writtenFrames.GetValue(); }
+
+	/// <summary>
+	/// Returns the number of frames that have been dropped, because the writer has fallen behind.
+	/// </summary>
+	int32 GetDroppedFrames() const { return m_droppedFrames.GetValue(); }
+
+	/// <summary>
+	/// Returns the path of the capture file.
+	/// </summary>
+	const FString& GetFileName() const noexcept { return m_fileName; }
+
+	// FRunnable
+public:
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	void WriteQueuedFrames();
+	bool WriteFrame(const FCameraFrame& frame);
+	void WriteIndex();
+};
@@ -0,0 +1,286 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "UnrealDR.h"
+#include "CameraInpainting.h"
+#include "CameraStereoDepth.h"
+#include "CameraOpticalFlow.h"
+#include "CameraChromaKey.h"
+#include "CameraStreamSettings.generated.h"
+
+/// <summary>
+/// Settings of a camera stream, which control how its frames are uploaded and which results are computed from them.
+/// </summary>
+/// <remarks>
+/// A stream is shared by all components that display the same frame source. It is created with the settings of the first component that subscribes to it, and the
+/// settings of further subscribers are ignored, until the last subscriber has released the stream. Since properties that are set from C++ or Blueprints bypass the
+/// clamps of the editor, the stream calls <see cref="Validate" /> on its copy of the settings.
+/// </remarks>
+USTRUCT(BlueprintType)
+struct UNREALDR_API FCameraStreamSettings
+{
+	GENERATED_BODY()
+
+	/// <summary>
+	/// The number of frame buffers that are allocated for streaming, in addition to the ones reserved by the subscribers and held by pending tasks. If all buffers
+	/// are in use (e.g. because the render thread falls behind), new frames are dropped.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (ClampMin = 4, ClampMax = 32), Category = "UnrealDR|Camera Stream") int32 FrameBufferPoolSize = 6;
+
+	/// <summary>
+	/// If enabled, only the tiles of the eye images that have changed since the last frame are uploaded. This saves upload bandwidth for static, noise-free sources,
+	/// such as replays of synthetic frames. Sensor noise changes nearly every tile of live camera frames, so that the checksums cost a pass over each frame on the
+	/// game thread and the whole frame is uploaded anyway. Changes that happen to keep the checksum of a tile are not uploaded.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "UnrealDR|Camera Stream") bool bUploadDirtyTilesOnly = false;
+
+	/// <summary>
+	/// If enabled, each frame is uploaded into a single stereo image with one texture update, instead of separate eye images. The material receives it as
+	/// `StereoImage`, along with `StereoImageLayout`, which contains the vertical offset of the left eye, the vertical offset of the right eye and the vertical scale
+	/// of each eye.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "UnrealDR|Camera Stream") bool bUploadStereoImage = false;
+
+	/// <summary>
+	/// The edge length (in pixels) of the tiles that are checked for changes.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (ClampMin = 8, ClampMax = 256, EditCondition = "bUploadDirtyTilesOnly"), Category = "UnrealDR|Camera Stream") int32 DirtyTileSize = 32;
+
+	/// <summary>
+	/// The ratio of changed tiles, above which the whole eye image is uploaded at once.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (ClampMin = 0, ClampMax = 1, EditCondition = "bUploadDirtyTilesOnly"), Category = "UnrealDR|Camera Stream") float MaxDirtyTileRatio = 0.5f;
+
+	/// <summary>
+	/// If enabled, the static background of the camera images is estimated with a running approximate median and exposed to the material as `LeftEyeBackground` and
+	/// `RightEyeBackground`.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "UnrealDR|Background Model") bool bEnableBackgroundModel = false;
+
+	/// <summary>
+	/// The number of frames between two updates of the background model. Higher values reduce the cost, but make the model adapt slower.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (ClampMin = 1, ClampMax = 60, EditCondition = "bEnableBackgroundModel"), Category = "UnrealDR|Background Model") int32 BackgroundUpdateStride = 2;
+
+	/// <summary>
+	/// The maximum change of each color channel of the background model per update. Higher values make the model adapt faster, but let moving objects leave a trace.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (ClampMin = 1, ClampMax = 32, EditCondition = "bEnableBackgroundModel"), Category = "UnrealDR|Background Model") int32 BackgroundAdaptationStep = 1;
+
+	/// <summary>
+	/// If enabled, the regions set by <see cref="UCameraSeeThroughComponent::SetInpaintingMask" /> are filled with content synthesized from their surroundings and
+	/// exposed to the material as `LeftEyeInpainted` and `RightEyeInpainted`.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "UnrealDR|Inpainting") bool bEnableInpainting = false;
+
+	/// <summary>
+	/// The maximum number of pyramid levels, the images are inpainted on. More levels fill larger regions more coherently.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (ClampMin = 1, ClampMax = 8, EditCondition = "bEnableInpainting"), Category = "UnrealDR|Inpainting") int32 InpaintingPyramidLevels = 4;
+
+	/// <summary>
+	/// The number of iterations on each pyramid level, if a frame is inpainted from scratch.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (ClampMin = 1, ClampMax = 16, EditCondition = "bEnableInpainting"), Category = "UnrealDR|Inpainting") int32 InpaintingIterations = 4;
+
+	/// <summary>
+	/// The number of iterations at full resolution, if a frame continues from the result of the previous one.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (ClampMin = 1, ClampMax = 16, EditCondition = "bEnableInpainting"), Category = "UnrealDR|Inpainting") int32 InpaintingSteadyStateIterations = 2;
+
+	/// <summary>
+	/// The time (in milliseconds) per frame, after which no further inpainting iterations are started.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (ClampMin = 1, ClampMax = 100, EditCondition = "bEnableInpainting"), Category = "UnrealDR|Inpainting") float InpaintingTimeBudget = 8.f;
+
+	/// <summary>
+	/// If enabled, a depth map is estimated from the stereo camera images with semi-global matching and exposed to the material as `DepthImage`, e.g. to occlude
+	/// virtual content by real objects.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "UnrealDR|Stereo Depth") bool bEnableStereoDepth = false;
+
+	/// <summary>
+	/// The resolution of the depth map. Lower resolutions are cheaper to compute, but miss thin structures.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (ClampMin = 16, ClampMax = 1024, EditCondition = "bEnableStereoDepth"), Category = "UnrealDR|Stereo Depth") FIntPoint StereoDepthSize = FIntPoint(160, 120);
+
+	/// <summary>
+	/// The number of disparities (in pixels of the depth map) that are searched, which determines the minimum depth. It is rounded up to a multiple of 16.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (ClampMin = 16, ClampMax = 128, EditCondition = "bEnableStereoDepth"), Category = "UnrealDR|Stereo Depth") int32 StereoDepthDisparityRange = 48;
+
+	/// <summary>
+	/// The penalty of small disparity changes between neighboring pixels. Higher values produce smoother depth maps.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (ClampMin = 1, ClampMax = 255, EditCondition = "bEnableStereoDepth"), Category = "UnrealDR|Stereo Depth") int32 StereoDepthSmallPenalty = 6;
+
+	/// <summary>
+	/// The penalty of depth discontinuities between neighboring pixels. Higher values produce fewer, but more blurred edges.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (ClampMin = 1, ClampMax = 255, EditCondition = "bEnableStereoDepth"), Category = "UnrealDR|Stereo Depth") int32 StereoDepthLargePenalty = 48;
+
+	/// <summary>
+	/// If enabled, depths that are not confirmed by matching the right image against the left one are rejected. This removes most errors in occluded regions.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (EditCondition = "bEnableStereoDepth"), Category = "UnrealDR|Stereo Depth") bool bStereoDepthLeftRightCheck = true;
+
+	/// <summary>
+	/// If enabled, the motion between the latest two frames is estimated by block matching on the thread pool, so that the camera images can be presented at the
+	/// display refresh rate instead of the camera frame rate. The material receives the motion as `FlowImage` in the layout of `StereoImage` and the time since the
+	/// latest frame as `FlowPhase`, and samples the eye images at `UV - Flow * FlowPhase`. The flow contains the motion of the head, which reprojection already
+	/// compensates, so it is best combined with reprojection disabled.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "UnrealDR|Frame Interpolation") bool bEnableFrameInterpolation = false;
+
+	/// <summary>
+	/// The number of times the eye images are halved before blocks of 8x8 pixels are matched. Higher levels are cheaper and follow faster motion, but blur the flow.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (ClampMin = 0, ClampMax = 4, EditCondition = "bEnableFrameInterpolation"), Category = "UnrealDR|Frame Interpolation") int32 FlowPyramidLevel = 2;
+
+	/// <summary>
+	/// The largest motion (in pixels of the pyramid level) between two frames that is searched in each direction. The cost grows with its square.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (ClampMin = 1, ClampMax = 16, EditCondition = "bEnableFrameInterpolation"), Category = "UnrealDR|Frame Interpolation") int32 FlowSearchRadius = 4;
+
+	/// <summary>
+	/// The sum of absolute luminance differences, by which a motion has to match better than no motion. Higher values suppress flow in flat and noisy regions.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (ClampMin = 0, ClampMax = 4096, EditCondition = "bEnableFrameInterpolation"), Category = "UnrealDR|Frame Interpolation") int32 FlowZeroMotionBias = 32;
+
+	/// <summary>
+	/// The largest multiple of the frame interval, by which the images are extrapolated beyond the latest frame, e.g. if frames are late.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (ClampMin = 0, ClampMax = 2, EditCondition = "bEnableFrameInterpolation"), Category = "UnrealDR|Frame Interpolation") float MaxInterpolationPhase = 1.f;
+
+	/// <summary>
+	/// If enabled, only the fovea region of each eye is uploaded at full resolution and the rest from a downsampled copy, which reduces the uploaded bytes per frame.
+	/// The material receives the downsampled images as `PeripheryImage` in the layout of `StereoImage`, and the fovea region as `FoveaRect`, which contains the
+	/// minimum and maximum texture coordinates of the region within an eye image. Outside of the fovea region, the eye images are not up to date. Dirty tiles are not
+	/// tracked.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "UnrealDR|Foveated Upload") bool bFoveatedUpload = false;
+
+	/// <summary>
+	/// The size of the fovea region relative to the size of an eye image.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 0.05, ClampMax = 1, EditCondition = "bFoveatedUpload"), Category = "UnrealDR|Foveated Upload") FVector2D FoveaSize = FVector2D(0.5f, 0.5f);
+
+	/// <summary>
+	/// The number of times the eye images are halved for the periphery.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (ClampMin = 1, ClampMax = 4, EditCondition = "bFoveatedUpload"), Category = "UnrealDR|Foveated Upload") int32 PeripheryLevels = 2;
+
+	/// <summary>
+	/// If enabled, each frame is published with its header, pose and the camera calibration into a named shared memory ring, so that other processes on the same
+	/// machine can use the frames without acquiring the camera. The layout is described in `CameraSharedMemoryPublisher.h`.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "UnrealDR|Shared Memory") bool bPublishToSharedMemory = false;
+
+	/// <summary>
+	/// The base name of the shared memory region. The stream key is appended (e.g. `UnrealDR_CameraFrames_OpenVR_0`), so that each stream publishes into its own
+	/// region. On POSIX platforms, the region is created as `/<name>`.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (EditCondition = "bPublishToSharedMemory"), Category = "UnrealDR|Shared Memory") FString SharedMemoryName = TEXT("UnrealDR_CameraFrames");
+
+	/// <summary>
+	/// The number of frames the shared memory ring holds. Readers that take longer than this many frames to process one are lapped.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (ClampMin = 2, ClampMax = 16, EditCondition = "bPublishToSharedMemory"), Category = "UnrealDR|Shared Memory") int32 SharedMemorySlots = 4;
+
+	/// <summary>
+	/// If enabled, the color and luminance statistics of each frame are measured, e.g. to match the exposure and white balance of virtual content to the camera
+	/// images. The smoothed statistics are passed to the material as `CameraAverageColor`, `CameraWhiteBalance`, `CameraLuminance` (5th percentile, median, 95th
+	/// percentile and average) and `CameraExposureBias`.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "UnrealDR|Color Statistics") bool bEnableColorStatistics = false;
+
+	/// <summary>
+	/// Only every n-th row, and every n-th block of four pixels within it, is sampled.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (ClampMin = 1, ClampMax = 32, EditCondition = "bEnableColorStatistics"), Category = "UnrealDR|Color Statistics") int32 ColorStatisticsStride = 4;
+
+	/// <summary>
+	/// The time constant (in seconds) of the temporal smoothing. If set to `0`, the statistics of each frame are used as is.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (ClampMin = 0, EditCondition = "bEnableColorStatistics"), Category = "UnrealDR|Color Statistics") float ColorStatisticsSmoothingTime = 0.5f;
+
+	/// <summary>
+	/// If enabled, the frames are chroma keyed on the thread pool and the connected regions of keyed pixels are provided as `ChromaKeyBlobs`. While updates are
+	/// restricted to the region of interest, only it is keyed.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "UnrealDR|Chroma Key") bool bEnableChromaKey = false;
+
+	/// <summary>
+	/// The color of the backdrop that is keyed.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (EditCondition = "bEnableChromaKey"), Category = "UnrealDR|Chroma Key") FColor ChromaKeyColor = FColor(0, 177, 64);
+
+	/// <summary>
+	/// The chroma distance to the key color, below which pixels are fully keyed.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 0, ClampMax = 510, EditCondition = "bEnableChromaKey"), Category = "UnrealDR|Chroma Key") int32 ChromaKeyThreshold = 32;
+
+	/// <summary>
+	/// The width of the soft edge beyond the threshold, in which the mask falls off to `0`.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 1, ClampMax = 255, EditCondition = "bEnableChromaKey"), Category = "UnrealDR|Chroma Key") int32 ChromaKeySoftness = 32;
+
+	/// <summary>
+	/// The number of pixels, below which connected regions are discarded.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (ClampMin = 1, EditCondition = "bEnableChromaKey"), Category = "UnrealDR|Chroma Key") int32 ChromaKeyMinBlobArea = 64;
+
+	/// <summary>
+	/// The largest number of connected regions that are kept, starting with the largest one.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (ClampMin = 1, ClampMax = 1024, EditCondition = "bEnableChromaKey"), Category = "UnrealDR|Chroma Key") int32 ChromaKeyMaxBlobs = 32;
+
+	/// <summary>
+	/// If enabled, the mask is uploaded and passed to the material as `ChromaKeyImage` in the layout of `StereoImage`. Leave it disabled, if only the connected
+	/// regions are needed.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (EditCondition = "bEnableChromaKey"), Category = "UnrealDR|Chroma Key") bool bUploadChromaKeyMask = false;
+
+	/// <summary>
+	/// If enabled, only the region of interest of each eye image is uploaded and inpainted, once it has been set. The full frames are uploaded at a lower rate. Dirty
+	/// tiles are not tracked. Foveated upload takes precedence.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "UnrealDR|Region Of Interest") bool bRestrictToRegionOfInterest = false;
+
+	/// <summary>
+	/// The time (in seconds) between two uploads of the full frames.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Meta = (ClampMin = 0, EditCondition = "bRestrictToRegionOfInterest"), Category = "UnrealDR|Region Of Interest") float FullFrameRefreshInterval = 0.25f;
+
+	/// <summary>
+	/// If enabled, the timestamps and latencies of each frame are written to a CSV file under `Saved/UnrealDR/Latency/` during play.
+	/// </summary>
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "UnrealDR|Profiling") bool bWriteLatencyCsv = false;
+
+public:
+	/// <summary>
+	/// Clamps all settings to their valid ranges.
+	/// </summary>
+	void Validate();
+
+	/// <summary>
+	/// Returns the settings of the inpainting.
+	/// </summary>
+	FCameraInpaintingSettings GetInpaintingSettings() const;
+
+	/// <summary>
+	/// Returns the settings of the stereo depth estimation.
+	/// </summary>
+	FCameraStereoDepthSettings GetStereoDepthSettings() const;
+
+	/// <summary>
+	/// Returns the settings of the optical flow estimation.
+	/// </summary>
+	FCameraOpticalFlowSettings GetOpticalFlowSettings() const;
+
+	/// <summary>
+	/// Returns the settings of the chroma keying.
+	/// </summary>
+	FCameraChromaKeySettings GetChromaKeySettings() const;
+};
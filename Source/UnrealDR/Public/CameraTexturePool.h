@@ -0,0 +1,164 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/GCObject.h"
+#include "Engine/Texture2D.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Containers/LockFreeList.h"
+
+#include "UnrealDR.h"
+
+/// <summary>
+/// A block of texture update regions, which stays alive until the render thread has finished the upload that reads it.
+/// </summary>
+struct FCameraUploadRegions
+{
+	/// <summary>
+	/// The regions of the upload. The allocation is kept, when the block is returned to the pool.
+	/// </summary>
+	TArray<FUpdateTextureRegion2D> Regions;
+};
+
+/// <summary>
+/// Pools the transient textures of camera streams and the region blocks of their uploads.
+/// </summary>
+/// <remarks>
+/// Components are re-registered frequently in the editor (e.g. on every property change), and a changed frame size or stream configuration replaces their stream.
+/// Instead of creating new textures for each stream, textures are acquired from the pool by size and format and returned to it, when the stream is destroyed. Free
+/// textures are released, once they have not been reused for <see cref="FreeTextureLifetime" /> seconds, or if there are more than <see cref="MaxFreeTextures" />
+/// of them. Textures must only be acquired and returned on the game thread. Region blocks are acquired on the game thread and returned from the cleanup of the
+/// upload on the render thread, which is lock-free. The pool is owned by the <see cref="FUnrealDRModule" /> and shared with the streams and their pending uploads.
+/// </remarks>
+class UNREALDR_API FCameraTexturePool : public FGCObject
+{
+public:
+	/// <summary>
+	/// The maximum number of free textures that are kept for reuse.
+	/// </summary>
+	static constexpr int32 MaxFreeTextures = 16;
+
+	/// <summary>
+	/// The time (in seconds), after which a free texture that has not been reused is released.
+	/// </summary>
+	static constexpr double FreeTextureLifetime = 30.0;
+
+private:
+	/// <summary>
+	/// A texture that is currently not in use.
+	/// </summary>
+	struct FFreeTexture
+	{
+		UTexture2D* Texture;
+		double ReleaseTime;
+	};
+
+	/// <summary>
+	/// The textures that are currently in use.
+	/// </summary>
+	TArray<UTexture2D*> m_usedTextures;
+
+	/// <summary>
+	/// The textures that can be reused, in the order they have been returned.
+	/// </summary>
+	TArray<FFreeTexture> m_freeTextures;
+
+	/// <summary>
+	/// The number of texture requests that have been served from the pool or have created a new texture.
+	/// </summary>
+	uint32 m_textureHits{ 0 };
+	uint32 m_textureMisses{ 0 };
+
+	/// <summary>
+	/// All region blocks owned by the pool.
+	/// </summary>
+	TArray<FCameraUploadRegions*> m_regionBlocks;
+
+	/// <summary>
+	/// The region blocks that are currently not in use.
+	/// </summary>
+	TLockFreePointerListUnordered<FCameraUploadRegions, PLATFORM_CACHE_LINE_SIZE> m_freeRegionBlocks;
+
+	/// <summary>
+	/// The number of region block requests that have been served from the pool or have allocated a new block.
+	/// </summary>
+	FThreadSafeCounter m_regionHits;
+	FThreadSafeCounter m_regionMisses;
+
+public:
+	FCameraTexturePool() = default;
+	virtual ~FCameraTexturePool();
+
+	FCameraTexturePool(const FCameraTexturePool&) = delete;
+	FCameraTexturePool& operator=(const FCameraTexturePool&) = delete;
+
+public:
+	/// <summary>
+	/// Acquires a texture with a given size and format, reusing a free one if possible.
+	/// </summary>
+	/// <remarks>
+	/// Reused textures still contain the image they have been returned with, until they are updated.
+	/// </remarks>
+	/// <param name="width">The width of the texture in pixels.</param>
+	/// <param name="height">The height of the texture in pixels.</param>
+	/// <param name="format">The pixel format of the texture.</param>
+	/// <returns>The texture, or `nullptr`, if it could not be created.</returns>
+	UTexture2D* AcquireTexture(int32 width, int32 height, EPixelFormat format);
+
+	/// <summary>
+	/// Returns a texture to the pool, so that it can be reused. Textures that have not been acquired from the pool are ignored.
+	/// </summary>
+	void ReleaseTexture(UTexture2D* texture);
+
+	/// <summary>
+	/// Acquires a block of update regions and copies the regions into it. The block is never `nullptr`.
+	/// </summary>
+	FCameraUploadRegions* AcquireRegions(const FUpdateTextureRegion2D* regions, uint32 regionCount);
+
+	/// <summary>
+	/// Returns a block of update regions to the pool. May be called from any thread.
+	/// </summary>
+	void ReleaseRegions(FCameraUploadRegions* block);
+
+	/// <summary>
+	/// Releases the free textures that have not been reused for <see cref="FreeTextureLifetime" /> seconds, or all of them, if <paramref name="all" /> is `true`.
+	/// </summary>
+	void Trim(bool all = false);
+
+	/// <summary>
+	/// Returns the number of textures owned by the pool, including the ones in use.
+	/// </summary>
+	int32 GetTextureCount() const noexcept { return m_usedTextures.Num() + m_freeTextures.Num(); }
+
+	/// <summary>
+	/// Returns the number of textures that are currently not in use.
+	/// </summary>
+	int32 GetFreeTextureCount() const noexcept { return m_freeTextures.Num(); }
+
+	/// <summary>
+	/// Returns the ratio of texture requests that have been served by reusing a texture.
+	/// </summary>
+	float GetTextureHitRate() const noexcept;
+
+	/// <summary>
+	/// Returns the number of region blocks owned by the pool, including the ones in use.
+	/// </summary>
+	int32 GetRegionBlockCount() const noexcept { return m_regionBlocks.Num(); }
+
+	/// <summary>
+	/// Returns the ratio of region block requests that have been served by reusing a block.
+	/// </summary>
+	float GetRegionHitRate() const;
+
+private:
+	void PublishStats() const;
+
+	// FGCObject
+public:
+	virtual void AddReferencedObjects(FReferenceCollector& collector) override;
+	virtual FString GetReferencerName() const override { return TEXT("FCameraTexturePool"); }
+};
+
+/// <summary>
+/// Thread-safe shared pointer to a texture pool, held by the module, the streams and their pending uploads.
+/// </summary>
+using FCameraTexturePoolPtr = TSharedPtr<FCameraTexturePool, ESPMode::ThreadSafe>;
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "UnrealDR.h"
+#include "CameraFrameSource.h"
+
+/// <summary>
+/// Describes the mapping between a distorted source image and an undistorted target image.
+/// </summary>
+struct FCameraRemapParameters
+{
+	/// <summary>
+	/// The size of the distorted image in pixels.
+	/// </summary>
+	uint32 SourceWidth{ 0 };
+	uint32 SourceHeight{ 0 };
+
+	/// <summary>
+	/// The intrinsics of the distorted image in pixels.
+	/// </summary>
+	FVector2D SourceFocalLength{ 1.f, 1.f };
+	FVector2D SourceCenter{ 0.f, 0.f };
+
+	/// <summary>
+	/// The lens distortion of the source image.
+	/// </summary>
+	FCameraDistortion Distortion;
+
+	/// <summary>
+	/// The size of the undistorted image in pixels.
+	/// </summary>
+	uint32 TargetWidth{ 0 };
+	uint32 TargetHeight{ 0 };
+
+	/// <summary>
+	/// The intrinsics of the undistorted image in pixels.
+	/// </summary>
+	FVector2D TargetFocalLength{ 1.f, 1.f };
+	FVector2D TargetCenter{ 0.f, 0.f };
+
+	/// <summary>
+	/// The rotation from the target camera into the source camera, e.g. to rectify a stereo pair. Both use image coordinates: x right, y down and z forward. The rows
+	/// contain the target axes in source camera coordinates.
+	/// </summary>
+	FMatrix TargetRotation{ FMatrix::Identity };
+
+	bool operator==(const FCameraRemapParameters& other) const noexcept;
+	bool operator!=(const FCameraRemapParameters& other) const noexcept { return !(*this == other); }
+};
+
+/// <summary>
+/// Removes the lens distortion from RGBA images, using a pre-computed remap table.
+/// </summary>
+/// <remarks>
+/// For each target pixel, the table stores the coordinates of the top-left source pixel and the bilinear weights in 8 bit fixed point. The table is stored in tiles of
+/// <see cref="TileSize" /> x <see cref="TileSize" /> target pixels, so that the source pixels read while processing a tile are close to each other. Tile rows are
+/// processed in parallel. The target camera may be rotated against the source camera, so that the same tables can rectify a stereo pair. The table only needs to be
+/// re-built if the parameters change, which is why <see cref="Build" /> returns immediately, if they are equal to the ones of the current table. Target pixels that
+/// map outside of the source image are filled with opaque black.
+/// </remarks>
+class UNREALDR_API FCameraUndistortion
+{
+public:
+	/// <summary>
+	/// The edge length of a tile of the remap table in pixels.
+	/// </summary>
+	static constexpr uint32 TileSize = 16;
+
+private:
+	/// <summary>
+	/// A single entry of the remap table.
+	/// </summary>
+	struct FRemapEntry
+	{
+		/// <summary>
+		/// The coordinates of the top-left source pixel. <see cref="X" /> is `MAX_uint16`, if the target pixel maps outside of the source image.
+		/// </summary>
+		uint16 X;
+		uint16 Y;
+
+		/// <summary>
+		/// The horizontal and vertical weights of the right and bottom source pixels, in the range `[0, 256]`.
+		/// </summary>
+		uint16 WeightX;
+		uint16 WeightY;
+	};
+
+private:
+	/// <summary>
+	/// The parameters the remap table has been built for.
+	/// </summary>
+	FCameraRemapParameters m_parameters;
+
+	/// <summary>
+	/// The remap table.
+	/// </summary>
+	TArray<FRemapEntry> m_table;
+
+	/// <summary>
+	/// The number of tiles in horizontal direction.
+	/// </summary>
+	uint32 m_tilesX{ 0 };
+
+	/// <summary>
+	/// The number of tiles in vertical direction.
+	/// </summary>
+	uint32 m_tilesY{ 0 };
+
+public:
+	/// <summary>
+	/// Builds the remap table, if the parameters differ from the ones of the current table.
+	/// </summary>
+	/// <param name="parameters">The remap parameters.</param>
+	/// <returns>`true`, if the table is valid, otherwise `false`.</returns>
+	bool Build(const FCameraRemapParameters& parameters);
+
+	/// <summary>
+	/// Removes the distortion from an image.
+	/// </summary>
+	/// <param name="source">Pointer to the first pixel of the distorted source image.</param>
+	/// <param name="sourcePitch">The number of bytes between two rows of the source image.</param>
+	/// <param name="target">Pointer to the first pixel of the target image.</param>
+	/// <param name="targetPitch">The number of bytes between two rows of the target image.</param>
+	void Apply(const uint8* source, uint32 sourcePitch, uint8* target, uint32 targetPitch) const;
+
+	/// <summary>
+	/// Returns `true`, if a remap table has been built.
+	/// </summary>
+	bool IsValid() const noexcept { return m_table.Num() > 0; }
+
+	/// <summary>
+	/// Returns the parameters the remap table has been built for.
+	/// </summary>
+	const FCameraRemapParameters& GetParameters() const noexcept { return m_parameters; }
+
+	/// <summary>
+	/// Maps a normalized, undistorted image coordinate to its distorted counterpart.
+	/// </summary>
+	/// <param name="distortion">The lens distortion.</param>
+	/// <param name="point">The undistorted point on the normalized image plane.</param>
+	/// <returns>The distorted point on the normalized image plane.</returns>
+	static FVector2D Distort(const FCameraDistortion& distortion, const FVector2D& point) noexcept;
+
+private:
+	void ApplyTileRow(const uint8* source, uint32 sourcePitch, uint8* target, uint32 targetPitch, uint32 tileY) const;
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "UnrealDR.h"
+
+/// <summary>
+/// A timestamped ring of HMD poses, used to look up the pose the HMD had at a certain point in time.
+/// </summary>
+/// <remarks>
+/// Poses are stored in Unreal Engine tracking space (see <see cref="FHmdPoseHistory::ConvertPose" />), so that they can directly be combined with component
+/// transforms. The history has a fixed capacity and never allocates after construction. Sampling interpolates between the two poses surrounding the requested time
+/// and clamps to the oldest or newest pose, if the time is outside of the recorded range. The class has no dependency on a VR runtime, so that the pose math can be
+/// exercised without an HMD.
+/// </remarks>
+class UNREALDR_API FHmdPoseHistory
+{
+private:
+	/// <summary>
+	/// A single pose sample.
+	/// </summary>
+	struct FTimedPose
+	{
+		double Time{ 0.0 };
+		FQuat Rotation{ FQuat::Identity };
+		FVector Translation{ FVector::ZeroVector };
+	};
+
+private:
+	/// <summary>
+	/// The pose samples. Used as a ring buffer.
+	/// </summary>
+	TArray<FTimedPose> m_poses;
+
+	/// <summary>
+	/// The index of the next sample to overwrite.
+	/// </summary>
+	int32 m_next{ 0 };
+
+	/// <summary>
+	/// The number of valid samples.
+	/// </summary>
+	int32 m_count{ 0 };
+
+public:
+	FHmdPoseHistory(int32 capacity = 128);
+
+public:
+	/// <summary>
+	/// Adds a pose sample. Samples must be added in chronological order, samples older than the newest one are ignored.
+	/// </summary>
+	/// <param name="time">The platform time (in seconds), the pose has been valid.</param>
+	/// <param name="pose">The head-to-tracking space transform.</param>
+	void Add(double time, const FTransform& pose);
+
+	/// <summary>
+	/// Returns the pose the HMD had at a certain point in time.
+	/// </summary>
+	/// <param name="time">The platform time (in seconds) to sample the pose for.</param>
+	/// <param name="pose">The interpolated head-to-tracking space transform.</param>
+	/// <returns>`true`, if the history contains at least one sample, otherwise `false`.</returns>
+	bool Sample(double time, FTransform& pose) const;
+
+	/// <summary>
+	/// Removes all samples.
+	/// </summary>
+	void Reset() noexcept;
+
+	/// <summary>
+	/// Returns the number of samples in the history.
+	/// </summary>
+	int32 Num() const noexcept { return m_count; }
+
+	/// <summary>
+	/// Returns the maximum number of samples in the history.
+	/// </summary>
+	int32 GetCapacity() const noexcept { return m_poses.Num(); }
+
+public:
+	/// <summary>
+	/// Converts an OpenVR device-to-tracking space matrix into an Unreal Engine transform.
+	/// </summary>
+	/// <remarks>
+	/// OpenVR uses a right-handed coordinate system in meters (up: +y, right: +x, forward: -z), whilst Unreal Engine uses a left-handed coordinate system in Unreal
+	/// Units (up: +z, right: +y, forward: +x). The conversion is the same one the SteamVR plugin applies to tracked device poses.
+	/// </remarks>
+	/// <param name="deviceToTracking">The OpenVR pose matrix.</param>
+	/// <param name="worldToMeters">The number of Unreal Units per meter.</param>
+	static FTransform ConvertPose(const vr::HmdMatrix34_t& deviceToTracking, float worldToMeters) noexcept;
+
+	/// <summary>
+	/// Computes the transform that moves content, which has been captured relative to the head at one pose, so that it appears at the same place in the world
+	/// when viewed from another head pose.
+	/// </summary>
+	/// <param name="capturePose">The head-to-tracking space transform at the time the content has been captured.</param>
+	/// <param name="displayPose">The head-to-tracking space transform at the time the content is displayed.</param>
+	/// <returns>A transform from head space at capture time into head space at display time.</returns>
+	static FTransform ComputeReprojection(const FTransform& capturePose, const FTransform& displayPose) noexcept;
+};
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "CameraFrameSource.h"
+#include "OpenVRCameraFrameSource.generated.h"
+
+/// <summary>
+/// Describes a tracked device that provides a camera.
+/// </summary>
+USTRUCT(BlueprintType)
+struct UNREALDR_API FCameraDeviceInfo
+{
+	GENERATED_BODY()
+
+	/// <summary>
+	/// The index of the tracked device. Device indices are assigned by the runtime and may change, when devices are reconnected.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Devices") int32 DeviceIndex { 0 };
+
+	/// <summary>
+	/// The serial number of the device, which identifies it across sessions.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Devices") FString Serial;
+
+	/// <summary>
+	/// The model number of the device.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Devices") FString Model;
+
+	/// <summary>
+	/// `true`, if the device is the HMD.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Devices") bool bIsHmd { false };
+
+	/// <summary>
+	/// The size of the undistorted camera frames (i.e. both eye images) in pixels.
+	/// </summary>
+	UPROPERTY(BlueprintReadOnly, Category = "UnrealDR|Devices") FIntPoint FrameSize { 0, 0 };
+};
+
+/// <summary>
+/// Frame source that streams frames from an OpenVR tracked camera.
+/// </summary>
+class UNREALDR_API FOpenVRCameraFrameSource : public ICameraFrameSource
+{
+private:
+	/// <summary>
+	/// Interface pointer to the VR system instance.
+	/// </summary>
+	vr::IVRSystem* m_system{ nullptr };
+
+	/// <summary>
+	/// Interface pointer to the tracked camera instance.
+	/// </summary>
+	vr::IVRTrackedCamera* m_camera{ nullptr };
+
+	/// <summary>
+	/// The index of the tracked device that provides the camera.
+	/// </summary>
+	vr::TrackedDeviceIndex_t m_device{ vr::k_unTrackedDeviceIndex_Hmd };
+
+	/// <summary>
+	/// Handle of the tracked camera.
+	/// </summary>
+	vr::TrackedCameraHandle_t m_trackedCamera{ INVALID_TRACKED_CAMERA_HANDLE };
+
+	/// <summary>
+	/// The type of frames requested from the runtime.
+	/// </summary>
+	vr::EVRTrackedCameraFrameType m_frameType{ vr::VRTrackedCameraFrameType_Undistorted };
+
+public:
+	FOpenVRCameraFrameSource(vr::IVRSystem* system, vr::IVRTrackedCamera* camera, vr::TrackedDeviceIndex_t device = vr::k_unTrackedDeviceIndex_Hmd, vr::EVRTrackedCameraFrameType frameType = vr::VRTrackedCameraFrameType_Undistorted);
+	virtual ~FOpenVRCameraFrameSource();
+
+public:
+	/// <summary>
+	/// Creates a frame source for a tracked device, if the device provides a camera.
+	/// </summary>
+	/// <param name="system">The VR system instance.</param>
+	/// <param name="device">The index of the tracked device.</param>
+	/// <param name="frameType">The type of frames to request. If distorted frames are requested, the runtime does not undistort them.</param>
+	/// <returns>The frame source or `nullptr`, if the device does not provide a camera.</returns>
+	static FCameraFrameSourcePtr Create(vr::IVRSystem* system, vr::TrackedDeviceIndex_t device = vr::k_unTrackedDeviceIndex_Hmd, vr::EVRTrackedCameraFrameType frameType = vr::VRTrackedCameraFrameType_Undistorted);
+
+	/// <summary>
+	/// Enumerates the connected tracked devices that provide a camera.
+	/// </summary>
+	/// <param name="system">The VR system instance.</param>
+	/// <param name="devices">Receives the devices, ordered by their device index.</param>
+	static void EnumerateDevices(vr::IVRSystem* system, TArray<FCameraDeviceInfo>& devices);
+
+	/// <summary>
+	/// Returns the index of the connected tracked device with a serial number, or `vr::k_unTrackedDeviceIndexInvalid`, if there is no such device.
+	/// </summary>
+	static vr::TrackedDeviceIndex_t FindDevice(vr::IVRSystem* system, const FString& serial);
+
+	/// <summary>
+	/// Returns a string property of a tracked device, or an empty string, if the device does not report it.
+	/// </summary>
+	static FString GetStringProperty(vr::IVRSystem* system, vr::TrackedDeviceIndex_t device, vr::ETrackedDeviceProperty property);
+
+	// ICameraFrameSource
+public:
+	virtual const TCHAR* GetName() const noexcept override { return TEXT("OpenVR"); }
+	virtual bool GetFrameSize(uint32_t& width, uint32_t& height, uint32_t& frameBufferSize) const override;
+	virtual bool GetIntrinsics(vr::EVREye eye, vr::HmdVector2_t& focalLength, vr::HmdVector2_t& center) const override;
+	virtual bool GetExtrinsics(vr::HmdMatrix34_t (&cameraToHead)[2]) const override;
+	virtual bool Acquire() override;
+	virtual void Release() override;
+	virtual bool IsAcquired() const noexcept override { return m_trackedCamera != INVALID_TRACKED_CAMERA_HANDLE; }
+	virtual bool GetNextFrame(uint32_t lastFrameSequence, uint8_t* buffer, uint32_t bufferSize, vr::CameraVideoStreamFrameHeader_t& header) override;
+	virtual bool GetDistortion(vr::EVREye eye, FCameraDistortion& distortion) const override;
+};
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeCounter64.h"
+
+#include "CameraFrameSource.h"
+#include "CameraStreamFormat.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/// <summary>
+/// Frame source that replays a capture file, written by the <see cref="FCameraStreamRecorder" />.
+/// </summary>
+/// <remarks>
+/// The capture file is memory-mapped and frames are decoded on demand, directly into the buffer provided by the caller. The frame index is copied and validated
+/// when the file is opened, so that a truncated or corrupted capture file is rejected instead of being read past its end. Frames are replayed at the original rate,
+/// scaled by a playback rate. If the playback rate is `0`, each call to <see cref="GetNextFrame" /> returns the next frame, which allows to process a capture as
+/// fast as possible.
+/// </remarks>
+class UNREALDR_API FReplayCameraFrameSource : public ICameraFrameSource
+{
+private:
+	/// <summary>
+	/// The path of the capture file.
+	/// </summary>
+	FString m_fileName;
+
+	/// <summary>
+	/// The handle of the memory-mapped capture file.
+	/// </summary>
+	TUniquePtr<IMappedFileHandle> m_mappedFile;
+
+	/// <summary>
+	/// The mapped region that covers the whole capture file.
+	/// </summary>
+	TUniquePtr<IMappedFileRegion> m_mappedRegion;
+
+	/// <summary>
+	/// The header of the capture file.
+	/// </summary>
+	FCameraStreamFileHeader m_header;
+
+	/// <summary>
+	/// A copy of the frame index of the capture file.
+	/// </summary>
+	TArray<FCameraStreamIndexEntry> m_index;
+
+	/// <summary>
+	/// The number of frames in the capture file.
+	/// </summary>
+	uint32 m_frameCount{ 0 };
+
+	/// <summary>
+	/// The replay speed relative to the original frame rate or `0` to replay frames as fast as they are requested.
+	/// </summary>
+	float m_playbackRate{ 1.f };
+
+	/// <summary>
+	/// `true`, if the replay should start over after the last frame.
+	/// </summary>
+	bool m_loop{ true };
+
+	/// <summary>
+	/// The platform cycles at which the source has been acquired or a negative value, if it is not acquired. It is written by the game thread and read by the
+	/// capture thread.
+	/// </summary>
+	FThreadSafeCounter64 m_startCycles{ -1 };
+
+	/// <summary>
+	/// The index of the frame that has been returned last. It is reset by the game thread and advanced by the capture thread.
+	/// </summary>
+	FThreadSafeCounter64 m_currentFrame{ -1 };
+
+public:
+	FReplayCameraFrameSource(const FString& fileName, float playbackRate = 1.f, bool loop = true);
+	virtual ~FReplayCameraFrameSource();
+
+public:
+	/// <summary>
+	/// Opens and validates a capture file.
+	/// </summary>
+	/// <param name="fileName">The path of the capture file.</param>
+	/// <param name="playbackRate">The replay speed relative to the original frame rate or `0` to replay frames as fast as they are requested.</param>
+	/// <param name="loop">`true`, if the replay should start over after the last frame.</param>
+	/// <returns>The frame source or `nullptr`, if the file could not be opened.</returns>
+	static FCameraFrameSourcePtr Create(const FString& fileName, float playbackRate = 1.f, bool loop = true);
+
+	/// <summary>
+	/// Returns the number of frames in the capture file.
+	/// </summary>
+	uint32 GetFrameCount() const noexcept { return m_frameCount; }
+
+	/// <summary>
+	/// Decodes a frame of the capture file.
+	/// </summary>
+	/// <param name="frameIndex">The index of the frame within the capture file.</param>
+	/// <param name="buffer">The buffer to decode the frame into. If this is `nullptr`, only the header is returned.</param>
+	/// <param name="bufferSize">The size of <paramref name="buffer" /> in bytes.</param>
+	/// <param name="header">The header of the frame.</param>
+	/// <returns>`true`, if the frame has been decoded, otherwise `false`.</returns>
+	bool DecodeFrame(uint32 frameIndex, uint8_t* buffer, uint32_t bufferSize, vr::CameraVideoStreamFrameHeader_t& header) const;
+
+private:
+	bool Open();
+
+	// ICameraFrameSource
+public:
+	virtual const TCHAR* GetName() const noexcept override { return TEXT("Replay"); }
+	virtual bool GetFrameSize(uint32_t& width, uint32_t& height, uint32_t& frameBufferSize) const override;
+	virtual bool GetIntrinsics(vr::EVREye eye, vr::HmdVector2_t& focalLength, vr::HmdVector2_t& center) const override;
+	virtual bool GetExtrinsics(vr::HmdMatrix34_t (&cameraToHead)[2]) const override;
+	virtual bool Acquire() override;
+	virtual void Release() override;
+	virtual bool IsAcquired() const noexcept override { return m_startCycles.GetValue() >= 0; }
+	virtual bool GetNextFrame(uint32_t lastFrameSequence, uint8_t* buffer, uint32_t bufferSize, vr::CameraVideoStreamFrameHeader_t& header) override;
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "CameraFrameSource.h"
+
+/// <summary>
+/// Frame source that generates deterministic stereo frames, so that the frame pipeline can be run and profiled without an HMD.
+/// </summary>
+/// <remarks>
+/// The source produces a scrolling checkerboard pattern at a fixed frame rate. The content of each frame only depends on its sequence number, whilst the sequence
+/// number only depends on the time since the source has been acquired. The right eye image is shifted horizontally to mimic a stereo disparity.
+/// </remarks>
+class UNREALDR_API FSyntheticCameraFrameSource : public ICameraFrameSource
+{
+private:
+	/// <summary>
+	/// The width of an eye image in pixels.
+	/// </summary>
+	uint32_t m_eyeWidth{ 0 };
+
+	/// <summary>
+	/// The height of an eye image in pixels.
+	/// </summary>
+	uint32_t m_eyeHeight{ 0 };
+
+	/// <summary>
+	/// The number of frames generated per second.
+	/// </summary>
+	float m_frameRate{ 60.f };
+
+	/// <summary>
+	/// The horizontal field of view of the virtual cameras in degrees.
+	/// </summary>
+	float m_fieldOfView{ 100.f };
+
+	/// <summary>
+	/// The pre-computed pattern the frames are copied from. It is one pattern period wider than an eye image, so that it can be scrolled.
+	/// </summary>
+	TArray<uint8> m_pattern;
+
+	/// <summary>
+	/// The platform time (in seconds), the source has been acquired or a negative value, if it is not acquired.
+	/// </summary>
+	double m_startTime{ -1.0 };
+
+public:
+	FSyntheticCameraFrameSource(uint32_t eyeWidth, uint32_t eyeHeight, float frameRate = 60.f, float fieldOfView = 100.f);
+	virtual ~FSyntheticCameraFrameSource() = default;
+
+public:
+	/// <summary>
+	/// Fills a frame buffer with the synthetic frame of a certain sequence number.
+	/// </summary>
+	/// <param name="frameSequence">The sequence number of the frame.</param>
+	/// <param name="buffer">The buffer to write the frame to. Must be at least as large as the frame buffer size.</param>
+	void GenerateFrame(uint32_t frameSequence, uint8_t* buffer) const;
+
+	/// <summary>
+	/// Returns the platform time (in seconds) a frame with a certain sequence number is exposed, or `0`, if the source has not been acquired.
+	/// </summary>
+	double GetExposureTime(uint32_t frameSequence) const noexcept;
+
+	// ICameraFrameSource
+public:
+	virtual const TCHAR* GetName() const noexcept override { return TEXT("Synthetic"); }
+	virtual bool GetFrameSize(uint32_t& width, uint32_t& height, uint32_t& frameBufferSize) const override;
+	virtual bool GetIntrinsics(vr::EVREye eye, vr::HmdVector2_t& focalLength, vr::HmdVector2_t& center) const override;
+	virtual bool GetExtrinsics(vr::HmdMatrix34_t (&cameraToHead)[2]) const override;
+	virtual bool Acquire() override;
+	virtual void Release() override;
+	virtual bool IsAcquired() const noexcept override { return m_startTime >= 0.0; }
+	virtual bool GetNextFrame(uint32_t lastFrameSequence, uint8_t* buffer, uint32_t bufferSize, vr::CameraVideoStreamFrameHeader_t& header) override;
+	virtual double GetExposureTime(const vr::CameraVideoStreamFrameHeader_t& header) const override { return this->GetExposureTime(header.nFrameSequence); }
+};
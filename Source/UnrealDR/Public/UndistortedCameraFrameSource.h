@@ -0,0 +1,86 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "CameraFrameSource.h"
+#include "CameraUndistortion.h"
+
+/// <summary>
+/// Frame source that removes the lens distortion from the frames of another source on the CPU.
+/// </summary>
+/// <remarks>
+/// The source wraps a source that provides distorted frames (e.g. an OpenVR tracked camera that requests `VRTrackedCameraFrameType_Distorted`), so that the runtime
+/// does not need to undistort them. Each frame is copied into an intermediate buffer and undistorted into the target buffer using a pre-computed remap table for
+/// each eye. The target frames use a configurable resolution and a pinhole projection with a configurable horizontal field of view, which allows to trade field of
+/// view for throughput. The remap tables are only re-built, if the calibration of the wrapped source changes. Undistortion runs on the thread that requests the
+/// frames, which is the capture worker.
+/// </remarks>
+class UNREALDR_API FUndistortedCameraFrameSource : public ICameraFrameSource
+{
+private:
+	/// <summary>
+	/// The source that provides the distorted frames.
+	/// </summary>
+	FCameraFrameSourcePtr m_source;
+
+	/// <summary>
+	/// The width of an undistorted eye image in pixels.
+	/// </summary>
+	uint32_t m_eyeWidth{ 0 };
+
+	/// <summary>
+	/// The height of an undistorted eye image in pixels.
+	/// </summary>
+	uint32_t m_eyeHeight{ 0 };
+
+	/// <summary>
+	/// The horizontal field of view of the undistorted images in degrees.
+	/// </summary>
+	float m_fieldOfView{ 100.f };
+
+	/// <summary>
+	/// The size of a distorted frame.
+	/// </summary>
+	uint32_t m_sourceWidth{ 0 };
+	uint32_t m_sourceHeight{ 0 };
+
+	/// <summary>
+	/// The buffer the distorted frames are copied into.
+	/// </summary>
+	TArray<uint8> m_sourceBuffer;
+
+	/// <summary>
+	/// The remap tables for the left and right eye.
+	/// </summary>
+	FCameraUndistortion m_undistortion[2];
+
+public:
+	FUndistortedCameraFrameSource(FCameraFrameSourcePtr source, uint32_t eyeWidth, uint32_t eyeHeight, float fieldOfView = 100.f);
+	virtual ~FUndistortedCameraFrameSource() = default;
+
+public:
+	/// <summary>
+	/// Creates a source that undistorts the frames of another source.
+	/// </summary>
+	/// <param name="source">The source that provides distorted frames.</param>
+	/// <param name="eyeWidth">The width of an undistorted eye image in pixels.</param>
+	/// <param name="eyeHeight">The height of an undistorted eye image in pixels.</param>
+	/// <param name="fieldOfView">The horizontal field of view of the undistorted images in degrees.</param>
+	/// <returns>The frame source or `nullptr`, if <paramref name="source" /> is invalid.</returns>
+	static FCameraFrameSourcePtr Create(FCameraFrameSourcePtr source, uint32_t eyeWidth, uint32_t eyeHeight, float fieldOfView = 100.f);
+
+private:
+	bool BuildRemapTables();
+
+	// ICameraFrameSource
+public:
+	virtual const TCHAR* GetName() const noexcept override { return TEXT("Undistorted"); }
+	virtual bool GetFrameSize(uint32_t& width, uint32_t& height, uint32_t& frameBufferSize) const override;
+	virtual bool GetIntrinsics(vr::EVREye eye, vr::HmdVector2_t& focalLength, vr::HmdVector2_t& center) const override;
+	virtual bool GetExtrinsics(vr::HmdMatrix34_t (&cameraToHead)[2]) const override { return m_source->GetExtrinsics(cameraToHead); }
+	virtual bool Acquire() override;
+	virtual void Release() override { m_source->Release(); }
+	virtual bool IsAcquired() const noexcept override { return m_source->IsAcquired(); }
+	virtual bool GetNextFrame(uint32_t lastFrameSequence, uint8_t* buffer, uint32_t bufferSize, vr::CameraVideoStreamFrameHeader_t& header) override;
+	virtual double GetExposureTime(const vr::CameraVideoStreamFrameHeader_t& header) const override { return m_source->GetExposureTime(header); }
+};
@@ -2,14 +2,29 @@
 
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
+#include "Stats/Stats.h"
+#include "Async/Future.h"
+#include "HAL/CriticalSection.h"
 
 #include <OpenVR/OpenVRv1_5_17/headers/openvr.h>
 
 DEFINE_LOG_CATEGORY_STATIC(LOG_UNREAL_DR, Log, All);
+DECLARE_STATS_GROUP(TEXT("UnrealDR"), STATGROUP_UnrealDR, STATCAT_Advanced);
+
+class FCameraStreamHub;
 
 class FUnrealDRModule : public IModuleInterface {
 private:
-	vr::IVRSystem* m_system;
+	mutable vr::IVRSystem* m_system{ nullptr };
+	TUniquePtr<FCameraStreamHub> m_streamHub;
+
+	// The VR system is initialized lazily on a background thread, when it is requested for the first time. Callbacks wait, until an initialization succeeds, and
+	// failed initializations are retried periodically, while callbacks are waiting.
+	mutable FCriticalSection m_systemLock;
+	mutable TSharedFuture<vr::IVRSystem*> m_systemFuture;
+	mutable double m_lastInitializationTime{ 0.0 };
+	TArray<TTuple<FDelegateHandle, TFunction<void(vr::IVRSystem*)>>> m_systemCallbacks;
+	FDelegateHandle m_retryHandle;
 
 public:
 	virtual void StartupModule() override;
@@ -17,4 +32,14 @@ public:
 
 public:
 	vr::IVRSystem* getVirtualRealitySystem() const;
+	TSharedFuture<vr::IVRSystem*> requestVirtualRealitySystem() const;
+	FDelegateHandle whenVirtualRealitySystemReady(TFunction<void(vr::IVRSystem*)> callback);
+	void cancelVirtualRealitySystemCallback(FDelegateHandle handle);
+	FCameraStreamHub& getStreamHub();
+
+private:
+	TSharedFuture<vr::IVRSystem*> beginInitializingVirtualRealitySystem() const;
+	vr::IVRSystem* initializeVirtualRealitySystem(bool retry) const;
+	void notifyVirtualRealitySystemReady();
+	void scheduleVirtualRealitySystemRetry();
 };
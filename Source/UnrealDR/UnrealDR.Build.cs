@@ -17,6 +17,8 @@ public class UnrealDR : ModuleRules
 		PrivateDependencyModuleNames.AddRange(new string[] {
 			"CoreUObject",
 			"Engine",
+			"RenderCore",
+			"RHI",
 			"Slate",
 			"SlateCore",
 			"HeadMountedDisplay",
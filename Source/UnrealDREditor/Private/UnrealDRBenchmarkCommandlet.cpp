@@ -0,0 +1,422 @@
+#include "UnrealDRBenchmarkCommandlet.h"
+#include "CameraSeeThroughComponent.h"
+#include <Engine/World.h>
+#include <Engine/Engine.h>
+#include <GameFramework/Actor.h>
+#include <HAL/PlatformTime.h>
+#include <HAL/PlatformProcess.h>
+#include <HAL/PlatformTLS.h>
+#include <HAL/UnrealMemory.h>
+#include <Misc/Parse.h>
+#include <Misc/Paths.h>
+#include <Misc/DateTime.h>
+#include <Misc/FileHelper.h>
+#include <RenderingThread.h>
+#include <Dom/JsonObject.h>
+#include <Serialization/JsonWriter.h>
+#include <Serialization/JsonSerializer.h>
+
+namespace
+{
+	/// <summary>
+	/// Forwards to the engine allocator and counts the allocations of the threads that have enabled counting.
+	/// </summary>
+	/// <remarks>
+	/// The allocator is installed as `GMalloc` once and is never uninstalled or destroyed, so that memory is released through the same allocator chain it has been
+	/// allocated from. Counting is scoped to a thread by a TLS slot, so that allocations of the capture worker, the task graph and the render thread are not counted.
+	/// </remarks>
+	class FCountingMalloc : public FMalloc
+	{
+	public:
+		/// <summary>
+		/// Counts the allocations of the calling thread, while it is in scope.
+		/// </summary>
+		class FScope
+		{
+		private:
+			const FCountingMalloc& m_allocator;
+			int64 m_allocations{ 0 };
+
+		public:
+			FScope(const FCountingMalloc& allocator) : m_allocator(allocator) { FPlatformTLS::SetTlsValue(m_allocator.m_tlsSlot, &m_allocations); }
+			~FScope() { FPlatformTLS::SetTlsValue(m_allocator.m_tlsSlot, nullptr); }
+
+			FScope(const FScope&) = delete;
+			FScope& operator=(const FScope&) = delete;
+
+		public:
+			int64 GetAllocations() const noexcept { return m_allocations; }
+		};
+
+	private:
+		FMalloc* m_allocator;
+		uint32 m_tlsSlot;
+
+	private:
+		FCountingMalloc(FMalloc* allocator) : m_allocator(allocator), m_tlsSlot(FPlatformTLS::AllocTlsSlot()) { }
+
+	public:
+		/// <summary>
+		/// Returns the counting allocator and installs it as `GMalloc`, when it is requested for the first time. Must be called from the game thread.
+		/// </summary>
+		static const FCountingMalloc& Get()
+		{
+			// The allocator lives in static storage and is never destroyed, since other threads keep allocating through it until the process exits.
+			static TTypeCompatibleBytes<FCountingMalloc> storage;
+			static FCountingMalloc* allocator = nullptr;
+
+			if (allocator == nullptr)
+			{
+				allocator = new (storage.GetTypedPtr()) FCountingMalloc(GMalloc);
+				GMalloc = allocator;
+			}
+
+			return *allocator;
+		}
+
+	private:
+		FORCEINLINE void Count() const
+		{
+			if (int64* allocations = static_cast<int64*>(FPlatformTLS::GetTlsValue(m_tlsSlot)))
+				++(*allocations);
+		}
+
+		// FMalloc
+	public:
+		virtual void* Malloc(SIZE_T count, uint32 alignment) override
+		{
+			this->Count();
+			return m_allocator->Malloc(count, alignment);
+		}
+
+		virtual void* Realloc(void* original, SIZE_T count, uint32 alignment) override
+		{
+			if (count > 0)
+				this->Count();
+
+			return m_allocator->Realloc(original, count, alignment);
+		}
+
+		virtual void Free(void* original) override { m_allocator->Free(original); }
+		virtual SIZE_T QuantizeSize(SIZE_T count, uint32 alignment) override { return m_allocator->QuantizeSize(count, alignment); }
+		virtual bool GetAllocationSize(void* original, SIZE_T& size) override { return m_allocator->GetAllocationSize(original, size); }
+		virtual void Trim(bool trimThreadCaches) override { m_allocator->Trim(trimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { m_allocator->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { m_allocator->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual void UpdateStats() override { m_allocator->UpdateStats(); }
+		virtual void GetAllocatorStats(FGenericMemoryStats& stats) override { m_allocator->GetAllocatorStats(stats); }
+		virtual void DumpAllocatorStats(FOutputDevice& output) override { m_allocator->DumpAllocatorStats(output); }
+		virtual bool ValidateHeap() override { return m_allocator->ValidateHeap(); }
+		virtual bool Exec(UWorld* world, const TCHAR* command, FOutputDevice& output) override { return m_allocator->Exec(world, command, output); }
+		virtual bool IsInternallyThreadSafe() const override { return m_allocator->IsInternallyThreadSafe(); }
+		virtual const TCHAR* GetDescriptiveName() override { return m_allocator->GetDescriptiveName(); }
+	};
+
+	/// <summary>
+	/// A single combination of the swept parameters.
+	/// </summary>
+	struct FBenchmarkConfiguration
+	{
+		FIntPoint Resolution{ 612, 460 };
+		float FrameRate{ 60.f };
+		int32 Components{ 1 };
+	};
+
+	/// <summary>
+	/// The options that apply to all configurations.
+	/// </summary>
+	struct FBenchmarkOptions
+	{
+		float Duration{ 10.f };
+		float Warmup{ 1.f };
+		float TickRate{ 90.f };
+		bool bDirtyTiles{ false };
+		bool bStereoImage{ false };
+	};
+
+	TArray<FString> ParseList(const FString& params, const TCHAR* name, const TCHAR* defaultValue)
+	{
+		FString value;
+
+		if (!FParse::Value(*params, name, value, false))
+			value = defaultValue;
+
+		TArray<FString> items;
+		value.ParseIntoArray(items, TEXT(","), true);
+
+		return items;
+	}
+
+	float GetPercentile(const TArray<float>& sortedSamples, float percentile)
+	{
+		if (sortedSamples.Num() == 0)
+			return 0.f;
+
+		return sortedSamples[FMath::Clamp(FMath::FloorToInt(sortedSamples.Num() * percentile), 0, sortedSamples.Num() - 1)];
+	}
+
+	TSharedRef<FJsonObject> ToJson(const FCameraLatencySummary& summary)
+	{
+		TSharedRef<FJsonObject> json = MakeShared<FJsonObject>();
+		json->SetNumberField(TEXT("Min"), summary.Min);
+		json->SetNumberField(TEXT("Avg"), summary.Avg);
+		json->SetNumberField(TEXT("P50"), summary.P50);
+		json->SetNumberField(TEXT("P95"), summary.P95);
+		json->SetNumberField(TEXT("P99"), summary.P99);
+
+		return json;
+	}
+
+	TSharedPtr<FJsonObject> RunConfiguration(UWorld* world, const FBenchmarkConfiguration& configuration, const FBenchmarkOptions& options, const FCountingMalloc& allocator)
+	{
+		// Spawn an actor with see-through components that stream from the synthetic frame source.
+		AActor* actor = world->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity);
+
+		if (actor == nullptr)
+			return nullptr;
+
+		TArray<UCameraSeeThroughComponent*> components;
+
+		for (int32 c = 0; c < configuration.Components; ++c)
+		{
+			auto component = NewObject<UCameraSeeThroughComponent>(actor, *FString::Printf(TEXT("SeeThrough%d"), c));
+			component->FrameSource = ECameraFrameSourceType::Synthetic;
+			component->SyntheticFrameSize = configuration.Resolution;
+			component->SyntheticFrameRate = configuration.FrameRate;
+			component->StreamSettings.bUploadDirtyTilesOnly = options.bDirtyTiles;
+			component->StreamSettings.bUploadStereoImage = options.bStereoImage;
+
+			if (actor->GetRootComponent() == nullptr)
+				actor->SetRootComponent(component);
+			else
+				component->SetupAttachment(actor->GetRootComponent());
+
+			component->RegisterComponent();
+			components.Add(component);
+		}
+
+		// Begin play starts the shared camera stream.
+		actor->DispatchBeginPlay();
+
+		const FCameraStreamPtr stream = components[0]->GetCameraStream();
+
+		if (!stream.IsValid() || !stream->IsStreaming())
+		{
+			UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to start the benchmark camera stream."));
+			actor->Destroy();
+			return nullptr;
+		}
+
+		// Tick the components like the engine loop does: advance the frame counter, tick all components and end the render frame.
+		const float tickInterval = options.TickRate > 0.f ? 1.f / options.TickRate : 0.f;
+		const double warmupEnd = FPlatformTime::Seconds() + options.Warmup;
+		const double measureEnd = warmupEnd + options.Duration;
+
+		TArray<float> tickTimes;
+		int64 allocations = 0;
+		uint32 frames = 0, ticks = 0, lastSequence = 0;
+		int32 droppedFrames = 0, skippedFrames = 0;
+		double lastTick = FPlatformTime::Seconds();
+
+		for (double now = lastTick; now < measureEnd; now = FPlatformTime::Seconds())
+		{
+			const bool measure = now >= warmupEnd;
+
+			if (measure && ticks == 0)
+			{
+				droppedFrames = stream->GetDroppedFrames();
+				skippedFrames = stream->GetSkippedFrames();
+			}
+
+			int64 tickAllocations = 0;
+			const double tickStart = FPlatformTime::Seconds();
+
+			++GFrameCounter;
+
+			{
+				// Only the allocations of the game thread tick are counted.
+				FCountingMalloc::FScope counting(allocator);
+
+				for (auto component : components)
+					component->TickComponent(static_cast<float>(now - lastTick), ELevelTick::LEVELTICK_All, nullptr);
+
+				tickAllocations = counting.GetAllocations();
+			}
+
+			const double tickEnd = FPlatformTime::Seconds();
+
+			// Since no viewport is rendered, the end of the render frame is marked on the stream's statistics directly, instead of broadcasting the engine delegate.
+			if (const FCameraLatencyStatsPtr& stats = stream->GetLatencyStats())
+			{
+				ENQUEUE_RENDER_COMMAND(UnrealDRBenchmarkEndFrame)([stats](FRHICommandListImmediate&) {
+					stats->MarkRenderFrameEnd();
+				});
+			}
+
+			FlushRenderingCommands();
+			lastTick = now;
+
+			if (measure)
+			{
+				allocations += tickAllocations;
+				tickTimes.Add(static_cast<float>((tickEnd - tickStart) * 1000.0));
+				++ticks;
+
+				if (stream->GetFrameSequence() != lastSequence)
+					++frames;
+			}
+
+			lastSequence = stream->GetFrameSequence();
+
+			// Wait for the next tick.
+			const double sleep = lastTick + tickInterval - FPlatformTime::Seconds();
+
+			if (sleep > 0.0)
+				FPlatformProcess::Sleep(static_cast<float>(sleep));
+		}
+
+		tickTimes.Sort();
+
+		TSharedPtr<FJsonObject> result = MakeShared<FJsonObject>();
+		result->SetStringField(TEXT("Resolution"), FString::Printf(TEXT("%dx%d"), configuration.Resolution.X, configuration.Resolution.Y));
+		result->SetNumberField(TEXT("FrameRate"), configuration.FrameRate);
+		result->SetNumberField(TEXT("Components"), configuration.Components);
+		result->SetNumberField(TEXT("Duration"), options.Duration);
+		result->SetNumberField(TEXT("Ticks"), ticks);
+		result->SetNumberField(TEXT("Frames"), frames);
+		result->SetNumberField(TEXT("Throughput"), frames / options.Duration);
+		result->SetNumberField(TEXT("DroppedFrames"), stream->GetDroppedFrames() - droppedFrames);
+		result->SetNumberField(TEXT("SkippedFrames"), stream->GetSkippedFrames() - skippedFrames);
+		result->SetNumberField(TEXT("AllocationsPerTick"), ticks > 0 ? static_cast<double>(allocations) / ticks : 0.0);
+		result->SetNumberField(TEXT("AllocationsPerFrame"), frames > 0 ? static_cast<double>(allocations) / frames : 0.0);
+
+		TSharedRef<FJsonObject> tickTime = MakeShared<FJsonObject>();
+		tickTime->SetNumberField(TEXT("P50"), GetPercentile(tickTimes, 0.5f));
+		tickTime->SetNumberField(TEXT("P95"), GetPercentile(tickTimes, 0.95f));
+		tickTime->SetNumberField(TEXT("P99"), GetPercentile(tickTimes, 0.99f));
+		tickTime->SetNumberField(TEXT("Max"), tickTimes.Num() > 0 ? tickTimes.Last() : 0.f);
+		result->SetObjectField(TEXT("TickTime"), tickTime);
+
+		// The latency statistics cover the most recent frames of the measurement window. Stages without samples (e.g. exposure, if the source does not report
+		// exposure times) are written as `null` instead of zero latency.
+		TSharedRef<FJsonObject> latencies = MakeShared<FJsonObject>();
+		const FCameraLatencyStatsPtr& stats = stream->GetLatencyStats();
+
+		for (int32 s = 0; s < static_cast<int32>(ECameraLatencyStage::Count); ++s)
+		{
+			const auto stage = static_cast<ECameraLatencyStage>(s);
+
+			if (stats->IsStageAvailable(stage))
+				latencies->SetObjectField(FCameraLatencyStats::GetStageName(stage), ToJson(stats->GetSummary(stage)));
+			else
+				latencies->SetField(FCameraLatencyStats::GetStageName(stage), MakeShared<FJsonValueNull>());
+		}
+
+		result->SetObjectField(TEXT("Latency"), latencies);
+
+		UE_LOG(LOG_UNREAL_DR, Display, TEXT("[UnrealDR] %dx%d @ %.0f fps, %d component(s): %.1f frames/s, tick p50 %.3f ms, p99 %.3f ms, %.1f allocations/frame."), configuration.Resolution.X, configuration.Resolution.Y,
+			configuration.FrameRate, configuration.Components, frames / options.Duration, GetPercentile(tickTimes, 0.5f), GetPercentile(tickTimes, 0.99f), frames > 0 ? static_cast<double>(allocations) / frames : 0.0);
+
+		// Destroying the actor ends play, which stops the stream.
+		actor->Destroy();
+		FlushRenderingCommands();
+
+		return result;
+	}
+}
+
+UUnrealDRBenchmarkCommandlet::UUnrealDRBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 UUnrealDRBenchmarkCommandlet::Main(const FString& params)
+{
+	// Parse the swept parameters.
+	TArray<FBenchmarkConfiguration> configurations;
+
+	for (const FString& resolution : ParseList(params, TEXT("Resolutions="), TEXT("612x460")))
+	{
+		FString width, height;
+
+		if (!resolution.Split(TEXT("x"), &width, &height) || FCString::Atoi(*width) <= 0 || FCString::Atoi(*height) <= 0)
+		{
+			UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Invalid benchmark resolution \"%s\"."), *resolution);
+			return 1;
+		}
+
+		for (const FString& frameRate : ParseList(params, TEXT("FrameRates="), TEXT("60")))
+		{
+			for (const FString& components : ParseList(params, TEXT("Components="), TEXT("1")))
+			{
+				FBenchmarkConfiguration configuration;
+				configuration.Resolution = FIntPoint(FCString::Atoi(*width), FCString::Atoi(*height));
+				configuration.FrameRate = FMath::Max(FCString::Atof(*frameRate), 1.f);
+				configuration.Components = FMath::Max(FCString::Atoi(*components), 1);
+				configurations.Add(configuration);
+			}
+		}
+	}
+
+	FBenchmarkOptions options;
+	FParse::Value(*params, TEXT("Duration="), options.Duration);
+	FParse::Value(*params, TEXT("Warmup="), options.Warmup);
+	FParse::Value(*params, TEXT("TickRate="), options.TickRate);
+	options.bDirtyTiles = FParse::Param(*params, TEXT("DirtyTiles"));
+	options.bStereoImage = FParse::Param(*params, TEXT("StereoImage"));
+	options.Duration = FMath::Max(options.Duration, 0.1f);
+
+	FString outputFile = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("UnrealDR"), TEXT("Benchmarks"), FString::Printf(TEXT("Benchmark_%s.json"), *FDateTime::Now().ToString()));
+	FParse::Value(*params, TEXT("Output="), outputFile);
+
+	// Create a private game world for the components.
+	UWorld* world = UWorld::CreateWorld(EWorldType::Game, false, TEXT("UnrealDRBenchmark"));
+	FWorldContext& context = GEngine->CreateNewWorldContext(EWorldType::Game);
+	context.SetCurrentWorld(world);
+
+	// Count the allocations of the game thread, while the components are ticked.
+	const FCountingMalloc& allocator = FCountingMalloc::Get();
+
+	TArray<TSharedPtr<FJsonValue>> results;
+
+	for (const auto& configuration : configurations)
+	{
+		TSharedPtr<FJsonObject> result = RunConfiguration(world, configuration, options, allocator);
+
+		if (result.IsValid())
+			results.Add(MakeShared<FJsonValueObject>(result));
+
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	}
+
+	GEngine->DestroyWorldContext(world);
+	world->DestroyWorld(false);
+
+	// Write the results.
+	TSharedRef<FJsonObject> root = MakeShared<FJsonObject>();
+	root->SetNumberField(TEXT("Version"), 1);
+	root->SetStringField(TEXT("Timestamp"), FDateTime::UtcNow().ToIso8601());
+	root->SetStringField(TEXT("Platform"), FPlatformProperties::IniPlatformName());
+	root->SetStringField(TEXT("Cpu"), FPlatformMisc::GetCPUBrand().TrimStartAndEnd());
+	root->SetNumberField(TEXT("Cores"), FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+	root->SetNumberField(TEXT("TickRate"), options.TickRate);
+	root->SetBoolField(TEXT("DirtyTileUploads"), options.bDirtyTiles);
+	root->SetBoolField(TEXT("StereoImage"), options.bStereoImage);
+	root->SetArrayField(TEXT("Results"), results);
+
+	FString json;
+	auto writer = TJsonWriterFactory<>::Create(&json);
+
+	if (!FJsonSerializer::Serialize(root, writer) || !FFileHelper::SaveStringToFile(json, *outputFile))
+	{
+		UE_LOG(LOG_UNREAL_DR, Error, TEXT("[UnrealDR] Unable to write benchmark results to \"%s\"."), *outputFile);
+		return 1;
+	}
+
+	UE_LOG(LOG_UNREAL_DR, Display, TEXT("[UnrealDR] Benchmark results have been written to \"%s\"."), *outputFile);
+	return results.Num() == configurations.Num() ? 0 : 1;
+}
@@ -0,0 +1,4 @@
+#include "Modules/ModuleManager.h"
+
+// The editor module only contains the tooling for the runtime module, such as the benchmark commandlet, so it does not need a module implementation.
+IMPLEMENT_MODULE(FDefaultModuleImpl, UnrealDREditor)
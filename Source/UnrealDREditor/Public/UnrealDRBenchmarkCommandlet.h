@@ -0,0 +1,34 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "UnrealDRBenchmarkCommandlet.generated.h"
+
+/// <summary>
+/// Benchmarks the camera-to-texture pipeline of <see cref="UCameraSeeThroughComponent" /> without an HMD.
+/// </summary>
+/// <remarks>
+/// The commandlet spawns see-through components that stream from the synthetic frame source into a private game world and ticks them at a fixed rate. The components
+/// run the same frame path as in a game: they share one camera stream, which picks up the frames from the capture worker and uploads them.
+/// For each combination of resolution, frame rate and component count, it measures the throughput, the game thread time per tick, the latencies of the pipeline
+/// stages and the number of allocations, and writes them to a JSON file. It is meant to be run headless, e.g.:
+///
+/// `UE4Editor-Cmd Project.uproject -run=UnrealDRBenchmark -nullrhi -Resolutions=612x460,1224x920 -FrameRates=30,60 -Components=1,4 -Duration=10`
+///
+/// Further options are `-TickRate=` (ticks per second, `0` ticks as fast as possible), `-Warmup=` (seconds before measuring), `-Output=` (the JSON file, which
+/// defaults to `Saved/UnrealDR/Benchmarks/`), `-DirtyTiles` (only uploads dirty tiles, which components do not by default) and `-StereoImage` (uploads a single
+/// stereo image).
+/// </remarks>
+UCLASS()
+class UNREALDREDITOR_API UUnrealDRBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UUnrealDRBenchmarkCommandlet();
+
+	// UCommandlet
+public:
+	virtual int32 Main(const FString& params) override;
+};
@@ -0,0 +1,27 @@
+using UnrealBuildTool;
+
+public class UnrealDREditor : ModuleRules
+{
+	public UnrealDREditor(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+		
+		PublicIncludePaths.AddRange(new string[] { });
+		PrivateIncludePaths.AddRange(new string[] { });
+		DynamicallyLoadedModuleNames.AddRange(new string[] { });
+
+		PublicDependencyModuleNames.AddRange(new string[] { 
+			"Core",
+			"CoreUObject",
+			"Engine"
+		});
+
+		PrivateDependencyModuleNames.AddRange(new string[] {
+			"RenderCore",
+			"OpenVR",
+			"ProceduralMeshComponent",
+			"Json",
+			"UnrealDR"
+		});
+	}
+}